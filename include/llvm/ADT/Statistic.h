@@ -21,11 +21,16 @@
 //
 // NOTE: Statistics *must* be declared as global variables.
 //
+// Each thread counts into its own copy of the statistics, so threads bumping
+// the same statistic do not share a cache line. The copies are added up when
+// the value is read or printed.
+//
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_ADT_STATISTIC_H
 #define LLVM_ADT_STATISTIC_H
 
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Atomic.h"
 #include "llvm/Support/Compiler.h"
 #include <atomic>
@@ -42,8 +47,12 @@ public:
   const char *Desc;
   std::atomic<unsigned> Value;
   bool Initialized;
+  unsigned Index;
 
-  unsigned getValue() const { return Value.load(std::memory_order_relaxed); }
+  /// Return the value of the statistic, summed over all the threads. This
+  /// takes a lock: avoid it in hot code, and so the postfix ++ and --, which
+  /// return the value from before the update.
+  unsigned getValue() const;
   const char *getDebugType() const { return DebugType; }
   const char *getName() const { return Name; }
   const char *getDesc() const { return Desc; }
@@ -55,49 +64,59 @@ public:
     Desc = desc;
     Value = 0;
     Initialized = false;
+    Index = 0;
   }
 
   // Allow use of this class as the value itself.
   operator unsigned() const { return getValue(); }
 
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
-   const Statistic &operator=(unsigned Val) {
-    Value.store(Val, std::memory_order_relaxed);
-    return init();
+  const Statistic &operator=(unsigned Val) {
+    init();
+    setValue(Val);
+    return *this;
   }
 
   const Statistic &operator++() {
-    Value.fetch_add(1, std::memory_order_relaxed);
-    return init();
+    init();
+    addValue(1);
+    return *this;
   }
 
   unsigned operator++(int) {
     init();
-    return Value.fetch_add(1, std::memory_order_relaxed);
+    unsigned OldValue = getValue();
+    addValue(1);
+    return OldValue;
   }
 
   const Statistic &operator--() {
-    Value.fetch_sub(1, std::memory_order_relaxed);
-    return init();
+    init();
+    addValue(-1u);
+    return *this;
   }
 
   unsigned operator--(int) {
     init();
-    return Value.fetch_sub(1, std::memory_order_relaxed);
+    unsigned OldValue = getValue();
+    addValue(-1u);
+    return OldValue;
   }
 
   const Statistic &operator+=(unsigned V) {
     if (V == 0)
       return *this;
-    Value.fetch_add(V, std::memory_order_relaxed);
-    return init();
+    init();
+    addValue(V);
+    return *this;
   }
 
   const Statistic &operator-=(unsigned V) {
     if (V == 0)
       return *this;
-    Value.fetch_sub(V, std::memory_order_relaxed);
-    return init();
+    init();
+    addValue(-V);
+    return *this;
   }
 
 #else  // Statistics are disabled in release builds.
@@ -141,12 +160,31 @@ protected:
     return *this;
   }
   void RegisterStatistic();
+
+  /// Add \p Delta to the copy of the statistic of the current thread.
+  void addValue(unsigned Delta);
+
+  /// Set the value of the statistic, clearing the copies of all threads.
+  void setValue(unsigned Val);
 };
 
 // STATISTIC - A macro to make definition of statistics really simple.  This
 // automatically passes the DEBUG_TYPE of the file into the statistic.
 #define STATISTIC(VARNAME, DESC)                                               \
-  static llvm::Statistic VARNAME = {DEBUG_TYPE, #VARNAME, DESC, {0}, 0}
+  static llvm::Statistic VARNAME = {DEBUG_TYPE, #VARNAME, DESC, {0}, 0, 0}
+
+/// Attribute the statistics the current thread bumps to the module \p Name
+/// while the scope is alive. The legacy pass manager opens one around each
+/// module it runs; threads working on a module on its behalf should open
+/// their own. -stats-json reports the statistics of each module separately.
+/// The scope does nothing unless statistics are compiled in and enabled.
+class StatisticModuleScope {
+  unsigned PrevModule;
+
+public:
+  explicit StatisticModuleScope(StringRef Name);
+  ~StatisticModuleScope();
+};
 
 /// \brief Enable the collection and printing of statistics.
 void EnableStatistics();
@@ -163,7 +201,8 @@ void PrintStatistics();
 /// \brief Print statistics to the given output stream.
 void PrintStatistics(raw_ostream &OS);
 
-/// Print statistics in JSON format.
+/// Print statistics in JSON format: the totals, then the statistics of each
+/// module, keyed by module identifier.
 void PrintStatisticsJSON(raw_ostream &OS);
 
 } // end llvm namespace
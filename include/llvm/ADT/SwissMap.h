@@ -0,0 +1,726 @@
+//===- llvm/ADT/SwissMap.h - Group probed hash table ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SwissMap class, an open addressing hash table that
+// keeps one control byte per slot next to the slots, in the style of the
+// "Swiss tables" of Abseil.
+//
+// A control byte tells whether its slot is empty, deleted or full, and for a
+// full slot, holds 7 bits of the hash of its key. A lookup compares the
+// control bytes of a whole group of slots with the 7 bits of the hash it
+// looks for at once (with SSE2 or NEON when available), and only compares
+// the keys of the slots that match, which are few: lookups touch the slots
+// themselves about once, even in a table of tombstones.
+//
+// Unlike DenseMap, SwissMap does not need empty and tombstone keys, and it
+// reuses the slots erased in a group before probing further, so a map that
+// sees many insertions and erasures does not have to rehash for them.
+//
+// The price is that a lookup that finds its key reads a line of control bytes
+// and then a line of slots, where a DenseMap lookup usually finds its key in
+// the first bucket it reads. Once the table no longer fits in the caches,
+// which for pointer keys happens around a million entries, successful lookups
+// and erasures are slower than with DenseMap; unsuccessful lookups and
+// workloads that mix insertions and erasures still gain. utils/swissmap-bench
+// measures both maps.
+//
+// The interface follows DenseMap, so that a DenseMap can be replaced by a
+// SwissMap. Like with DenseMap, inserting into the map invalidates the
+// iterators, and erasing an entry only invalidates the iterators to it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_SWISSMAP_H
+#define LLVM_ADT_SWISSMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/EpochTracker.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace llvm {
+
+namespace detail {
+
+/// The values of the control byte of the slots that are not full. Full slots
+/// have the top bit clear and 7 bits of the hash of their key in the others.
+enum : int8_t { SwissEmpty = -128, SwissDeleted = -2 };
+
+/// The slots of a group that match some criterion. The bit of slot I is bit
+/// I << Shift of the mask.
+template <unsigned Shift> class SwissBitMask {
+  uint64_t Mask;
+
+public:
+  explicit SwissBitMask(uint64_t Mask) : Mask(Mask) {}
+  explicit operator bool() const { return Mask != 0; }
+
+  /// Return the index in the group of the first slot of the mask.
+  unsigned getFirst() const {
+    return countTrailingZeros(Mask, ZB_Undefined) >> Shift;
+  }
+
+  /// Remove the first slot from the mask.
+  SwissBitMask &operator++() {
+    Mask &= Mask - 1;
+    return *this;
+  }
+};
+
+#if defined(__SSE2__)
+/// A group of 16 control bytes, matched with SSE2.
+class SwissGroup {
+  __m128i Ctrl;
+
+public:
+  enum : unsigned { Width = 16 };
+  typedef SwissBitMask<0> BitMask;
+
+  explicit SwissGroup(const int8_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  BitMask match(int8_t H2) const {
+    return BitMask(static_cast<uint16_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Ctrl))));
+  }
+  BitMask matchEmpty() const { return match(SwissEmpty); }
+  /// The slots that are not full are those with the top bit set.
+  BitMask matchEmptyOrDeleted() const {
+    return BitMask(static_cast<uint16_t>(_mm_movemask_epi8(Ctrl)));
+  }
+};
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+/// A group of 8 control bytes, matched with NEON. The masks keep the top bit
+/// of each byte of the comparisons.
+class SwissGroup {
+  int8x8_t Ctrl;
+
+  static uint64_t toMask(uint8x8_t V) {
+    return vget_lane_u64(vreinterpret_u64_u8(V), 0) & 0x8080808080808080ULL;
+  }
+
+public:
+  enum : unsigned { Width = 8 };
+  typedef SwissBitMask<3> BitMask;
+
+  explicit SwissGroup(const int8_t *Pos) : Ctrl(vld1_s8(Pos)) {}
+
+  BitMask match(int8_t H2) const {
+    return BitMask(toMask(vceq_s8(Ctrl, vdup_n_s8(H2))));
+  }
+  BitMask matchEmpty() const { return match(SwissEmpty); }
+  BitMask matchEmptyOrDeleted() const {
+    return BitMask(toMask(vcltz_s8(Ctrl)));
+  }
+};
+#else
+/// A group of 8 control bytes, matched 64 bits at a time. The masks have the
+/// top bit of the byte of each slot set.
+class SwissGroup {
+  uint64_t Ctrl;
+
+  static const uint64_t LSBs = 0x0101010101010101ULL;
+  static const uint64_t MSBs = 0x8080808080808080ULL;
+
+public:
+  enum : unsigned { Width = 8 };
+  typedef SwissBitMask<3> BitMask;
+
+  explicit SwissGroup(const int8_t *Pos)
+      : Ctrl(support::endian::read64le(Pos)) {}
+
+  /// Find the zero bytes of Ctrl ^ H2. This can report a false positive for
+  /// the byte above a true one, when it holds H2 ^ 1: that slot is full, so
+  /// the key comparison rejects it.
+  BitMask match(int8_t H2) const {
+    uint64_t X = Ctrl ^ (LSBs * static_cast<uint8_t>(H2));
+    return BitMask((X - LSBs) & ~X & MSBs);
+  }
+  /// Empty is the only control byte with the top bit set and bit 1 clear.
+  BitMask matchEmpty() const { return BitMask(Ctrl & ~(Ctrl << 6) & MSBs); }
+  BitMask matchEmptyOrDeleted() const { return BitMask(Ctrl & MSBs); }
+};
+#endif
+
+} // end namespace detail
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst>
+class SwissMapIterator;
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>,
+          typename BucketT = detail::DenseMapPair<KeyT, ValueT>>
+class SwissMap : public DebugEpochBase {
+  typedef detail::SwissGroup Group;
+
+  /// The control bytes, and then the slots, in one allocation. The number of
+  /// slots is 0 or a power of 2 that is at least the width of a group.
+  int8_t *Ctrl;
+  BucketT *Slots;
+  unsigned NumSlots;
+  unsigned NumEntries;
+  /// The number of empty slots that can still be filled before the load
+  /// factor gets over 7/8. Deleted slots are reused for free.
+  unsigned GrowthLeft;
+
+public:
+  typedef unsigned size_type;
+  typedef KeyT key_type;
+  typedef ValueT mapped_type;
+  typedef BucketT value_type;
+
+  typedef SwissMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false> iterator;
+  typedef SwissMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>
+      const_iterator;
+
+  /// Create a map that can hold \p InitialReserve entries without growing.
+  explicit SwissMap(unsigned InitialReserve = 0)
+      : Ctrl(nullptr), Slots(nullptr), NumSlots(0), NumEntries(0),
+        GrowthLeft(0) {
+    if (InitialReserve)
+      allocateSlots(getMinSlotsForEntries(InitialReserve));
+  }
+
+  SwissMap(const SwissMap &Other) : SwissMap() { copyFrom(Other); }
+
+  SwissMap(SwissMap &&Other) : SwissMap() { swap(Other); }
+
+  template <typename InputIt> SwissMap(const InputIt &I, const InputIt &E)
+      : SwissMap(std::distance(I, E)) {
+    insert(I, E);
+  }
+
+  ~SwissMap() {
+    destroyAll();
+    operator delete(Ctrl);
+  }
+
+  SwissMap &operator=(const SwissMap &Other) {
+    if (&Other != this) {
+      clear();
+      copyFrom(Other);
+    }
+    return *this;
+  }
+
+  SwissMap &operator=(SwissMap &&Other) {
+    destroyAll();
+    operator delete(Ctrl);
+    Ctrl = nullptr;
+    Slots = nullptr;
+    NumSlots = NumEntries = GrowthLeft = 0;
+    swap(Other);
+    return *this;
+  }
+
+  void swap(SwissMap &RHS) {
+    incrementEpoch();
+    RHS.incrementEpoch();
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Slots, RHS.Slots);
+    std::swap(NumSlots, RHS.NumSlots);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  iterator begin() {
+    if (empty())
+      return end();
+    return iterator(Ctrl, Slots, Ctrl + NumSlots, *this);
+  }
+  iterator end() {
+    return iterator(Ctrl + NumSlots, Slots + NumSlots, Ctrl + NumSlots,
+                    *this, true);
+  }
+  const_iterator begin() const {
+    if (empty())
+      return end();
+    return const_iterator(Ctrl, Slots, Ctrl + NumSlots, *this);
+  }
+  const_iterator end() const {
+    return const_iterator(Ctrl + NumSlots, Slots + NumSlots, Ctrl + NumSlots,
+                          *this, true);
+  }
+
+  bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can contain at least \p NumEntries items
+  /// before resizing again.
+  void reserve(size_type Size) {
+    incrementEpoch();
+    unsigned NewNumSlots = getMinSlotsForEntries(Size);
+    if (NewNumSlots > NumSlots)
+      rehash(NewNumSlots);
+  }
+
+  void clear() {
+    incrementEpoch();
+    if (NumSlots == 0)
+      return;
+    destroyAll();
+    // Free a huge array that is mostly unused.
+    if (NumEntries * 4 < NumSlots && NumSlots > 128) {
+      unsigned NewNumSlots = getMinSlotsForEntries(NumEntries);
+      operator delete(Ctrl);
+      NumEntries = 0;
+      allocateSlots(NewNumSlots);
+      return;
+    }
+    NumEntries = 0;
+    resetCtrl();
+  }
+
+  /// Clear the map and shrink the table to what its number of entries
+  /// before clearing needs.
+  void shrink_and_clear() {
+    incrementEpoch();
+    unsigned OldNumEntries = NumEntries;
+    destroyAll();
+    NumEntries = 0;
+    unsigned NewNumSlots = 0;
+    if (OldNumEntries)
+      NewNumSlots = std::max(64u, getMinSlotsForEntries(OldNumEntries));
+    if (NewNumSlots == NumSlots) {
+      if (NumSlots)
+        resetCtrl();
+      return;
+    }
+    operator delete(Ctrl);
+    allocateSlots(NewNumSlots);
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const KeyT &Val) const { return findSlot(Val) ? 1 : 0; }
+
+  iterator find(const KeyT &Val) {
+    if (BucketT *Slot = findSlot(Val))
+      return makeIterator(Slot);
+    return end();
+  }
+  const_iterator find(const KeyT &Val) const {
+    if (const BucketT *Slot = findSlot(Val))
+      return makeIterator(Slot);
+    return end();
+  }
+
+  /// Alternate version of find() which allows a different, and possibly
+  /// less expensive, key type. The KeyInfoT must provide getHashValue and
+  /// isEqual for LookupKeyT.
+  template <class LookupKeyT> iterator find_as(const LookupKeyT &Val) {
+    if (BucketT *Slot = findSlot(Val))
+      return makeIterator(Slot);
+    return end();
+  }
+  template <class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Val) const {
+    if (const BucketT *Slot = findSlot(Val))
+      return makeIterator(Slot);
+    return end();
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const KeyT &Val) const {
+    if (const BucketT *Slot = findSlot(Val))
+      return Slot->getSecond();
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    return try_emplace(std::move(KV.first), std::move(KV.second));
+  }
+
+  /// Insert the range [I, E) into the map.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(KeyT &&Key, Ts &&... Args) {
+    uint64_t Hash = getHash(Key);
+    if (BucketT *Slot = findSlot(Key, Hash))
+      return std::make_pair(makeIterator(Slot), false);
+    BucketT *Slot = prepareInsert(Hash);
+    new (&Slot->getFirst()) KeyT(std::move(Key));
+    new (&Slot->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    return std::make_pair(makeIterator(Slot), true);
+  }
+
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    uint64_t Hash = getHash(Key);
+    if (BucketT *Slot = findSlot(Key, Hash))
+      return std::make_pair(makeIterator(Slot), false);
+    BucketT *Slot = prepareInsert(Hash);
+    new (&Slot->getFirst()) KeyT(Key);
+    new (&Slot->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    return std::make_pair(makeIterator(Slot), true);
+  }
+
+  bool erase(const KeyT &Val) {
+    BucketT *Slot = findSlot(Val);
+    if (!Slot)
+      return false;
+    eraseSlot(Slot);
+    return true;
+  }
+  void erase(iterator I) { eraseSlot(&*I); }
+
+  value_type &FindAndConstruct(const KeyT &Key) {
+    return *try_emplace(Key).first;
+  }
+
+  ValueT &operator[](const KeyT &Key) { return FindAndConstruct(Key).second; }
+
+  value_type &FindAndConstruct(KeyT &&Key) {
+    return *try_emplace(std::move(Key)).first;
+  }
+
+  ValueT &operator[](KeyT &&Key) {
+    return FindAndConstruct(std::move(Key)).second;
+  }
+
+  /// Return the approximate size (in bytes) of the actual map.
+  /// This is just the raw memory used by the map.
+  /// If entries are pointers to objects, the size of the referenced objects
+  /// are not included.
+  size_t getMemorySize() const {
+    return NumSlots ? getAllocationSize(NumSlots) : 0;
+  }
+
+  /// Return true if the specified pointer points somewhere into the map's
+  /// array of slots (i.e. either to a key or value in the map).
+  bool isPointerIntoBucketsArray(const void *Ptr) const {
+    return Ptr >= Slots && Ptr < Slots + NumSlots;
+  }
+
+  /// Return an opaque pointer into the slots array. In conjunction with the
+  /// previous method, this can be used to determine whether an insertion
+  /// caused the map to reallocate.
+  const void *getPointerIntoBucketsArray() const { return Slots; }
+
+private:
+  /// Scramble the hash of the key, since DenseMapInfo hashes are often
+  /// weak in their high bits. H2, the 7 bits in the control bytes, is taken
+  /// from the top; H1, which picks the first group to probe, from the bits
+  /// below.
+  template <typename LookupKeyT> static uint64_t getHash(const LookupKeyT &K) {
+    return uint64_t(KeyInfoT::getHashValue(K)) * 0x9E3779B97F4A7C15ULL;
+  }
+  static int8_t getH2(uint64_t Hash) { return Hash >> 57; }
+  static unsigned getH1(uint64_t Hash) { return Hash >> 25; }
+
+  static unsigned getMaxEntries(unsigned NumSlots) {
+    return NumSlots - NumSlots / 8;
+  }
+
+  static unsigned getMinSlotsForEntries(unsigned NumEntries) {
+    if (NumEntries == 0)
+      return 0;
+    return std::max<unsigned>(Group::Width,
+                              NextPowerOf2((NumEntries * 8 + 6) / 7 - 1));
+  }
+
+  static size_t getAllocationSize(unsigned NumSlots) {
+    return getSlotsOffset(NumSlots) + sizeof(BucketT) * NumSlots;
+  }
+
+  /// The slots come after the control bytes, at the alignment of BucketT.
+  static size_t getSlotsOffset(unsigned NumSlots) {
+    return alignTo(NumSlots, alignOf<BucketT>());
+  }
+
+  /// The groups are aligned to their width and probed in a triangular
+  /// sequence, which visits every group once since their number is a power
+  /// of 2.
+  class ProbeSeq {
+    unsigned Mask, GroupIndex, Step;
+
+  public:
+    ProbeSeq(uint64_t Hash, unsigned NumSlots)
+        : Mask(NumSlots / Group::Width - 1), GroupIndex(getH1(Hash) & Mask),
+          Step(0) {}
+    /// Return the index of the first slot of the current group.
+    unsigned getOffset() const { return GroupIndex * Group::Width; }
+    void next() {
+      ++Step;
+      GroupIndex = (GroupIndex + Step) & Mask;
+    }
+  };
+
+  template <typename LookupKeyT>
+  BucketT *findSlot(const LookupKeyT &Key, uint64_t Hash) const {
+    if (NumSlots == 0)
+      return nullptr;
+    int8_t H2 = getH2(Hash);
+    for (ProbeSeq Seq(Hash, NumSlots);; Seq.next()) {
+      Group G(Ctrl + Seq.getOffset());
+      for (auto M = G.match(H2); M; ++M) {
+        BucketT *Slot = Slots + Seq.getOffset() + M.getFirst();
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Key, Slot->getFirst())))
+          return Slot;
+      }
+      // A key is never inserted past a group with an empty slot.
+      if (LLVM_LIKELY(G.matchEmpty()))
+        return nullptr;
+    }
+  }
+
+  template <typename LookupKeyT>
+  BucketT *findSlot(const LookupKeyT &Key) const {
+    return findSlot(Key, getHash(Key));
+  }
+
+  /// Return the index of the first slot for \p Hash that is empty or
+  /// deleted.
+  unsigned findFirstNonFull(uint64_t Hash) const {
+    for (ProbeSeq Seq(Hash, NumSlots);; Seq.next()) {
+      auto M = Group(Ctrl + Seq.getOffset()).matchEmptyOrDeleted();
+      if (M)
+        return Seq.getOffset() + M.getFirst();
+    }
+  }
+
+  /// Find the slot to insert an entry for \p Hash into, growing the table if
+  /// needed, and mark it full.
+  BucketT *prepareInsert(uint64_t Hash) {
+    incrementEpoch();
+    unsigned Index = NumSlots ? findFirstNonFull(Hash) : 0;
+    // Reusing a deleted slot does not change the load of the table.
+    if (LLVM_UNLIKELY(GrowthLeft == 0 &&
+                      (NumSlots == 0 || Ctrl[Index] != detail::SwissDeleted))) {
+      rehashAndGrow();
+      Index = findFirstNonFull(Hash);
+    }
+    if (Ctrl[Index] == detail::SwissEmpty)
+      --GrowthLeft;
+    ++NumEntries;
+    Ctrl[Index] = getH2(Hash);
+    return Slots + Index;
+  }
+
+  /// Make room for one more entry. When the table is full mostly of deleted
+  /// slots, rehash it at the same size, which drops them; grow it otherwise.
+  void rehashAndGrow() {
+    if (NumSlots && NumEntries < getMaxEntries(NumSlots) / 2)
+      rehash(NumSlots);
+    else
+      rehash(std::max<unsigned>(Group::Width, NumSlots * 2));
+  }
+
+  void eraseSlot(BucketT *Slot) {
+    unsigned Index = Slot - Slots;
+    Slot->getSecond().~ValueT();
+    Slot->getFirst().~KeyT();
+    --NumEntries;
+
+    // Lookups stop at the first group with an empty slot, so no key was
+    // inserted past a group that has one: the slot can be made empty again.
+    // Otherwise, a lookup may have to go on past it, and it is marked
+    // deleted until the next insertion into the group or rehash.
+    if (Group(Ctrl + (Index & ~(Group::Width - 1))).matchEmpty()) {
+      Ctrl[Index] = detail::SwissEmpty;
+      ++GrowthLeft;
+    } else {
+      Ctrl[Index] = detail::SwissDeleted;
+    }
+  }
+
+  void resetCtrl() {
+    std::memset(Ctrl, detail::SwissEmpty, NumSlots);
+    GrowthLeft = getMaxEntries(NumSlots);
+  }
+
+  void allocateSlots(unsigned Num) {
+    NumSlots = Num;
+    if (Num == 0) {
+      Ctrl = nullptr;
+      Slots = nullptr;
+      GrowthLeft = 0;
+      return;
+    }
+    Ctrl = static_cast<int8_t *>(operator new(getAllocationSize(Num)));
+    Slots = reinterpret_cast<BucketT *>(
+        reinterpret_cast<char *>(Ctrl) + getSlotsOffset(Num));
+    resetCtrl();
+  }
+
+  /// Move the entries into a new table of \p NewNumSlots slots.
+  void rehash(unsigned NewNumSlots) {
+    int8_t *OldCtrl = Ctrl;
+    BucketT *OldSlots = Slots;
+    unsigned OldNumSlots = NumSlots;
+    allocateSlots(NewNumSlots);
+    for (unsigned I = 0; I != OldNumSlots; ++I) {
+      if (OldCtrl[I] < 0)
+        continue;
+      BucketT &Old = OldSlots[I];
+      uint64_t Hash = getHash(Old.getFirst());
+      unsigned Index = findFirstNonFull(Hash);
+      Ctrl[Index] = getH2(Hash);
+      new (&Slots[Index].getFirst()) KeyT(std::move(Old.getFirst()));
+      new (&Slots[Index].getSecond()) ValueT(std::move(Old.getSecond()));
+      Old.getSecond().~ValueT();
+      Old.getFirst().~KeyT();
+    }
+    GrowthLeft -= NumEntries;
+    operator delete(OldCtrl);
+  }
+
+  void destroyAll() {
+    if (isPodLike<KeyT>::value && isPodLike<ValueT>::value)
+      return;
+    for (unsigned I = 0; I != NumSlots; ++I) {
+      if (Ctrl[I] < 0)
+        continue;
+      Slots[I].getSecond().~ValueT();
+      Slots[I].getFirst().~KeyT();
+    }
+  }
+
+  void copyFrom(const SwissMap &Other) {
+    assert(NumEntries == 0 && "copying into a map with entries");
+    if (Other.empty())
+      return;
+    reserve(Other.size());
+    for (const BucketT &KV : Other)
+      try_emplace(KV.getFirst(), KV.getSecond());
+  }
+
+  iterator makeIterator(BucketT *Slot) {
+    return iterator(Ctrl + (Slot - Slots), Slot, Ctrl + NumSlots, *this,
+                    true);
+  }
+  const_iterator makeIterator(const BucketT *Slot) const {
+    return const_iterator(Ctrl + (Slot - Slots), Slot, Ctrl + NumSlots, *this,
+                          true);
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst>
+class SwissMapIterator : DebugEpochBase::HandleBase {
+  typedef SwissMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>
+      ConstIterator;
+  friend class SwissMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+  friend class SwissMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false>;
+
+public:
+  typedef ptrdiff_t difference_type;
+  typedef typename std::conditional<IsConst, const BucketT, BucketT>::type
+      value_type;
+  typedef value_type *pointer;
+  typedef value_type &reference;
+  typedef std::forward_iterator_tag iterator_category;
+
+private:
+  const int8_t *Ctrl, *CtrlEnd;
+  pointer Ptr;
+
+public:
+  SwissMapIterator() : Ctrl(nullptr), CtrlEnd(nullptr), Ptr(nullptr) {}
+
+  SwissMapIterator(const int8_t *Ctrl, pointer Pos, const int8_t *CtrlEnd,
+                   const DebugEpochBase &Epoch, bool NoAdvance = false)
+      : DebugEpochBase::HandleBase(&Epoch), Ctrl(Ctrl), CtrlEnd(CtrlEnd),
+        Ptr(Pos) {
+    assert(isHandleInSync() && "invalid construction!");
+    if (!NoAdvance)
+      advancePastEmptySlots();
+  }
+
+  // Converting ctor from non-const iterators to const iterators. SFINAE'd out
+  // for const iterator destinations so it doesn't end up as a user defined copy
+  // constructor.
+  template <bool IsConstSrc,
+            typename = typename std::enable_if<!IsConstSrc && IsConst>::type>
+  SwissMapIterator(
+      const SwissMapIterator<KeyT, ValueT, KeyInfoT, BucketT, IsConstSrc> &I)
+      : DebugEpochBase::HandleBase(I), Ctrl(I.Ctrl), CtrlEnd(I.CtrlEnd),
+        Ptr(I.Ptr) {}
+
+  reference operator*() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return *Ptr;
+  }
+  pointer operator->() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return Ptr;
+  }
+
+  bool operator==(const ConstIterator &RHS) const {
+    assert((!Ptr || isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return Ptr == RHS.Ptr;
+  }
+  bool operator!=(const ConstIterator &RHS) const { return !(*this == RHS); }
+
+  inline SwissMapIterator &operator++() { // Preincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    ++Ctrl;
+    ++Ptr;
+    advancePastEmptySlots();
+    return *this;
+  }
+  SwissMapIterator operator++(int) { // Postincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    SwissMapIterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+private:
+  void advancePastEmptySlots() {
+    while (Ctrl != CtrlEnd && *Ctrl < 0) {
+      ++Ctrl;
+      ++Ptr;
+    }
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT>
+static inline size_t
+capacity_in_bytes(const SwissMap<KeyT, ValueT, KeyInfoT> &X) {
+  return X.getMemorySize();
+}
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_SWISSMAP_H
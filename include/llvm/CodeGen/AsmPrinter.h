@@ -113,6 +113,12 @@ private:
   MCSymbol *CurrentFnEnd;
   MCSymbol *CurExceptionSym;
 
+  /// If the function splitter moved blocks of the current function to the
+  /// cold section, the end of the part of the function left in its own section
+  /// and the symbol starting the cold part.
+  MCSymbol *CurrentFnHotEnd;
+  MCSymbol *CurrentFnColdBegin;
+
   // The garbage collection metadata printer table.
   void *GCMetadataPrinters; // Really a DenseMap.
 
@@ -160,6 +166,8 @@ public:
 
   MCSymbol *getFunctionBegin() const { return CurrentFnBegin; }
   MCSymbol *getFunctionEnd() const { return CurrentFnEnd; }
+  MCSymbol *getFunctionHotEnd() const { return CurrentFnHotEnd; }
+  MCSymbol *getFunctionColdBegin() const { return CurrentFnColdBegin; }
   MCSymbol *getCurExceptionSym();
 
   /// Return information about object file lowering.
@@ -221,6 +229,10 @@ public:
   /// This method emits the body and trailer for a function.
   void EmitFunctionBody();
 
+  /// End the hot part of a split function and start its cold part with
+  /// \p MBB, the first block of the cold section.
+  void emitColdSectionStart(const MachineBasicBlock &MBB);
+
   void emitCFIInstruction(const MachineInstr &MI);
 
   void emitFrameAlloc(const MachineInstr &MI);
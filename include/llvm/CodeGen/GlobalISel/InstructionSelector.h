@@ -0,0 +1,110 @@
+//==-- llvm/CodeGen/GlobalISel/InstructionSelector.h -------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file This file declares the API for the instruction selector.
+/// This class is responsible for selecting machine instructions.
+/// It's implemented by the target. It's used by the InstructionSelect pass.
+///
+/// Targets are expected to select most instructions through a match table
+/// generated by TableGen from their SelectionDAG patterns (see
+/// -gen-global-isel), and to handle by hand what the table cannot express.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_GLOBALISEL_INSTRUCTIONSELECTOR_H
+#define LLVM_CODEGEN_GLOBALISEL_INSTRUCTIONSELECTOR_H
+
+#include "llvm/ADT/ArrayRef.h"
+
+namespace llvm {
+class ConstantInt;
+class MachineInstr;
+class RegisterBankInfo;
+class TargetInstrInfo;
+class TargetRegisterInfo;
+
+/// Provides the logic to select generic machine instructions.
+class InstructionSelector {
+public:
+  virtual ~InstructionSelector() {}
+
+  /// Select the (possibly generic) instruction \p I to only use target-specific
+  /// opcodes. It is OK to insert multiple instructions, but they cannot be
+  /// generic pre-isel instructions.
+  ///
+  /// \returns whether selection succeeded.
+  /// \pre  I.getParent() && I.getParent()->getParent()
+  /// \post
+  ///   if returns true:
+  ///     for I in all mutated/inserted instructions:
+  ///       !isPreISelGenericOpcode(I.getOpcode())
+  ///
+  virtual bool select(MachineInstr &I) const = 0;
+
+protected:
+  /// One row of a match table imported from the SelectionDAG patterns of a
+  /// target. A row matches a generic instruction with the given opcode and
+  /// type size, and replaces it by a single target instruction.
+  struct MatchTableEntry {
+    /// Generic opcode and size in bits of the type of the matched instruction.
+    unsigned GenericOpcode;
+    unsigned SizeInBits;
+    /// Index of the operand of the generic instruction that must be a
+    /// constant, or -1 if none. The constant may either be the operand
+    /// itself or a vreg defined by a G_CONSTANT.
+    int ImmOperand;
+    /// Predicate to check on that constant, 0 if none.
+    unsigned ImmPredicateID;
+    /// Subtarget predicates guarding the pattern, 0 if none.
+    unsigned PredicatesID;
+    /// Target instruction to build.
+    unsigned Opcode;
+    /// For each explicit operand of the target instruction, the index of the
+    /// generic operand it comes from.
+    unsigned NumOperands;
+    int OperandMap[4];
+  };
+
+  InstructionSelector();
+
+  /// Try to select \p I with the first row of \p Table that matches it.
+  /// \p Table must be sorted by generic opcode, then by decreasing pattern
+  /// complexity.
+  ///
+  /// \returns true if \p I has been replaced by a target instruction.
+  bool selectFromTable(MachineInstr &I, ArrayRef<MatchTableEntry> Table,
+                       const TargetInstrInfo &TII,
+                       const TargetRegisterInfo &TRI,
+                       const RegisterBankInfo &RBI) const;
+
+  /// Check the subtarget predicates \p PredicatesID of a match table row.
+  virtual bool checkPredicates(unsigned PredicatesID) const;
+
+  /// Check the immediate predicate \p PredicateID of a match table row
+  /// against \p Imm.
+  virtual bool checkImmPredicate(unsigned PredicateID,
+                                 const ConstantInt &Imm) const;
+
+  /// Mutate the newly-selected instruction \p I to constrain its (possibly
+  /// generic) virtual register operands to the instruction's register class.
+  /// This could involve inserting COPYs before (for uses) or after (for defs).
+  /// This requires the number of operands to match the instruction description.
+  /// \returns whether operand regclass constraining succeeded.
+  ///
+  // FIXME: Not all instructions have the same number of operands. We should
+  // probably expose a constrain helper per operand and let the target selector
+  // constrain individual registers, like fast-isel.
+  bool constrainSelectedInstRegOperands(MachineInstr &I,
+                                        const TargetInstrInfo &TII,
+                                        const TargetRegisterInfo &TRI,
+                                        const RegisterBankInfo &RBI) const;
+};
+
+} // End namespace llvm.
+
+#endif
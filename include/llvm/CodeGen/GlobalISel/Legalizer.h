@@ -0,0 +1,53 @@
+//== llvm/CodeGen/GlobalISel/Legalizer.h ---------------------- -*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file A pass to convert the target-illegal operations created by IR -> MIR
+/// translation into ones the target expects to be able to select. The
+/// decision of what to do with each generic instruction is taken from the
+/// LegalizerInfo of the subtarget, and the actual rewriting is done by the
+/// LegalizerHelper.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_GLOBALISEL_LEGALIZER_H
+#define LLVM_CODEGEN_GLOBALISEL_LEGALIZER_H
+
+#include "llvm/CodeGen/MachineFunctionPass.h"
+
+namespace llvm {
+// Forward declarations.
+class LegalizerInfo;
+class MachineRegisterInfo;
+
+class Legalizer : public MachineFunctionPass {
+public:
+  static char ID;
+
+private:
+  /// Fold each G_ANYEXT of a G_TRUNC into a single conversion of the
+  /// original value (or into the value itself), and delete the conversions
+  /// that become dead. Widening an operation produces those pairs at its
+  /// boundaries.
+  ///
+  /// \return true if the function has been modified.
+  bool combineConversions(MachineFunction &MF, MachineRegisterInfo &MRI);
+
+public:
+  // Ctor, nothing fancy.
+  Legalizer();
+
+  const char *getPassName() const override {
+    return "Legalizer";
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+};
+} // End namespace llvm.
+
+#endif
@@ -0,0 +1,75 @@
+//== llvm/CodeGen/GlobalISel/LegalizerHelper.h ---------------- -*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file Helper to convert the target-illegal operations created by IR -> MIR
+/// translation into ones the target expects to be able to select. This may
+/// occur in multiple phases, for example G_ADD i8 -> G_ADD i16 -> G_ADD i32.
+///
+/// The LegalizerHelper class is where most of the work of the Legalizer pass
+/// happens, and is designed to be callable from other passes that find
+/// themselves with an illegal instruction.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_GLOBALISEL_LEGALIZERHELPER_H
+#define LLVM_CODEGEN_GLOBALISEL_LEGALIZERHELPER_H
+
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+
+namespace llvm {
+// Forward declarations.
+class LegalizerInfo;
+class MachineFunction;
+class MachineInstr;
+class MachineRegisterInfo;
+
+class LegalizerHelper {
+public:
+  enum LegalizeResult {
+    /// Instruction was already legal and no change was made to the
+    /// MachineFunction.
+    AlreadyLegal,
+
+    /// Instruction has been legalized and the MachineFunction changed.
+    Legalized,
+
+    /// Some kind of error has occurred and we could not legalize this
+    /// instruction.
+    UnableToLegalize,
+  };
+
+  LegalizerHelper(MachineFunction &MF);
+
+  /// Replace \p MI by a sequence of legal instructions that can implement the
+  /// same operation. Note that this means \p MI may be deleted, so any
+  /// iterator steps should be performed before calling this function.
+  ///
+  /// Considered as an opaque blob, the legal code will use and define the same
+  /// registers as \p MI.
+  LegalizeResult legalizeInstr(MachineInstr &MI,
+                               const LegalizerInfo &LegalizerInfo);
+
+  /// Perform one legalization step on \p MI. The instructions it produces may
+  /// themselves need further legalization.
+  LegalizeResult legalizeInstrStep(MachineInstr &MI,
+                                   const LegalizerInfo &LegalizerInfo);
+
+  /// Legalize an instruction by performing the operation on a wider scalar
+  /// type of \p WideSize bits (for example an i8 -> i32 add), and truncating
+  /// the result back to the original type.
+  LegalizeResult widenScalar(MachineInstr &MI, unsigned WideSize);
+
+private:
+  MachineIRBuilder MIRBuilder;
+  MachineRegisterInfo &MRI;
+};
+
+} // End namespace llvm.
+
+#endif
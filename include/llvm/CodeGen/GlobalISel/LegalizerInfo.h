@@ -0,0 +1,111 @@
+//==-- llvm/CodeGen/GlobalISel/LegalizerInfo.h ------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// Interface for Targets to specify which operations they can successfully
+/// select and how the others should be expanded most efficiently.
+///
+/// The description is declarative: a target records, for each generic opcode
+/// and scalar size, what should happen to it. Sizes that have not been
+/// described are widened to the next larger legal size of the same opcode if
+/// there is one, and are unsupported otherwise.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_GLOBALISEL_LEGALIZERINFO_H
+#define LLVM_CODEGEN_GLOBALISEL_LEGALIZERINFO_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Target/TargetOpcodes.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace llvm {
+class MachineInstr;
+class MachineIRBuilder;
+class MachineRegisterInfo;
+
+class LegalizerInfo {
+public:
+  enum LegalizeAction : std::uint8_t {
+    /// The operation is expected to be selectable directly by the target, and
+    /// no transformation is necessary.
+    Legal,
+
+    /// The operation should be implemented in terms of a wider scalar
+    /// type. For example an i8 add could be implemented as an i32 add
+    /// (ignoring the high bits).
+    WidenScalar,
+
+    /// The target wants to do something special with this combination of
+    /// operand and type. A callback will be issued when it is needed.
+    Custom,
+
+    /// This operation is completely unsupported on the target. A programming
+    /// error has occurred.
+    Unsupported,
+  };
+
+  LegalizerInfo();
+  virtual ~LegalizerInfo() {}
+
+  /// Compute any ancillary tables needed to quickly decide how an operation
+  /// should be handled. This must be called after all "set*Action" methods but
+  /// before any query is made or incorrect results may be returned.
+  void computeTables();
+
+  /// More friendly way to set an action for common opcodes. \p SizeInBits is
+  /// the size of the type carried by the instruction, or 0 for opcodes such
+  /// as G_BR whose type is not a scalar.
+  void setAction(unsigned Opcode, unsigned SizeInBits, LegalizeAction Action) {
+    assert(isPreISelGenericOpcode(Opcode) && "Not a generic opcode");
+    Actions[Opcode - FirstOp].push_back(std::make_pair(SizeInBits, Action));
+    TablesInitialized = false;
+  }
+
+  /// Determine what action should be taken to legalize the given generic
+  /// instruction opcode and size.
+  ///
+  /// \returns a pair consisting of the kind of legalization that should be
+  /// performed and the destination size in bits that should be used. For
+  /// WidenScalar, this is the size the operation should be widened to.
+  std::pair<LegalizeAction, unsigned> getAction(unsigned Opcode,
+                                                unsigned SizeInBits) const;
+
+  /// Determine what action should be taken to legalize the given generic
+  /// instruction.
+  std::pair<LegalizeAction, unsigned> getAction(const MachineInstr &MI) const;
+
+  bool isLegal(const MachineInstr &MI) const;
+
+  /// Called for instructions whose action is Custom. The target is expected
+  /// to replace \p MI with a legal sequence built by \p MIRBuilder.
+  ///
+  /// \return true if \p MI has been legalized (and erased), false otherwise.
+  virtual bool legalizeCustom(MachineInstr &MI, MachineRegisterInfo &MRI,
+                              MachineIRBuilder &MIRBuilder) const;
+
+private:
+  static const unsigned FirstOp = TargetOpcode::PRE_ISEL_GENERIC_OPCODE_START;
+  static const unsigned LastOp = TargetOpcode::PRE_ISEL_GENERIC_OPCODE_END;
+
+  /// Return the size in bits of the type carried by \p MI, or 0 if that type
+  /// is not a scalar.
+  static unsigned getSizeInBits(const MachineInstr &MI);
+
+  /// For each generic opcode, the explicitly specified (size, action) pairs.
+  /// computeTables sorts them by increasing size.
+  SmallVector<std::pair<unsigned, LegalizeAction>, 4>
+      Actions[LastOp - FirstOp + 1];
+
+  bool TablesInitialized;
+};
+
+} // End namespace llvm.
+
+#endif
@@ -22,6 +22,7 @@
 namespace llvm {
 
 // Forward declarations.
+class ConstantInt;
 class MachineFunction;
 class MachineInstr;
 class TargetInstrInfo;
@@ -115,6 +116,23 @@ public:
   MachineInstr *buildInstr(unsigned Opcode, Type *Ty, unsigned Res,
                            unsigned Op0, unsigned Op1);
 
+  /// Build and insert \p Res<def> = \p Opcode [\p Ty] \p Op0.
+  ///
+  /// \pre setBasicBlock or setMI must have been called.
+  /// \pre Ty == nullptr or isPreISelGenericOpcode(Opcode)
+  ///
+  /// \return The newly created instruction.
+  MachineInstr *buildInstr(unsigned Opcode, Type *Ty, unsigned Res,
+                           unsigned Op0);
+
+  /// Build and insert \p Res<def> = G_CONSTANT [\p Ty] \p Val.
+  ///
+  /// \pre setBasicBlock or setMI must have been called.
+  /// \pre \p Ty is the type of \p Val.
+  ///
+  /// \return The newly created instruction.
+  MachineInstr *buildConstant(Type *Ty, unsigned Res, const ConstantInt &Val);
+
   /// Build and insert \p Res<def> = \p Opcode \p Op0, \p Op1.
   /// I.e., instruction with a non-generic opcode.
   ///
@@ -122,6 +122,10 @@ private:
   /// Indicate that this basic block is the entry block of a cleanup funclet.
   bool IsCleanupFuncletEntry = false;
 
+  /// Indicate that this basic block was moved to the cold section of the
+  /// function by the function splitter.
+  bool IsColdSection = false;
+
   /// \brief since getSymbol is a relatively heavy-weight operation, the symbol
   /// is only computed once and is cached.
   mutable MCSymbol *CachedMCSymbol = nullptr;
@@ -356,6 +360,13 @@ public:
   /// Indicates if this is the entry block of a cleanup funclet.
   void setIsCleanupFuncletEntry(bool V = true) { IsCleanupFuncletEntry = V; }
 
+  /// Returns true if this block is emitted in the cold section of the
+  /// function rather than with its entry block.
+  bool isColdSection() const { return IsColdSection; }
+
+  /// Indicates if this block is emitted in the cold section of the function.
+  void setIsColdSection(bool V = true) { IsColdSection = V; }
+
   // Code Layout methods.
 
   /// Move 'this' block before or after the specified block.  This only moves
@@ -445,7 +456,8 @@ public:
   /// block, such that if this block exits by falling through, control will
   /// transfer to the specified MBB. Note that MBB need not be a successor at
   /// all, for example if this block ends with an unconditional branch to some
-  /// other block.
+  /// other block. A block emitted in another section of the function is never
+  /// a layout successor.
   bool isLayoutSuccessor(const MachineBasicBlock *MBB) const;
 
   /// Return true if the block can implicitly transfer control to the block
@@ -20,21 +20,26 @@ namespace llvm {
 
 class MachineFunction;
 class MachineFunctionInitializer;
+class MachineModuleInfo;
 class TargetMachine;
 
 /// MachineFunctionAnalysis - This class is a Pass that manages a
-/// MachineFunction object.
+/// MachineFunction object. The MachineFunction is owned by MachineModuleInfo;
+/// unless KeepMachineFunctions is set, it is deleted when the pass manager
+/// releases this analysis.
 struct MachineFunctionAnalysis : public FunctionPass {
 private:
   const TargetMachine &TM;
   MachineFunction *MF;
-  unsigned NextFnNum;
+  MachineModuleInfo *MMI;
   MachineFunctionInitializer *MFInitializer;
+  bool KeepMachineFunctions;
 
 public:
   static char ID;
   explicit MachineFunctionAnalysis(const TargetMachine &tm,
-                                   MachineFunctionInitializer *MFInitializer);
+                                   MachineFunctionInitializer *MFInitializer,
+                                   bool KeepMachineFunctions = false);
   ~MachineFunctionAnalysis() override;
 
   MachineFunction &getMF() const { return *MF; }
@@ -43,8 +43,10 @@
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/MC/MachineLocation.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/Dwarf.h"
+#include <memory>
 
 namespace llvm {
 
@@ -57,9 +59,11 @@ class MDNode;
 class MMIAddrLabelMap;
 class MachineBasicBlock;
 class MachineFunction;
+class MachineFunctionInitializer;
 class Module;
 class PointerType;
 class StructType;
+class TargetMachine;
 
 struct SEHHandler {
   // Filter or finally function. Null indicates a catch-all.
@@ -120,36 +124,6 @@ class MachineModuleInfo : public ImmutablePass {
   /// want.
   MachineModuleInfoImpl *ObjFileMMI;
 
-  /// List of moves done by a function's prolog.  Used to construct frame maps
-  /// by debug and exception handling consumers.
-  std::vector<MCCFIInstruction> FrameInstructions;
-
-  /// LandingPads - List of LandingPadInfo describing the landing pad
-  /// information in the current function.
-  std::vector<LandingPadInfo> LandingPads;
-
-  /// LPadToCallSiteMap - Map a landing pad's EH symbol to the call site
-  /// indexes.
-  DenseMap<MCSymbol*, SmallVector<unsigned, 4> > LPadToCallSiteMap;
-
-  /// CallSiteMap - Map of invoke call site index values to associated begin
-  /// EH_LABEL for the current function.
-  DenseMap<MCSymbol*, unsigned> CallSiteMap;
-
-  /// CurCallSite - The current call site index being processed, if any. 0 if
-  /// none.
-  unsigned CurCallSite;
-
-  /// TypeInfos - List of C++ TypeInfo used in the current function.
-  std::vector<const GlobalValue *> TypeInfos;
-
-  /// FilterIds - List of typeids encoding filters used in the current function.
-  std::vector<unsigned> FilterIds;
-
-  /// FilterEnds - List of the indices in FilterIds corresponding to filter
-  /// terminators.
-  std::vector<unsigned> FilterEnds;
-
   /// Personalities - Vector of all personality functions ever seen. Used to
   /// emit common EH frames.
   std::vector<const Function *> Personalities;
@@ -158,10 +132,6 @@ class MachineModuleInfo : public ImmutablePass {
   /// the specified basic block's address of label.
   MMIAddrLabelMap *AddrLabelSymbols;
 
-  bool CallsEHReturn;
-  bool CallsUnwindInit;
-  bool HasEHFunclets;
-
   // TODO: Ideally, what we'd like is to have a switch that allows emitting 
   // synchronous (precise at call-sites only) CFA into .eh_frame. However,
   // even under this switch, we'd like .debug_frame to be precise when using.
@@ -184,8 +154,6 @@ class MachineModuleInfo : public ImmutablePass {
   /// details.
   bool UsesMorestackAddr;
 
-  EHPersonality PersonalityTypeCache;
-
 public:
   static char ID; // Pass identification, replacement for typeid
 
@@ -200,8 +168,77 @@ public:
         : Var(Var), Expr(Expr), Slot(Slot), Loc(Loc) {}
   };
   typedef SmallVector<VariableDbgInfo, 4> VariableDbgInfoMapTy;
-  VariableDbgInfoMapTy VariableDbgInfos;
 
+private:
+  /// FunctionInfo - The MachineFunction of a function and what is collected
+  /// about the function, from instruction selection until it is emitted.
+  /// Every function has its own, so that the machine passes of different
+  /// functions can run in any order, or concurrently.
+  struct FunctionInfo {
+    std::unique_ptr<MachineFunction> MF;
+
+    /// List of moves done by a function's prolog.  Used to construct frame
+    /// maps by debug and exception handling consumers.
+    std::vector<MCCFIInstruction> FrameInstructions;
+
+    /// LandingPads - List of LandingPadInfo describing the landing pad
+    /// information in the function.
+    std::vector<LandingPadInfo> LandingPads;
+
+    /// LPadToCallSiteMap - Map a landing pad's EH symbol to the call site
+    /// indexes.
+    DenseMap<MCSymbol*, SmallVector<unsigned, 4> > LPadToCallSiteMap;
+
+    /// CallSiteMap - Map of invoke call site index values to associated begin
+    /// EH_LABEL for the function.
+    DenseMap<MCSymbol*, unsigned> CallSiteMap;
+
+    /// CurCallSite - The current call site index being processed, if any. 0
+    /// if none.
+    unsigned CurCallSite = 0;
+
+    /// TypeInfos - List of C++ TypeInfo used in the function.
+    std::vector<const GlobalValue *> TypeInfos;
+
+    /// FilterIds - List of typeids encoding filters used in the function.
+    std::vector<unsigned> FilterIds;
+
+    /// FilterEnds - List of the indices in FilterIds corresponding to filter
+    /// terminators.
+    std::vector<unsigned> FilterEnds;
+
+    bool CallsEHReturn = false;
+    bool CallsUnwindInit = false;
+    bool HasEHFunclets = false;
+
+    EHPersonality PersonalityTypeCache = EHPersonality::Unknown;
+
+    VariableDbgInfoMapTy VariableDbgInfos;
+
+    /// Whether the temporary symbols created for the function are only named
+    /// when it is emitted, and those still waiting for a name.
+    bool DeferTempSymbolNames = false;
+    std::vector<MCSymbol *> TempSymbols;
+  };
+
+  /// Functions - The functions of the module that currently have a
+  /// MachineFunction.
+  DenseMap<const Function *, std::unique_ptr<FunctionInfo>> Functions;
+
+  /// NextFnNum - The number given to the next MachineFunction created.
+  unsigned NextFnNum;
+
+  /// Whether the functions created from now on defer the names of their
+  /// temporary symbols.
+  bool DeferTempSymbolNames = false;
+
+  /// CurrentFunction - The function the per-function queries of this thread
+  /// refer to.
+  static LLVM_THREAD_LOCAL FunctionInfo *CurrentFunction;
+
+  FunctionInfo &getCurrentFunction() const;
+
+public:
   MachineModuleInfo();  // DUMMY CONSTRUCTOR, DO NOT CALL.
   // Real constructor.
   MachineModuleInfo(const MCAsmInfo &MAI, const MCRegisterInfo &MRI,
@@ -222,6 +259,36 @@ public:
   void setModule(const Module *M) { TheModule = M; }
   const Module *getModule() const { return TheModule; }
 
+  /// Returns the MachineFunction of \p F, creating it if it does not exist
+  /// yet. A new MachineFunction is initialized by \p MFInitializer, if
+  /// non-null, and becomes the current function of the calling thread.
+  MachineFunction &
+  getOrCreateMachineFunction(const Function &F, const TargetMachine &TM,
+                             MachineFunctionInitializer *MFInitializer);
+
+  /// Returns the MachineFunction of \p F, or null if it has none.
+  MachineFunction *getMachineFunction(const Function &F) const;
+
+  /// Delete the MachineFunction of \p F, along with everything collected
+  /// about the function.
+  void deleteMachineFunctionFor(const Function &F);
+
+  /// Make the per-function queries below refer to \p MF, on the calling
+  /// thread only. MachineFunctionPass does this before running on a function,
+  /// which lets different threads work on different functions.
+  void setCurrentFunction(const MachineFunction &MF);
+
+  /// Only name the temporary symbols created for the MachineFunctions created
+  /// from now on when they are emitted, so that the numbers in their names
+  /// follow the order in which functions are emitted, as they do when each
+  /// function is emitted right after its machine passes ran.
+  void setDeferTempSymbolNames(bool Defer) { DeferTempSymbolNames = Defer; }
+
+  /// Name the temporary symbols of the current function created so far, and
+  /// name those created from now on immediately. The AsmPrinter calls this
+  /// before emitting a function.
+  void nameTempSymbols();
+
   /// getInfo - Keep track of various per-function pieces of information for
   /// backends that would like to do so.
   ///
@@ -242,14 +309,14 @@ public:
   bool hasDebugInfo() const { return DbgInfoAvailable; }
   void setDebugInfoAvailability(bool avail) { DbgInfoAvailable = avail; }
 
-  bool callsEHReturn() const { return CallsEHReturn; }
-  void setCallsEHReturn(bool b) { CallsEHReturn = b; }
+  bool callsEHReturn() const { return getCurrentFunction().CallsEHReturn; }
+  void setCallsEHReturn(bool b) { getCurrentFunction().CallsEHReturn = b; }
 
-  bool callsUnwindInit() const { return CallsUnwindInit; }
-  void setCallsUnwindInit(bool b) { CallsUnwindInit = b; }
+  bool callsUnwindInit() const { return getCurrentFunction().CallsUnwindInit; }
+  void setCallsUnwindInit(bool b) { getCurrentFunction().CallsUnwindInit = b; }
 
-  bool hasEHFunclets() const { return HasEHFunclets; }
-  void setHasEHFunclets(bool V) { HasEHFunclets = V; }
+  bool hasEHFunclets() const { return getCurrentFunction().HasEHFunclets; }
+  void setHasEHFunclets(bool V) { getCurrentFunction().HasEHFunclets = V; }
 
   bool usesVAFloatArgument() const {
     return UsesVAFloatArgument;
@@ -271,11 +338,13 @@ public:
   /// function's prologue.  Used to construct frame maps for debug and exception
   /// handling comsumers.
   const std::vector<MCCFIInstruction> &getFrameInstructions() const {
-    return FrameInstructions;
+    return getCurrentFunction().FrameInstructions;
   }
 
   unsigned LLVM_ATTRIBUTE_UNUSED_RESULT
   addFrameInst(const MCCFIInstruction &Inst) {
+    std::vector<MCCFIInstruction> &FrameInstructions =
+        getCurrentFunction().FrameInstructions;
     FrameInstructions.push_back(Inst);
     return FrameInstructions.size() - 1;
   }
@@ -359,7 +428,7 @@ public:
   /// getLandingPads - Return a reference to the landing pad info for the
   /// current function.
   const std::vector<LandingPadInfo> &getLandingPads() const {
-    return LandingPads;
+    return getCurrentFunction().LandingPads;
   }
 
   /// setCallSiteLandingPad - Map the landing pad's EH symbol to the call
@@ -371,60 +440,64 @@ public:
   SmallVectorImpl<unsigned> &getCallSiteLandingPad(MCSymbol *Sym) {
     assert(hasCallSiteLandingPad(Sym) &&
            "missing call site number for landing pad!");
-    return LPadToCallSiteMap[Sym];
+    return getCurrentFunction().LPadToCallSiteMap[Sym];
   }
 
   /// hasCallSiteLandingPad - Return true if the landing pad Eh symbol has an
   /// associated call site.
   bool hasCallSiteLandingPad(MCSymbol *Sym) {
-    return !LPadToCallSiteMap[Sym].empty();
+    return !getCurrentFunction().LPadToCallSiteMap[Sym].empty();
   }
 
   /// setCallSiteBeginLabel - Map the begin label for a call site.
   void setCallSiteBeginLabel(MCSymbol *BeginLabel, unsigned Site) {
-    CallSiteMap[BeginLabel] = Site;
+    getCurrentFunction().CallSiteMap[BeginLabel] = Site;
   }
 
   /// getCallSiteBeginLabel - Get the call site number for a begin label.
   unsigned getCallSiteBeginLabel(MCSymbol *BeginLabel) {
     assert(hasCallSiteBeginLabel(BeginLabel) &&
            "Missing call site number for EH_LABEL!");
-    return CallSiteMap[BeginLabel];
+    return getCurrentFunction().CallSiteMap[BeginLabel];
   }
 
   /// hasCallSiteBeginLabel - Return true if the begin label has a call site
   /// number associated with it.
   bool hasCallSiteBeginLabel(MCSymbol *BeginLabel) {
-    return CallSiteMap[BeginLabel] != 0;
+    return getCurrentFunction().CallSiteMap[BeginLabel] != 0;
   }
 
   /// setCurrentCallSite - Set the call site currently being processed.
-  void setCurrentCallSite(unsigned Site) { CurCallSite = Site; }
+  void setCurrentCallSite(unsigned Site) {
+    getCurrentFunction().CurCallSite = Site;
+  }
 
   /// getCurrentCallSite - Get the call site currently being processed, if any.
   /// return zero if none.
-  unsigned getCurrentCallSite() { return CurCallSite; }
+  unsigned getCurrentCallSite() { return getCurrentFunction().CurCallSite; }
 
   /// getTypeInfos - Return a reference to the C++ typeinfo for the current
   /// function.
   const std::vector<const GlobalValue *> &getTypeInfos() const {
-    return TypeInfos;
+    return getCurrentFunction().TypeInfos;
   }
 
   /// getFilterIds - Return a reference to the typeids encoding filters used in
   /// the current function.
   const std::vector<unsigned> &getFilterIds() const {
-    return FilterIds;
+    return getCurrentFunction().FilterIds;
   }
 
   /// setVariableDbgInfo - Collect information used to emit debugging
   /// information of a variable.
   void setVariableDbgInfo(const DILocalVariable *Var, const DIExpression *Expr,
                           unsigned Slot, const DILocation *Loc) {
-    VariableDbgInfos.emplace_back(Var, Expr, Slot, Loc);
+    getCurrentFunction().VariableDbgInfos.emplace_back(Var, Expr, Slot, Loc);
   }
 
-  VariableDbgInfoMapTy &getVariableDbgInfo() { return VariableDbgInfos; }
+  VariableDbgInfoMapTy &getVariableDbgInfo() {
+    return getCurrentFunction().VariableDbgInfos;
+  }
 
 }; // End class MachineModuleInfo
 
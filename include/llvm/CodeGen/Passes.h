@@ -22,6 +22,7 @@ namespace llvm {
 
 class Function;
 class FunctionPass;
+class LLVMTargetMachine;
 class MachineFunctionPass;
 class ModulePass;
 class Pass;
@@ -213,6 +214,10 @@ namespace llvm {
   /// information.
   extern char &MachineBlockPlacementStatsID;
 
+  /// MachineFunctionSplitter - This pass moves the blocks the profile says
+  /// are cold to a separate section.
+  extern char &MachineFunctionSplitterID;
+
   /// GCLowering Pass - Used by gc.root to perform its default lowering
   /// operations.
   FunctionPass *createGCLoweringPass();
@@ -272,7 +277,10 @@ namespace llvm {
 
   /// createStackProtectorPass - This pass adds stack protectors to functions.
   ///
-  FunctionPass *createStackProtectorPass(const TargetMachine *TM);
+  /// If LayoutOnly is set, it only computes the stack layout of functions
+  /// that have already been protected.
+  FunctionPass *createStackProtectorPass(const TargetMachine *TM,
+                                         bool LayoutOnly = false);
 
   /// createMachineVerifierPass - This pass verifies cenerated machine code
   /// instructions for correctness.
@@ -374,6 +382,13 @@ namespace llvm {
   /// and propagates register usage information of callee to caller
   /// if available with PysicalRegisterUsageInfo pass.
   FunctionPass *createRegUsageInfoPropPass();
+
+  /// ParallelMachinePasses - This pass runs the machine function passes on
+  /// NumThreads threads once instruction selection is done for the whole
+  /// module, keeping the MachineFunctions for the AsmPrinter.
+  ModulePass *createParallelMachinePassesPass(LLVMTargetMachine *TM,
+                                              unsigned NumThreads,
+                                              bool DisableVerify);
 } // End llvm namespace
 
 /// Target machine pass initializer for passes with dependencies. Use with
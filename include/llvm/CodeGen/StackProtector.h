@@ -17,10 +17,10 @@
 #ifndef LLVM_CODEGEN_STACKPROTECTOR_H
 #define LLVM_CODEGEN_STACKPROTECTOR_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/IR/Dominators.h"
-#include "llvm/IR/ValueMap.h"
 #include "llvm/Pass.h"
 #include "llvm/Target/TargetLowering.h"
 
@@ -45,7 +45,7 @@ public:
   };
 
   /// A mapping of AllocaInsts to their required SSP layout.
-  typedef ValueMap<const AllocaInst *, SSPLayoutKind> SSPLayoutMap;
+  typedef DenseMap<const AllocaInst *, SSPLayoutKind> SSPLayoutMap;
 
 private:
   const TargetMachine *TM;
@@ -81,6 +81,11 @@ private:
   // IR checking code is generated.
   bool HasIRCheck = false;
 
+  /// LayoutOnly - Only compute the Layout of functions whose stack protector
+  /// has already been inserted, without changing the IR. Used by the machine
+  /// passes running on other threads than instruction selection.
+  bool LayoutOnly = false;
+
   /// InsertStackProtectors - Insert code into the prologue and epilogue of
   /// the function.
   ///
@@ -115,9 +120,9 @@ public:
       : FunctionPass(ID), TM(nullptr), TLI(nullptr), SSPBufferSize(0) {
     initializeStackProtectorPass(*PassRegistry::getPassRegistry());
   }
-  StackProtector(const TargetMachine *TM)
+  StackProtector(const TargetMachine *TM, bool LayoutOnly = false)
       : FunctionPass(ID), TM(TM), TLI(nullptr), Trip(TM->getTargetTriple()),
-        SSPBufferSize(8) {
+        SSPBufferSize(8), LayoutOnly(LayoutOnly) {
     initializeStackProtectorPass(*PassRegistry::getPassRegistry());
   }
 
@@ -67,6 +67,9 @@ public:
   bool shouldPutJumpTableInFunctionSection(bool UsesLabelDifference,
                                            const Function &F) const override;
 
+  MCSection *getSectionForColdCode(const Function &F, Mangler &Mang,
+                                   const TargetMachine &TM) const override;
+
   /// Return an MCExpr to use for a reference to the specified type info global
   /// variable from exception handling information.
   const MCExpr *
@@ -226,6 +226,40 @@ public:
                                       unsigned MinStubs, void *InitialPtrVal);
 };
 
+/// @brief RISCV64 support.
+///
+/// RISCV64 supports lazy JITing.
+class OrcRISCV64 {
+public:
+  static const unsigned PointerSize = 8;
+  static const unsigned TrampolineSize = 16;
+  static const unsigned ResolverCodeSize = 0xc0;
+
+  typedef GenericIndirectStubsInfo<16> IndirectStubsInfo;
+
+  typedef TargetAddress (*JITReentryFn)(void *CallbackMgr, void *TrampolineId);
+
+  /// @brief Write the resolver code into the given memory. The user is be
+  ///        responsible for allocating the memory and setting permissions.
+  static void writeResolverCode(uint8_t *ResolveMem, JITReentryFn Reentry,
+                                void *CallbackMgr);
+
+  /// @brief Write the requsted number of trampolines into the given memory,
+  ///        which must be big enough to hold 1 pointer, plus NumTrampolines
+  ///        trampolines.
+  static void writeTrampolines(uint8_t *TrampolineMem, void *ResolverAddr,
+                               unsigned NumTrampolines);
+
+  /// @brief Emit at least MinStubs worth of indirect call stubs, rounded out to
+  ///        the nearest page size.
+  ///
+  ///   E.g. Asking for 4 stubs on riscv64, where stubs are 16-bytes, with 4k
+  /// pages will return a block of 256 stubs (4096 / 16 = 256). Asking for 257
+  /// will return a block of 512 (2-pages worth).
+  static Error emitIndirectStubsBlock(IndirectStubsInfo &StubsInfo,
+                                      unsigned MinStubs, void *InitialPtrVal);
+};
+
 } // End namespace orc.
 } // End namespace llvm.
 
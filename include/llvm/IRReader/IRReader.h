@@ -15,6 +15,7 @@
 #ifndef LLVM_IRREADER_IRREADER_H
 #define LLVM_IRREADER_IRREADER_H
 
+#include "llvm/Support/MemoryBuffer.h"
 #include <memory>
 
 namespace llvm {
@@ -34,6 +35,13 @@ std::unique_ptr<Module>
 getLazyIRFileModule(StringRef Filename, SMDiagnostic &Err, LLVMContext &Context,
                     bool ShouldLazyLoadMetadata = false);
 
+/// Like getLazyIRFileModule, but tell the host how the function bodies are
+/// going to be read with \p Hints.
+std::unique_ptr<Module>
+getLazyIRFileModule(StringRef Filename, SMDiagnostic &Err, LLVMContext &Context,
+                    const MemoryBuffer::FileHints &Hints,
+                    bool ShouldLazyLoadMetadata = false);
+
 /// If the given MemoryBuffer holds a bitcode image, return a Module
 /// for it.  Otherwise, attempt to parse it as LLVM Assembly and return
 /// a Module for it.
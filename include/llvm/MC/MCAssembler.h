@@ -25,6 +25,7 @@
 
 namespace llvm {
 class raw_ostream;
+class raw_pwrite_stream;
 class MCAsmLayout;
 class MCAssembler;
 class MCContext;
@@ -219,6 +220,12 @@ public:
   void writeSectionData(const MCSection *Section,
                         const MCAsmLayout &Layout) const;
 
+  /// Emit the section contents to \p OS rather than to the object writer's
+  /// stream. This only reads the assembler state, so it can be called for
+  /// different sections at once.
+  void writeSectionData(raw_pwrite_stream &OS, const MCSection *Section,
+                        const MCAsmLayout &Layout) const;
+
   /// Check whether a given symbol has been flagged with .thumb_func.
   bool isThumbFunc(const MCSymbol *Func) const;
 
@@ -22,6 +22,7 @@
 #include "llvm/MC/SectionKind.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
 #include <tuple>
@@ -105,6 +106,18 @@ namespace llvm {
     /// a given prefix.
     StringMap<unsigned> NextID;
 
+    /// The names temporary symbols are created with while their unique name
+    /// is deferred, without the suffix.
+    StringMap<bool, BumpPtrAllocator &> DeferredNames;
+
+    /// The list the unique temporary symbols created on this thread are added
+    /// to until they are named, or null if they are named when created.
+    static LLVM_THREAD_LOCAL std::vector<MCSymbol *> *DeferredTempSymbols;
+
+    /// Guards the symbol tables and Allocator: the machine passes of
+    /// different functions may create symbols concurrently.
+    mutable sys::SmartMutex<true> SymbolsLock;
+
     /// Instances of directional local labels.
     DenseMap<unsigned, MCLabel *> Instances;
     /// NextInstance() creates the next instance of the directional local label
@@ -232,6 +245,10 @@ namespace llvm {
                                bool CanBeUnnamed);
     MCSymbol *createSymbol(StringRef Name, bool AlwaysAddSuffix,
                            bool IsTemporary);
+    /// Return the entry of UsedNames for the first unused name made of
+    /// \p Name and, if needed or \p AddSuffix is set, a number.
+    const StringMapEntry<bool> *getUniqueName(StringRef Name, bool AddSuffix,
+                                              bool IsTemporary);
 
     MCSymbol *getOrCreateDirectionalLocalSymbol(unsigned LocalLabelVal,
                                                 unsigned Instance);
@@ -278,6 +295,18 @@ namespace llvm {
     MCSymbol *createTempSymbol(const Twine &Name, bool AlwaysAddSuffix,
                                bool CanBeUnnamed = true);
 
+    /// Defer the choice of the numbered names of the temporary symbols created
+    /// on the calling thread from now on, adding the symbols to \p Symbols
+    /// until nameDeferredTempSymbols() is called on it. This makes the numbers
+    /// follow the order in which the lists are named instead of the order in
+    /// which threads happen to create the symbols. Pass null to name new
+    /// symbols when they are created again.
+    static void deferTempSymbolNames(std::vector<MCSymbol *> *Symbols);
+
+    /// Give the symbols of \p Symbols their numbered names, in order, and
+    /// clear it.
+    void nameDeferredTempSymbols(std::vector<MCSymbol *> &Symbols);
+
     /// Create the definition of a directional local symbol for numbered label
     /// (used for "1:" definitions).
     MCSymbol *createDirectionalLocalSymbol(unsigned LocalLabelVal);
@@ -572,6 +601,7 @@ namespace llvm {
     void setSecureLogUsed(bool Value) { SecureLogUsed = Value; }
 
     void *allocate(unsigned Size, unsigned Align = 8) {
+      sys::SmartScopedLock<true> Lock(SymbolsLock);
       return Allocator.Allocate(Size, Align);
     }
     void deallocate(void *Ptr) {}
@@ -21,6 +21,7 @@
 namespace llvm {
 
 struct InstrItinerary;
+class MCSubtargetInfo;
 
 /// Define a kind of processor resource that will be modeled by the scheduler.
 struct MCProcResourceDesc {
@@ -223,6 +224,18 @@ struct MCSchedModel {
     return &SchedClassTable[SchedClassIdx];
   }
 
+  /// Return the latency of an instruction of the given scheduling class,
+  /// i.e. the largest latency of any of its defs. Invalid latencies are
+  /// treated as very high.
+  static unsigned computeInstrLatency(const MCSubtargetInfo &STI,
+                                      const MCSchedClassDesc &SCDesc);
+
+  /// Return the reciprocal throughput of an instruction of the given
+  /// scheduling class: the average number of cycles between two independent
+  /// instances of it, as limited by its most contended processor resource.
+  static double getReciprocalThroughput(const MCSubtargetInfo &STI,
+                                        const MCSchedClassDesc &SCDesc);
+
   /// Returns the default initialized model.
   static const MCSchedModel &GetDefaultSchedModel() { return Default; }
   static const MCSchedModel Default;
@@ -861,6 +861,8 @@ StringRef ELFObjectFile<ELFT>::getFileFormatName() const {
       return "ELF32-wasm";
     case ELF::EM_AMDGPU:
       return "ELF32-amdgpu";
+    case ELF::EM_RISCV:
+      return "ELF32-riscv";
     default:
       return "ELF32-unknown";
     }
@@ -888,6 +890,8 @@ StringRef ELFObjectFile<ELFT>::getFileFormatName() const {
              "ELF64-amdgpu-hsacobj" : "ELF64-amdgpu";
     case ELF::EM_BPF:
       return "ELF64-BPF";
+    case ELF::EM_RISCV:
+      return "ELF64-riscv";
     default:
       return "ELF64-unknown";
     }
@@ -929,6 +933,15 @@ unsigned ELFObjectFile<ELFT>::getArch() const {
     return Triple::ppc;
   case ELF::EM_PPC64:
     return IsLittleEndian ? Triple::ppc64le : Triple::ppc64;
+  case ELF::EM_RISCV:
+    switch (EF.getHeader()->e_ident[ELF::EI_CLASS]) {
+    case ELF::ELFCLASS32:
+      return Triple::riscv;
+    case ELF::ELFCLASS64:
+      return Triple::riscv64;
+    default:
+      report_fatal_error("Invalid ELFCLASS!");
+    }
   case ELF::EM_S390:
     return Triple::systemz;
 
@@ -8,8 +8,9 @@
 //===----------------------------------------------------------------------===//
 /// \file
 ///
-/// This file defines the MallocAllocator and BumpPtrAllocator interfaces. Both
-/// of these conform to an LLVM "Allocator" concept which consists of an
+/// This file defines the MallocAllocator, SlabCacheAllocator and
+/// BumpPtrAllocator interfaces. All of these conform to an LLVM "Allocator"
+/// concept which consists of an
 /// Allocate method accepting a size and alignment, and a Deallocate accepting
 /// a pointer and size. Further, the LLVM "Allocator" concept has overloads of
 /// Allocate and Deallocate for setting size and alignment based on the final
@@ -108,6 +109,64 @@ public:
   void PrintStats() const {}
 };
 
+/// \brief Statistics of the slab cache behind SlabCacheAllocator, for all the
+/// threads of the process.
+struct SlabCacheStatistics {
+  /// The number of slabs allocated with malloc.
+  uint64_t SlabsAllocated;
+  /// The number of slabs handed out again from the cache instead.
+  uint64_t SlabsReused;
+  /// The number of slabs returned to malloc, because the cache was full.
+  uint64_t SlabsFreed;
+  /// The number of bytes in the shared pool of the cache now.
+  size_t SharedPoolBytes;
+};
+
+/// \brief An allocator for the slabs of a BumpPtrAllocator which keeps freed
+/// slabs for the next allocations instead of returning them to malloc.
+///
+/// This helps clients that create and destroy or reset many allocators, like
+/// a JIT compiling one function after another. Slabs of a power of 2 size
+/// between 4 KiB and 1 MiB are cached; other sizes go straight to malloc.
+///
+/// Every thread keeps a few free slabs of each size for itself, without
+/// locking. Beyond that, freed slabs go to a pool shared by all the threads,
+/// up to a size limit, and threads refill their cache from it. The cache of
+/// a thread is not released when it exits: long-lived threads that stop
+/// allocating, and threads about to exit, should call releaseThreadCache().
+///
+/// Use it with BumpPtrAllocatorImpl<SlabCacheAllocator>, which is typedef'd
+/// to CachingBumpPtrAllocator, or SpecificBumpPtrAllocator<T,
+/// SlabCacheAllocator>.
+class SlabCacheAllocator : public AllocatorBase<SlabCacheAllocator> {
+public:
+  void Reset() {}
+
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                size_t /*Alignment*/);
+
+  // Pull in base class overloads.
+  using AllocatorBase<SlabCacheAllocator>::Allocate;
+
+  void Deallocate(const void *Ptr, size_t Size);
+
+  // Pull in base class overloads.
+  using AllocatorBase<SlabCacheAllocator>::Deallocate;
+
+  void PrintStats() const;
+
+  /// \brief Set how many free slabs of each size a thread keeps for itself,
+  /// 16 by default, and the size in bytes of the pool shared by the threads,
+  /// 32 MiB by default. Slabs beyond the new limits are freed.
+  static void setLimits(unsigned SlabsPerThread, size_t SharedPoolBytes);
+
+  /// \brief Move the free slabs of the calling thread to the shared pool, or
+  /// free them if llvm_shutdown() already destroyed the pool.
+  static void releaseThreadCache();
+
+  static SlabCacheStatistics getStatistics();
+};
+
 namespace detail {
 
 // We call out to an external function to actually print the message as the
@@ -350,20 +409,27 @@ private:
     }
   }
 
-  template <typename T> friend class SpecificBumpPtrAllocator;
+  template <typename T, typename SlabAllocatorT>
+  friend class SpecificBumpPtrAllocator;
 };
 
 /// \brief The standard BumpPtrAllocator which just uses the default template
 /// paramaters.
 typedef BumpPtrAllocatorImpl<> BumpPtrAllocator;
 
+/// \brief A BumpPtrAllocator which recycles its slabs through the slab cache.
+typedef BumpPtrAllocatorImpl<SlabCacheAllocator> CachingBumpPtrAllocator;
+
 /// \brief A BumpPtrAllocator that allows only elements of a specific type to be
 /// allocated.
 ///
 /// This allows calling the destructor in DestroyAll() and when the allocator is
-/// destroyed.
-template <typename T> class SpecificBumpPtrAllocator {
-  BumpPtrAllocator Allocator;
+/// destroyed. The slabs come from \p SlabAllocatorT, which can be
+/// SlabCacheAllocator to recycle them.
+template <typename T, typename SlabAllocatorT = MallocAllocator>
+class SpecificBumpPtrAllocator {
+  typedef BumpPtrAllocatorImpl<SlabAllocatorT> AllocatorT;
+  AllocatorT Allocator;
 
 public:
   SpecificBumpPtrAllocator() : Allocator() {}
@@ -388,7 +454,7 @@ public:
 
     for (auto I = Allocator.Slabs.begin(), E = Allocator.Slabs.end(); I != E;
          ++I) {
-      size_t AllocatedSlabSize = BumpPtrAllocator::computeSlabSize(
+      size_t AllocatedSlabSize = AllocatorT::computeSlabSize(
           std::distance(Allocator.Slabs.begin(), I));
       char *Begin = (char*)alignAddr(*I, alignOf<T>());
       char *End = *I == Allocator.Slabs.back() ? Allocator.CurPtr
@@ -407,7 +473,7 @@ public:
   }
 
   /// \brief Allocate space for an array of objects without constructing them.
-  T *Allocate(size_t num = 1) { return Allocator.Allocate<T>(num); }
+  T *Allocate(size_t num = 1) { return Allocator.template Allocate<T>(num); }
 };
 
 }  // end namespace llvm
@@ -309,7 +309,10 @@ protected:
   inline void setNumAdditionalVals(unsigned n) { AdditionalVals = n; }
 
 public:
-  // addArgument - Register this argument with the commandline system.
+  // addArgument - Register this argument with the commandline system. The
+  // option is only added to the option maps of its subcommands when they are
+  // needed, e.g. to print the help.  The parser looks up the named options
+  // that are not in the maps yet.
   //
   void addArgument();
 
@@ -43,6 +43,16 @@ bool isAvailable();
 Status compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                 CompressionLevel Level = DefaultCompression);
 
+/// Compress \p InputBuffer like compress(), but split inputs larger than
+/// \p ChunkSize into chunks that are compressed in parallel. The chunks are
+/// joined with sync flushes, so the output is still a single zlib stream that
+/// uncompress() can read. It only depends on the input and \p ChunkSize, not
+/// on the number of threads.
+Status compressParallel(StringRef InputBuffer,
+                        SmallVectorImpl<char> &CompressedBuffer,
+                        CompressionLevel Level = DefaultCompression,
+                        size_t ChunkSize = 256 * 1024);
+
 Status uncompress(StringRef InputBuffer,
                   SmallVectorImpl<char> &UncompressedBuffer,
                   size_t UncompressedSize);
@@ -19,6 +19,8 @@
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <vector>
 
 namespace llvm {
 /// FileOutputBuffer - This interface provides simple way to create an in-memory
@@ -84,6 +86,54 @@ private:
   SmallString<128>    FinalPath;
   SmallString<128>    TempPath;
 };
+
+/// raw_output_buffer_ostream - A raw_pwrite_stream that writes a file whose
+/// contents are only laid out once they are complete. Plain writes are kept in
+/// memory, and deferred writes leave holes in the output. flushDeferred() then
+/// creates a FileOutputBuffer of the final size, copies the plain writes into
+/// it and fills the holes in place, in parallel if they are large. Outputs
+/// smaller than MinMapSize, for which a mapping costs more than it saves, are
+/// assembled in memory instead and written out by commit().
+///
+/// Nothing can be written after flushDeferred() other than with pwrite. The
+/// file only appears once commit() succeeds.
+class raw_output_buffer_ostream : public raw_pwrite_stream {
+  struct DeferredWrite {
+    uint64_t Offset;
+    uint64_t Size;
+    DeferredWriteFn Fill;
+  };
+
+  SmallString<128> Path;
+  uint64_t MinMapSize;
+
+  /// The plain writes, and the holes between them, before flushDeferred().
+  SmallVector<char, 0> Data;
+  std::vector<DeferredWrite> Deferred;
+  uint64_t Pos = 0;
+
+  /// The complete output, after flushDeferred().
+  std::unique_ptr<FileOutputBuffer> Buffer;
+  std::unique_ptr<char[]> HeapBuffer;
+  char *Out = nullptr;
+
+  void write_impl(const char *Ptr, size_t Size) override;
+  void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) override;
+  uint64_t current_pos() const override { return Pos; }
+
+public:
+  explicit raw_output_buffer_ostream(StringRef Path, uint64_t MinMapSize = 0);
+  ~raw_output_buffer_ostream() override;
+
+  void writeDeferred(uint64_t Size, DeferredWriteFn Fill) override;
+  void flushDeferred() override;
+
+  /// Returns true if the output was written to a mapped FileOutputBuffer.
+  bool isMapped() const { return Buffer != nullptr; }
+
+  /// Flushes the deferred writes if needed and writes the output to its file.
+  std::error_code commit();
+};
 } // end namespace llvm
 
 #endif
@@ -683,19 +683,36 @@ public:
     priv ///< May modify via data, but changes are lost on destruction.
   };
 
+  /// Hints on how the region is going to be accessed. Hosts that cannot act
+  /// on a hint ignore it.
+  enum mapflags : unsigned {
+    none = 0,
+    /// The region is read mostly in order: read ahead of the accesses more
+    /// aggressively.
+    sequential = 1,
+    /// The region is read in no particular order: do not read ahead.
+    random = 2,
+    /// Read the whole region in while mapping it, instead of faulting the
+    /// pages in one at a time.
+    populate = 4,
+    /// Align large regions so that they can be backed by huge pages.
+    huge_pages = 8
+  };
+
 private:
   /// Platform-specific mapping state.
   uint64_t Size;
   void *Mapping;
 
-  std::error_code init(int FD, uint64_t Offset, mapmode Mode);
+  std::error_code init(int FD, uint64_t Offset, mapmode Mode, unsigned Flags);
 
 public:
   /// \param fd An open file descriptor to map. mapped_file_region takes
   ///   ownership if closefd is true. It must have been opended in the correct
   ///   mode.
+  /// \param flags A combination of mapflags.
   mapped_file_region(int fd, mapmode mode, uint64_t length, uint64_t offset,
-                     std::error_code &ec);
+                     std::error_code &ec, unsigned flags = none);
 
   ~mapped_file_region();
 
@@ -137,6 +137,11 @@ namespace sys {
     /// platforms.
     static void InvalidateInstructionCache(const void *Addr, size_t Len);
 
+    /// prefetchRange - Ask the operating system to start reading in the pages
+    /// of [Addr, Addr + Len) in the background, e.g. from the file they map.
+    /// This is only a hint: it does nothing where it is not supported.
+    static void prefetchRange(const void *Addr, size_t Len);
+
     /// setExecutable - Before the JIT can run a block of code, it has to be
     /// given read and executable privilege. Return true if it is already r-x
     /// or the system is able to change its previlege.
@@ -60,6 +60,23 @@ public:
     return "Unknown buffer";
   }
 
+  /// Hints on how the contents of a file are going to be read. They never
+  /// change the contents of the buffer, and hosts that cannot act on them
+  /// ignore them.
+  struct FileHints {
+    /// The sys::fs::mapped_file_region::mapflags to map the file with. The
+    /// sequential and random access hints also apply when the file is read
+    /// into memory instead of mapped.
+    unsigned MapFlags;
+
+    /// If the file is mapped, start reading in up to this many bytes from
+    /// the start of the buffer in the background.
+    uint64_t ReadAheadSize;
+
+    explicit FileHints(unsigned MapFlags = 0, uint64_t ReadAheadSize = 0)
+        : MapFlags(MapFlags), ReadAheadSize(ReadAheadSize) {}
+  };
+
   /// Open the specified file as a MemoryBuffer, returning a new MemoryBuffer
   /// if successful, otherwise returning null. If FileSize is specified, this
   /// means that the client knows that the file exists and that it has the
@@ -72,6 +89,12 @@ public:
   getFile(const Twine &Filename, int64_t FileSize = -1,
           bool RequiresNullTerminator = true, bool IsVolatileSize = false);
 
+  /// Open the specified file as a MemoryBuffer, telling the host how it is
+  /// going to be read.
+  static ErrorOr<std::unique_ptr<MemoryBuffer>>
+  getFile(const Twine &Filename, const FileHints &Hints, int64_t FileSize = -1,
+          bool RequiresNullTerminator = true, bool IsVolatileSize = false);
+
   /// Given an already-open file descriptor, map some slice of it into a
   /// MemoryBuffer. The slice is specified by an \p Offset and \p MapSize.
   /// Since this is in the middle of a file, the buffer is not null terminated.
@@ -124,6 +147,12 @@ public:
   getFileOrSTDIN(const Twine &Filename, int64_t FileSize = -1,
                  bool RequiresNullTerminator = true);
 
+  /// Open the specified file as a MemoryBuffer with the given hints, or open
+  /// stdin if the Filename is "-".
+  static ErrorOr<std::unique_ptr<MemoryBuffer>>
+  getFileOrSTDIN(const Twine &Filename, const FileHints &Hints,
+                 int64_t FileSize = -1, bool RequiresNullTerminator = true);
+
   /// Map a subrange of the specified file as a MemoryBuffer.
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getFileSlice(const Twine &Filename, uint64_t MapSize, uint64_t Offset);
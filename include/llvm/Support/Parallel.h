@@ -0,0 +1,214 @@
+//===- llvm/Support/Parallel.h - Parallel algorithms ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines data parallel versions of common algorithms:
+// parallel_for, parallel_for_each, parallel_sort and
+// parallel_transform_reduce. They share one process-wide executor, whose size
+// the -threads option controls. With one thread, every algorithm runs
+// sequentially on the calling thread, which makes debugging deterministic.
+//
+// The algorithms can be nested: a thread waiting for the tasks of an
+// algorithm runs them itself rather than blocking, so nesting does not
+// deadlock the executor.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PARALLEL_H
+#define LLVM_SUPPORT_PARALLEL_H
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace llvm {
+
+class ThreadPoolTaskGroup;
+
+namespace parallel {
+
+/// The number of threads requested with -threads. 0, the default, requests
+/// one thread per hardware thread.
+extern unsigned ThreadsRequested;
+
+/// Return the number of threads the parallel algorithms use, counting the
+/// calling thread. The executor is created the first time it is needed;
+/// changing ThreadsRequested afterwards only switches between sequential (1)
+/// and parallel execution.
+unsigned getThreadCount();
+
+namespace detail {
+
+/// Return true if the algorithms run in parallel, that is if more than one
+/// thread is requested.
+bool isParallel();
+
+/// A group of tasks of the shared executor that can be waited for together.
+class TaskGroup {
+  std::unique_ptr<ThreadPoolTaskGroup> Group;
+
+public:
+  TaskGroup();
+  ~TaskGroup();
+
+  /// Run \p F on the executor, or right away if the group is sequential.
+  void spawn(std::function<void()> F);
+
+  /// Wait for all the spawned tasks to finish, running them in the meantime.
+  void sync();
+
+  bool isParallel() const { return Group != nullptr; }
+};
+
+/// Sort in parallel above this many elements.
+enum : size_t { MinParallelSize = 1024 };
+
+/// The maximum number of tasks a parallel_for or parallel_transform_reduce
+/// splits its range into when the caller does not give a grain size.
+enum : size_t { MaxTasksPerGroup = 1024 };
+
+template <class RandomAccessIterator, class Comparator>
+RandomAccessIterator medianOf3(RandomAccessIterator Start,
+                               RandomAccessIterator End,
+                               const Comparator &Comp) {
+  RandomAccessIterator Mid = Start + (std::distance(Start, End) / 2);
+  return Comp(*Start, *(End - 1))
+             ? (Comp(*Mid, *(End - 1)) ? (Comp(*Start, *Mid) ? Mid : Start)
+                                       : End - 1)
+             : (Comp(*Mid, *Start) ? (Comp(*(End - 1), *Mid) ? Mid : End - 1)
+                                   : Start);
+}
+
+template <class RandomAccessIterator, class Comparator>
+void parallelQuickSort(RandomAccessIterator Start, RandomAccessIterator End,
+                       const Comparator &Comp, TaskGroup &TG, size_t Depth) {
+  // Do a sequential sort for small inputs, and when the recursion got deep,
+  // which bounds the number of tasks on bad inputs.
+  if (static_cast<size_t>(std::distance(Start, End)) < MinParallelSize ||
+      Depth == 0) {
+    std::sort(Start, End, Comp);
+    return;
+  }
+
+  // Partition around the median of three, which is moved to the end.
+  auto Pivot = medianOf3(Start, End, Comp);
+  std::swap(*(End - 1), *Pivot);
+  Pivot = std::partition(Start, End - 1, [&Comp, End](decltype(*Start) V) {
+    return Comp(V, *(End - 1));
+  });
+  // Move the pivot into place.
+  std::swap(*Pivot, *(End - 1));
+
+  // Sort the left half on another thread and the right half on this one.
+  TG.spawn([=, &Comp, &TG] {
+    parallelQuickSort(Start, Pivot, Comp, TG, Depth - 1);
+  });
+  parallelQuickSort(Pivot + 1, End, Comp, TG, Depth - 1);
+}
+
+/// Return the number of elements of each task for \p NumItems elements, given
+/// the grain size the caller asked for.
+size_t getTaskSize(size_t NumItems, size_t GrainSize);
+
+} // end namespace detail
+} // end namespace parallel
+
+/// Call \p Fn with every index in [\p Begin, \p End), in parallel. Each task
+/// handles \p GrainSize consecutive indices; when it is 0, the range is split
+/// into a bounded number of tasks.
+void parallel_for(size_t Begin, size_t End,
+                  function_ref<void(size_t)> Fn, size_t GrainSize = 0);
+
+/// Call \p Fn with every element of [\p Begin, \p End), in parallel.
+template <class RandomAccessIterator, class FuncTy>
+void parallel_for_each(RandomAccessIterator Begin, RandomAccessIterator End,
+                       FuncTy Fn) {
+  parallel_for(0, std::distance(Begin, End),
+               [&](size_t I) { Fn(Begin[I]); });
+}
+
+template <class RangeTy, class FuncTy>
+void parallel_for_each(RangeTy &&R, FuncTy Fn) {
+  parallel_for_each(std::begin(R), std::end(R), Fn);
+}
+
+/// Sort [\p Start, \p End) with \p Comp, in parallel. Like std::sort, this
+/// sort is not stable.
+template <class RandomAccessIterator, class Comparator>
+void parallel_sort(RandomAccessIterator Start, RandomAccessIterator End,
+                   const Comparator &Comp) {
+  parallel::detail::TaskGroup TG;
+  if (!TG.isParallel()) {
+    std::sort(Start, End, Comp);
+    return;
+  }
+  parallel::detail::parallelQuickSort(Start, End, Comp, TG,
+                                      Log2_64(std::distance(Start, End)) + 1);
+}
+
+template <class RandomAccessIterator>
+void parallel_sort(RandomAccessIterator Start, RandomAccessIterator End) {
+  typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+  parallel_sort(Start, End, std::less<T>());
+}
+
+template <class RangeTy, class Comparator>
+void parallel_sort(RangeTy &&R, const Comparator &Comp) {
+  parallel_sort(std::begin(R), std::end(R), Comp);
+}
+
+/// Return the reduction, with \p Reduce, of \p Init and \p Transform applied
+/// to every element of [\p Begin, \p End). The elements are transformed and
+/// reduced in parallel, in chunks whose results are then reduced in order:
+/// the result is deterministic as long as \p Reduce is associative.
+template <class RandomAccessIterator, class ResultTy, class ReduceFuncTy,
+          class TransformFuncTy>
+ResultTy parallel_transform_reduce(RandomAccessIterator Begin,
+                                   RandomAccessIterator End, ResultTy Init,
+                                   ReduceFuncTy Reduce,
+                                   TransformFuncTy Transform) {
+  size_t NumItems = std::distance(Begin, End);
+  if (NumItems == 0)
+    return Init;
+  parallel::detail::TaskGroup TG;
+  if (!TG.isParallel()) {
+    for (; Begin != End; ++Begin)
+      Init = Reduce(std::move(Init), Transform(*Begin));
+    return Init;
+  }
+
+  // Each task reduces its chunk to one value of Results, starting from the
+  // transformed first element, so Init is only used once.
+  size_t TaskSize = parallel::detail::getTaskSize(NumItems, 0);
+  size_t NumTasks = (NumItems + TaskSize - 1) / TaskSize;
+  std::vector<ResultTy> Results(NumTasks, Init);
+  for (size_t TaskId = 0; TaskId != NumTasks; ++TaskId) {
+    TG.spawn([=, &Results, &Reduce, &Transform] {
+      RandomAccessIterator I = Begin + TaskId * TaskSize;
+      RandomAccessIterator E = Begin + std::min(NumItems,
+                                                (TaskId + 1) * TaskSize);
+      ResultTy R = Transform(*I);
+      for (++I; I != E; ++I)
+        R = Reduce(std::move(R), Transform(*I));
+      Results[TaskId] = std::move(R);
+    });
+  }
+  TG.sync();
+
+  for (ResultTy &R : Results)
+    Init = Reduce(std::move(Init), std::move(R));
+  return Init;
+}
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_PARALLEL_H
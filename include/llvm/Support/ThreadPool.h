@@ -7,7 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file defines a crude C++11 based thread pool.
+// This file defines a C++11 based work-stealing thread pool.
 //
 //===----------------------------------------------------------------------===//
 
@@ -35,19 +35,37 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
+class ThreadPoolTaskGroup;
+
 /// A ThreadPool for asynchronous parallel execution on a defined number of
 /// threads.
 ///
-/// The pool keeps a vector of threads alive, waiting on a condition variable
-/// for some work to become available.
+/// Every thread of the pool has its own deque of tasks. A task submitted from
+/// a thread of the pool goes to the back of that thread's deque, and other
+/// tasks are spread over the deques round robin. A thread runs the tasks of
+/// its own deque last in, first out, and when it runs out, steals from the
+/// front of the others. Threads with nothing to do wait on a condition
+/// variable.
+///
+/// Tasks can be submitted to a ThreadPoolTaskGroup and waited for as a group.
+/// Waiting for a group runs its queued tasks on the waiting thread instead of
+/// blocking it, so a task can wait for subtasks it submitted without
+/// deadlocking the pool. Waiting for the whole pool runs any queued task.
+///
+/// The deques pay off when tasks submit tasks. A single thread submitting
+/// many tiny tasks from outside the pool is slower than with one shared
+/// queue: each submission updates counters shared with every thread, locks
+/// the deque of the next thread and often wakes it up, and the threads then
+/// contend on those counters. utils/threadpool-bench measures both patterns.
 class ThreadPool {
 public:
 #ifndef _MSC_VER
@@ -79,14 +97,14 @@ public:
     auto Task =
         std::bind(std::forward<Function>(F), std::forward<Args>(ArgList)...);
 #ifndef _MSC_VER
-    return asyncImpl(std::move(Task));
+    return asyncImpl(std::move(Task), nullptr);
 #else
     // This lambda has to be marked mutable because MSVC 2013's std::bind call
     // operator isn't const qualified.
     return asyncImpl([Task](VoidTy) mutable -> VoidTy {
       Task();
       return VoidTy();
-    });
+    }, nullptr);
 #endif
   }
 
@@ -95,42 +113,128 @@ public:
   template <typename Function>
   inline std::shared_future<VoidTy> async(Function &&F) {
 #ifndef _MSC_VER
-    return asyncImpl(std::forward<Function>(F));
+    return asyncImpl(std::forward<Function>(F), nullptr);
 #else
-    return asyncImpl([F] (VoidTy) -> VoidTy { F(); return VoidTy(); });
+    return asyncImpl([F] (VoidTy) -> VoidTy { F(); return VoidTy(); },
+                     nullptr);
+#endif
+  }
+
+  /// Asynchronous submission of a task of \p Group to the pool.
+  template <typename Function>
+  inline std::shared_future<VoidTy> async(ThreadPoolTaskGroup &Group,
+                                          Function &&F) {
+#ifndef _MSC_VER
+    return asyncImpl(std::forward<Function>(F), &Group);
+#else
+    return asyncImpl([F] (VoidTy) -> VoidTy { F(); return VoidTy(); },
+                     &Group);
 #endif
   }
 
   /// Blocking wait for all the threads to complete and the queue to be empty.
-  /// It is an error to try to add new tasks while blocking on this call.
+  /// The calling thread runs queued tasks while it waits. It is an error to
+  /// try to add new tasks while blocking on this call, or to call it from a
+  /// task of the pool.
   void wait();
 
+  /// Blocking wait for the tasks of \p Group, running its queued tasks in the
+  /// meantime. This may be called from a task of the pool.
+  void wait(ThreadPoolTaskGroup &Group);
+
+  /// Returns true if the current thread is a thread of this pool.
+  bool isWorkerThread() const;
+
 private:
+  /// A queued task and the group it belongs to, if any.
+  struct QueuedTask {
+    PackagedTaskTy Task;
+    ThreadPoolTaskGroup *Group;
+
+    QueuedTask() : Group(nullptr) {}
+    QueuedTask(PackagedTaskTy Task, ThreadPoolTaskGroup *Group)
+        : Task(std::move(Task)), Group(Group) {}
+  };
+
+  /// The tasks of one thread of the pool.
+  struct WorkerQueue {
+    std::mutex Lock;
+    std::deque<QueuedTask> Tasks;
+  };
+
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
-  std::shared_future<VoidTy> asyncImpl(TaskTy F);
+  std::shared_future<VoidTy> asyncImpl(TaskTy F, ThreadPoolTaskGroup *Group);
+
+  /// Pop a task from the deque of the current thread, or steal one from
+  /// another, and run it. If \p Group is not null, only consider its tasks.
+  /// Returns false if there was no task to run.
+  bool runOneTask(ThreadPoolTaskGroup *Group);
+
+  /// Wake up the threads waiting for the completion of a task.
+  void notifyWaiters();
+
+  /// The loop of the thread of \p Index.
+  void work(unsigned Index);
 
   /// Threads in flight
   std::vector<llvm::thread> Threads;
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// The deques of tasks waiting for execution, one per thread, or a single
+  /// one if the pool has no threads.
+  std::vector<std::unique_ptr<WorkerQueue>> Queues;
 
-  /// Locking and signaling for accessing the Tasks queue.
+  /// The deque the next task from outside the pool goes to.
+  std::atomic<unsigned> NextQueue;
+
+  /// Number of tasks in the deques, and number of tasks not finished yet.
+  std::atomic<unsigned> QueuedTasks;
+  std::atomic<unsigned> UnfinishedTasks;
+
+  /// Locking and signaling for the threads waiting for tasks.
   std::mutex QueueLock;
   std::condition_variable QueueCondition;
+  std::atomic<unsigned> SleepingThreads;
 
-  /// Locking and signaling for job completion
+  /// Locking and signaling for the completion of tasks.
   std::mutex CompletionLock;
   std::condition_variable CompletionCondition;
+  std::atomic<unsigned> Waiters;
 
-  /// Keep track of the number of thread actually busy
-  std::atomic<unsigned> ActiveThreads;
-
-#if LLVM_ENABLE_THREADS // avoids warning for unused variable
   /// Signal for the destruction of the pool, asking thread to exit.
   bool EnableFlag;
-#endif
+};
+
+/// A group of tasks of a ThreadPool that can be waited for together.
+class ThreadPoolTaskGroup {
+public:
+  explicit ThreadPoolTaskGroup(ThreadPool &Pool)
+      : Pool(Pool), Pending(0), Queued(0) {}
+
+  /// Blocking destructor: waits for the tasks of the group.
+  ~ThreadPoolTaskGroup() { wait(); }
+
+  /// Asynchronous submission of a task of this group to the pool.
+  template <typename Function>
+  inline std::shared_future<ThreadPool::VoidTy> async(Function &&F) {
+    return Pool.async(*this, std::forward<Function>(F));
+  }
+
+  /// Blocking wait for the tasks of this group, running its queued tasks in
+  /// the meantime.
+  void wait() { Pool.wait(*this); }
+
+  ThreadPool &getPool() { return Pool; }
+
+private:
+  friend class ThreadPool;
+
+  ThreadPool &Pool;
+  /// Number of tasks of the group not finished yet.
+  std::atomic<unsigned> Pending;
+  /// Number of tasks of the group in the deques, so that waiting for the
+  /// group does not search the deques when only other tasks are queued.
+  std::atomic<unsigned> Queued;
 };
 }
 
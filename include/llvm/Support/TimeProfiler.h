@@ -0,0 +1,87 @@
+//===- llvm/Support/TimeProfiler.h - Hierarchical Time Profiler -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a profiler that records when the phases of a compilation
+// (parsing, each pass on each function, ...) begin and end, and writes them in
+// the Chrome trace event format, which chrome://tracing and Speedscope can
+// display. Unlike -time-passes, it shows which functions and which pass
+// instances take the time.
+//
+// The profiler is process-wide. Every thread keeps its own stack of open
+// sections, so sections may be recorded from several threads at once.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_TIMEPROFILER_H
+#define LLVM_SUPPORT_TIMEPROFILER_H
+
+#include "llvm/ADT/StringRef.h"
+#include <system_error>
+
+namespace llvm {
+
+class raw_ostream;
+
+struct TimeTraceProfiler;
+extern TimeTraceProfiler *TimeTraceProfilerInstance;
+
+/// Initialize the time trace profiler. Sections shorter than
+/// \p TimeTraceGranularity microseconds are left out of the trace, although
+/// they still count in the totals. \p ProcName names the process in the
+/// trace. This must be called before any other thread records sections.
+void timeTraceProfilerInitialize(unsigned TimeTraceGranularity,
+                                 StringRef ProcName);
+
+/// Stop the profiler and free the recorded sections. No other thread may be
+/// recording sections.
+void timeTraceProfilerCleanup();
+
+/// Is the time trace profiler enabled, i.e. initialized?
+inline bool timeTraceProfilerEnabled() {
+  return TimeTraceProfilerInstance != nullptr;
+}
+
+/// Write the recorded sections to \p OS as Chrome trace event JSON. Every
+/// section must have ended.
+void timeTraceProfilerWrite(raw_ostream &OS);
+
+/// Write the recorded sections to \p PreferredFileName, or when it is empty,
+/// to \p FallbackFileName with the ".time-trace" suffix.
+std::error_code timeTraceProfilerWrite(StringRef PreferredFileName,
+                                       StringRef FallbackFileName);
+
+/// Begin a section named \p Name on the current thread, with \p Detail
+/// describing what it works on, for instance the name of the function.
+void timeTraceProfilerBegin(StringRef Name, StringRef Detail);
+
+/// End the innermost section of the current thread.
+void timeTraceProfilerEnd();
+
+/// The TimeTraceScope is a helper class to call the begin and end functions
+/// of the time trace profiler. When the object is constructed, it begins
+/// the section; and when it is destroyed, it stops it. If the profiler is not
+/// enabled, it does nothing, so it is cheap to leave in hot code paths.
+struct TimeTraceScope {
+  TimeTraceScope() = delete;
+  TimeTraceScope(const TimeTraceScope &) = delete;
+  TimeTraceScope &operator=(const TimeTraceScope &) = delete;
+
+  TimeTraceScope(StringRef Name, StringRef Detail = StringRef()) {
+    if (TimeTraceProfilerInstance != nullptr)
+      timeTraceProfilerBegin(Name, Detail);
+  }
+  ~TimeTraceScope() {
+    if (TimeTraceProfilerInstance != nullptr)
+      timeTraceProfilerEnd();
+  }
+};
+
+} // end namespace llvm
+
+#endif
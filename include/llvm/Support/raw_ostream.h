@@ -17,6 +17,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/DataTypes.h"
+#include <memory>
 #include <system_error>
 
 namespace llvm {
@@ -210,6 +211,10 @@ public:
   /// satisfy std::isprint into an escape sequence.
   raw_ostream &write_escaped(StringRef Str, bool UseHexEscapes = false);
 
+  /// Output \p Str as a quoted JSON string, escaping '"', '\\' and the
+  /// control characters.
+  raw_ostream &write_json_string(StringRef Str);
+
   raw_ostream &write(unsigned char C);
   raw_ostream &write(const char *Ptr, size_t Size);
 
@@ -321,8 +326,47 @@ class raw_pwrite_stream : public raw_ostream {
   virtual void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) = 0;
 
 public:
+  /// A callback producing the contents of a deferred write. It must write
+  /// exactly the number of bytes that were reserved for it. This is a minimal
+  /// std::function, which keeps <functional> out of this header.
+  class DeferredWriteFn {
+    struct CallbackBase {
+      virtual ~CallbackBase() {}
+      virtual void call(raw_pwrite_stream &OS) = 0;
+    };
+    template <typename Callable> struct Callback : CallbackBase {
+      Callable Fn;
+      explicit Callback(Callable Fn) : Fn(std::move(Fn)) {}
+      void call(raw_pwrite_stream &OS) override { Fn(OS); }
+    };
+    std::unique_ptr<CallbackBase> Impl;
+
+  public:
+    template <typename Callable>
+    DeferredWriteFn(Callable Fn)
+        : Impl(new Callback<Callable>(std::move(Fn))) {}
+    DeferredWriteFn(DeferredWriteFn &&) = default;
+    DeferredWriteFn &operator=(DeferredWriteFn &&) = default;
+
+    void operator()(raw_pwrite_stream &OS) const { Impl->call(OS); }
+  };
+
   explicit raw_pwrite_stream(bool Unbuffered = false)
       : raw_ostream(Unbuffered) {}
+
+  /// Write \p Size bytes produced by \p Fill at the current position. By
+  /// default \p Fill is called right away on this stream. Streams that only
+  /// know where their output goes once it is complete may instead leave a hole
+  /// and call \p Fill later, from flushDeferred(), on a stream of its own and
+  /// concurrently with other deferred writes.
+  virtual void writeDeferred(uint64_t Size, DeferredWriteFn Fill) {
+    Fill(*this);
+  }
+
+  /// Call the callbacks of the deferred writes that are still pending. Anything
+  /// they refer to must stay alive until then.
+  virtual void flushDeferred() {}
+
   void pwrite(const char *Ptr, size_t Size, uint64_t Offset) {
 #ifndef NDBEBUG
     uint64_t Pos = tell();
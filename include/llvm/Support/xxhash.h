@@ -0,0 +1,121 @@
+//===- llvm/Support/xxhash.h - Fast non-cryptographic hashing ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the xxHash64 hash function, a fast non-cryptographic
+// hash of byte buffers by Yann Collet, with one-shot and streaming interfaces,
+// and a 128-bit value made of two seeded xxHash64 hashes.
+//
+// Stability: xxHash64 computes the reference xxHash64 of the bytes given to
+// it, so its values are the same on every host and in every release, and may
+// be stored in files. The 128-bit hash is as stable, as long as it is given
+// the same seed. Neither is meant to resist deliberate collisions: use SHA1
+// or MD5 where an adversary can choose the data. This is unlike hash_code,
+// whose values may change from one execution to the next and must never be
+// stored.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_XXHASH_H
+#define LLVM_SUPPORT_XXHASH_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <string>
+
+namespace llvm {
+
+/// Return the xxHash64 of \p Data with the seed \p Seed.
+uint64_t xxHash64(ArrayRef<uint8_t> Data, uint64_t Seed = 0);
+
+inline uint64_t xxHash64(StringRef Data, uint64_t Seed = 0) {
+  return xxHash64(ArrayRef<uint8_t>(Data.bytes_begin(), Data.size()), Seed);
+}
+
+/// Compute the xxHash64 of data given in pieces. The result is the same as
+/// that of xxHash64() on the concatenation of the pieces.
+class XXHash64 {
+public:
+  explicit XXHash64(uint64_t Seed = 0) { init(Seed); }
+
+  /// Reinitialize the state, forgetting the data hashed so far.
+  void init(uint64_t Seed = 0);
+
+  /// Digest more data.
+  void update(ArrayRef<uint8_t> Data);
+
+  void update(StringRef Str) {
+    update(ArrayRef<uint8_t>(Str.bytes_begin(), Str.size()));
+  }
+
+  /// Return the hash of the data digested since the last call to init(). More
+  /// data can be digested afterwards.
+  uint64_t digest() const;
+
+private:
+  uint64_t Acc[4];
+  uint64_t Seed;
+  uint64_t TotalLength;
+  /// The bytes that do not fill a stripe of 32 bytes yet.
+  uint8_t Buffer[32];
+  unsigned BufferSize;
+};
+
+/// The 128-bit hash of some data: the xxHash64 of the data with two different
+/// seeds. The two halves come from the same algorithm and are not independent,
+/// so this is not a 128-bit hash in strength. Two inputs only collide if their
+/// xxHash64 with the first seed does, so the odds of an accidental collision
+/// are at most those of xxHash64 alone, about 2^-64 per pair of inputs.
+struct XXHash128Result {
+  uint64_t High;
+  uint64_t Low;
+
+  /// Return the 32 hexadecimal digits of the hash.
+  std::string toHex() const;
+
+  bool operator==(const XXHash128Result &RHS) const {
+    return High == RHS.High && Low == RHS.Low;
+  }
+  bool operator!=(const XXHash128Result &RHS) const { return !(*this == RHS); }
+};
+
+/// Compute the 128-bit hash of data given in pieces.
+class XXHash128 {
+public:
+  XXHash128() { init(); }
+
+  void init();
+
+  void update(ArrayRef<uint8_t> Data) {
+    HighHash.update(Data);
+    LowHash.update(Data);
+  }
+
+  void update(StringRef Str) {
+    update(ArrayRef<uint8_t>(Str.bytes_begin(), Str.size()));
+  }
+
+  XXHash128Result digest() const {
+    return XXHash128Result{HighHash.digest(), LowHash.digest()};
+  }
+
+private:
+  XXHash64 HighHash, LowHash;
+};
+
+/// Return the 128-bit hash of \p Data.
+XXHash128Result xxHash128(ArrayRef<uint8_t> Data);
+
+inline XXHash128Result xxHash128(StringRef Data) {
+  return xxHash128(ArrayRef<uint8_t>(Data.bytes_begin(), Data.size()));
+}
+
+} // end namespace llvm
+
+#endif
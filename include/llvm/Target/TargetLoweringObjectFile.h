@@ -103,6 +103,13 @@ public:
   virtual bool shouldPutJumpTableInFunctionSection(bool UsesLabelDifference,
                                                    const Function &F) const;
 
+  /// Return the section holding the blocks of \p F that the function splitter
+  /// found cold, or null if the object file format does not support it.
+  virtual MCSection *getSectionForColdCode(const Function &F, Mangler &Mang,
+                                           const TargetMachine &TM) const {
+    return nullptr;
+  }
+
   /// Targets should implement this method to assign a section to globals with
   /// an explicit section specfied. The implementation of this method can
   /// assume that GV->hasSection() is true.
@@ -25,6 +25,8 @@ namespace llvm {
 
 class CallLowering;
 class DataLayout;
+class InstructionSelector;
+class LegalizerInfo;
 class MachineFunction;
 class MachineInstr;
 class RegisterBankInfo;
@@ -88,6 +90,13 @@ public:
     return nullptr;
   }
   virtual const CallLowering *getCallLowering() const { return nullptr; }
+
+  /// Return the selector used by GlobalISel to turn generic instructions
+  /// into target ones, or nullptr if the target does not support GlobalISel.
+  virtual const InstructionSelector *getInstructionSelector() const {
+    return nullptr;
+  }
+
   /// Target can subclass this hook to select a different DAG scheduler.
   virtual RegisterScheduler::FunctionPassCtor
       getDAGScheduler(CodeGenOpt::Level) const {
@@ -103,6 +112,10 @@ public:
   /// Otherwise return nullptr.
   virtual const RegisterBankInfo *getRegBankInfo() const { return nullptr; }
 
+  /// Return the information about which generic operations the target can
+  /// select, or nullptr if the target does not support GlobalISel.
+  virtual const LegalizerInfo *getLegalizerInfo() const { return nullptr; }
+
   /// getInstrItineraryData - Returns instruction itinerary data for the target
   /// or specific subtarget.
   ///
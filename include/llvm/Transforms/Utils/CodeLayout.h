@@ -0,0 +1,59 @@
+//===- CodeLayout.h - Code layout/placement algorithms ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Declares methods and data structures for code layout algorithms.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_UTILS_CODELAYOUT_H
+#define LLVM_TRANSFORMS_UTILS_CODELAYOUT_H
+
+#include "llvm/Support/DataTypes.h"
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+/// A jump between two nodes of a control flow graph, and how many times it
+/// is taken.
+typedef std::pair<uint64_t, uint64_t> EdgeT;
+typedef std::pair<EdgeT, uint64_t> EdgeCountT;
+
+/// Find a layout of the nodes (basic blocks) of a control flow graph that
+/// maximizes the Ext-TSP score, a model of how well the layout uses the
+/// instruction cache: a jump scores best when it becomes a fall-through, and
+/// still scores a little when it is a short forward or backward jump.
+///
+/// \p NodeSizes holds the size of each node in bytes, \p NodeCounts how many
+/// times it is executed and \p EdgeCounts the jumps between the nodes. Node 0
+/// is the entry of the graph and is always placed first.
+///
+/// \returns The nodes in their new order.
+std::vector<uint64_t>
+applyExtTspLayout(const std::vector<uint64_t> &NodeSizes,
+                  const std::vector<uint64_t> &NodeCounts,
+                  const std::vector<EdgeCountT> &EdgeCounts);
+
+/// Estimate the Ext-TSP score of the layout \p Order of the nodes of a control
+/// flow graph, described as for applyExtTspLayout.
+double calcExtTspScore(const std::vector<uint64_t> &Order,
+                       const std::vector<uint64_t> &NodeSizes,
+                       const std::vector<uint64_t> &NodeCounts,
+                       const std::vector<EdgeCountT> &EdgeCounts);
+
+/// Estimate the Ext-TSP score of the nodes of a control flow graph laid out
+/// in their original order.
+double calcExtTspScore(const std::vector<uint64_t> &NodeSizes,
+                       const std::vector<uint64_t> &NodeCounts,
+                       const std::vector<EdgeCountT> &EdgeCounts);
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_UTILS_CODELAYOUT_H
@@ -109,6 +109,8 @@ AsmPrinter::AsmPrinter(TargetMachine &tm, std::unique_ptr<MCStreamer> Streamer)
   CurExceptionSym = CurrentFnSym = CurrentFnSymForSize = nullptr;
   CurrentFnBegin = nullptr;
   CurrentFnEnd = nullptr;
+  CurrentFnHotEnd = nullptr;
+  CurrentFnColdBegin = nullptr;
   GCMetadataPrinters = nullptr;
   VerboseAsm = OutStreamer->isVerboseAsm();
 }
@@ -849,6 +851,10 @@ void AsmPrinter::EmitFunctionBody() {
   // Print out code for the function.
   bool HasAnyRealCode = false;
   for (auto &MBB : *MF) {
+    // The blocks moved to the cold section all come last.
+    if (MBB.isColdSection() && !CurrentFnColdBegin)
+      emitColdSectionStart(MBB);
+
     // Print a label for the basic block.
     EmitBasicBlockStart(MBB);
     for (auto &MI : MBB) {
@@ -952,14 +958,17 @@ void AsmPrinter::EmitFunctionBody() {
   }
 
   // If the target wants a .size directive for the size of the function, emit
-  // it.
+  // it. The size of the hot part of a split function was emitted with it.
   if (MAI->hasDotTypeDotSizeDirective()) {
+    MCSymbol *SizeSym = CurrentFnColdBegin ? CurrentFnColdBegin : CurrentFnSym;
+    MCSymbol *BeginSym =
+        CurrentFnColdBegin ? CurrentFnColdBegin : CurrentFnSymForSize;
     // We can get the size as difference between the function label and the
     // temp label.
     const MCExpr *SizeExp = MCBinaryExpr::createSub(
         MCSymbolRefExpr::create(CurrentFnEnd, OutContext),
-        MCSymbolRefExpr::create(CurrentFnSymForSize, OutContext), OutContext);
-    if (auto Sym = dyn_cast<MCSymbolELF>(CurrentFnSym))
+        MCSymbolRefExpr::create(BeginSym, OutContext), OutContext);
+    if (auto Sym = dyn_cast<MCSymbolELF>(SizeSym))
       OutStreamer->emitELFSize(Sym, SizeExp);
   }
 
@@ -981,6 +990,49 @@ void AsmPrinter::EmitFunctionBody() {
   OutStreamer->AddBlankLine();
 }
 
+void AsmPrinter::emitColdSectionStart(const MachineBasicBlock &MBB) {
+  // Close the hot part of the function, which keeps the function symbol and
+  // its own frame description entry.
+  CurrentFnHotEnd = createTempSymbol("func_hot_end");
+  OutStreamer->EmitLabel(CurrentFnHotEnd);
+  if (MAI->hasDotTypeDotSizeDirective()) {
+    const MCExpr *SizeExp = MCBinaryExpr::createSub(
+        MCSymbolRefExpr::create(CurrentFnHotEnd, OutContext),
+        MCSymbolRefExpr::create(CurrentFnSymForSize, OutContext), OutContext);
+    if (auto Sym = dyn_cast<MCSymbolELF>(CurrentFnSym))
+      OutStreamer->emitELFSize(Sym, SizeExp);
+  }
+  for (const HandlerInfo &HI : Handlers) {
+    NamedRegionTimer T(HI.TimerName, HI.TimerGroupName, TimePassesIsEnabled);
+    HI.Handler->endFragment();
+  }
+
+  MCSection *ColdSection = getObjFileLowering().getSectionForColdCode(
+      *MF->getFunction(), *Mang, TM);
+  assert(ColdSection && "Function split for an unsupported object format");
+  OutStreamer->SwitchSection(ColdSection);
+  EmitAlignment(MF->getAlignment());
+
+  // The cold part is a local function of its own.
+  CurrentFnColdBegin =
+      OutContext.getOrCreateSymbol(CurrentFnSym->getName() + ".cold");
+  if (MAI->hasDotTypeDotSizeDirective())
+    OutStreamer->EmitSymbolAttribute(CurrentFnColdBegin, MCSA_ELF_TypeFunction);
+  OutStreamer->EmitLabel(CurrentFnColdBegin);
+  for (const HandlerInfo &HI : Handlers) {
+    NamedRegionTimer T(HI.TimerName, HI.TimerGroupName, TimePassesIsEnabled);
+    HI.Handler->beginFragment(
+        &MBB, [](AsmPrinter *AP) { return AP->getCurExceptionSym(); });
+  }
+
+  // The splitter leaves all frame moves in the entry block, so they describe
+  // the frame of every cold block: repeat them for the new frame description
+  // entry.
+  for (const MachineInstr &MI : MF->front())
+    if (MI.isCFIInstruction())
+      emitCFIInstruction(MI);
+}
+
 /// \brief Compute the number of Global Variables that uses a Constant.
 static unsigned getNumGlobalVariableUses(const Constant *C) {
   if (!C)
@@ -1263,10 +1315,15 @@ MCSymbol *AsmPrinter::getCurExceptionSym() {
 
 void AsmPrinter::SetupMachineFunction(MachineFunction &MF) {
   this->MF = &MF;
+  // Number the temporary symbols created for the function before it is
+  // emitted, if that was deferred, before creating any for its emission.
+  MMI->nameTempSymbols();
   // Get the function symbol.
   CurrentFnSym = getSymbol(MF.getFunction());
   CurrentFnSymForSize = CurrentFnSym;
   CurrentFnBegin = nullptr;
+  CurrentFnHotEnd = nullptr;
+  CurrentFnColdBegin = nullptr;
   CurExceptionSym = nullptr;
   bool NeedsLocalForSize = MAI->needsLocalForSize();
   if (!MMI->getLandingPads().empty() || MMI->hasDebugInfo() ||
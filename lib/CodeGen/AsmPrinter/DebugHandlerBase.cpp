@@ -223,6 +223,14 @@ void DebugHandlerBase::endInstruction() {
   I->second = PrevLabel;
 }
 
+void DebugHandlerBase::beginFragment(const MachineBasicBlock *MBB,
+                                     ExceptionSymbolProvider ESP) {
+  // The fragment starts in another section: neither the last label nor the
+  // last line table entry apply to its first instruction.
+  PrevLabel = nullptr;
+  PrevInstLoc = DebugLoc();
+}
+
 void DebugHandlerBase::endFunction(const MachineFunction *MF) {
   DbgValues.clear();
   LabelsBeforeInsn.clear();
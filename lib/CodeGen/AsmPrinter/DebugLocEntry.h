@@ -122,6 +122,15 @@ public:
     return false;
   }
 
+  /// Make this entry end at \p SplitEnd and return an entry for the same
+  /// values covering the rest of the range, from \p SplitBegin on.
+  DebugLocEntry splitAt(const MCSymbol *SplitEnd, const MCSymbol *SplitBegin) {
+    DebugLocEntry Rest = *this;
+    End = SplitEnd;
+    Rest.Begin = SplitBegin;
+    return Rest;
+  }
+
   const MCSymbol *getBeginSym() const { return Begin; }
   const MCSymbol *getEndSym() const { return End; }
   ArrayRef<Value> getValues() const { return Values; }
@@ -293,7 +293,12 @@ void DwarfCompileUnit::attachLowHighPC(DIE &D, const MCSymbol *Begin,
 DIE &DwarfCompileUnit::updateSubprogramScopeDIE(const DISubprogram *SP) {
   DIE *SPDie = getOrCreateSubprogramDIE(SP, includeMinimalInlineScopes());
 
-  attachLowHighPC(*SPDie, Asm->getFunctionBegin(), Asm->getFunctionEnd());
+  if (MCSymbol *ColdBegin = Asm->getFunctionColdBegin())
+    attachRangesOrLowHighPC(
+        *SPDie, {RangeSpan(Asm->getFunctionBegin(), Asm->getFunctionHotEnd()),
+                 RangeSpan(ColdBegin, Asm->getFunctionEnd())});
+  else
+    attachLowHighPC(*SPDie, Asm->getFunctionBegin(), Asm->getFunctionEnd());
   if (DD->useAppleExtensionAttributes() &&
       !DD->getCurrentFunction()->getTarget().Options.DisableFramePointerElim(
           *DD->getCurrentFunction()))
@@ -423,9 +428,17 @@ void DwarfCompileUnit::attachRangesOrLowHighPC(
     DIE &Die, const SmallVectorImpl<InsnRange> &Ranges) {
   SmallVector<RangeSpan, 2> List;
   List.reserve(Ranges.size());
-  for (const InsnRange &R : Ranges)
-    List.push_back(RangeSpan(DD->getLabelBeforeInsn(R.first),
-                             DD->getLabelAfterInsn(R.second)));
+  for (const InsnRange &R : Ranges) {
+    MCSymbol *Begin = DD->getLabelBeforeInsn(R.first);
+    // A range running from the hot into the cold part of a split function
+    // covers the end of one section and the start of the other.
+    if (!R.first->getParent()->isColdSection() &&
+        R.second->getParent()->isColdSection()) {
+      List.push_back(RangeSpan(Begin, Asm->getFunctionHotEnd()));
+      Begin = Asm->getFunctionColdBegin();
+    }
+    List.push_back(RangeSpan(Begin, DD->getLabelAfterInsn(R.second)));
+  }
   attachRangesOrLowHighPC(Die, std::move(List));
 }
 
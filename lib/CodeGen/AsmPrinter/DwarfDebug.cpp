@@ -902,6 +902,17 @@ DwarfDebug::buildLocationList(SmallVectorImpl<DebugLocEntry> &DebugLoc,
     if (PrevEntry != DebugLoc.rend() && PrevEntry->MergeRanges(*CurEntry))
       DebugLoc.pop_back();
   }
+
+  // No entry may cover the end of the hot and the start of the cold part of a
+  // split function, which live in different sections.
+  if (const MCSymbol *ColdBegin = Asm->getFunctionColdBegin())
+    for (unsigned I = 0; I != DebugLoc.size(); ++I)
+      if (&DebugLoc[I].getBeginSym()->getSection() !=
+          &DebugLoc[I].getEndSym()->getSection()) {
+        DebugLocEntry ColdEntry =
+            DebugLoc[I].splitAt(Asm->getFunctionHotEnd(), ColdBegin);
+        DebugLoc.insert(DebugLoc.begin() + I + 1, std::move(ColdEntry));
+      }
 }
 
 DbgVariable *DwarfDebug::createConcreteVariable(LexicalScope &Scope,
@@ -1119,7 +1130,12 @@ void DwarfDebug::endFunction(const MachineFunction *MF) {
   collectVariableInfo(TheCU, SP, ProcessedVars);
 
   // Add the range of this function to the list of ranges for the CU.
-  TheCU.addRange(RangeSpan(Asm->getFunctionBegin(), Asm->getFunctionEnd()));
+  if (MCSymbol *ColdBegin = Asm->getFunctionColdBegin()) {
+    TheCU.addRange(
+        RangeSpan(Asm->getFunctionBegin(), Asm->getFunctionHotEnd()));
+    TheCU.addRange(RangeSpan(ColdBegin, Asm->getFunctionEnd()));
+  } else
+    TheCU.addRange(RangeSpan(Asm->getFunctionBegin(), Asm->getFunctionEnd()));
 
   // Under -gmlt, skip building the subprogram if there are no inlined
   // subroutines inside it.
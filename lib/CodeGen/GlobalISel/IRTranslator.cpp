@@ -16,7 +16,7 @@
 #include "llvm/CodeGen/GlobalISel/CallLowering.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
-#include "llvm/IR/Constant.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Value.h"
@@ -35,6 +35,16 @@ IRTranslator::IRTranslator() : MachineFunctionPass(ID), MRI(nullptr) {
 }
 
 unsigned IRTranslator::getOrCreateVReg(const Value &Val) {
+  // Integer constants are rematerialized right before each of their uses.
+  // This keeps their live-ranges short and lets the instruction selector fold
+  // them into immediate operands.
+  if (const ConstantInt *CI = dyn_cast<ConstantInt>(&Val)) {
+    unsigned VReg =
+        MRI->createGenericVirtualRegister(CI->getType()->getBitWidth());
+    MIRBuilder.buildConstant(CI->getType(), VReg, *CI);
+    return VReg;
+  }
+
   unsigned &ValReg = ValToVReg[&Val];
   // Check if this is the first time we see Val.
   if (!ValReg) {
@@ -104,8 +114,22 @@ bool IRTranslator::translate(const Instruction &Inst) {
   switch(Inst.getOpcode()) {
   case Instruction::Add:
     return translateBinaryOp(TargetOpcode::G_ADD, Inst);
+  case Instruction::Sub:
+    return translateBinaryOp(TargetOpcode::G_SUB, Inst);
+  case Instruction::Mul:
+    return translateBinaryOp(TargetOpcode::G_MUL, Inst);
+  case Instruction::And:
+    return translateBinaryOp(TargetOpcode::G_AND, Inst);
   case Instruction::Or:
     return translateBinaryOp(TargetOpcode::G_OR, Inst);
+  case Instruction::Xor:
+    return translateBinaryOp(TargetOpcode::G_XOR, Inst);
+  case Instruction::Shl:
+    return translateBinaryOp(TargetOpcode::G_SHL, Inst);
+  case Instruction::LShr:
+    return translateBinaryOp(TargetOpcode::G_LSHR, Inst);
+  case Instruction::AShr:
+    return translateBinaryOp(TargetOpcode::G_ASHR, Inst);
   case Instruction::Br:
     return translateBr(Inst);
   case Instruction::Ret:
@@ -122,6 +146,7 @@ void IRTranslator::finalize() {
   // needed during the translation.
   ValToVReg.clear();
   Constants.clear();
+  BBToMBB.clear();
 }
 
 bool IRTranslator::runOnMachineFunction(MachineFunction &MF) {
@@ -160,5 +185,6 @@ bool IRTranslator::runOnMachineFunction(MachineFunction &MF) {
   // the reserved registers are possible.
   MRI->freezeReservedRegs(MF);
 
+  finalize();
   return false;
 }
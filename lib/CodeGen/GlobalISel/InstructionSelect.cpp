@@ -0,0 +1,97 @@
+//===- llvm/CodeGen/GlobalISel/InstructionSelect.cpp - InstructionSelect ---==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the InstructionSelect class.
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/InstructionSelect.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+
+#define DEBUG_TYPE "instruction-select"
+
+using namespace llvm;
+
+char InstructionSelect::ID = 0;
+INITIALIZE_PASS(InstructionSelect, DEBUG_TYPE,
+                "Select target instructions out of generic instructions",
+                false, false);
+
+InstructionSelect::InstructionSelect() : MachineFunctionPass(ID) {
+  initializeInstructionSelectPass(*PassRegistry::getPassRegistry());
+}
+
+/// Check whether \p MI is a generic instruction whose only effect is to
+/// define registers that nobody reads. The selection of its users may have
+/// folded it away, e.g. a G_CONSTANT that became an immediate operand.
+static bool isTriviallyDead(const MachineInstr &MI,
+                            const MachineRegisterInfo &MRI) {
+  if (!isPreISelGenericOpcode(MI.getOpcode()) || MI.hasUnmodeledSideEffects() ||
+      MI.isTerminator())
+    return false;
+  for (const MachineOperand &MO : MI.operands()) {
+    if (!MO.isReg() || !MO.isDef())
+      continue;
+    if (!TargetRegisterInfo::isVirtualRegister(MO.getReg()) ||
+        !MRI.use_nodbg_empty(MO.getReg()))
+      return false;
+  }
+  return true;
+}
+
+bool InstructionSelect::runOnMachineFunction(MachineFunction &MF) {
+  DEBUG(dbgs() << "Selecting function: " << MF.getName() << '\n');
+
+  const InstructionSelector *ISel = MF.getSubtarget().getInstructionSelector();
+  assert(ISel && "Cannot work without InstructionSelector");
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  for (MachineBasicBlock *MBB : post_order(&MF)) {
+    if (MBB->empty())
+      continue;
+
+    // Select instructions in reverse block order. We permit erasing so have
+    // to resort to manually iterating and recognizing the begin (rend) case.
+    bool ReachedBegin = false;
+    for (auto MII = std::prev(MBB->end()), Begin = MBB->begin();
+         !ReachedBegin;) {
+      // Select this instruction.
+      MachineInstr &MI = *MII;
+
+      // And have our iterator point to the next instruction, if there is one.
+      if (MII == Begin)
+        ReachedBegin = true;
+      else
+        --MII;
+
+      // The users of MI have been selected already: if they don't need it
+      // anymore, there is no point in selecting it.
+      if (isTriviallyDead(MI, MRI)) {
+        DEBUG(dbgs() << "Erasing dead: " << MI);
+        MI.eraseFromParent();
+        continue;
+      }
+
+      DEBUG(dbgs() << "Selecting: " << MI);
+      if (!ISel->select(MI))
+        report_fatal_error("Unable to select instruction");
+    }
+  }
+
+  // Now that selection is complete, there are no more generic vregs: the
+  // sizes are redundant with the register classes.
+  MRI.clearVirtRegSizes();
+
+  // FIXME: Should we accurately track changes?
+  return true;
+}
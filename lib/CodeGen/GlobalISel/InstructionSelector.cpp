@@ -0,0 +1,152 @@
+//===- llvm/CodeGen/GlobalISel/InstructionSelector.cpp -----------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the InstructionSelector class.
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+
+#include <algorithm>
+
+#define DEBUG_TYPE "instructionselector"
+
+using namespace llvm;
+
+InstructionSelector::InstructionSelector() {}
+
+bool InstructionSelector::checkPredicates(unsigned PredicatesID) const {
+  return PredicatesID == 0;
+}
+
+bool InstructionSelector::checkImmPredicate(unsigned PredicateID,
+                                            const ConstantInt &Imm) const {
+  return PredicateID == 0;
+}
+
+/// Return the constant held or defined by operand \p OpIdx of \p I, or null
+/// if it is not a constant.
+static const ConstantInt *getConstantOperand(const MachineInstr &I,
+                                             unsigned OpIdx,
+                                             const MachineRegisterInfo &MRI) {
+  const MachineOperand &MO = I.getOperand(OpIdx);
+  if (MO.isCImm())
+    return MO.getCImm();
+  if (!MO.isReg() || !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+    return nullptr;
+  const MachineInstr *Def = MRI.getVRegDef(MO.getReg());
+  if (!Def || Def->getOpcode() != TargetOpcode::G_CONSTANT)
+    return nullptr;
+  return Def->getOperand(1).getCImm();
+}
+
+bool InstructionSelector::selectFromTable(MachineInstr &I,
+                                          ArrayRef<MatchTableEntry> Table,
+                                          const TargetInstrInfo &TII,
+                                          const TargetRegisterInfo &TRI,
+                                          const RegisterBankInfo &RBI) const {
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineRegisterInfo &MRI = MBB.getParent()->getRegInfo();
+  unsigned SizeInBits = I.getNumOperands() && I.getOperand(0).isReg()
+                            ? MRI.getSize(I.getOperand(0).getReg())
+                            : 0;
+
+  auto Row = std::lower_bound(
+      Table.begin(), Table.end(), I.getOpcode(),
+      [](const MatchTableEntry &LHS, unsigned Opcode) {
+        return LHS.GenericOpcode < Opcode;
+      });
+  for (; Row != Table.end() && Row->GenericOpcode == I.getOpcode(); ++Row) {
+    if (Row->SizeInBits != SizeInBits || !checkPredicates(Row->PredicatesID))
+      continue;
+
+    const ConstantInt *Imm = nullptr;
+    if (Row->ImmOperand >= 0) {
+      Imm = getConstantOperand(I, Row->ImmOperand, MRI);
+      if (!Imm || !checkImmPredicate(Row->ImmPredicateID, *Imm))
+        continue;
+    }
+
+    MachineInstrBuilder MIB =
+        BuildMI(MBB, I, I.getDebugLoc(), TII.get(Row->Opcode));
+    for (unsigned OpI = 0; OpI != Row->NumOperands; ++OpI) {
+      int SrcIdx = Row->OperandMap[OpI];
+      if (SrcIdx == Row->ImmOperand)
+        MIB.addImm(Imm->getSExtValue());
+      else
+        MIB.addOperand(I.getOperand(SrcIdx));
+    }
+    DEBUG(dbgs() << "Imported pattern selected: "; MIB->print(dbgs()));
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+  return false;
+}
+
+bool InstructionSelector::constrainSelectedInstRegOperands(
+    MachineInstr &I, const TargetInstrInfo &TII, const TargetRegisterInfo &TRI,
+    const RegisterBankInfo &RBI) const {
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineFunction &MF = *MBB.getParent();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  for (unsigned OpI = 0, OpE = I.getNumExplicitOperands(); OpI != OpE; ++OpI) {
+    MachineOperand &MO = I.getOperand(OpI);
+
+    // There's nothing to be done on non-register operands.
+    if (!MO.isReg())
+      continue;
+
+    DEBUG(dbgs() << "Converting operand: " << MO << '\n');
+
+    unsigned Reg = MO.getReg();
+    // Physical registers don't need to be constrained.
+    if (TRI.isPhysicalRegister(Reg))
+      continue;
+
+    // Register operands with a value of 0 (e.g. predicate operands) don't need
+    // to be constrained.
+    if (Reg == 0)
+      continue;
+
+    const TargetRegisterClass *RC = TII.getRegClass(I.getDesc(), OpI, &TRI, MF);
+    if (!RC)
+      continue;
+
+    // A generic virtual register simply takes the class the instruction
+    // wants.
+    if (!MRI.getRegClassOrNull(Reg)) {
+      MRI.setRegClass(Reg, RC);
+      continue;
+    }
+    if (MRI.constrainRegClass(Reg, RC))
+      continue;
+
+    // The register has already been constrained to an incompatible class:
+    // go through a copy.
+    unsigned NewReg = MRI.createVirtualRegister(RC);
+    if (MO.isDef())
+      BuildMI(MBB, std::next(I.getIterator()), I.getDebugLoc(),
+              TII.get(TargetOpcode::COPY), Reg)
+          .addReg(NewReg);
+    else
+      BuildMI(MBB, I, I.getDebugLoc(), TII.get(TargetOpcode::COPY), NewReg)
+          .addReg(Reg);
+    MO.setReg(NewReg);
+  }
+  return true;
+}
@@ -0,0 +1,137 @@
+//===-- llvm/CodeGen/GlobalISel/Legalizer.cpp -----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the Legalizer pass that runs the
+/// LegalizerHelper on every generic instruction of a function.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/Legalizer.h"
+#include "llvm/CodeGen/GlobalISel/LegalizerHelper.h"
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+
+#define DEBUG_TYPE "legalizer"
+
+using namespace llvm;
+
+char Legalizer::ID = 0;
+INITIALIZE_PASS(Legalizer, DEBUG_TYPE,
+                "Legalize the Machine IR a function's Machine IR", false,
+                false);
+
+Legalizer::Legalizer() : MachineFunctionPass(ID) {
+  initializeLegalizerPass(*PassRegistry::getPassRegistry());
+}
+
+static bool isConversion(const MachineInstr &MI) {
+  return MI.getOpcode() == TargetOpcode::G_ANYEXT ||
+         MI.getOpcode() == TargetOpcode::G_TRUNC;
+}
+
+bool Legalizer::combineConversions(MachineFunction &MF,
+                                   MachineRegisterInfo &MRI) {
+  MachineIRBuilder MIRBuilder;
+  MIRBuilder.setMF(MF);
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : MF) {
+    for (auto MI = MBB.begin(), End = MBB.end(); MI != End;) {
+      MachineInstr &Ext = *MI++;
+      if (Ext.getOpcode() != TargetOpcode::G_ANYEXT)
+        continue;
+      MachineInstr *Trunc = MRI.getVRegDef(Ext.getOperand(1).getReg());
+      if (!Trunc || Trunc->getOpcode() != TargetOpcode::G_TRUNC)
+        continue;
+      DEBUG(dbgs() << "Combining: "; Ext.print(dbgs()));
+      Changed = true;
+
+      // The bits dropped by the truncation are undefined after the extension
+      // anyway, so extend, truncate or reuse the original value directly.
+      unsigned SrcReg = Trunc->getOperand(1).getReg();
+      unsigned DstReg = Ext.getOperand(0).getReg();
+      unsigned SrcSize = MRI.getSize(SrcReg);
+      unsigned DstSize = MRI.getSize(DstReg);
+      if (SrcSize < DstSize) {
+        Ext.getOperand(1).setReg(SrcReg);
+        continue;
+      }
+      if (SrcSize > DstSize) {
+        MIRBuilder.setInstr(Ext, /*Before=*/true);
+        MIRBuilder.buildInstr(TargetOpcode::G_TRUNC, Ext.getType(), DstReg,
+                              SrcReg);
+      } else
+        MRI.replaceRegWith(DstReg, SrcReg);
+      Ext.eraseFromParent();
+    }
+  }
+
+  // Removing a conversion may make the one feeding it dead, so iterate until
+  // nothing changes.
+  bool Erased;
+  do {
+    Erased = false;
+    for (MachineBasicBlock &MBB : MF) {
+      for (auto MI = MBB.begin(), End = MBB.end(); MI != End;) {
+        MachineInstr &Conv = *MI++;
+        if (!isConversion(Conv) ||
+            !MRI.use_empty(Conv.getOperand(0).getReg()))
+          continue;
+        Conv.eraseFromParent();
+        Erased = true;
+      }
+    }
+    Changed |= Erased;
+  } while (Erased);
+  return Changed;
+}
+
+bool Legalizer::runOnMachineFunction(MachineFunction &MF) {
+  DEBUG(dbgs() << "Legalize Machine IR for: " << MF.getName() << '\n');
+  const LegalizerInfo &LegalizerInfo = *MF.getSubtarget().getLegalizerInfo();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  LegalizerHelper Helper(MF);
+
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : MF) {
+    for (auto MI = MBB.begin(), End = MBB.end(); MI != End;) {
+      // Legalizing MI may insert instructions before it and erase it, so
+      // move the iterator first.
+      MachineInstr &CurMI = *MI++;
+      // Only legalize pre-isel generic instructions: others don't have types
+      // and are assumed to be legal. The conversions are dealt with once the
+      // operations around them have been legalized.
+      if (!isPreISelGenericOpcode(CurMI.getOpcode()) || isConversion(CurMI))
+        continue;
+
+      LegalizerHelper::LegalizeResult Res =
+          Helper.legalizeInstr(CurMI, LegalizerInfo);
+      // Error out if we couldn't legalize this instruction. We may want to fall
+      // back to DAG ISel instead in the future.
+      if (Res == LegalizerHelper::UnableToLegalize)
+        report_fatal_error("unable to legalize instruction");
+      Changed |= Res == LegalizerHelper::Legalized;
+    }
+  }
+
+  Changed |= combineConversions(MF, MRI);
+
+  // Whatever conversion remains must be selectable on its own.
+  for (MachineBasicBlock &MBB : MF)
+    for (MachineInstr &MI : MBB)
+      if (isConversion(MI) && !LegalizerInfo.isLegal(MI)) {
+        DEBUG(dbgs() << "Illegal conversion: "; MI.print(dbgs()));
+        report_fatal_error("unable to legalize instruction");
+      }
+
+  return Changed;
+}
@@ -0,0 +1,188 @@
+//===-- llvm/CodeGen/GlobalISel/LegalizerHelper.cpp -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file implements the LegalizerHelper class to legalize
+/// individual instructions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/LegalizerHelper.h"
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "legalize-mir"
+
+using namespace llvm;
+
+LegalizerHelper::LegalizerHelper(MachineFunction &MF)
+    : MRI(MF.getRegInfo()) {
+  MIRBuilder.setMF(MF);
+}
+
+LegalizerHelper::LegalizeResult
+LegalizerHelper::legalizeInstrStep(MachineInstr &MI,
+                                   const LegalizerInfo &LegalizerInfo) {
+  DEBUG(dbgs() << "Legalizing: "; MI.print(dbgs()));
+
+  auto Action = LegalizerInfo.getAction(MI);
+  switch (Action.first) {
+  case LegalizerInfo::Legal:
+    return AlreadyLegal;
+  case LegalizerInfo::WidenScalar:
+    return widenScalar(MI, Action.second);
+  case LegalizerInfo::Custom:
+    MIRBuilder.setInstr(MI, /*Before=*/true);
+    return LegalizerInfo.legalizeCustom(MI, MRI, MIRBuilder) ? Legalized
+                                                             : UnableToLegalize;
+  default:
+    return UnableToLegalize;
+  }
+}
+
+LegalizerHelper::LegalizeResult
+LegalizerHelper::legalizeInstr(MachineInstr &MI,
+                               const LegalizerInfo &LegalizerInfo) {
+  SmallVector<MachineInstr *, 4> WorkList;
+  WorkList.push_back(&MI);
+
+  bool Changed = false;
+  while (!WorkList.empty()) {
+    MachineInstr &CurMI = *WorkList.pop_back_val();
+    MachineBasicBlock &MBB = *CurMI.getParent();
+
+    // The instructions produced by one step are inserted right before CurMI,
+    // so remember the boundaries of the range they will end up in.
+    MachineBasicBlock::iterator CurIt(CurMI);
+    bool IsFirst = CurIt == MBB.begin();
+    MachineBasicBlock::iterator Prev = IsFirst ? MBB.end() : std::prev(CurIt);
+    MachineBasicBlock::iterator Next = std::next(CurIt);
+
+    LegalizeResult Res = legalizeInstrStep(CurMI, LegalizerInfo);
+    if (Res == UnableToLegalize) {
+      DEBUG(dbgs() << "Unable to legalize: "; CurMI.print(dbgs()));
+      return UnableToLegalize;
+    }
+    if (Res == AlreadyLegal)
+      continue;
+    Changed = true;
+
+    // Revisit every generic instruction the step produced, except the
+    // conversions it used to glue things together: those are cleaned up by
+    // the Legalizer pass once all the instructions have been processed.
+    MachineBasicBlock::iterator I = IsFirst ? MBB.begin() : std::next(Prev);
+    for (; I != Next; ++I)
+      if (isPreISelGenericOpcode(I->getOpcode()) &&
+          I->getOpcode() != TargetOpcode::G_ANYEXT &&
+          I->getOpcode() != TargetOpcode::G_TRUNC && !LegalizerInfo.isLegal(*I))
+        WorkList.push_back(&*I);
+  }
+
+  return Changed ? Legalized : AlreadyLegal;
+}
+
+LegalizerHelper::LegalizeResult
+LegalizerHelper::widenScalar(MachineInstr &MI, unsigned WideSize) {
+  MachineFunction &MF = MIRBuilder.getMF();
+  Type *NarrowTy = MI.getType();
+  Type *WideTy = IntegerType::get(MF.getFunction()->getContext(), WideSize);
+  MIRBuilder.setInstr(MI, /*Before=*/true);
+
+  switch (MI.getOpcode()) {
+  default:
+    return UnableToLegalize;
+  case TargetOpcode::G_ADD:
+  case TargetOpcode::G_SUB:
+  case TargetOpcode::G_MUL:
+  case TargetOpcode::G_AND:
+  case TargetOpcode::G_OR:
+  case TargetOpcode::G_XOR: {
+    // Perform operation at larger width (any extension is fine here, high bits
+    // don't affect the result) and then truncate the result back to the
+    // original type.
+    unsigned Src1Ext = MRI.createGenericVirtualRegister(WideSize);
+    unsigned Src2Ext = MRI.createGenericVirtualRegister(WideSize);
+    MIRBuilder.buildInstr(TargetOpcode::G_ANYEXT, WideTy, Src1Ext,
+                          MI.getOperand(1).getReg());
+    MIRBuilder.buildInstr(TargetOpcode::G_ANYEXT, WideTy, Src2Ext,
+                          MI.getOperand(2).getReg());
+
+    unsigned DstExt = MRI.createGenericVirtualRegister(WideSize);
+    MIRBuilder.buildInstr(MI.getOpcode(), WideTy, DstExt, Src1Ext, Src2Ext);
+
+    MIRBuilder.buildInstr(TargetOpcode::G_TRUNC, NarrowTy,
+                          MI.getOperand(0).getReg(), DstExt);
+    MI.eraseFromParent();
+    return Legalized;
+  }
+  case TargetOpcode::G_SHL:
+  case TargetOpcode::G_LSHR:
+  case TargetOpcode::G_ASHR: {
+    // The amount is smaller than the narrow width, so any extension of it
+    // will do. Right shifts move the high bits of the wide value into the
+    // result though, so the value must be zero-extended for G_LSHR and
+    // sign-extended for G_ASHR. There are no generic extensions for those
+    // yet: mask the high bits off, or shift the sign bit up and back down.
+    LLVMContext &Ctx = MF.getFunction()->getContext();
+    unsigned NarrowSize = NarrowTy->getPrimitiveSizeInBits();
+    unsigned SrcExt = MRI.createGenericVirtualRegister(WideSize);
+    unsigned AmtExt = MRI.createGenericVirtualRegister(WideSize);
+    MIRBuilder.buildInstr(TargetOpcode::G_ANYEXT, WideTy, SrcExt,
+                          MI.getOperand(1).getReg());
+    MIRBuilder.buildInstr(TargetOpcode::G_ANYEXT, WideTy, AmtExt,
+                          MI.getOperand(2).getReg());
+
+    if (MI.getOpcode() == TargetOpcode::G_LSHR) {
+      unsigned Mask = MRI.createGenericVirtualRegister(WideSize);
+      MIRBuilder.buildConstant(
+          WideTy, Mask,
+          *ConstantInt::get(Ctx, APInt::getLowBitsSet(WideSize, NarrowSize)));
+      unsigned ZExt = MRI.createGenericVirtualRegister(WideSize);
+      MIRBuilder.buildInstr(TargetOpcode::G_AND, WideTy, ZExt, SrcExt, Mask);
+      SrcExt = ZExt;
+    } else if (MI.getOpcode() == TargetOpcode::G_ASHR) {
+      unsigned SignShift = MRI.createGenericVirtualRegister(WideSize);
+      MIRBuilder.buildConstant(
+          WideTy, SignShift,
+          *ConstantInt::get(Ctx, APInt(WideSize, WideSize - NarrowSize)));
+      unsigned Shl = MRI.createGenericVirtualRegister(WideSize);
+      MIRBuilder.buildInstr(TargetOpcode::G_SHL, WideTy, Shl, SrcExt,
+                            SignShift);
+      unsigned SExt = MRI.createGenericVirtualRegister(WideSize);
+      MIRBuilder.buildInstr(TargetOpcode::G_ASHR, WideTy, SExt, Shl,
+                            SignShift);
+      SrcExt = SExt;
+    }
+
+    unsigned DstExt = MRI.createGenericVirtualRegister(WideSize);
+    MIRBuilder.buildInstr(MI.getOpcode(), WideTy, DstExt, SrcExt, AmtExt);
+
+    MIRBuilder.buildInstr(TargetOpcode::G_TRUNC, NarrowTy,
+                          MI.getOperand(0).getReg(), DstExt);
+    MI.eraseFromParent();
+    return Legalized;
+  }
+  case TargetOpcode::G_CONSTANT: {
+    const ConstantInt *CI = MI.getOperand(1).getCImm();
+    const ConstantInt *WideCI = ConstantInt::get(
+        MF.getFunction()->getContext(), CI->getValue().sext(WideSize));
+
+    unsigned DstExt = MRI.createGenericVirtualRegister(WideSize);
+    MIRBuilder.buildConstant(WideTy, DstExt, *WideCI);
+    MIRBuilder.buildInstr(TargetOpcode::G_TRUNC, NarrowTy,
+                          MI.getOperand(0).getReg(), DstExt);
+    MI.eraseFromParent();
+    return Legalized;
+  }
+  }
+}
@@ -0,0 +1,80 @@
+//===---- lib/CodeGen/GlobalISel/LegalizerInfo.cpp - Legalizer -------==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implement an interface to specify and query how an illegal operation on a
+// given type should be expanded.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Type.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+LegalizerInfo::LegalizerInfo() : TablesInitialized(false) {}
+
+void LegalizerInfo::computeTables() {
+  for (auto &OpcodeActions : Actions)
+    std::stable_sort(OpcodeActions.begin(), OpcodeActions.end(),
+                     [](const std::pair<unsigned, LegalizeAction> &LHS,
+                        const std::pair<unsigned, LegalizeAction> &RHS) {
+                       return LHS.first < RHS.first;
+                     });
+  TablesInitialized = true;
+}
+
+unsigned LegalizerInfo::getSizeInBits(const MachineInstr &MI) {
+  Type *Ty = MI.getType();
+  if (!Ty || !Ty->isIntegerTy())
+    return 0;
+  return cast<IntegerType>(Ty)->getBitWidth();
+}
+
+std::pair<LegalizerInfo::LegalizeAction, unsigned>
+LegalizerInfo::getAction(unsigned Opcode, unsigned SizeInBits) const {
+  assert(TablesInitialized && "backend forgot to call computeTables");
+  assert(isPreISelGenericOpcode(Opcode) && "Not a generic opcode");
+  const auto &OpcodeActions = Actions[Opcode - FirstOp];
+
+  auto Explicit = std::find_if(
+      OpcodeActions.begin(), OpcodeActions.end(),
+      [&](const std::pair<unsigned, LegalizeAction> &Entry) {
+        return Entry.first == SizeInBits;
+      });
+  if (Explicit != OpcodeActions.end() && Explicit->second != WidenScalar)
+    return std::make_pair(Explicit->second, SizeInBits);
+
+  // Either the target asked for this size to be widened or it did not say
+  // anything about it. In both cases, the best we can do is the smallest
+  // wider size that is legal.
+  for (const auto &Entry : OpcodeActions)
+    if (Entry.first > SizeInBits && Entry.second == Legal)
+      return std::make_pair(WidenScalar, Entry.first);
+
+  return std::make_pair(Unsupported, SizeInBits);
+}
+
+std::pair<LegalizerInfo::LegalizeAction, unsigned>
+LegalizerInfo::getAction(const MachineInstr &MI) const {
+  return getAction(MI.getOpcode(), getSizeInBits(MI));
+}
+
+bool LegalizerInfo::isLegal(const MachineInstr &MI) const {
+  return getAction(MI).first == Legal;
+}
+
+bool LegalizerInfo::legalizeCustom(MachineInstr &MI, MachineRegisterInfo &MRI,
+                                   MachineIRBuilder &MIRBuilder) const {
+  return false;
+}
@@ -14,6 +14,7 @@
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/Target/TargetOpcodes.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
@@ -30,6 +31,7 @@ void MachineIRBuilder::setMF(MachineFunction &MF) {
 
 void MachineIRBuilder::setMBB(MachineBasicBlock &MBB, bool Beginning) {
   this->MBB = &MBB;
+  this->MI = nullptr;
   Before = Beginning;
   assert(&getMF() == MBB.getParent() &&
          "Basic block is in a different function");
@@ -85,6 +87,23 @@ MachineInstr *MachineIRBuilder::buildInstr(unsigned Opcode, Type *Ty,
   return NewMI;
 }
 
+MachineInstr *MachineIRBuilder::buildInstr(unsigned Opcode, Type *Ty,
+                                           unsigned Res, unsigned Op0) {
+  MachineInstr *NewMI = buildInstr(Opcode, Ty);
+  MachineInstrBuilder(getMF(), NewMI).addReg(Res, RegState::Define).addReg(Op0);
+  return NewMI;
+}
+
+MachineInstr *MachineIRBuilder::buildConstant(Type *Ty, unsigned Res,
+                                              const ConstantInt &Val) {
+  assert(Val.getType() == Ty && "Constant and instruction types disagree");
+  MachineInstr *NewMI = buildInstr(TargetOpcode::G_CONSTANT, Ty);
+  MachineInstrBuilder(getMF(), NewMI)
+      .addReg(Res, RegState::Define)
+      .addCImm(&Val);
+  return NewMI;
+}
+
 MachineInstr *MachineIRBuilder::buildInstr(unsigned Opcode, unsigned Res,
                                            unsigned Op0) {
   MachineInstr *NewMI = buildInstr(Opcode, nullptr);
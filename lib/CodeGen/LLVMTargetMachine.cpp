@@ -47,6 +47,11 @@ static cl::opt<bool>
     EnableGlobalISel("global-isel", cl::Hidden, cl::init(false),
                      cl::desc("Enable the \"global\" instruction selector"));
 
+static cl::opt<unsigned>
+    CodeGenThreads("codegen-threads", cl::Hidden, cl::init(1),
+                   cl::desc("Number of threads running the machine function "
+                            "passes after instruction selection"));
+
 void LLVMTargetMachine::initAsmInfo() {
   MRI = TheTarget.createMCRegInfo(getTargetTriple().str());
   MII = TheTarget.createMCInstrInfo();
@@ -150,8 +155,22 @@ addPassesToGenerateCode(LLVMTargetMachine *TM, PassManagerBase &PM,
 
   PassConfig->addISelPrepare();
 
+  // The machine passes can only be moved to other threads when the whole
+  // pipeline runs: the start/stop passes, IPRA and MIR input all depend on
+  // one function going through every pass before the next one starts.
+  bool Threaded = CodeGenThreads > 1 && !StartBefore && !StartAfter &&
+                  !StopAfter && !TM->Options.EnableIPRA && !MFInitializer;
+
   MachineModuleInfo &MMI = TM->addMachineModuleInfo(PM);
-  TM->addMachineFunctionAnalysis(PM, MFInitializer);
+  // Instruction selection runs for every function before any is emitted:
+  // number its temporary symbols when each function is emitted instead, as
+  // the serial pipeline does.
+  MMI.setDeferTempSymbolNames(Threaded);
+  if (Threaded)
+    PM.add(new MachineFunctionAnalysis(*TM, MFInitializer,
+                                       /*KeepMachineFunctions=*/true));
+  else
+    TM->addMachineFunctionAnalysis(PM, MFInitializer);
 
   // Enable FastISel with -fast, but allow that to be overridden.
   TM->setO0WantsFastISel(EnableFastISelOption != cl::BOU_FALSE);
@@ -165,6 +184,9 @@ addPassesToGenerateCode(LLVMTargetMachine *TM, PassManagerBase &PM,
     if (PassConfig->addIRTranslator())
       return nullptr;
 
+    if (PassConfig->addLegalizeMachineIR())
+      return nullptr;
+
     // Before running the register bank selector, ask the target if it
     // wants to run some passes.
     PassConfig->addPreRegBankSelect();
@@ -172,10 +194,19 @@ addPassesToGenerateCode(LLVMTargetMachine *TM, PassManagerBase &PM,
     if (PassConfig->addRegBankSelect())
       return nullptr;
 
+    if (PassConfig->addGlobalInstructionSelect())
+      return nullptr;
+
   } else if (PassConfig->addInstSelector())
     return nullptr;
 
-  PassConfig->addMachinePasses();
+  if (Threaded) {
+    // Select every function, run the machine passes on CodeGenThreads
+    // threads, then hand the MachineFunctions to the passes emitting them.
+    PM.add(createParallelMachinePassesPass(TM, CodeGenThreads, DisableVerify));
+    TM->addMachineFunctionAnalysis(PM, nullptr);
+  } else
+    PassConfig->addMachinePasses();
 
   PassConfig->setInitialized();
 
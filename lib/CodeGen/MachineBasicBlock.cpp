@@ -266,6 +266,7 @@ void MachineBasicBlock::print(raw_ostream &OS, ModuleSlotTracker &MST,
   }
   if (isEHPad()) { OS << Comma << "EH LANDING PAD"; Comma = ", "; }
   if (hasAddressTaken()) { OS << Comma << "ADDRESS TAKEN"; Comma = ", "; }
+  if (isColdSection()) { OS << Comma << "COLD SECTION"; Comma = ", "; }
   if (Alignment)
     OS << Comma << "Align " << Alignment << " (" << (1u << Alignment)
        << " bytes)";
@@ -670,7 +671,8 @@ bool MachineBasicBlock::isSuccessor(const MachineBasicBlock *MBB) const {
 
 bool MachineBasicBlock::isLayoutSuccessor(const MachineBasicBlock *MBB) const {
   MachineFunction::const_iterator I(this);
-  return std::next(I) == MachineFunction::const_iterator(MBB);
+  return std::next(I) == MachineFunction::const_iterator(MBB) &&
+         MBB->isColdSection() == isColdSection();
 }
 
 bool MachineBasicBlock::canFallThrough() {
@@ -680,6 +682,10 @@ bool MachineBasicBlock::canFallThrough() {
   if (Fallthrough == getParent()->end())
     return false;
 
+  // Blocks in another section of the function are only reached by branches.
+  if (Fallthrough->isColdSection() != isColdSection())
+    return false;
+
   // If FallthroughBlock isn't a successor, no fallthrough is possible.
   if (!isSuccessor(&*Fallthrough))
     return false;
@@ -43,11 +43,14 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/Target/TargetLowering.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
+#include "llvm/Transforms/Utils/CodeLayout.h"
 #include <algorithm>
+#include <climits>
 using namespace llvm;
 
 #define DEBUG_TYPE "block-placement"
@@ -58,6 +61,10 @@ STATISTIC(CondBranchTakenFreq,
           "Potential frequency of taking conditional branches");
 STATISTIC(UncondBranchTakenFreq,
           "Potential frequency of taking unconditional branches");
+STATISTIC(ExtTspScoreBefore,
+          "Ext-TSP score of the chain-based layout");
+STATISTIC(ExtTspScoreAfter,
+          "Ext-TSP score of the final layout");
 
 static cl::opt<unsigned> AlignAllBlock("align-all-blocks",
                                        cl::desc("Force the alignment of all "
@@ -124,6 +131,12 @@ BranchFoldPlacement("branch-fold-placement",
                        "Reduces code size."),
               cl::init(true), cl::Hidden);
 
+static cl::opt<bool> EnableExtTspBlockPlacement(
+    "enable-ext-tsp-block-placement", cl::Hidden, cl::init(false),
+    cl::desc("Lay out the blocks to maximize the Ext-TSP score, which models "
+             "I-cache utilization, instead of keeping the chain-based "
+             "layout"));
+
 extern cl::opt<unsigned> StaticLikelyProb;
 extern cl::opt<unsigned> ProfileLikelyProb;
 
@@ -332,6 +345,8 @@ class MachineBlockPlacement : public MachineFunctionPass {
                              const BlockFilterSet &LoopBlockSet);
   void collectMustExecuteBBs();
   void buildCFGChains();
+  void spliceFunctionChain(BlockChain &FunctionChain);
+  void applyExtTsp();
   void optimizeBranches();
   void alignBlocks();
 
@@ -1499,6 +1514,17 @@ void MachineBlockPlacement::buildCFGChains() {
     assert(!BadFunc && "Detected problems with the block placement.");
   });
 
+  spliceFunctionChain(FunctionChain);
+
+  BlockWorkList.clear();
+  EHPadWorkList.clear();
+}
+
+/// Move the blocks of the function into the order of \p FunctionChain and
+/// update their terminators.
+void MachineBlockPlacement::spliceFunctionChain(BlockChain &FunctionChain) {
+  SmallVector<MachineOperand, 4> Cond; // For AnalyzeBranch.
+
   // Splice the blocks into place.
   MachineFunction::iterator InsertPos = F->begin();
   DEBUG(dbgs() << "[MBP] Function: "<< F->getName() << "\n");
@@ -1552,9 +1578,99 @@ void MachineBlockPlacement::buildCFGChains() {
   MachineBasicBlock *TBB = nullptr, *FBB = nullptr; // For AnalyzeBranch.
   if (!TII->analyzeBranch(F->back(), TBB, FBB, Cond))
     F->back().updateTerminator();
+}
 
-  BlockWorkList.clear();
-  EHPadWorkList.clear();
+/// Convert an Ext-TSP score to a statistic increment. Scores of hot
+/// functions can exceed what a statistic holds, so saturate them.
+static unsigned scoreToStatistic(double Score) {
+  return Score < double(UINT_MAX) ? static_cast<unsigned>(Score) : UINT_MAX;
+}
+
+void MachineBlockPlacement::applyExtTsp() {
+  // Blocks falling through to their layout successor without an analyzable
+  // branch cannot be separated: lay out such runs of blocks as one node.
+  SmallVector<SmallVector<MachineBasicBlock *, 4>, 16> Nodes;
+  DenseMap<const MachineBasicBlock *, uint64_t> BlockToNode;
+  SmallVector<MachineOperand, 4> Cond; // For AnalyzeBranch.
+  bool FallsThrough = false;
+  for (MachineBasicBlock &MBB : *F) {
+    if (!FallsThrough)
+      Nodes.emplace_back();
+    Nodes.back().push_back(&MBB);
+    BlockToNode[&MBB] = Nodes.size() - 1;
+
+    Cond.clear();
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr; // For AnalyzeBranch.
+    FallsThrough = MBB.canFallThrough() &&
+                   TII->analyzeBranch(MBB, TBB, FBB, Cond);
+  }
+  if (Nodes.size() < 3)
+    return;
+
+  // Estimate the size of a node from its instruction count, and weigh the
+  // jumps with the frequency of the edges.
+  std::vector<uint64_t> NodeSizes(Nodes.size());
+  std::vector<uint64_t> NodeCounts(Nodes.size());
+  std::vector<EdgeCountT> EdgeCounts;
+  DenseMap<EdgeT, size_t> EdgeIndex;
+  for (uint64_t Node = 0, E = Nodes.size(); Node != E; ++Node) {
+    NodeCounts[Node] = MBFI->getBlockFreq(Nodes[Node].front()).getFrequency();
+    for (MachineBasicBlock *MBB : Nodes[Node]) {
+      for (const MachineInstr &MI : *MBB)
+        if (!MI.isDebugValue() && !MI.isPosition() && !MI.isImplicitDef() &&
+            !MI.isKill())
+          NodeSizes[Node] += 4;
+
+      BlockFrequency Freq = MBFI->getBlockFreq(MBB);
+      for (MachineBasicBlock *Succ : MBB->successors()) {
+        uint64_t SuccNode = BlockToNode[Succ];
+        if (SuccNode == Node)
+          continue;
+        uint64_t Count =
+            (Freq * MBPI->getEdgeProbability(MBB, Succ)).getFrequency();
+        auto Inserted =
+            EdgeIndex.insert(std::make_pair(EdgeT(Node, SuccNode),
+                                            EdgeCounts.size()));
+        if (Inserted.second)
+          EdgeCounts.push_back(EdgeCountT(EdgeT(Node, SuccNode), Count));
+        else
+          EdgeCounts[Inserted.first->second].second += Count;
+      }
+    }
+  }
+
+  double ScoreBefore = calcExtTspScore(NodeSizes, NodeCounts, EdgeCounts);
+  std::vector<uint64_t> NewOrder =
+      applyExtTspLayout(NodeSizes, NodeCounts, EdgeCounts);
+  double ScoreAfter =
+      calcExtTspScore(NewOrder, NodeSizes, NodeCounts, EdgeCounts);
+  DEBUG(dbgs() << "[MBP] Ext-TSP score of " << F->getName() << ": "
+               << format("%.1f", ScoreBefore) << " -> "
+               << format("%.1f", ScoreAfter) << "\n");
+
+  // The algorithm is a heuristic: keep the chain-based layout unless the new
+  // one scores better.
+  ExtTspScoreBefore += scoreToStatistic(ScoreBefore);
+  if (ScoreAfter <= ScoreBefore) {
+    ExtTspScoreAfter += scoreToStatistic(ScoreBefore);
+    return;
+  }
+  ExtTspScoreAfter += scoreToStatistic(ScoreAfter);
+
+  // Rebuild the function chain in the new order, which the branch and
+  // alignment updates walk.
+  BlockToChain.clear();
+  ChainAllocator.DestroyAll();
+  BlockChain *FunctionChain = nullptr;
+  for (uint64_t Node : NewOrder)
+    for (MachineBasicBlock *MBB : Nodes[Node]) {
+      if (!FunctionChain)
+        FunctionChain =
+            new (ChainAllocator.Allocate()) BlockChain(BlockToChain, MBB);
+      else
+        FunctionChain->merge(MBB, nullptr);
+    }
+  spliceFunctionChain(*FunctionChain);
 }
 
 void MachineBlockPlacement::optimizeBranches() {
@@ -1701,6 +1817,9 @@ bool MachineBlockPlacement::runOnMachineFunction(MachineFunction &MF) {
     }
   }
 
+  if (EnableExtTspBlockPlacement)
+    applyExtTsp();
+
   optimizeBranches();
   alignBlocks();
 
@@ -21,8 +21,11 @@ using namespace llvm;
 char MachineFunctionAnalysis::ID = 0;
 
 MachineFunctionAnalysis::MachineFunctionAnalysis(
-    const TargetMachine &tm, MachineFunctionInitializer *MFInitializer)
-    : FunctionPass(ID), TM(tm), MF(nullptr), MFInitializer(MFInitializer) {
+    const TargetMachine &tm, MachineFunctionInitializer *MFInitializer,
+    bool KeepMachineFunctions)
+    : FunctionPass(ID), TM(tm), MF(nullptr), MMI(nullptr),
+      MFInitializer(MFInitializer),
+      KeepMachineFunctions(KeepMachineFunctions) {
   initializeMachineModuleInfoPass(*PassRegistry::getPassRegistry());
 }
 
@@ -37,24 +40,24 @@ void MachineFunctionAnalysis::getAnalysisUsage(AnalysisUsage &AU) const {
 }
 
 bool MachineFunctionAnalysis::doInitialization(Module &M) {
-  MachineModuleInfo *MMI = getAnalysisIfAvailable<MachineModuleInfo>();
+  MMI = getAnalysisIfAvailable<MachineModuleInfo>();
   assert(MMI && "MMI not around yet??");
   MMI->setModule(&M);
-  NextFnNum = 0;
   return false;
 }
 
 
 bool MachineFunctionAnalysis::runOnFunction(Function &F) {
   assert(!MF && "MachineFunctionAnalysis already initialized!");
-  MF = new MachineFunction(&F, TM, NextFnNum++,
-                           getAnalysis<MachineModuleInfo>());
-  if (MFInitializer)
-    MFInitializer->initializeMachineFunction(*MF);
+  // A function whose MachineFunction was kept by an earlier instance of this
+  // analysis picks it up again.
+  MF = &MMI->getOrCreateMachineFunction(F, TM, MFInitializer);
+  MMI->setCurrentFunction(*MF);
   return false;
 }
 
 void MachineFunctionAnalysis::releaseMemory() {
-  delete MF;
+  if (MF && !KeepMachineFunctions)
+    MMI->deleteMachineFunctionFor(*MF->getFunction());
   MF = nullptr;
 }
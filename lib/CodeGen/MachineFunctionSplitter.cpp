@@ -0,0 +1,216 @@
+//===-- MachineFunctionSplitter.cpp - Split cold blocks off functions -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a pass that uses the profile to move the blocks of a
+// function that (almost) never run to a separate cold section, .text.unlikely
+// or .text.split.<name>, so that the hot code of the program is packed more
+// densely. Block placement only moves cold blocks to the end of the function,
+// where they still share cache lines and pages with hot code.
+//
+// The cold blocks are marked and moved after all the other blocks of the
+// function. A block is never the layout successor of a block of the other
+// section, so every edge between the two sections becomes an explicit branch.
+// The AsmPrinter emits the cold part under a local <name>.cold symbol with a
+// frame description entry of its own. Targets whose conditional branches cannot
+// reach another section expand them before emission, as their branch
+// relaxation does for out of range branches.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
+#include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/IR/Module.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+using namespace llvm;
+
+#define DEBUG_TYPE "machine-function-splitter"
+
+STATISTIC(NumSplitFunctions, "Number of functions split");
+STATISTIC(NumColdBlocks, "Number of blocks moved to the cold section");
+
+static cl::opt<unsigned> ColdCountThreshold(
+    "mfs-count-threshold", cl::Hidden, cl::init(1),
+    cl::desc("Also move the blocks executed fewer times than this to the "
+             "cold section, whatever the profile summary says"));
+
+namespace {
+class MachineFunctionSplitter : public MachineFunctionPass {
+  const TargetInstrInfo *TII;
+  const MachineBlockFrequencyInfo *MBFI;
+  ProfileSummaryInfo *PSI;
+
+  bool isColdBlock(const MachineBasicBlock &MBB) const;
+  bool
+  canMoveBlock(MachineBasicBlock &MBB,
+               const SmallPtrSetImpl<const MachineBasicBlock *> &JTTargets);
+  bool isAnalyzable(MachineBasicBlock &MBB) const;
+  bool canSplitFunction(const MachineFunction &MF) const;
+
+public:
+  static char ID; // Pass identification, replacement for typeid
+  MachineFunctionSplitter() : MachineFunctionPass(ID) {
+    initializeMachineFunctionSplitterPass(*PassRegistry::getPassRegistry());
+  }
+
+  const char *getPassName() const override {
+    return "Machine Function Splitter";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    AU.addRequired<ProfileSummaryInfoWrapperPass>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+};
+} // end anonymous namespace
+
+char MachineFunctionSplitter::ID = 0;
+char &llvm::MachineFunctionSplitterID = MachineFunctionSplitter::ID;
+INITIALIZE_PASS_BEGIN(MachineFunctionSplitter, "machine-function-splitter",
+                      "Split machine functions using profile information",
+                      false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_DEPENDENCY(ProfileSummaryInfoWrapperPass)
+INITIALIZE_PASS_END(MachineFunctionSplitter, "machine-function-splitter",
+                    "Split machine functions using profile information",
+                    false, false)
+
+bool MachineFunctionSplitter::isColdBlock(const MachineBasicBlock &MBB) const {
+  Optional<uint64_t> Count = MBFI->getBlockProfileCount(&MBB);
+  if (!Count)
+    return false;
+  return *Count < ColdCountThreshold || PSI->isColdCount(*Count);
+}
+
+/// Return true if the terminators of \p MBB can be rewritten once the block
+/// or its successors moved.
+bool MachineFunctionSplitter::isAnalyzable(MachineBasicBlock &MBB) const {
+  if (MBB.succ_empty())
+    return true;
+  MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+  SmallVector<MachineOperand, 4> Cond;
+  return !TII->analyzeBranch(MBB, TBB, FBB, Cond);
+}
+
+bool MachineFunctionSplitter::canMoveBlock(
+    MachineBasicBlock &MBB,
+    const SmallPtrSetImpl<const MachineBasicBlock *> &JTTargets) {
+  // Jump tables, indirect branches and landing pads may refer to the blocks
+  // of a function relative to its start.
+  if (&MBB == &MBB.getParent()->front() || MBB.isEHPad() ||
+      MBB.hasAddressTaken() || JTTargets.count(&MBB))
+    return false;
+
+  // The branches into and out of the block must be rewritten.
+  if (!isAnalyzable(MBB))
+    return false;
+  for (MachineBasicBlock *Pred : MBB.predecessors())
+    if (!isAnalyzable(*Pred))
+      return false;
+  return true;
+}
+
+bool MachineFunctionSplitter::canSplitFunction(
+    const MachineFunction &MF) const {
+  const Function &F = *MF.getFunction();
+  const TargetMachine &TM = MF.getTarget();
+  // The cold part needs a section of its own and a frame description entry.
+  if (!TM.getTargetTriple().isOSBinFormatELF())
+    return false;
+  ExceptionHandling EHType = TM.getMCAsmInfo()->getExceptionHandlingType();
+  if (EHType != ExceptionHandling::None &&
+      EHType != ExceptionHandling::DwarfCFI)
+    return false;
+
+  // The exception table describes the call sites of the function relative to
+  // its start, and an explicit section must hold all of the function.
+  if (F.hasSection() || F.hasPersonalityFn() ||
+      !MF.getMMI().getLandingPads().empty())
+    return false;
+
+  // Without a profile nothing is known to be cold, and a function that is
+  // cold as a whole does not gain anything from leaving its entry behind.
+  if (!F.getEntryCount() || PSI->isColdFunction(&F))
+    return false;
+
+  // The AsmPrinter describes the frame of the cold part with the frame moves
+  // of the entry block, the prologue.
+  for (const MachineBasicBlock &MBB : MF) {
+    if (&MBB == &MF.front())
+      continue;
+    for (const MachineInstr &MI : MBB)
+      if (MI.isCFIInstruction())
+        return false;
+  }
+  return true;
+}
+
+bool MachineFunctionSplitter::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(*MF.getFunction()) || MF.size() < 2)
+    return false;
+
+  TII = MF.getSubtarget().getInstrInfo();
+  MBFI = &getAnalysis<MachineBlockFrequencyInfo>();
+  PSI = getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI(
+      *const_cast<Module *>(MF.getFunction()->getParent()));
+  if (!canSplitFunction(MF))
+    return false;
+
+  SmallPtrSet<const MachineBasicBlock *, 8> JTTargets;
+  if (const MachineJumpTableInfo *MJTI = MF.getJumpTableInfo())
+    for (const MachineJumpTableEntry &JTE : MJTI->getJumpTables())
+      JTTargets.insert(JTE.MBBs.begin(), JTE.MBBs.end());
+
+  SmallVector<MachineBasicBlock *, 8> ColdBlocks;
+  for (MachineBasicBlock &MBB : MF)
+    if (isColdBlock(MBB) && canMoveBlock(MBB, JTTargets))
+      ColdBlocks.push_back(&MBB);
+  if (ColdBlocks.empty())
+    return false;
+
+  DEBUG(dbgs() << "Moving " << ColdBlocks.size() << " blocks of "
+               << MF.getName() << " to the cold section\n");
+
+  // Keep the order block placement chose within each section.
+  for (MachineBasicBlock *MBB : ColdBlocks) {
+    MBB->setIsColdSection();
+    if (MBB != &MF.back())
+      MBB->moveAfter(&MF.back());
+  }
+
+  // Fix up the branches for the new layout. The blocks of the other section
+  // are no layout successors, so the edges crossing the sections get explicit
+  // branches.
+  SmallVector<MachineOperand, 4> Cond;
+  for (MachineBasicBlock &MBB : MF) {
+    Cond.clear();
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr; // For AnalyzeBranch.
+    if (!TII->analyzeBranch(MBB, TBB, FBB, Cond))
+      MBB.updateTerminator();
+  }
+
+  ++NumSplitFunctions;
+  NumColdBlocks += ColdBlocks.size();
+  return true;
+}
@@ -13,6 +13,7 @@
 #include "llvm/Analysis/EHPersonalities.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionInitializer.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/IR/Constants.h"
@@ -206,20 +207,20 @@ MachineModuleInfo::~MachineModuleInfo() {
 bool MachineModuleInfo::doInitialization(Module &M) {
 
   ObjFileMMI = nullptr;
-  CurCallSite = 0;
-  CallsEHReturn = false;
-  CallsUnwindInit = false;
-  HasEHFunclets = false;
   DbgInfoAvailable = UsesVAFloatArgument = UsesMorestackAddr = false;
-  PersonalityTypeCache = EHPersonality::Unknown;
   AddrLabelSymbols = nullptr;
   TheModule = nullptr;
+  NextFnNum = 0;
 
   return false;
 }
 
 bool MachineModuleInfo::doFinalization(Module &M) {
 
+  Functions.clear();
+  CurrentFunction = nullptr;
+  MCContext::deferTempSymbolNames(nullptr);
+
   Personalities.clear();
 
   delete AddrLabelSymbols;
@@ -236,20 +237,84 @@ bool MachineModuleInfo::doFinalization(Module &M) {
 /// EndFunction - Discard function meta information.
 ///
 void MachineModuleInfo::EndFunction() {
+  FunctionInfo &FI = getCurrentFunction();
+
   // Clean up frame info.
-  FrameInstructions.clear();
+  FI.FrameInstructions.clear();
 
   // Clean up exception info.
-  LandingPads.clear();
-  PersonalityTypeCache = EHPersonality::Unknown;
-  CallSiteMap.clear();
-  TypeInfos.clear();
-  FilterIds.clear();
-  FilterEnds.clear();
-  CallsEHReturn = false;
-  CallsUnwindInit = false;
-  HasEHFunclets = false;
-  VariableDbgInfos.clear();
+  FI.LandingPads.clear();
+  FI.PersonalityTypeCache = EHPersonality::Unknown;
+  FI.CallSiteMap.clear();
+  FI.TypeInfos.clear();
+  FI.FilterIds.clear();
+  FI.FilterEnds.clear();
+  FI.CallsEHReturn = false;
+  FI.CallsUnwindInit = false;
+  FI.HasEHFunclets = false;
+  FI.VariableDbgInfos.clear();
+}
+
+//===- Machine Functions --------------------------------------------------===//
+
+LLVM_THREAD_LOCAL MachineModuleInfo::FunctionInfo *
+    MachineModuleInfo::CurrentFunction = nullptr;
+
+MachineModuleInfo::FunctionInfo &
+MachineModuleInfo::getCurrentFunction() const {
+  assert(CurrentFunction && "No current MachineFunction on this thread!");
+  return *CurrentFunction;
+}
+
+MachineFunction &MachineModuleInfo::getOrCreateMachineFunction(
+    const Function &F, const TargetMachine &TM,
+    MachineFunctionInitializer *MFInitializer) {
+  std::unique_ptr<FunctionInfo> &FI = Functions[&F];
+  if (FI)
+    return *FI->MF;
+
+  FI = make_unique<FunctionInfo>();
+  FI->MF = make_unique<MachineFunction>(&F, TM, NextFnNum++, *this);
+  FI->DeferTempSymbolNames = DeferTempSymbolNames;
+  CurrentFunction = FI.get();
+  MCContext::deferTempSymbolNames(
+      FI->DeferTempSymbolNames ? &FI->TempSymbols : nullptr);
+  if (MFInitializer)
+    MFInitializer->initializeMachineFunction(*FI->MF);
+  return *FI->MF;
+}
+
+MachineFunction *
+MachineModuleInfo::getMachineFunction(const Function &F) const {
+  auto I = Functions.find(&F);
+  return I == Functions.end() ? nullptr : I->second->MF.get();
+}
+
+void MachineModuleInfo::deleteMachineFunctionFor(const Function &F) {
+  auto I = Functions.find(&F);
+  assert(I != Functions.end() && "Function has no MachineFunction!");
+  if (CurrentFunction == I->second.get()) {
+    CurrentFunction = nullptr;
+    MCContext::deferTempSymbolNames(nullptr);
+  }
+  Functions.erase(I);
+}
+
+void MachineModuleInfo::setCurrentFunction(const MachineFunction &MF) {
+  auto I = Functions.find(MF.getFunction());
+  assert(I != Functions.end() && I->second->MF.get() == &MF &&
+         "MachineFunction is not owned by this MachineModuleInfo!");
+  CurrentFunction = I->second.get();
+  MCContext::deferTempSymbolNames(CurrentFunction->DeferTempSymbolNames
+                                      ? &CurrentFunction->TempSymbols
+                                      : nullptr);
+}
+
+void MachineModuleInfo::nameTempSymbols() {
+  FunctionInfo &FI = getCurrentFunction();
+  FI.DeferTempSymbolNames = false;
+  MCContext::deferTempSymbolNames(nullptr);
+  Context.nameDeferredTempSymbols(FI.TempSymbols);
 }
 
 //===- Address of Block Management ----------------------------------------===//
@@ -285,6 +350,7 @@ takeDeletedSymbolsForFunction(const Function *F,
 /// specified MachineBasicBlock.
 LandingPadInfo &MachineModuleInfo::getOrCreateLandingPadInfo
     (MachineBasicBlock *LandingPad) {
+  std::vector<LandingPadInfo> &LandingPads = getCurrentFunction().LandingPads;
   unsigned N = LandingPads.size();
   for (unsigned i = 0; i < N; ++i) {
     LandingPadInfo &LP = LandingPads[i];
@@ -372,6 +438,7 @@ void MachineModuleInfo::addSEHCleanupHandler(MachineBasicBlock *LandingPad,
 /// TidyLandingPads - Remap landing pad labels and remove any deleted landing
 /// pads.
 void MachineModuleInfo::TidyLandingPads(DenseMap<MCSymbol*, uintptr_t> *LPMap) {
+  std::vector<LandingPadInfo> &LandingPads = getCurrentFunction().LandingPads;
   for (unsigned i = 0; i != LandingPads.size(); ) {
     LandingPadInfo &LandingPad = LandingPads[i];
     if (LandingPad.LandingPadLabel &&
@@ -419,12 +486,14 @@ void MachineModuleInfo::TidyLandingPads(DenseMap<MCSymbol*, uintptr_t> *LPMap) {
 /// indexes.
 void MachineModuleInfo::setCallSiteLandingPad(MCSymbol *Sym,
                                               ArrayRef<unsigned> Sites) {
-  LPadToCallSiteMap[Sym].append(Sites.begin(), Sites.end());
+  getCurrentFunction().LPadToCallSiteMap[Sym].append(Sites.begin(),
+                                                    Sites.end());
 }
 
 /// getTypeIDFor - Return the type id for the specified typeinfo.  This is
 /// function wide.
 unsigned MachineModuleInfo::getTypeIDFor(const GlobalValue *TI) {
+  std::vector<const GlobalValue *> &TypeInfos = getCurrentFunction().TypeInfos;
   for (unsigned i = 0, N = TypeInfos.size(); i != N; ++i)
     if (TypeInfos[i] == TI) return i + 1;
 
@@ -435,6 +504,8 @@ unsigned MachineModuleInfo::getTypeIDFor(const GlobalValue *TI) {
 /// getFilterIDFor - Return the filter id for the specified typeinfos.  This is
 /// function wide.
 int MachineModuleInfo::getFilterIDFor(std::vector<unsigned> &TyIds) {
+  std::vector<unsigned> &FilterIds = getCurrentFunction().FilterIds;
+  std::vector<unsigned> &FilterEnds = getCurrentFunction().FilterEnds;
   // If the new filter coincides with the tail of an existing filter, then
   // re-use the existing filter.  Folding filters more than this requires
   // re-ordering filters and/or their elements - probably not worth it.
@@ -133,6 +133,23 @@ MachineRegisterInfo::createGenericVirtualRegister(unsigned Size) {
   return Reg;
 }
 
+void MachineRegisterInfo::clearVirtRegSizes() {
+#ifndef NDEBUG
+  // Verify that the size of the now-constrained vreg is unchanged.
+  for (auto &VRegToSize : getVRegToSize()) {
+    if (reg_nodbg_empty(VRegToSize.first))
+      continue;
+    const TargetRegisterClass *RC = getRegClassOrNull(VRegToSize.first);
+    assert(RC && "Generic virtual register left after selection");
+    if (VRegToSize.second != (RC->getSize() * 8))
+      llvm_unreachable(
+          "Virtual register has explicit size different from its class size");
+  }
+#endif
+
+  getVRegToSize().clear();
+}
+
 /// clearVirtRegs - Remove all virtual registers (after physreg assignment).
 void MachineRegisterInfo::clearVirtRegs() {
 #ifndef NDEBUG
@@ -0,0 +1,178 @@
+//===-- ParallelMachinePasses.cpp - Run machine passes on threads ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a module pass that runs the machine function passes of
+// the code generator on several threads, each thread compiling a different
+// function of the module. Instruction selection, which still creates LLVM IR
+// constants, runs before it on the calling thread for every function, and the
+// AsmPrinter runs after it, in module order, so that the output does not
+// depend on the number of threads.
+//
+// Every thread gets its own pass manager running a copy of the machine pass
+// pipeline. The immutable passes holding module-wide state, like
+// MachineModuleInfo, are not recreated for each thread but shared with the
+// pass manager of the caller.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/ScopedNoAliasAA.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/TypeBasedAliasAnalysis.h"
+#include "llvm/CodeGen/GCMetadata.h"
+#include "llvm/CodeGen/MachineFunctionAnalysis.h"
+#include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/CodeGen/TargetPassConfig.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Target/TargetMachine.h"
+#include <algorithm>
+#include <atomic>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "parallel-machine-passes"
+
+namespace {
+/// Makes an immutable pass of the pass manager of the caller available to the
+/// pass manager of a thread. Queries for the ID of the pass are answered by the
+/// original pass, which stays owned by the pass manager of the caller.
+class ImmutablePassProxy : public ImmutablePass {
+  ImmutablePass &Impl;
+
+public:
+  explicit ImmutablePassProxy(ImmutablePass &Impl)
+      : ImmutablePass(
+            *const_cast<char *>(static_cast<const char *>(Impl.getPassID()))),
+        Impl(Impl) {}
+
+  const char *getPassName() const override { return Impl.getPassName(); }
+
+  void *getAdjustedAnalysisPointer(AnalysisID ID) override {
+    return Impl.getAdjustedAnalysisPointer(ID);
+  }
+};
+
+class ParallelMachinePasses : public ModulePass {
+  LLVMTargetMachine *TM;
+  unsigned NumThreads;
+  bool DisableVerify;
+
+  /// Create the pass manager used by one thread.
+  std::unique_ptr<legacy::FunctionPassManager> createThreadPipeline(Module &M);
+
+public:
+  static char ID;
+  ParallelMachinePasses(LLVMTargetMachine *TM, unsigned NumThreads,
+                        bool DisableVerify)
+      : ModulePass(ID), TM(TM), NumThreads(NumThreads),
+        DisableVerify(DisableVerify) {}
+
+  const char *getPassName() const override {
+    return "Run machine function passes in parallel";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesAll();
+    AU.addRequired<MachineModuleInfo>();
+    AU.addRequired<AssumptionCacheTracker>();
+    AU.addRequired<TargetLibraryInfoWrapperPass>();
+    AU.addRequired<GCModuleInfo>();
+  }
+
+  bool runOnModule(Module &M) override;
+};
+} // end anonymous namespace
+
+char ParallelMachinePasses::ID = 0;
+
+std::unique_ptr<legacy::FunctionPassManager>
+ParallelMachinePasses::createThreadPipeline(Module &M) {
+  auto FPM = llvm::make_unique<legacy::FunctionPassManager>(&M);
+  FPM->add(new ImmutablePassProxy(getAnalysis<MachineModuleInfo>()));
+  FPM->add(new ImmutablePassProxy(getAnalysis<AssumptionCacheTracker>()));
+  FPM->add(new ImmutablePassProxy(getAnalysis<TargetLibraryInfoWrapperPass>()));
+  FPM->add(new ImmutablePassProxy(getAnalysis<GCModuleInfo>()));
+  // Use the same alias analyses as the rest of the code generator.
+  if (auto *TBAA = getAnalysisIfAvailable<TypeBasedAAWrapperPass>())
+    FPM->add(new ImmutablePassProxy(*TBAA));
+  if (auto *ScopedAA = getAnalysisIfAvailable<ScopedNoAliasAAWrapperPass>())
+    FPM->add(new ImmutablePassProxy(*ScopedAA));
+
+  TargetPassConfig *PassConfig = TM->createPassConfig(*FPM);
+  PassConfig->setDisableVerify(DisableVerify);
+  FPM->add(PassConfig);
+  // The stack protector was inserted before instruction selection; only
+  // compute the layout the frame passes ask for.
+  FPM->add(createStackProtectorPass(TM, /*LayoutOnly=*/true));
+  FPM->add(new MachineFunctionAnalysis(*TM, nullptr,
+                                       /*KeepMachineFunctions=*/true));
+  PassConfig->addMachinePasses();
+  PassConfig->setInitialized();
+
+  FPM->doInitialization();
+  return FPM;
+}
+
+bool ParallelMachinePasses::runOnModule(Module &M) {
+  MachineModuleInfo &MMI = getAnalysis<MachineModuleInfo>();
+  AssumptionCacheTracker &ACT = getAnalysis<AssumptionCacheTracker>();
+  GCModuleInfo &GCMI = getAnalysis<GCModuleInfo>();
+
+  // Collect the functions instruction selection produced a MachineFunction
+  // for. The analyses shared between threads compute their per-function
+  // information lazily: do it here, so that the threads only read it.
+  std::vector<Function *> Functions;
+  for (Function &F : M) {
+    if (!MMI.getMachineFunction(F))
+      continue;
+    Functions.push_back(&F);
+    ACT.getAssumptionCache(F).assumptions();
+    if (F.hasGC())
+      GCMI.getFunctionInfo(F);
+  }
+  if (Functions.empty())
+    return false;
+
+  // The pipelines are created on this thread: creating passes goes through
+  // the pass registry and the target machine.
+  unsigned NumPipelines = std::min<size_t>(NumThreads, Functions.size());
+  std::vector<std::unique_ptr<legacy::FunctionPassManager>> Pipelines;
+  for (unsigned I = 0; I != NumPipelines; ++I)
+    Pipelines.push_back(createThreadPipeline(M));
+
+  // Hand the functions out in module order to whichever thread is free.
+  std::atomic<unsigned> NextFunction(0);
+  {
+    ThreadPool Pool(NumPipelines);
+    for (auto &FPM : Pipelines) {
+      legacy::FunctionPassManager *Pipeline = FPM.get();
+      Pool.async([&M, &Functions, &NextFunction, Pipeline]() {
+        StatisticModuleScope StatsScope(M.getModuleIdentifier());
+        for (unsigned I = NextFunction++; I < Functions.size();
+             I = NextFunction++)
+          Pipeline->run(*Functions[I]);
+      });
+    }
+    Pool.wait();
+  }
+
+  for (auto &FPM : Pipelines)
+    FPM->doFinalization();
+  return false;
+}
+
+ModulePass *llvm::createParallelMachinePassesPass(LLVMTargetMachine *TM,
+                                                  unsigned NumThreads,
+                                                  bool DisableVerify) {
+  return new ParallelMachinePasses(TM, NumThreads, DisableVerify);
+}
@@ -53,8 +53,9 @@ char StackProtector::ID = 0;
 INITIALIZE_PASS(StackProtector, "stack-protector", "Insert stack protectors",
                 false, true)
 
-FunctionPass *llvm::createStackProtectorPass(const TargetMachine *TM) {
-  return new StackProtector(TM);
+FunctionPass *llvm::createStackProtectorPass(const TargetMachine *TM,
+                                             bool LayoutOnly) {
+  return new StackProtector(TM, LayoutOnly);
 }
 
 StackProtector::SSPLayoutKind
@@ -92,6 +93,7 @@ bool StackProtector::runOnFunction(Function &Fn) {
   TLI = TM->getSubtargetImpl(Fn)->getTargetLowering();
   HasPrologue = false;
   HasIRCheck = false;
+  Layout.clear();
 
   Attribute Attr = Fn.getFnAttribute("stack-protector-buffer-size");
   if (Attr.isStringAttribute() &&
@@ -109,6 +111,9 @@ bool StackProtector::runOnFunction(Function &Fn) {
       return false;
   }
 
+  if (LayoutOnly)
+    return false;
+
   ++NumFunProtected;
   return InsertStackProtectors();
 }
@@ -211,13 +216,16 @@ bool StackProtector::HasAddressTaken(const Instruction *AI) {
 bool StackProtector::RequiresStackProtector() {
   bool Strong = false;
   bool NeedsProtector = false;
+  // The slot the prologue stores the guard to, which is not laid out like the
+  // other allocas.
+  const Value *GuardSlot = nullptr;
   for (const BasicBlock &BB : *F)
     for (const Instruction &I : BB)
-      if (const CallInst *CI = dyn_cast<CallInst>(&I))
-        if (CI->getCalledFunction() ==
-            Intrinsic::getDeclaration(F->getParent(),
-                                      Intrinsic::stackprotector))
+      if (const auto *II = dyn_cast<IntrinsicInst>(&I))
+        if (II->getIntrinsicID() == Intrinsic::stackprotector) {
           HasPrologue = true;
+          GuardSlot = II->getArgOperand(1);
+        }
 
   if (F->hasFnAttribute(Attribute::SafeStack))
     return false;
@@ -235,6 +243,9 @@ bool StackProtector::RequiresStackProtector() {
   for (const BasicBlock &BB : *F) {
     for (const Instruction &I : BB) {
       if (const AllocaInst *AI = dyn_cast<AllocaInst>(&I)) {
+        if (LayoutOnly && AI == GuardSlot)
+          continue;
+
         if (AI->isArrayAllocation()) {
           // SSP-Strong: Enable protectors for any call to alloca, regardless
           // of size.
@@ -350,6 +350,33 @@ bool TargetLoweringObjectFileELF::shouldPutJumpTableInFunctionSection(
   return false;
 }
 
+MCSection *TargetLoweringObjectFileELF::getSectionForColdCode(
+    const Function &F, Mangler &Mang, const TargetMachine &TM) const {
+  unsigned Flags = ELF::SHF_ALLOC | ELF::SHF_EXECINSTR;
+  StringRef Group = "";
+  if (const Comdat *C = getELFComdat(&F)) {
+    Flags |= ELF::SHF_GROUP;
+    Group = C->getName();
+  }
+
+  // Cold code normally goes to .text.unlikely. If the function has a section
+  // of its own, give its cold part one as well, so that the linker can remove
+  // both together.
+  if (!TM.getFunctionSections() && !F.hasComdat())
+    return getContext().getELFSection(".text.unlikely", ELF::SHT_PROGBITS,
+                                      Flags);
+
+  SmallString<128> Name(".text.split");
+  unsigned UniqueID = MCContext::GenericSectionID;
+  if (TM.getUniqueSectionNames()) {
+    Name.push_back('.');
+    TM.getNameWithPrefix(Name, &F, Mang, true);
+  } else
+    UniqueID = NextUniqueID++;
+  return getContext().getELFSection(Name, ELF::SHT_PROGBITS, Flags, 0, Group,
+                                    UniqueID);
+}
+
 /// Given a mergeable constant with the specified size and relocation
 /// information, return a section that it should be placed in.
 MCSection *TargetLoweringObjectFileELF::getSectionForConstant(
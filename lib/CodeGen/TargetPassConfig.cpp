@@ -82,6 +82,10 @@ static cl::opt<bool> EnableImplicitNullChecks(
     "enable-implicit-null-checks",
     cl::desc("Fold null checks into faulting memory operations"),
     cl::init(false));
+static cl::opt<bool> EnableMachineFunctionSplitter(
+    "split-machine-functions", cl::Hidden, cl::init(false),
+    cl::desc("Move the blocks the profile says are cold out of their "
+             "function into a separate section"));
 static cl::opt<bool> PrintLSR("print-lsr-output", cl::Hidden,
     cl::desc("Print LLVM IR produced by the loop-reduce pass"));
 static cl::opt<bool> PrintISelInput("print-isel-input", cl::Hidden,
@@ -643,6 +647,9 @@ void TargetPassConfig::addMachinePasses() {
   if (getOptLevel() != CodeGenOpt::None)
     addBlockPlacement();
 
+  if (getOptLevel() != CodeGenOpt::None && EnableMachineFunctionSplitter)
+    addPass(&MachineFunctionSplitterID);
+
   addPreEmitPass();
 
   if (TM->Options.EnableIPRA)
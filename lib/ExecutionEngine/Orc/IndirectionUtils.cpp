@@ -28,6 +28,11 @@ createLocalCompileCallbackManager(const Triple &T,
   switch (T.getArch()) {
     default: return nullptr;
 
+    case Triple::riscv64: {
+      typedef orc::LocalJITCompileCallbackManager<orc::OrcRISCV64> CCMgrT;
+      return llvm::make_unique<CCMgrT>(ErrorHandlerAddress);
+    }
+
     case Triple::x86: {
       typedef orc::LocalJITCompileCallbackManager<orc::OrcI386> CCMgrT;
       return llvm::make_unique<CCMgrT>(ErrorHandlerAddress);
@@ -50,6 +55,12 @@ createLocalIndirectStubsManagerBuilder(const Triple &T) {
   switch (T.getArch()) {
     default: return nullptr;
 
+    case Triple::riscv64:
+      return [](){
+        return llvm::make_unique<
+                       orc::LocalIndirectStubsManager<orc::OrcRISCV64>>();
+      };
+
     case Triple::x86:
       return [](){
         return llvm::make_unique<
@@ -538,5 +538,181 @@ Error OrcI386::emitIndirectStubsBlock(IndirectStubsInfo &StubsInfo,
   return Error::success();
 }
 
+void OrcRISCV64::writeResolverCode(uint8_t *ResolverMem,
+                                   JITReentryFn ReentryFn,
+                                   void *CallbackMgr) {
+
+  // The trampoline leaves its own address + 12 in t1 and the return address
+  // of the original call in ra. Only the argument registers need saving, the
+  // reentry function preserves the callee-saved ones.
+  const uint32_t ResolverCode[] = {
+    // resolver_entry:
+    0xf7010113,        // 0x000:  addi  sp, sp, -144
+    0x00113023,        // 0x004:  sd    ra, 0(sp)
+    0x00a13423,        // 0x008:  sd    a0, 8(sp)
+    0x00b13823,        // 0x00c:  sd    a1, 16(sp)
+    0x00c13c23,        // 0x010:  sd    a2, 24(sp)
+    0x02d13023,        // 0x014:  sd    a3, 32(sp)
+    0x02e13423,        // 0x018:  sd    a4, 40(sp)
+    0x02f13823,        // 0x01c:  sd    a5, 48(sp)
+    0x03013c23,        // 0x020:  sd    a6, 56(sp)
+    0x05113023,        // 0x024:  sd    a7, 64(sp)
+    0x04a13427,        // 0x028:  fsd   fa0, 72(sp)
+    0x04b13827,        // 0x02c:  fsd   fa1, 80(sp)
+    0x04c13c27,        // 0x030:  fsd   fa2, 88(sp)
+    0x06d13027,        // 0x034:  fsd   fa3, 96(sp)
+    0x06e13427,        // 0x038:  fsd   fa4, 104(sp)
+    0x06f13827,        // 0x03c:  fsd   fa5, 112(sp)
+    0x07013c27,        // 0x040:  fsd   fa6, 120(sp)
+    0x09113027,        // 0x044:  fsd   fa7, 128(sp)
+    0x00000517,        // 0x048:  auipc a0, 0
+    0x07053503,        // 0x04c:  ld    a0, Lcallbackmgr
+    0xff430593,        // 0x050:  addi  a1, t1, -12
+    0x00000617,        // 0x054:  auipc a2, 0
+    0x05c63603,        // 0x058:  ld    a2, Lreentry_fn_ptr
+    0x000600e7,        // 0x05c:  jalr  a2
+    0x00050293,        // 0x060:  mv    t0, a0
+    0x08013887,        // 0x064:  fld   fa7, 128(sp)
+    0x07813807,        // 0x068:  fld   fa6, 120(sp)
+    0x07013787,        // 0x06c:  fld   fa5, 112(sp)
+    0x06813707,        // 0x070:  fld   fa4, 104(sp)
+    0x06013687,        // 0x074:  fld   fa3, 96(sp)
+    0x05813607,        // 0x078:  fld   fa2, 88(sp)
+    0x05013587,        // 0x07c:  fld   fa1, 80(sp)
+    0x04813507,        // 0x080:  fld   fa0, 72(sp)
+    0x04013883,        // 0x084:  ld    a7, 64(sp)
+    0x03813803,        // 0x088:  ld    a6, 56(sp)
+    0x03013783,        // 0x08c:  ld    a5, 48(sp)
+    0x02813703,        // 0x090:  ld    a4, 40(sp)
+    0x02013683,        // 0x094:  ld    a3, 32(sp)
+    0x01813603,        // 0x098:  ld    a2, 24(sp)
+    0x01013583,        // 0x09c:  ld    a1, 16(sp)
+    0x00813503,        // 0x0a0:  ld    a0, 8(sp)
+    0x00013083,        // 0x0a4:  ld    ra, 0(sp)
+    0x09010113,        // 0x0a8:  addi  sp, sp, 144
+    0x00028067,        // 0x0ac:  jr    t0
+    0x01234567,        // 0x0b0:  Lreentry_fn_ptr:
+    0xdeadbeef,        // 0x0b4:      .quad 0
+    0x98765432,        // 0x0b8:  Lcallbackmgr:
+    0xcafef00d         // 0x0bc:      .quad 0
+  };
+
+  const unsigned ReentryFnAddrOffset = 0xb0;
+  const unsigned CallbackMgrAddrOffset = 0xb8;
+
+  memcpy(ResolverMem, ResolverCode, sizeof(ResolverCode));
+  memcpy(ResolverMem + ReentryFnAddrOffset, &ReentryFn, sizeof(ReentryFn));
+  memcpy(ResolverMem + CallbackMgrAddrOffset, &CallbackMgr,
+         sizeof(CallbackMgr));
+}
+
+// Split a PC-relative offset into the auipc and load immediates that
+// reconstruct it.
+static uint32_t getRISCVHi20(int64_t Offset) {
+  return static_cast<uint32_t>((Offset + 0x800) >> 12) & 0xfffff;
+}
+
+static uint32_t getRISCVLo12(int64_t Offset) {
+  return static_cast<uint32_t>(Offset) & 0xfff;
+}
+
+void OrcRISCV64::writeTrampolines(uint8_t *TrampolineMem, void *ResolverAddr,
+                                  unsigned NumTrampolines) {
+
+  unsigned OffsetToPtr = alignTo(NumTrampolines * TrampolineSize, 8);
+
+  memcpy(TrampolineMem + OffsetToPtr, &ResolverAddr, sizeof(void *));
+
+  uint32_t *Trampolines = reinterpret_cast<uint32_t *>(TrampolineMem);
+
+  // Each trampoline is:
+  //                 auipc   t2, %hi(Lptr)
+  //                 ld      t2, %lo(Lptr)(t2)
+  //                 jalr    t1, t2
+  //                 nop
+  for (unsigned I = 0; I < NumTrampolines; ++I, OffsetToPtr -= TrampolineSize) {
+    Trampolines[4 * I + 0] = 0x00000397 | (getRISCVHi20(OffsetToPtr) << 12);
+    Trampolines[4 * I + 1] = 0x0003b383 | (getRISCVLo12(OffsetToPtr) << 20);
+    Trampolines[4 * I + 2] = 0x00038367;
+    Trampolines[4 * I + 3] = 0x00000013;
+  }
+}
+
+Error OrcRISCV64::emitIndirectStubsBlock(IndirectStubsInfo &StubsInfo,
+                                         unsigned MinStubs,
+                                         void *InitialPtrVal) {
+  // Stub format is:
+  //
+  // .section __orc_stubs
+  // stub1:
+  //                 auipc   t0, %hi(ptr1)      ; PC-rel load of ptr1
+  //                 ld      t0, %lo(ptr1)(t0)
+  //                 jr      t0                 ; Jump to resolver
+  //                 nop
+  // stub2:
+  //                 auipc   t0, %hi(ptr2)      ; PC-rel load of ptr2
+  //                 ld      t0, %lo(ptr2)(t0)
+  //                 jr      t0                 ; Jump to resolver
+  //                 nop
+  //
+  // ...
+  //
+  // .section __orc_ptrs
+  // ptr1:
+  //                 .quad 0x0
+  // ptr2:
+  //                 .quad 0x0
+  //
+  // ...
+
+  const unsigned StubSize = IndirectStubsInfo::StubSize;
+
+  // Emit at least MinStubs, rounded up to fill the pages allocated.
+  unsigned PageSize = sys::Process::getPageSize();
+  unsigned NumPages = ((MinStubs * StubSize) + (PageSize - 1)) / PageSize;
+  unsigned NumStubs = (NumPages * PageSize) / StubSize;
+
+  // Allocate memory for stubs and pointers in one call.
+  std::error_code EC;
+  auto StubsMem = sys::OwningMemoryBlock(sys::Memory::allocateMappedMemory(
+      2 * NumPages * PageSize, nullptr,
+      sys::Memory::MF_READ | sys::Memory::MF_WRITE, EC));
+
+  if (EC)
+    return errorCodeToError(EC);
+
+  // Create separate MemoryBlocks representing the stubs and pointers.
+  sys::MemoryBlock StubsBlock(StubsMem.base(), NumPages * PageSize);
+  sys::MemoryBlock PtrsBlock(static_cast<char *>(StubsMem.base()) +
+                                 NumPages * PageSize,
+                             NumPages * PageSize);
+
+  // Populate the stubs page stubs and mark it executable. Stubs are twice the
+  // size of the pointers, so each one is 8 bytes closer to its pointer than
+  // the last.
+  uint32_t *Stub = reinterpret_cast<uint32_t *>(StubsBlock.base());
+  int64_t PtrOffset = NumPages * PageSize;
+
+  for (unsigned I = 0; I < NumStubs; ++I, PtrOffset -= StubSize - 8) {
+    Stub[4 * I + 0] = 0x00000297 | (getRISCVHi20(PtrOffset) << 12);
+    Stub[4 * I + 1] = 0x0002b283 | (getRISCVLo12(PtrOffset) << 20);
+    Stub[4 * I + 2] = 0x00028067;
+    Stub[4 * I + 3] = 0x00000013;
+  }
+
+  if (auto EC = sys::Memory::protectMappedMemory(
+          StubsBlock, sys::Memory::MF_READ | sys::Memory::MF_EXEC))
+    return errorCodeToError(EC);
+
+  // Initialize all pointers to point at FailureAddress.
+  void **Ptr = reinterpret_cast<void **>(PtrsBlock.base());
+  for (unsigned I = 0; I < NumStubs; ++I)
+    Ptr[I] = InitialPtrVal;
+
+  StubsInfo = IndirectStubsInfo(NumStubs, std::move(StubsMem));
+
+  return Error::success();
+}
+
 } // End namespace orc.
 } // End namespace llvm.
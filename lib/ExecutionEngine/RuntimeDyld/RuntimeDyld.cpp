@@ -860,6 +860,16 @@ uint8_t *RuntimeDyldImpl::createStubFunction(uint8_t *Addr,
     writeInt16BE(Addr+6,  0x07F1);     // brc 15,%r1
     // 8-byte address stored at Addr + 8
     return Addr;
+  } else if (Arch == Triple::riscv || Arch == Triple::riscv64) {
+    writeBytesUnaligned(0x00000f97, Addr, 4);    // auipc t6, 0
+    if (Arch == Triple::riscv64)
+      writeBytesUnaligned(0x010fbf83, Addr+4, 4); // ld    t6, 16(t6)
+    else
+      writeBytesUnaligned(0x010faf83, Addr+4, 4); // lw    t6, 16(t6)
+    writeBytesUnaligned(0x000f8067, Addr+8, 4);  // jr    t6
+    writeBytesUnaligned(0x00000013, Addr+12, 4); // nop
+    // The callee address is stored at Addr + 16
+    return Addr;
   } else if (Arch == Triple::x86_64) {
     *Addr      = 0xFF; // jmp
     *(Addr+1)  = 0x25; // rip
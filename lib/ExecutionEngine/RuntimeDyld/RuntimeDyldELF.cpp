@@ -1074,6 +1074,113 @@ void RuntimeDyldELF::resolveSystemZRelocation(const SectionEntry &Section,
   }
 }
 
+// Helpers to patch the immediate fields of the RISC-V instruction formats.
+static uint32_t setRISCVBTypeImm(uint32_t Insn, uint32_t Imm) {
+  return (Insn & 0x01fff07f) | ((Imm >> 12 & 0x1) << 31) |
+         ((Imm >> 5 & 0x3f) << 25) | ((Imm >> 1 & 0xf) << 8) |
+         ((Imm >> 11 & 0x1) << 7);
+}
+
+static uint32_t setRISCVJTypeImm(uint32_t Insn, uint32_t Imm) {
+  return (Insn & 0x00000fff) | ((Imm >> 20 & 0x1) << 31) |
+         ((Imm >> 1 & 0x3ff) << 21) | ((Imm >> 11 & 0x1) << 20) |
+         ((Imm >> 12 & 0xff) << 12);
+}
+
+static uint32_t setRISCVUTypeImm(uint32_t Insn, uint32_t Imm) {
+  // The low part is sign-extended by its user, so round the high part.
+  return (Insn & 0x00000fff) | ((Imm + 0x800) & 0xfffff000);
+}
+
+static uint32_t setRISCVITypeImm(uint32_t Insn, uint32_t Imm) {
+  return (Insn & 0x000fffff) | ((Imm & 0xfff) << 20);
+}
+
+static uint32_t setRISCVSTypeImm(uint32_t Insn, uint32_t Imm) {
+  return (Insn & 0x01fff07f) | ((Imm >> 5 & 0x7f) << 25) |
+         ((Imm & 0x1f) << 7);
+}
+
+void RuntimeDyldELF::resolveRISCVRelocation(const SectionEntry &Section,
+                                            uint64_t Offset, uint64_t Value,
+                                            uint32_t Type, int64_t Addend,
+                                            uint64_t SymOffset) {
+  uint8_t *LocalAddress = Section.getAddressWithOffset(Offset);
+  uint64_t FinalAddress = Section.getLoadAddressWithOffset(Offset);
+  uint32_t Insn = support::endian::read32le(LocalAddress);
+
+  DEBUG(dbgs() << "resolveRISCVRelocation, LocalAddress: 0x"
+               << format("%llx", LocalAddress) << " FinalAddress: 0x"
+               << format("%llx", FinalAddress) << " Value: 0x"
+               << format("%llx", Value) << " Type: 0x" << format("%x", Type)
+               << " Addend: 0x" << format("%llx", Addend) << "\n");
+
+  switch (Type) {
+  default:
+    llvm_unreachable("Relocation type not implemented yet!");
+    break;
+  case ELF::R_RISCV_32:
+    support::endian::write32le(LocalAddress, Value + Addend);
+    break;
+  case ELF::R_RISCV_64:
+    support::endian::write64le(LocalAddress, Value + Addend);
+    break;
+  case ELF::R_RISCV_BRANCH: {
+    int64_t Delta = (Value + Addend) - FinalAddress;
+    assert(isInt<13>(Delta) && (Delta & 1) == 0 && "R_RISCV_BRANCH overflow");
+    support::endian::write32le(LocalAddress, setRISCVBTypeImm(Insn, Delta));
+    break;
+  }
+  case ELF::R_RISCV_JAL: {
+    int64_t Delta = (Value + Addend) - FinalAddress;
+    assert(isInt<21>(Delta) && (Delta & 1) == 0 && "R_RISCV_JAL overflow");
+    support::endian::write32le(LocalAddress, setRISCVJTypeImm(Insn, Delta));
+    break;
+  }
+  case ELF::R_RISCV_CALL:
+  case ELF::R_RISCV_CALL_PLT: {
+    // An auipc/jalr pair.
+    int64_t Delta = (Value + Addend) - FinalAddress;
+    assert(isInt<32>(Delta + 0x800) && "R_RISCV_CALL overflow");
+    uint32_t Jalr = support::endian::read32le(LocalAddress + 4);
+    support::endian::write32le(LocalAddress, setRISCVUTypeImm(Insn, Delta));
+    support::endian::write32le(LocalAddress + 4, setRISCVITypeImm(Jalr, Delta));
+    break;
+  }
+  case ELF::R_RISCV_HI20:
+    support::endian::write32le(LocalAddress,
+                               setRISCVUTypeImm(Insn, Value + Addend));
+    break;
+  case ELF::R_RISCV_LO12_I:
+    support::endian::write32le(LocalAddress,
+                               setRISCVITypeImm(Insn, Value + Addend));
+    break;
+  case ELF::R_RISCV_LO12_S:
+    support::endian::write32le(LocalAddress,
+                               setRISCVSTypeImm(Insn, Value + Addend));
+    break;
+  case ELF::R_RISCV_PCREL_HI20: {
+    int64_t Delta = (Value + Addend) - FinalAddress;
+    assert(isInt<32>(Delta + 0x800) && "R_RISCV_PCREL_HI20 overflow");
+    support::endian::write32le(LocalAddress, setRISCVUTypeImm(Insn, Delta));
+    break;
+  }
+  case ELF::R_RISCV_PCREL_LO12_I:
+  case ELF::R_RISCV_PCREL_LO12_S: {
+    // Value and Addend describe the target of the matching auipc, which is
+    // at SymOffset in the same section.
+    int64_t Delta =
+        (Value + Addend) - Section.getLoadAddressWithOffset(SymOffset);
+    if (Type == ELF::R_RISCV_PCREL_LO12_I)
+      Insn = setRISCVITypeImm(Insn, Delta);
+    else
+      Insn = setRISCVSTypeImm(Insn, Delta);
+    support::endian::write32le(LocalAddress, Insn);
+    break;
+  }
+  }
+}
+
 // The target location for the relocation is described by RE.SectionID and
 // RE.Offset.  RE.SectionID can be used to find the SectionEntry.  Each
 // SectionEntry has three members describing its location.
@@ -1147,6 +1254,10 @@ void RuntimeDyldELF::resolveRelocation(const SectionEntry &Section,
   case Triple::systemz:
     resolveSystemZRelocation(Section, Offset, Value, Type, Addend);
     break;
+  case Triple::riscv:
+  case Triple::riscv64:
+    resolveRISCVRelocation(Section, Offset, Value, Type, Addend, SymOffset);
+    break;
   default:
     llvm_unreachable("Unsupported CPU type!");
   }
@@ -1643,6 +1754,74 @@ RuntimeDyldELF::processRelocationRef(
       else
         addRelocationForSection(RE, Value.SectionID);
     }
+  } else if (Arch == Triple::riscv || Arch == Triple::riscv64) {
+    if (RelType == ELF::R_RISCV_NONE || RelType == ELF::R_RISCV_ALIGN)
+      return ++RelI;
+
+    if ((RelType == ELF::R_RISCV_CALL || RelType == ELF::R_RISCV_CALL_PLT ||
+         RelType == ELF::R_RISCV_JAL) &&
+        (Value.SymbolName || Value.SectionID != SectionID)) {
+      // The callee may be out of range of the call, so go through a stub
+      // that holds its full address.
+      DEBUG(dbgs() << "\t\tThis is a RISCV call relocation.");
+      SectionEntry &Section = Sections[SectionID];
+
+      // Look for an existing stub.
+      StubMap::const_iterator i = Stubs.find(Value);
+      uint64_t StubOffset;
+      if (i != Stubs.end()) {
+        StubOffset = i->second;
+        DEBUG(dbgs() << " Stub function found\n");
+      } else {
+        // Create a new stub function.
+        DEBUG(dbgs() << " Create a new stub function\n");
+
+        uintptr_t BaseAddress = uintptr_t(Section.getAddress());
+        uintptr_t StubAlignment = getStubAlignment();
+        uintptr_t StubAddress =
+            (BaseAddress + Section.getStubOffset() + StubAlignment - 1) &
+            -StubAlignment;
+        StubOffset = StubAddress - BaseAddress;
+
+        Stubs[Value] = StubOffset;
+        createStubFunction((uint8_t *)StubAddress);
+        RelocationEntry RE(SectionID, StubOffset + 16,
+                           Arch == Triple::riscv64 ? ELF::R_RISCV_64
+                                                   : ELF::R_RISCV_32,
+                           Value.Addend);
+        if (Value.SymbolName)
+          addRelocationForSymbol(RE, Value.SymbolName);
+        else
+          addRelocationForSection(RE, Value.SectionID);
+        Section.advanceStubOffset(getMaxStubSize());
+      }
+
+      // Make the call site refer to the stub.
+      RelocationEntry RE(SectionID, Offset, RelType, StubOffset);
+      addRelocationForSection(RE, SectionID);
+    } else if (RelType == ELF::R_RISCV_PCREL_HI20) {
+      RISCVPCRelHi20Relocs[std::make_pair(SectionID, Offset)] = Value;
+      processSimpleRelocation(SectionID, Offset, RelType, Value);
+    } else if (RelType == ELF::R_RISCV_PCREL_LO12_I ||
+               RelType == ELF::R_RISCV_PCREL_LO12_S) {
+      // The symbol of a *PCREL_LO12 relocation labels the auipc carrying the
+      // matching *PCREL_HI20, whose target is the one we want.
+      auto HI = RISCVPCRelHi20Relocs.find(
+          std::make_pair(Value.SectionID, uint64_t(Value.Addend)));
+      if (Value.SymbolName || Value.SectionID != SectionID ||
+          HI == RISCVPCRelHi20Relocs.end())
+        return make_error<RuntimeDyldError>(
+            "Can't find matching PCREL_HI20 reloc");
+      RelocationValueRef Target = HI->second;
+      RelocationEntry RE(SectionID, Offset, RelType, Target.Addend,
+                         HI->first.second);
+      if (Target.SymbolName)
+        addRelocationForSymbol(RE, Target.SymbolName);
+      else
+        addRelocationForSection(RE, Target.SectionID);
+    } else {
+      processSimpleRelocation(SectionID, Offset, RelType, Value);
+    }
   } else if (Arch == Triple::systemz &&
              (RelType == ELF::R_390_PLT32DBL || RelType == ELF::R_390_GOTENT)) {
     // Create function stubs for both PLT and GOT references, regardless of
@@ -1794,11 +1973,13 @@ size_t RuntimeDyldELF::getGOTEntrySize() {
   case Triple::ppc64:
   case Triple::ppc64le:
   case Triple::systemz:
+  case Triple::riscv64:
     Result = sizeof(uint64_t);
     break;
   case Triple::x86:
   case Triple::arm:
   case Triple::thumb:
+  case Triple::riscv:
     Result = sizeof(uint32_t);
     break;
   case Triple::mips:
@@ -1900,6 +2081,7 @@ Error RuntimeDyldELF::finalizeLoad(const ObjectFile &Obj,
 
   GOTSectionID = 0;
   CurrentGOTIndex = 0;
+  RISCVPCRelHi20Relocs.clear();
 
   return Error::success();
 }
@@ -55,6 +55,10 @@ class RuntimeDyldELF : public RuntimeDyldImpl {
   void resolveSystemZRelocation(const SectionEntry &Section, uint64_t Offset,
                                 uint64_t Value, uint32_t Type, int64_t Addend);
 
+  void resolveRISCVRelocation(const SectionEntry &Section, uint64_t Offset,
+                              uint64_t Value, uint32_t Type, int64_t Addend,
+                              uint64_t SymOffset);
+
   void resolveMIPS64Relocation(const SectionEntry &Section, uint64_t Offset,
                                uint64_t Value, uint32_t Type, int64_t Addend,
                                uint64_t SymOffset, SID SectionID);
@@ -80,13 +84,19 @@ class RuntimeDyldELF : public RuntimeDyldImpl {
       return 6; // 2-byte jmp instruction + 32-bit relative address
     else if (Arch == Triple::systemz)
       return 16;
+    else if (Arch == Triple::riscv64)
+      return 24; // auipc; ld; jr; nop and a 64-bit address
+    else if (Arch == Triple::riscv)
+      return 20; // auipc; lw; jr; nop and a 32-bit address
     else
       return 0;
   }
 
   unsigned getStubAlignment() override {
-    if (Arch == Triple::systemz)
+    if (Arch == Triple::systemz || Arch == Triple::riscv64)
       return 8;
+    else if (Arch == Triple::riscv)
+      return 4;
     else
       return 1;
   }
@@ -149,6 +159,11 @@ class RuntimeDyldELF : public RuntimeDyldImpl {
   // *LO16 part. (Mips specific)
   SmallVector<std::pair<RelocationValueRef, RelocationEntry>, 8> PendingRelocs;
 
+  // The targets of *PCREL_HI20 relocations, keyed by the section and offset
+  // of the auipc they apply to.  The *PCREL_LO12 relocations refer to that
+  // auipc rather than to the final target. (RISC-V specific)
+  DenseMap<std::pair<SID, uint64_t>, RelocationValueRef> RISCVPCRelHi20Relocs;
+
   // When a module is loaded we save the SectionID of the EH frame section
   // in a table until we receive a request to register all unregistered
   // EH frame sections with the memory manager.
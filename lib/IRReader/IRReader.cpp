@@ -14,8 +14,10 @@
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <system_error>
@@ -51,8 +53,17 @@ std::unique_ptr<Module> llvm::getLazyIRFileModule(StringRef Filename,
                                                   SMDiagnostic &Err,
                                                   LLVMContext &Context,
                                                   bool ShouldLazyLoadMetadata) {
+  return getLazyIRFileModule(Filename, Err, Context, MemoryBuffer::FileHints(),
+                             ShouldLazyLoadMetadata);
+}
+
+std::unique_ptr<Module>
+llvm::getLazyIRFileModule(StringRef Filename, SMDiagnostic &Err,
+                          LLVMContext &Context,
+                          const MemoryBuffer::FileHints &Hints,
+                          bool ShouldLazyLoadMetadata) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
-      MemoryBuffer::getFileOrSTDIN(Filename);
+      MemoryBuffer::getFileOrSTDIN(Filename, Hints);
   if (std::error_code EC = FileOrErr.getError()) {
     Err = SMDiagnostic(Filename, SourceMgr::DK_Error,
                        "Could not open input file: " + EC.message());
@@ -67,6 +78,7 @@ std::unique_ptr<Module> llvm::parseIR(MemoryBufferRef Buffer, SMDiagnostic &Err,
                                       LLVMContext &Context) {
   NamedRegionTimer T(TimeIRParsingName, TimeIRParsingGroupName,
                      TimePassesIsEnabled);
+  TimeTraceScope TimeScope("ParseIR", Buffer.getBufferIdentifier());
   if (isBitcode((const unsigned char *)Buffer.getBufferStart(),
                 (const unsigned char *)Buffer.getBufferEnd())) {
     ErrorOr<std::unique_ptr<Module>> ModuleOrErr =
@@ -84,8 +96,13 @@ std::unique_ptr<Module> llvm::parseIR(MemoryBufferRef Buffer, SMDiagnostic &Err,
 
 std::unique_ptr<Module> llvm::parseIRFile(StringRef Filename, SMDiagnostic &Err,
                                           LLVMContext &Context) {
+  // The whole file is parsed front to back. Start reading it in right away;
+  // the bitcode reader keeps requesting the pages ahead of it.
   ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
-      MemoryBuffer::getFileOrSTDIN(Filename);
+      MemoryBuffer::getFileOrSTDIN(
+          Filename,
+          MemoryBuffer::FileHints(sys::fs::mapped_file_region::sequential,
+                                  8 << 20));
   if (std::error_code EC = FileOrErr.getError()) {
     Err = SMDiagnostic(Filename, SourceMgr::DK_Error,
                        "Could not open input file: " + EC.message());
@@ -64,8 +64,9 @@ bool LTOModule::isBitcodeFile(const void *Mem, size_t Length) {
 }
 
 bool LTOModule::isBitcodeFile(const char *Path) {
-  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
-      MemoryBuffer::getFile(Path);
+  // Only the header is looked at.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr = MemoryBuffer::getFile(
+      Path, MemoryBuffer::FileHints(sys::fs::mapped_file_region::random));
   if (!BufferOrErr)
     return false;
 
@@ -109,8 +110,10 @@ std::string LTOModule::getProducerString(MemoryBuffer *Buffer) {
 ErrorOr<std::unique_ptr<LTOModule>>
 LTOModule::createFromFile(LLVMContext &Context, const char *path,
                           const TargetOptions &options) {
-  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
-      MemoryBuffer::getFile(path);
+  // The module is parsed front to back, like in parseIRFile.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr = MemoryBuffer::getFile(
+      path, MemoryBuffer::FileHints(sys::fs::mapped_file_region::sequential,
+                                    8 << 20));
   if (std::error_code EC = BufferOrErr.getError()) {
     Context.emitError(EC.message());
     return EC;
@@ -38,10 +38,11 @@
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
 #include "llvm/Support/CachePruning.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
-#include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/xxhash.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/FunctionImport.h"
@@ -63,9 +64,6 @@ extern cl::opt<bool> LTODiscardValueNames;
 
 namespace {
 
-static cl::opt<int> ThreadCount("threads",
-                                cl::init(std::thread::hardware_concurrency()));
-
 static void diagnosticHandler(const DiagnosticInfo &DI) {
   DiagnosticPrinterRawOStream DP(errs());
   DI.print(DP);
@@ -237,8 +235,14 @@ public:
     // This is based on the current compiler version, the module itself, the
     // export list, the hash for every single module in the import list, the
     // list of ResolvedODR for the module, and the list of preserved symbols.
+    // The key only has to tell apart the inputs of builds sharing the cache:
+    // use the 128-bit xxHash, which is much faster than SHA1. It is not
+    // cryptographic, so inputs crafted to collide would share an entry, and
+    // it is only as strong as one xxHash64: a cache of N entries has an
+    // accidental collision with odds of about N^2 / 2^65, which is negligible
+    // for the number of modules a build produces.
 
-    SHA1 Hasher;
+    XXHash128 Hasher;
 
     // Start with the compiler revision
     Hasher.update(LLVM_VERSION_STRING);
@@ -274,7 +278,7 @@ public:
             ArrayRef<uint8_t>((const uint8_t *)&Entry, sizeof(GlobalValue::GUID)));
     }
 
-    sys::path::append(EntryPath, CachePath, toHex(Hasher.result()));
+    sys::path::append(EntryPath, CachePath, Hasher.digest().toHex());
   }
 
   // Access the path to this entry in the cache.
@@ -771,7 +775,7 @@ void ThinLTOCodeGenerator::run() {
 
   // Parallel optimizer + codegen
   {
-    ThreadPool Pool(ThreadCount);
+    ThreadPool Pool(parallel::getThreadCount());
     for (auto IndexCount : ModulesOrdering) {
       auto &ModuleBuffer = Modules[IndexCount];
       Pool.async([&](int count) {
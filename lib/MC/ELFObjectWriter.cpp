@@ -1023,19 +1023,23 @@ void ELFObjectWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
       DebugCompressionType::DCT_None;
   if (!CompressionEnabled || !SectionName.startswith(".debug_") ||
       SectionName == ".debug_frame") {
-    Asm.writeSectionData(&Section, Layout);
+    // The stream may produce the contents later, directly in the output file
+    // and along with the contents of other sections.
+    getStream().writeDeferred(
+        Layout.getSectionFileSize(&Section),
+        [&Asm, &Section, &Layout](raw_pwrite_stream &OS) {
+          Asm.writeSectionData(OS, &Section, Layout);
+        });
     return;
   }
 
   SmallVector<char, 128> UncompressedData;
   raw_svector_ostream VecOS(UncompressedData);
-  raw_pwrite_stream &OldStream = getStream();
-  setStream(VecOS);
-  Asm.writeSectionData(&Section, Layout);
-  setStream(OldStream);
+  Asm.writeSectionData(VecOS, &Section, Layout);
 
+  // Large debug sections are compressed in chunks, on several threads.
   SmallVector<char, 128> CompressedContents;
-  zlib::Status Success = zlib::compress(
+  zlib::Status Success = zlib::compressParallel(
       StringRef(UncompressedData.data(), UncompressedData.size()),
       CompressedContents);
   if (Success != zlib::StatusOK) {
@@ -1341,6 +1345,9 @@ void ELFObjectWriter::writeObject(MCAssembler &Asm,
   }
   getStream().pwrite(reinterpret_cast<char *>(&NumSections),
                      sizeof(NumSections), NumSectionsOffset);
+
+  // ... and finally the contents of the sections that were deferred.
+  getStream().flushDeferred();
 }
 
 bool ELFObjectWriter::isSymbolRefDifferenceFullyResolvedImpl(
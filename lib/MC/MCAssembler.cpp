@@ -419,9 +419,7 @@ void MCAssembler::writeFragmentPadding(const MCFragment &F, uint64_t FSize,
 
 /// \brief Write the fragment \p F to the output file.
 static void writeFragment(const MCAssembler &Asm, const MCAsmLayout &Layout,
-                          const MCFragment &F) {
-  MCObjectWriter *OW = &Asm.getWriter();
-
+                          const MCFragment &F, MCObjectWriter *OW) {
   // FIXME: Embed in fragments instead?
   uint64_t FragmentSize = Asm.computeFragmentSize(Layout, F);
 
@@ -560,8 +558,9 @@ static void writeFragment(const MCAssembler &Asm, const MCAsmLayout &Layout,
          "The stream should advance by fragment size");
 }
 
-void MCAssembler::writeSectionData(const MCSection *Sec,
-                                   const MCAsmLayout &Layout) const {
+static void writeSectionContents(const MCAssembler &Asm,
+                                 const MCAsmLayout &Layout,
+                                 const MCSection *Sec, MCObjectWriter *OW) {
   // Ignore virtual sections.
   if (Sec->isVirtualSection()) {
     assert(Layout.getSectionFileSize(Sec) == 0 && "Invalid size for section!");
@@ -604,14 +603,48 @@ void MCAssembler::writeSectionData(const MCSection *Sec,
     return;
   }
 
-  uint64_t Start = getWriter().getStream().tell();
+  uint64_t Start = OW->getStream().tell();
   (void)Start;
 
   for (const MCFragment &F : *Sec)
-    writeFragment(*this, Layout, F);
+    writeFragment(Asm, Layout, F, OW);
+
+  assert(OW->getStream().tell() - Start == Layout.getSectionAddressSize(Sec));
+}
+
+namespace {
+/// An object writer that can only write section contents, which lets them be
+/// written to a stream other than the one of the assembler's object writer.
+class SectionContentsWriter : public MCObjectWriter {
+public:
+  SectionContentsWriter(raw_pwrite_stream &OS, bool IsLittleEndian)
+      : MCObjectWriter(OS, IsLittleEndian) {}
+
+  void executePostLayoutBinding(MCAssembler &Asm,
+                                const MCAsmLayout &Layout) override {
+    llvm_unreachable("Only writes section contents");
+  }
+  void recordRelocation(MCAssembler &Asm, const MCAsmLayout &Layout,
+                        const MCFragment *Fragment, const MCFixup &Fixup,
+                        MCValue Target, bool &IsPCRel,
+                        uint64_t &FixedValue) override {
+    llvm_unreachable("Only writes section contents");
+  }
+  void writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) override {
+    llvm_unreachable("Only writes section contents");
+  }
+};
+} // end anonymous namespace
+
+void MCAssembler::writeSectionData(const MCSection *Sec,
+                                   const MCAsmLayout &Layout) const {
+  writeSectionContents(*this, Layout, Sec, &getWriter());
+}
 
-  assert(getWriter().getStream().tell() - Start ==
-         Layout.getSectionAddressSize(Sec));
+void MCAssembler::writeSectionData(raw_pwrite_stream &OS, const MCSection *Sec,
+                                   const MCAsmLayout &Layout) const {
+  SectionContentsWriter Writer(OS, getWriter().isLittleEndian());
+  writeSectionContents(*this, Layout, Sec, &Writer);
 }
 
 std::pair<uint64_t, bool> MCAssembler::handleFixup(const MCAsmLayout &Layout,
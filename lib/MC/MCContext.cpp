@@ -45,7 +45,7 @@ MCContext::MCContext(const MCAsmInfo *mai, const MCRegisterInfo *mri,
                      const MCObjectFileInfo *mofi, const SourceMgr *mgr,
                      bool DoAutoReset)
     : SrcMgr(mgr), MAI(mai), MRI(mri), MOFI(mofi), Allocator(),
-      Symbols(Allocator), UsedNames(Allocator),
+      Symbols(Allocator), UsedNames(Allocator), DeferredNames(Allocator),
       CurrentDwarfLoc(0, 0, 0, DWARF2_FLAG_IS_STMT, 0, 0), DwarfLocSeen(false),
       GenDwarfForAssembly(false), GenDwarfFileNumber(0), DwarfVersion(4),
       AllowTemporaryLabels(true), DwarfCompileUnitID(0),
@@ -99,6 +99,7 @@ void MCContext::reset() {
   COFFUniquingMap.clear();
 
   NextID.clear();
+  DeferredNames.clear();
   AllowTemporaryLabels = true;
   DwarfLocSeen = false;
   GenDwarfForAssembly = false;
@@ -112,6 +113,7 @@ void MCContext::reset() {
 //===----------------------------------------------------------------------===//
 
 MCSymbol *MCContext::getOrCreateSymbol(const Twine &Name) {
+  sys::SmartScopedLock<true> Lock(SymbolsLock);
   SmallString<128> NameSV;
   StringRef NameRef = Name.toStringRef(NameSV);
 
@@ -125,6 +127,7 @@ MCSymbol *MCContext::getOrCreateSymbol(const Twine &Name) {
 }
 
 MCSymbolELF *MCContext::getOrCreateSectionSymbol(const MCSectionELF &Section) {
+  sys::SmartScopedLock<true> Lock(SymbolsLock);
   MCSymbolELF *&Sym = SectionSymbols[&Section];
   if (Sym)
     return Sym;
@@ -170,6 +173,7 @@ MCSymbol *MCContext::createSymbolImpl(const StringMapEntry<bool> *Name,
 
 MCSymbol *MCContext::createSymbol(StringRef Name, bool AlwaysAddSuffix,
                                   bool CanBeUnnamed) {
+  sys::SmartScopedLock<true> Lock(SymbolsLock);
   if (CanBeUnnamed && !UseNamesOnTempLabels)
     return createSymbolImpl(nullptr, true);
 
@@ -179,8 +183,19 @@ MCSymbol *MCContext::createSymbol(StringRef Name, bool AlwaysAddSuffix,
   if (AllowTemporaryLabels && !IsTemporary)
     IsTemporary = Name.startswith(MAI->getPrivateGlobalPrefix());
 
+  if (AlwaysAddSuffix && DeferredTempSymbols) {
+    auto NameEntry = DeferredNames.insert(std::make_pair(Name, true));
+    MCSymbol *Sym = createSymbolImpl(&*NameEntry.first, IsTemporary);
+    DeferredTempSymbols->push_back(Sym);
+    return Sym;
+  }
+  return createSymbolImpl(getUniqueName(Name, AlwaysAddSuffix, IsTemporary),
+                          IsTemporary);
+}
+
+const StringMapEntry<bool> *
+MCContext::getUniqueName(StringRef Name, bool AddSuffix, bool IsTemporary) {
   SmallString<128> NewName = Name;
-  bool AddSuffix = AlwaysAddSuffix;
   unsigned &NextUniqueID = NextID[Name];
   for (;;) {
     if (AddSuffix) {
@@ -194,7 +209,7 @@ MCSymbol *MCContext::createSymbol(StringRef Name, bool AlwaysAddSuffix,
       NameEntry.first->second = true;
       // Have the MCSymbol object itself refer to the copy of the string that is
       // embedded in the UsedNames entry.
-      return createSymbolImpl(&*NameEntry.first, IsTemporary);
+      return &*NameEntry.first;
     }
     assert(IsTemporary && "Cannot rename non-temporary symbols");
     AddSuffix = true;
@@ -209,6 +224,21 @@ MCSymbol *MCContext::createTempSymbol(const Twine &Name, bool AlwaysAddSuffix,
   return createSymbol(NameSV, AlwaysAddSuffix, CanBeUnnamed);
 }
 
+LLVM_THREAD_LOCAL std::vector<MCSymbol *> *MCContext::DeferredTempSymbols =
+    nullptr;
+
+void MCContext::deferTempSymbolNames(std::vector<MCSymbol *> *Symbols) {
+  DeferredTempSymbols = Symbols;
+}
+
+void MCContext::nameDeferredTempSymbols(std::vector<MCSymbol *> &Symbols) {
+  sys::SmartScopedLock<true> Lock(SymbolsLock);
+  for (MCSymbol *Sym : Symbols)
+    Sym->getNameEntryPtr() =
+        getUniqueName(Sym->getName(), /*AddSuffix=*/true, Sym->isTemporary());
+  Symbols.clear();
+}
+
 MCSymbol *MCContext::createLinkerPrivateTempSymbol() {
   SmallString<128> NameSV;
   raw_svector_ostream(NameSV) << MAI->getLinkerPrivateGlobalPrefix() << "tmp";
@@ -220,6 +250,7 @@ MCSymbol *MCContext::createTempSymbol(bool CanBeUnnamed) {
 }
 
 unsigned MCContext::NextInstance(unsigned LocalLabelVal) {
+  sys::SmartScopedLock<true> Lock(SymbolsLock);
   MCLabel *&Label = Instances[LocalLabelVal];
   if (!Label)
     Label = new (*this) MCLabel(0);
@@ -227,6 +258,7 @@ unsigned MCContext::NextInstance(unsigned LocalLabelVal) {
 }
 
 unsigned MCContext::GetInstance(unsigned LocalLabelVal) {
+  sys::SmartScopedLock<true> Lock(SymbolsLock);
   MCLabel *&Label = Instances[LocalLabelVal];
   if (!Label)
     Label = new (*this) MCLabel(0);
@@ -235,6 +267,7 @@ unsigned MCContext::GetInstance(unsigned LocalLabelVal) {
 
 MCSymbol *MCContext::getOrCreateDirectionalLocalSymbol(unsigned LocalLabelVal,
                                                        unsigned Instance) {
+  sys::SmartScopedLock<true> Lock(SymbolsLock);
   MCSymbol *&Sym = LocalSymbols[std::make_pair(LocalLabelVal, Instance)];
   if (!Sym)
     Sym = createTempSymbol(false);
@@ -257,6 +290,7 @@ MCSymbol *MCContext::getDirectionalLocalSymbol(unsigned LocalLabelVal,
 MCSymbol *MCContext::lookupSymbol(const Twine &Name) const {
   SmallString<128> NameSV;
   StringRef NameRef = Name.toStringRef(NameSV);
+  sys::SmartScopedLock<true> Lock(SymbolsLock);
   return Symbols.lookup(NameRef);
 }
 
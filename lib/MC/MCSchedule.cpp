@@ -7,11 +7,14 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file defines the default scheduling model.
+// This file defines the default scheduling model and helpers to query the
+// scheduling classes of a model.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/MC/MCSchedule.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include <algorithm>
 #include <type_traits>
 
 using namespace llvm;
@@ -32,3 +35,38 @@ const MCSchedModel MCSchedModel::Default = {DefaultIssueWidth,
                                             0,
                                             0,
                                             nullptr};
+
+unsigned MCSchedModel::computeInstrLatency(const MCSubtargetInfo &STI,
+                                           const MCSchedClassDesc &SCDesc) {
+  unsigned Latency = 0;
+  for (unsigned DefIdx = 0, DefEnd = SCDesc.NumWriteLatencyEntries;
+       DefIdx != DefEnd; ++DefIdx) {
+    // Lookup the definition's write latency in SubtargetInfo.
+    const MCWriteLatencyEntry *WLEntry =
+      STI.getWriteLatencyEntry(&SCDesc, DefIdx);
+    // Don't know how to handle an invalid latency; use a very large one
+    // that won't induce overflow.
+    unsigned Cycles = WLEntry->Cycles >= 0 ? WLEntry->Cycles : 1000;
+    Latency = std::max(Latency, Cycles);
+  }
+  return Latency;
+}
+
+double MCSchedModel::getReciprocalThroughput(const MCSubtargetInfo &STI,
+                                             const MCSchedClassDesc &SCDesc) {
+  const MCSchedModel &SM = STI.getSchedModel();
+  double Throughput = 0.0;
+  for (const MCWriteProcResEntry *I = STI.getWriteProcResBegin(&SCDesc),
+                                 *E = STI.getWriteProcResEnd(&SCDesc);
+       I != E; ++I) {
+    if (!I->Cycles)
+      continue;
+    unsigned NumUnits = SM.getProcResource(I->ProcResourceIdx)->NumUnits;
+    Throughput = std::max(Throughput, double(I->Cycles) / NumUnits);
+  }
+  if (Throughput != 0.0)
+    return Throughput;
+
+  // Without resources, the instruction is only limited by the issue width.
+  return double(SCDesc.NumMicroOps) / SM.IssueWidth;
+}
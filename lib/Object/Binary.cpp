@@ -75,8 +75,12 @@ Expected<std::unique_ptr<Binary>> object::createBinary(MemoryBufferRef Buffer,
 }
 
 Expected<OwningBinary<Binary>> object::createBinary(StringRef Path) {
+  // Most tools go on to read a good part of the sections: start reading the
+  // whole file in the background instead of faulting it in page by page.
   ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
-      MemoryBuffer::getFileOrSTDIN(Path);
+      MemoryBuffer::getFileOrSTDIN(
+          Path, MemoryBuffer::FileHints(
+                    sys::fs::mapped_file_region::huge_pages, uint64_t(-1)));
   if (std::error_code EC = FileOrErr.getError())
     return errorCodeToError(EC);
   std::unique_ptr<MemoryBuffer> &Buffer = FileOrErr.get();
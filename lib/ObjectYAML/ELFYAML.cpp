@@ -196,6 +196,7 @@ ScalarEnumerationTraits<ELFYAML::ELF_EM>::enumeration(IO &IO,
   ECase(EM_AMDGPU)
   ECase(EM_LANAI)
   ECase(EM_BPF)
+  ECase(EM_RISCV)
 #undef ECase
 }
 
@@ -538,6 +539,9 @@ void ScalarEnumerationTraits<ELFYAML::ELF_REL>::enumeration(
   case ELF::EM_BPF:
 #include "llvm/Support/ELFRelocs/BPF.def"
     break;
+  case ELF::EM_RISCV:
+#include "llvm/Support/ELFRelocs/RISCV.def"
+    break;
   default:
     llvm_unreachable("Unsupported architecture");
   }
@@ -7,15 +7,218 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file implements the BumpPtrAllocator interface.
+// This file implements the BumpPtrAllocator interface, and the slab cache of
+// SlabCacheAllocator.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 
 namespace llvm {
 
+namespace {
+
+/// The cached slab sizes: the powers of 2 from 4 KiB to 1 MiB.
+enum : unsigned { MinCachedSlabSizeLog2 = 12, NumSlabSizeClasses = 9 };
+
+/// A free slab, linked into a list through its first bytes.
+struct FreeSlab {
+  FreeSlab *Next;
+};
+
+struct SlabList {
+  FreeSlab *Head;
+  unsigned Count;
+
+  void push(void *Ptr) {
+    // The bump pointer allocator poisons the slabs it frees.
+    __asan_unpoison_memory_region(Ptr, sizeof(FreeSlab));
+    FreeSlab *Slab = static_cast<FreeSlab *>(Ptr);
+    Slab->Next = Head;
+    Head = Slab;
+    ++Count;
+  }
+
+  void *pop() {
+    FreeSlab *Slab = Head;
+    Head = Slab->Next;
+    --Count;
+    return Slab;
+  }
+};
+
+/// The free slabs shared by all the threads.
+struct SharedSlabPool {
+  sys::Mutex Lock;
+  SlabList Lists[NumSlabSizeClasses];
+  size_t Bytes;
+
+  SharedSlabPool() : Bytes(0) {
+    for (SlabList &List : Lists)
+      List = SlabList{nullptr, 0};
+  }
+
+  ~SharedSlabPool() {
+    for (SlabList &List : Lists)
+      while (List.Head)
+        free(List.pop());
+  }
+};
+
+} // end anonymous namespace
+
+static ManagedStatic<SharedSlabPool> SharedPool;
+
+/// The free slabs of the current thread, which it uses without locking.
+static LLVM_THREAD_LOCAL SlabList ThreadSlabs[NumSlabSizeClasses];
+
+static std::atomic<unsigned> SlabsPerThreadLimit(16);
+static std::atomic<size_t> SharedPoolLimit(32 << 20);
+
+static std::atomic<uint64_t> NumSlabsAllocated(0);
+static std::atomic<uint64_t> NumSlabsReused(0);
+static std::atomic<uint64_t> NumSlabsFreed(0);
+
+/// Return the index of the cached size class of \p Size, or -1 if slabs of
+/// this size are not cached.
+static int getSlabSizeClass(size_t Size) {
+  if (!isPowerOf2_64(Size))
+    return -1;
+  int Class = int(Log2_64(Size)) - MinCachedSlabSizeLog2;
+  return Class >= 0 && Class < int(NumSlabSizeClasses) ? Class : -1;
+}
+
+/// Move all but \p Keep slabs of \p List to the shared pool, or free them if
+/// it is full.
+static void spillSlabs(SlabList &List, unsigned Class, unsigned Keep) {
+  if (List.Count <= Keep)
+    return;
+  size_t Size = size_t(1) << (Class + MinCachedSlabSizeLog2);
+  size_t Limit = SharedPoolLimit.load(std::memory_order_relaxed);
+  uint64_t Freed = 0;
+  {
+    sys::ScopedLock Guard(SharedPool->Lock);
+    while (List.Count > Keep) {
+      void *Slab = List.pop();
+      if (SharedPool->Bytes + Size <= Limit) {
+        SharedPool->Lists[Class].push(Slab);
+        SharedPool->Bytes += Size;
+      } else {
+        free(Slab);
+        ++Freed;
+      }
+    }
+  }
+  NumSlabsFreed.fetch_add(Freed, std::memory_order_relaxed);
+}
+
+/// Move up to half the per thread limit of slabs from the shared pool to
+/// \p List.
+static void refillSlabs(SlabList &List, unsigned Class) {
+  size_t Size = size_t(1) << (Class + MinCachedSlabSizeLog2);
+  unsigned Wanted =
+      std::max(1u, SlabsPerThreadLimit.load(std::memory_order_relaxed) / 2);
+  sys::ScopedLock Guard(SharedPool->Lock);
+  SlabList &Shared = SharedPool->Lists[Class];
+  for (; Wanted && Shared.Head; --Wanted) {
+    List.push(Shared.pop());
+    SharedPool->Bytes -= Size;
+  }
+}
+
+void *SlabCacheAllocator::Allocate(size_t Size, size_t /*Alignment*/) {
+  int Class = getSlabSizeClass(Size);
+  if (Class < 0)
+    return malloc(Size);
+
+  SlabList &List = ThreadSlabs[Class];
+  if (!List.Head)
+    refillSlabs(List, Class);
+  if (List.Head) {
+    NumSlabsReused.fetch_add(1, std::memory_order_relaxed);
+    return List.pop();
+  }
+  NumSlabsAllocated.fetch_add(1, std::memory_order_relaxed);
+  return malloc(Size);
+}
+
+void SlabCacheAllocator::Deallocate(const void *Ptr, size_t Size) {
+  int Class = getSlabSizeClass(Size);
+  if (Class < 0) {
+    free(const_cast<void *>(Ptr));
+    return;
+  }
+
+  // When the cache of the thread is full, keep half of it so that the next
+  // slabs freed do not take the lock again right away.
+  SlabList &List = ThreadSlabs[Class];
+  List.push(const_cast<void *>(Ptr));
+  unsigned Limit = SlabsPerThreadLimit.load(std::memory_order_relaxed);
+  if (List.Count > Limit)
+    spillSlabs(List, Class, Limit / 2);
+}
+
+void SlabCacheAllocator::releaseThreadCache() {
+  // After llvm_shutdown() destroyed the shared pool, threads still exiting
+  // must not construct it again: free their slabs instead.
+  if (!SharedPool.isConstructed()) {
+    for (SlabList &List : ThreadSlabs)
+      while (List.Head)
+        free(List.pop());
+    return;
+  }
+  for (unsigned Class = 0; Class != NumSlabSizeClasses; ++Class)
+    spillSlabs(ThreadSlabs[Class], Class, 0);
+}
+
+void SlabCacheAllocator::setLimits(unsigned SlabsPerThread,
+                                   size_t SharedPoolBytes) {
+  SlabsPerThreadLimit = SlabsPerThread;
+  SharedPoolLimit = SharedPoolBytes;
+
+  // Trim the shared pool, from the largest slabs. The caches of the other
+  // threads shrink as they free slabs.
+  uint64_t Freed = 0;
+  {
+    sys::ScopedLock Guard(SharedPool->Lock);
+    for (unsigned Class = NumSlabSizeClasses;
+         Class-- && SharedPool->Bytes > SharedPoolBytes;) {
+      size_t Size = size_t(1) << (Class + MinCachedSlabSizeLog2);
+      SlabList &Shared = SharedPool->Lists[Class];
+      for (; Shared.Head && SharedPool->Bytes > SharedPoolBytes; ++Freed) {
+        free(Shared.pop());
+        SharedPool->Bytes -= Size;
+      }
+    }
+  }
+  NumSlabsFreed += Freed;
+  for (unsigned Class = 0; Class != NumSlabSizeClasses; ++Class)
+    spillSlabs(ThreadSlabs[Class], Class, SlabsPerThread);
+}
+
+SlabCacheStatistics SlabCacheAllocator::getStatistics() {
+  SlabCacheStatistics Stats;
+  Stats.SlabsAllocated = NumSlabsAllocated;
+  Stats.SlabsReused = NumSlabsReused;
+  Stats.SlabsFreed = NumSlabsFreed;
+  sys::ScopedLock Guard(SharedPool->Lock);
+  Stats.SharedPoolBytes = SharedPool->Bytes;
+  return Stats;
+}
+
+void SlabCacheAllocator::PrintStats() const {
+  SlabCacheStatistics Stats = getStatistics();
+  errs() << "\nSlabs allocated: " << Stats.SlabsAllocated << '\n'
+         << "Slabs reused: " << Stats.SlabsReused << '\n'
+         << "Slabs freed: " << Stats.SlabsFreed << '\n'
+         << "Bytes in the shared slab pool: " << Stats.SharedPoolBytes << '\n';
+}
+
 namespace detail {
 
 void printBumpPtrAllocatorStats(unsigned NumSlabs, size_t BytesAllocated,
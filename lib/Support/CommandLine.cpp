@@ -191,6 +191,49 @@ public:
     }
   }
 
+  /// Queue \p O to be added to the maps of its subcommands when they are
+  /// needed. Most options register from static constructors, and queueing
+  /// them is much cheaper than hashing and copying their names: the maps are
+  /// only built for the programs that look at all the options, e.g. to print
+  /// the help, and only once every library has registered its own. The parser
+  /// must see the positional, sink, consume-after and required options
+  /// without looking them up by name, so these are added right away.
+  void addPendingOption(Option *O) {
+    if (O->isPositional() || O->isSink() || O->isConsumeAfter() ||
+        O->getNumOccurrencesFlag() == cl::Required ||
+        O->getNumOccurrencesFlag() == cl::OneOrMore)
+      addOption(O);
+    else
+      PendingOptions.push_back(O);
+  }
+
+  /// Find the queued option named \p Name in \p Sub. A command line names a
+  /// few options, and scanning the queue for each of them is much cheaper
+  /// than adding the whole queue to the maps.
+  Option *findPendingOption(SubCommand &Sub, StringRef Name) const {
+    for (Option *O : PendingOptions) {
+      if (O->ArgStr != Name)
+        continue;
+      if (O->Subs.empty() ? &Sub == &*TopLevelSubCommand
+                          : O->isInAllSubCommands() || O->Subs.count(&Sub))
+        return O;
+    }
+    return nullptr;
+  }
+
+  /// Add the queued options to the maps of their subcommands. This must be
+  /// called before iterating over the options of any subcommand.
+  void addPendingOptions() {
+    if (PendingOptions.empty())
+      return;
+    // Adding an option can report an error, which must not see the option
+    // queued again.
+    std::vector<Option *> Options;
+    Options.swap(PendingOptions);
+    for (Option *O : Options)
+      addOption(O);
+  }
+
   void removeOption(Option *O, SubCommand *SC) {
     SmallVector<StringRef, 16> OptionNames;
     O->getExtraOptionNames(OptionNames);
@@ -221,6 +264,10 @@ public:
   }
 
   void removeOption(Option *O) {
+    // A queued option is only in the maps under its literal names, if any.
+    auto I = find(PendingOptions, O);
+    if (I != PendingOptions.end())
+      PendingOptions.erase(I);
     if (O->Subs.empty())
       removeOption(O, &*TopLevelSubCommand);
     else {
@@ -240,6 +287,8 @@ public:
   }
 
   bool hasOptions() const {
+    if (!PendingOptions.empty())
+      return true;
     for (const auto &S : RegisteredSubCommands) {
       if (hasOptions(*S))
         return true;
@@ -260,6 +309,9 @@ public:
   }
 
   void updateArgStr(Option *O, StringRef NewName) {
+    // A queued option is added to the maps under its new name.
+    if (is_contained(PendingOptions, O))
+      return;
     if (O->Subs.empty())
       updateArgStr(O, NewName, &*TopLevelSubCommand);
     else {
@@ -317,6 +369,7 @@ public:
 
     ResetAllOptionOccurrences();
     RegisteredSubCommands.clear();
+    PendingOptions.clear();
 
     TopLevelSubCommand->reset();
     AllSubCommands->reset();
@@ -327,6 +380,10 @@ public:
 private:
   SubCommand *ActiveSubCommand;
 
+  /// The options registered since the maps of the subcommands were last
+  /// used, in the order of registration.
+  std::vector<Option *> PendingOptions;
+
   Option *LookupOption(SubCommand &Sub, StringRef &Arg, StringRef &Value);
   SubCommand *LookupSubCommand(const char *Name);
 };
@@ -344,7 +401,7 @@ extrahelp::extrahelp(const char *Help) : morehelp(Help) {
 }
 
 void Option::addArgument() {
-  GlobalParser->addOption(this);
+  GlobalParser->addPendingOption(this);
   FullyInitialized = true;
 }
 
@@ -405,25 +462,19 @@ Option *CommandLineParser::LookupOption(SubCommand &Sub, StringRef &Arg,
 
   size_t EqualPos = Arg.find('=');
 
-  // If we have an equals sign, remember the value.
-  if (EqualPos == StringRef::npos) {
-    // Look up the option.
-    auto I = Sub.OptionsMap.find(Arg);
-    if (I == Sub.OptionsMap.end())
-      return nullptr;
-
-    return I != Sub.OptionsMap.end() ? I->second : nullptr;
+  // Look up the option, or the argument before the = if there is one.
+  StringRef Name = Arg.substr(0, EqualPos);
+  auto I = Sub.OptionsMap.find(Name);
+  Option *O =
+      I != Sub.OptionsMap.end() ? I->second : findPendingOption(Sub, Name);
+
+  // If the argument before the = is a valid option name, we match and
+  // remember the value.  If not, return Arg unmolested.
+  if (O && EqualPos != StringRef::npos) {
+    Value = Arg.substr(EqualPos + 1);
+    Arg = Name;
   }
-
-  // If the argument before the = is a valid option name, we match.  If not,
-  // return Arg unmolested.
-  auto I = Sub.OptionsMap.find(Arg.substr(0, EqualPos));
-  if (I == Sub.OptionsMap.end())
-    return nullptr;
-
-  Value = Arg.substr(EqualPos + 1);
-  Arg = Arg.substr(0, EqualPos);
-  return I->second;
+  return O;
 }
 
 SubCommand *CommandLineParser::LookupSubCommand(const char *Name) {
@@ -998,6 +1049,8 @@ bool cl::ParseCommandLineOptions(int argc, const char *const *argv,
 void CommandLineParser::ResetAllOptionOccurrences() {
   // So that we can parse different command lines multiple times in succession
   // we reset all option values to look like they have never been seen before.
+  for (Option *O : PendingOptions)
+    O->reset();
   for (auto SC : RegisteredSubCommands) {
     for (auto &O : SC->OptionsMap)
       O.second->reset();
@@ -1164,9 +1217,13 @@ bool CommandLineParser::ParseCommandLineOptions(int argc,
       Handler = LookupOption(*ChosenSubCommand, ArgName, Value);
 
       // Check to see if this "option" is really a prefixed or grouped argument.
-      if (!Handler)
+      // This and the search for a near match look at every option, so they
+      // need the queued ones in the map.
+      if (!Handler) {
+        addPendingOptions();
         Handler = HandlePrefixedOrGroupedOption(ArgName, Value, ErrorParsing,
                                                 OptionsMap);
+      }
 
       // Otherwise, look for the closest available option to report to the user
       // in the upcoming error.
@@ -1751,6 +1808,7 @@ public:
     if (!Value)
       return;
 
+    GlobalParser->addPendingOptions();
     SubCommand *Sub = GlobalParser->getActiveSubCommand();
     auto &OptionsMap = Sub->OptionsMap;
     auto &PositionalOpts = Sub->PositionalOpts;
@@ -2005,6 +2063,7 @@ void CommandLineParser::printOptionValues() {
   if (!PrintOptions && !PrintAllOptions)
     return;
 
+  addPendingOptions();
   SmallVector<std::pair<const char *, Option *>, 128> Opts;
   sortOpts(ActiveSubCommand->OptionsMap, Opts, /*ShowHidden*/ true);
 
@@ -2119,10 +2178,12 @@ StringMap<Option *> &cl::getRegisteredOptions(SubCommand &Sub) {
   auto &Subs = GlobalParser->RegisteredSubCommands;
   (void)Subs;
   assert(std::find(Subs.begin(), Subs.end(), &Sub) != Subs.end());
+  GlobalParser->addPendingOptions();
   return Sub.OptionsMap;
 }
 
 void cl::HideUnrelatedOptions(cl::OptionCategory &Category, SubCommand &Sub) {
+  GlobalParser->addPendingOptions();
   for (auto &I : Sub.OptionsMap) {
     if (I.second->Category != &Category &&
         I.second->Category != &GenericCategory)
@@ -2134,6 +2195,7 @@ void cl::HideUnrelatedOptions(ArrayRef<const cl::OptionCategory *> Categories,
                               SubCommand &Sub) {
   auto CategoriesBegin = Categories.begin();
   auto CategoriesEnd = Categories.end();
+  GlobalParser->addPendingOptions();
   for (auto &I : Sub.OptionsMap) {
     if (std::find(CategoriesBegin, CategoriesEnd, I.second->Category) ==
             CategoriesEnd &&
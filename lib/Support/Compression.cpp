@@ -17,9 +17,12 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Parallel.h"
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
+#include <algorithm>
+#include <vector>
 
 using namespace llvm;
 
@@ -62,6 +65,108 @@ zlib::Status zlib::compress(StringRef InputBuffer,
   return Res;
 }
 
+/// Compress one chunk of a compressParallel() input to raw deflate data. The
+/// 32KiB preceding the chunk serve as its dictionary, which keeps most of the
+/// compression ratio of a single stream. All chunks but the last end with a
+/// sync flush, which aligns them on a byte boundary so that they can be
+/// concatenated.
+static int compressChunk(StringRef Chunk, StringRef Dictionary, bool IsLast,
+                         int CLevel, SmallVectorImpl<char> &Out) {
+  z_stream Stream = {};
+  int Res = deflateInit2(&Stream, CLevel, Z_DEFLATED, -MAX_WBITS, 8,
+                         Z_DEFAULT_STRATEGY);
+  if (Res != Z_OK)
+    return Res;
+  if (!Dictionary.empty())
+    Res = deflateSetDictionary(&Stream, (const Bytef *)Dictionary.data(),
+                               Dictionary.size());
+
+  // The sync flush adds an empty stored block to the bound of a finished
+  // stream. Should that still not be enough, grow the buffer until deflate
+  // leaves room in it.
+  Out.resize(deflateBound(&Stream, Chunk.size()) + 16);
+  Stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(Chunk.data()));
+  Stream.avail_in = Chunk.size();
+  int Flush = IsLast ? Z_FINISH : Z_SYNC_FLUSH;
+  while (Res == Z_OK) {
+    Stream.next_out = (Bytef *)Out.data() + Stream.total_out;
+    Stream.avail_out = Out.size() - Stream.total_out;
+    Res = deflate(&Stream, Flush);
+    // A repeated sync flush with nothing left to write reports a buffer error.
+    if (Res == Z_STREAM_END || (Res == Z_OK && Stream.avail_out) ||
+        (Res == Z_BUF_ERROR && !IsLast)) {
+      Res = Z_OK;
+      break;
+    }
+    if (Res == Z_OK)
+      Out.resize(Out.size() * 2);
+  }
+  __msan_unpoison(Out.data(), Stream.total_out);
+  Out.resize(Stream.total_out);
+  deflateEnd(&Stream);
+  return Res;
+}
+
+zlib::Status zlib::compressParallel(StringRef InputBuffer,
+                                    SmallVectorImpl<char> &CompressedBuffer,
+                                    CompressionLevel Level, size_t ChunkSize) {
+  assert(ChunkSize && "Chunks cannot be empty");
+  if (InputBuffer.size() <= ChunkSize)
+    return compress(InputBuffer, CompressedBuffer, Level);
+
+  const size_t DictionarySize = 32 * 1024;
+  size_t NumChunks = (InputBuffer.size() + ChunkSize - 1) / ChunkSize;
+  std::vector<SmallVector<char, 0>> Chunks(NumChunks);
+  std::vector<uLong> Checksums(NumChunks);
+  std::vector<int> Results(NumChunks);
+  int CLevel = encodeZlibCompressionLevel(Level);
+  parallel_for(0, NumChunks, [&](size_t I) {
+    size_t Begin = I * ChunkSize;
+    StringRef Chunk = InputBuffer.substr(Begin, ChunkSize);
+    StringRef Dictionary = InputBuffer.slice(
+        Begin - std::min(Begin, DictionarySize), Begin);
+    Results[I] = compressChunk(Chunk, Dictionary, I == NumChunks - 1, CLevel,
+                               Chunks[I]);
+    Checksums[I] = adler32(adler32(0, nullptr, 0), (const Bytef *)Chunk.data(),
+                           Chunk.size());
+  }, 1);
+  for (int Res : Results)
+    if (Res != Z_OK)
+      return encodeZlibReturnValue(Res);
+
+  // Wrap the chunks in a zlib header and trailer, as compress2 would: a 32KiB
+  // window, the level and a check making the header a multiple of 31.
+  unsigned LevelFlags = 0;
+  switch (Level) {
+    case NoCompression: case BestSpeedCompression: LevelFlags = 0; break;
+    case DefaultCompression: LevelFlags = 2; break;
+    case BestSizeCompression: LevelFlags = 3; break;
+  }
+  unsigned Header = ((Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8) |
+                    (LevelFlags << 6);
+  Header += 31 - Header % 31;
+
+  uLong Checksum = Checksums[0];
+  size_t Size = 6;
+  for (size_t I = 0; I != NumChunks; ++I) {
+    if (I)
+      Checksum = adler32_combine(
+          Checksum, Checksums[I],
+          z_off_t(std::min(ChunkSize, InputBuffer.size() - I * ChunkSize)));
+    Size += Chunks[I].size();
+  }
+
+  CompressedBuffer.clear();
+  CompressedBuffer.reserve(Size);
+  CompressedBuffer.push_back(char(Header >> 8));
+  CompressedBuffer.push_back(char(Header));
+  for (const SmallVector<char, 0> &Chunk : Chunks)
+    CompressedBuffer.append(Chunk.begin(), Chunk.end());
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    CompressedBuffer.push_back(char(Checksum >> Shift));
+  return StatusOK;
+}
+
 zlib::Status zlib::uncompress(StringRef InputBuffer,
                               SmallVectorImpl<char> &UncompressedBuffer,
                               size_t UncompressedSize) {
@@ -87,6 +192,11 @@ zlib::Status zlib::compress(StringRef InputBuffer,
                             CompressionLevel Level) {
   return zlib::StatusUnsupported;
 }
+zlib::Status zlib::compressParallel(StringRef InputBuffer,
+                                    SmallVectorImpl<char> &CompressedBuffer,
+                                    CompressionLevel Level, size_t ChunkSize) {
+  return zlib::StatusUnsupported;
+}
 zlib::Status zlib::uncompress(StringRef InputBuffer,
                               SmallVectorImpl<char> &UncompressedBuffer,
                               size_t UncompressedSize) {
@@ -15,7 +15,9 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Errc.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Signals.h"
+#include <algorithm>
 #include <system_error>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -111,4 +113,141 @@ std::error_code FileOutputBuffer::commit() {
   sys::DontRemoveFileOnSignal(TempPath);
   return EC;
 }
+
+namespace {
+/// A raw_pwrite_stream writing to a fixed range of memory, which is where
+/// deferred writes produce their contents.
+class raw_range_ostream : public raw_pwrite_stream {
+  char *Start;
+  char *Cur;
+  char *End;
+
+  void write_impl(const char *Ptr, size_t Size) override {
+    assert(Size <= size_t(End - Cur) && "Deferred write overflows its hole");
+    memcpy(Cur, Ptr, Size);
+    Cur += Size;
+  }
+
+  void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) override {
+    memcpy(Start + Offset, Ptr, Size);
+  }
+
+  uint64_t current_pos() const override { return Cur - Start; }
+
+public:
+  raw_range_ostream(char *Start, uint64_t Size)
+      : Start(Start), Cur(Start), End(Start + Size) {
+    SetUnbuffered();
+  }
+
+  bool isFull() const { return Cur == End; }
+};
+} // end anonymous namespace
+
+/// Deferred writes into a mapped output are only filled in parallel when they
+/// add up to at least this many bytes. Below that, starting the threads costs
+/// more than the writes.
+static const uint64_t MinParallelFillSize = 1 << 20;
+
+raw_output_buffer_ostream::raw_output_buffer_ostream(StringRef Path,
+                                                     uint64_t MinMapSize)
+    : Path(Path), MinMapSize(MinMapSize) {
+  SetUnbuffered();
+}
+
+raw_output_buffer_ostream::~raw_output_buffer_ostream() {}
+
+void raw_output_buffer_ostream::write_impl(const char *Ptr, size_t Size) {
+  assert(!Out && "Cannot write after the deferred writes were flushed");
+  Data.append(Ptr, Ptr + Size);
+  Pos += Size;
+}
+
+void raw_output_buffer_ostream::pwrite_impl(const char *Ptr, size_t Size,
+                                            uint64_t Offset) {
+  if (Out) {
+    memcpy(Out + Offset, Ptr, Size);
+    return;
+  }
+
+  // Find where Offset is in Data by skipping the holes before it.
+  uint64_t DataOffset = Offset;
+  for (const DeferredWrite &W : Deferred) {
+    if (W.Offset >= Offset + Size)
+      break;
+    assert(W.Offset + W.Size <= Offset && "Cannot pwrite to a deferred write");
+    DataOffset -= W.Size;
+  }
+  memcpy(Data.data() + DataOffset, Ptr, Size);
+}
+
+void raw_output_buffer_ostream::writeDeferred(uint64_t Size,
+                                              DeferredWriteFn Fill) {
+  assert(!Out && "Cannot write after the deferred writes were flushed");
+  Deferred.push_back({Pos, Size, std::move(Fill)});
+  Pos += Size;
+}
+
+void raw_output_buffer_ostream::flushDeferred() {
+  if (Out)
+    return;
+
+  // Write large outputs straight into the file. If it cannot be mapped,
+  // commit() reports the error when it tries to write the file itself.
+  if (Pos && Pos >= MinMapSize) {
+    auto BufferOrErr = FileOutputBuffer::create(Path, Pos);
+    if (BufferOrErr) {
+      Buffer = std::move(*BufferOrErr);
+      Out = reinterpret_cast<char *>(Buffer->getBufferStart());
+    }
+  }
+  if (!Out) {
+    HeapBuffer.reset(new char[Pos]);
+    Out = HeapBuffer.get();
+  }
+
+  // Copy the plain writes around the holes, then fill the holes.
+  const char *Src = Data.data();
+  uint64_t Offset = 0;
+  uint64_t DeferredSize = 0;
+  for (const DeferredWrite &W : Deferred) {
+    memcpy(Out + Offset, Src, W.Offset - Offset);
+    Src += W.Offset - Offset;
+    Offset = W.Offset + W.Size;
+    DeferredSize += W.Size;
+  }
+  memcpy(Out + Offset, Src, Pos - Offset);
+
+  auto Fill = [&](DeferredWrite &W) {
+    raw_range_ostream OS(Out + W.Offset, W.Size);
+    W.Fill(OS);
+    assert(OS.isFull() && "Deferred write did not fill its hole");
+  };
+  if (Buffer && DeferredSize >= MinParallelFillSize)
+    parallel_for_each(Deferred, Fill);
+  else
+    std::for_each(Deferred.begin(), Deferred.end(), Fill);
+
+  // The callbacks may refer to state that does not outlive this call.
+  Deferred.clear();
+  SmallVector<char, 0>().swap(Data);
+}
+
+std::error_code raw_output_buffer_ostream::commit() {
+  flushDeferred();
+  if (Buffer)
+    return Buffer->commit();
+
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::F_None);
+  if (EC)
+    return EC;
+  OS.write(Out, Pos);
+  OS.close();
+  if (OS.has_error()) {
+    OS.clear_error();
+    return make_error_code(errc::io_error);
+  }
+  return std::error_code();
+}
 } // namespace
@@ -18,6 +18,7 @@
 #include "llvm/Support/Errno.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Memory.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Program.h"
@@ -28,6 +29,7 @@
 #include <sys/types.h>
 #include <system_error>
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
+#include <fcntl.h>
 #include <unistd.h>
 #else
 #include <io.h>
@@ -103,7 +105,8 @@ public:
 
 static ErrorOr<std::unique_ptr<MemoryBuffer>>
 getFileAux(const Twine &Filename, int64_t FileSize, uint64_t MapSize, 
-           uint64_t Offset, bool RequiresNullTerminator, bool IsVolatileSize);
+           uint64_t Offset, bool RequiresNullTerminator, bool IsVolatileSize,
+           const MemoryBuffer::FileHints &Hints);
 
 std::unique_ptr<MemoryBuffer>
 MemoryBuffer::getMemBuffer(StringRef InputData, StringRef BufferName,
@@ -168,18 +171,26 @@ MemoryBuffer::getNewMemBuffer(size_t Size, StringRef BufferName) {
 ErrorOr<std::unique_ptr<MemoryBuffer>>
 MemoryBuffer::getFileOrSTDIN(const Twine &Filename, int64_t FileSize,
                              bool RequiresNullTerminator) {
+  return getFileOrSTDIN(Filename, FileHints(), FileSize,
+                        RequiresNullTerminator);
+}
+
+ErrorOr<std::unique_ptr<MemoryBuffer>>
+MemoryBuffer::getFileOrSTDIN(const Twine &Filename, const FileHints &Hints,
+                             int64_t FileSize, bool RequiresNullTerminator) {
   SmallString<256> NameBuf;
   StringRef NameRef = Filename.toStringRef(NameBuf);
 
   if (NameRef == "-")
     return getSTDIN();
-  return getFile(Filename, FileSize, RequiresNullTerminator);
+  return getFile(Filename, Hints, FileSize, RequiresNullTerminator);
 }
 
 ErrorOr<std::unique_ptr<MemoryBuffer>>
 MemoryBuffer::getFileSlice(const Twine &FilePath, uint64_t MapSize, 
                            uint64_t Offset) {
-  return getFileAux(FilePath, -1, MapSize, Offset, false, false);
+  return getFileAux(FilePath, -1, MapSize, Offset, false, false,
+                    FileHints());
 }
 
 
@@ -208,12 +219,16 @@ class MemoryBufferMMapFile : public MemoryBuffer {
 
 public:
   MemoryBufferMMapFile(bool RequiresNullTerminator, int FD, uint64_t Len,
-                       uint64_t Offset, std::error_code &EC)
+                       uint64_t Offset, const FileHints &Hints,
+                       std::error_code &EC)
       : MFR(FD, sys::fs::mapped_file_region::readonly,
-            getLegalMapSize(Len, Offset), getLegalMapOffset(Offset), EC) {
+            getLegalMapSize(Len, Offset), getLegalMapOffset(Offset), EC,
+            Hints.MapFlags) {
     if (!EC) {
       const char *Start = getStart(Len, Offset);
       init(Start, Start + Len, RequiresNullTerminator);
+      if (Hints.ReadAheadSize)
+        sys::Memory::prefetchRange(Start, std::min(Len, Hints.ReadAheadSize));
     }
   }
 
@@ -256,17 +271,26 @@ ErrorOr<std::unique_ptr<MemoryBuffer>>
 MemoryBuffer::getFile(const Twine &Filename, int64_t FileSize,
                       bool RequiresNullTerminator, bool IsVolatileSize) {
   return getFileAux(Filename, FileSize, FileSize, 0,
-                    RequiresNullTerminator, IsVolatileSize);
+                    RequiresNullTerminator, IsVolatileSize, FileHints());
+}
+
+ErrorOr<std::unique_ptr<MemoryBuffer>>
+MemoryBuffer::getFile(const Twine &Filename, const FileHints &Hints,
+                      int64_t FileSize, bool RequiresNullTerminator,
+                      bool IsVolatileSize) {
+  return getFileAux(Filename, FileSize, FileSize, 0,
+                    RequiresNullTerminator, IsVolatileSize, Hints);
 }
 
 static ErrorOr<std::unique_ptr<MemoryBuffer>>
 getOpenFileImpl(int FD, const Twine &Filename, uint64_t FileSize,
                 uint64_t MapSize, int64_t Offset, bool RequiresNullTerminator,
-                bool IsVolatileSize);
+                bool IsVolatileSize, const MemoryBuffer::FileHints &Hints);
 
 static ErrorOr<std::unique_ptr<MemoryBuffer>>
 getFileAux(const Twine &Filename, int64_t FileSize, uint64_t MapSize,
-           uint64_t Offset, bool RequiresNullTerminator, bool IsVolatileSize) {
+           uint64_t Offset, bool RequiresNullTerminator, bool IsVolatileSize,
+           const MemoryBuffer::FileHints &Hints) {
   int FD;
   std::error_code EC = sys::fs::openFileForRead(Filename, FD);
   if (EC)
@@ -274,7 +298,7 @@ getFileAux(const Twine &Filename, int64_t FileSize, uint64_t MapSize,
 
   ErrorOr<std::unique_ptr<MemoryBuffer>> Ret =
       getOpenFileImpl(FD, Filename, FileSize, MapSize, Offset,
-                      RequiresNullTerminator, IsVolatileSize);
+                      RequiresNullTerminator, IsVolatileSize, Hints);
   close(FD);
   return Ret;
 }
@@ -338,7 +362,7 @@ static bool shouldUseMmap(int FD,
 static ErrorOr<std::unique_ptr<MemoryBuffer>>
 getOpenFileImpl(int FD, const Twine &Filename, uint64_t FileSize,
                 uint64_t MapSize, int64_t Offset, bool RequiresNullTerminator,
-                bool IsVolatileSize) {
+                bool IsVolatileSize, const MemoryBuffer::FileHints &Hints) {
   static int PageSize = sys::Process::getPageSize();
 
   // Default is to map the full file.
@@ -369,11 +393,20 @@ getOpenFileImpl(int FD, const Twine &Filename, uint64_t FileSize,
     std::error_code EC;
     std::unique_ptr<MemoryBuffer> Result(
         new (NamedBufferAlloc(Filename))
-        MemoryBufferMMapFile(RequiresNullTerminator, FD, MapSize, Offset, EC));
+        MemoryBufferMMapFile(RequiresNullTerminator, FD, MapSize, Offset,
+                             Hints, EC));
     if (!EC)
       return std::move(Result);
   }
 
+#if defined(POSIX_FADV_SEQUENTIAL) && defined(POSIX_FADV_RANDOM)
+  // Tell the page cache how the file is going to be read.
+  if (Hints.MapFlags & sys::fs::mapped_file_region::sequential)
+    ::posix_fadvise(FD, Offset, MapSize, POSIX_FADV_SEQUENTIAL);
+  else if (Hints.MapFlags & sys::fs::mapped_file_region::random)
+    ::posix_fadvise(FD, Offset, MapSize, POSIX_FADV_RANDOM);
+#endif
+
   std::unique_ptr<MemoryBuffer> Buf =
       MemoryBuffer::getNewUninitMemBuffer(MapSize, Filename);
   if (!Buf) {
@@ -417,7 +450,7 @@ ErrorOr<std::unique_ptr<MemoryBuffer>>
 MemoryBuffer::getOpenFile(int FD, const Twine &Filename, uint64_t FileSize,
                           bool RequiresNullTerminator, bool IsVolatileSize) {
   return getOpenFileImpl(FD, Filename, FileSize, FileSize, 0,
-                         RequiresNullTerminator, IsVolatileSize);
+                         RequiresNullTerminator, IsVolatileSize, FileHints());
 }
 
 ErrorOr<std::unique_ptr<MemoryBuffer>>
@@ -425,7 +458,7 @@ MemoryBuffer::getOpenFileSlice(int FD, const Twine &Filename, uint64_t MapSize,
                                int64_t Offset) {
   assert(MapSize != uint64_t(-1));
   return getOpenFileImpl(FD, Filename, -1, MapSize, Offset, false,
-                         /*IsVolatileSize*/ false);
+                         /*IsVolatileSize*/ false, FileHints());
 }
 
 ErrorOr<std::unique_ptr<MemoryBuffer>> MemoryBuffer::getSTDIN() {
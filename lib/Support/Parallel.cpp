@@ -0,0 +1,100 @@
+//===- llvm/Support/Parallel.cpp - Parallel algorithms --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the executor the parallel algorithms share, on top
+// of a work-stealing ThreadPool.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/Parallel.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/thread.h"
+
+using namespace llvm;
+using namespace llvm::parallel;
+
+unsigned llvm::parallel::ThreadsRequested = 0;
+
+static cl::opt<unsigned, true> ThreadsOpt(
+    "threads", cl::location(ThreadsRequested),
+    cl::desc("Number of threads for parallel work (0 uses one per hardware "
+             "thread; 1 does the work sequentially on the calling thread)"));
+
+unsigned llvm::parallel::getThreadCount() {
+#if LLVM_ENABLE_THREADS
+  if (ThreadsRequested)
+    return ThreadsRequested;
+  return std::max(1u, llvm::thread::hardware_concurrency());
+#else
+  return 1;
+#endif
+}
+
+namespace {
+/// The executor: the calling thread runs tasks too while it waits for them.
+struct Executor : ThreadPool {
+  Executor() : ThreadPool(getThreadCount() - 1) {}
+};
+} // end anonymous namespace
+
+static ManagedStatic<Executor> DefaultExecutor;
+
+bool parallel::detail::isParallel() { return getThreadCount() > 1; }
+
+parallel::detail::TaskGroup::TaskGroup() {
+  if (detail::isParallel())
+    Group = llvm::make_unique<ThreadPoolTaskGroup>(*DefaultExecutor);
+}
+
+parallel::detail::TaskGroup::~TaskGroup() { sync(); }
+
+void parallel::detail::TaskGroup::spawn(std::function<void()> F) {
+  if (!Group) {
+    F();
+    return;
+  }
+  Group->async(std::move(F));
+}
+
+void parallel::detail::TaskGroup::sync() {
+  if (Group)
+    Group->wait();
+}
+
+size_t parallel::detail::getTaskSize(size_t NumItems, size_t GrainSize) {
+  if (GrainSize)
+    return GrainSize;
+  return std::max<size_t>(1, NumItems / MaxTasksPerGroup);
+}
+
+void llvm::parallel_for(size_t Begin, size_t End,
+                        function_ref<void(size_t)> Fn, size_t GrainSize) {
+  if (Begin >= End)
+    return;
+  parallel::detail::TaskGroup TG;
+  if (!TG.isParallel()) {
+    for (size_t I = Begin; I != End; ++I)
+      Fn(I);
+    return;
+  }
+
+  // The calling thread takes the last chunk, so a range of a single chunk
+  // does not go through the executor at all.
+  size_t TaskSize = parallel::detail::getTaskSize(End - Begin, GrainSize);
+  for (; End - Begin > TaskSize; Begin += TaskSize)
+    TG.spawn([=] {
+      for (size_t I = Begin, E = Begin + TaskSize; I != E; ++I)
+        Fn(I);
+    });
+  for (size_t I = Begin; I != End; ++I)
+    Fn(I);
+}
@@ -22,7 +22,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
@@ -47,6 +49,59 @@ static cl::opt<bool> StatsAsJSON("stats-json",
                                  cl::desc("Display statistics as json data"));
 
 namespace {
+enum : unsigned {
+  /// The counters of a thread are allocated in chunks of this many
+  /// statistics, the first time one of them is bumped on the thread.
+  CountersPerChunk = 512,
+  /// Statistics beyond MaxCounterChunks * CountersPerChunk are counted
+  /// directly in Statistic::Value.
+  MaxCounterChunks = 64
+};
+
+/// StatisticCounters - The copies of the statistics that one thread bumps
+/// while working on one module, indexed by Statistic::Index. Only the owning
+/// thread writes them. They are read under StatLock when the statistics are
+/// added up.
+struct StatisticCounters {
+  unsigned Module;
+  /// The next counters of the same thread, for the other modules.
+  StatisticCounters *NextInThread;
+  std::atomic<std::atomic<unsigned> *> Chunks[MaxCounterChunks];
+
+  StatisticCounters(unsigned Module, StatisticCounters *NextInThread)
+      : Module(Module), NextInThread(NextInThread) {
+    for (auto &Chunk : Chunks)
+      Chunk.store(nullptr, std::memory_order_relaxed);
+  }
+
+  ~StatisticCounters() {
+    for (auto &Chunk : Chunks)
+      delete[] Chunk.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<unsigned> &getCounter(unsigned Index) {
+    auto &Chunk = Chunks[Index / CountersPerChunk];
+    std::atomic<unsigned> *Counters = Chunk.load(std::memory_order_relaxed);
+    if (!Counters) {
+      Counters = new std::atomic<unsigned>[CountersPerChunk]();
+      Chunk.store(Counters, std::memory_order_release);
+    }
+    return Counters[Index % CountersPerChunk];
+  }
+
+  /// Return the value of statistic \p Index in these counters. Called from
+  /// any thread.
+  unsigned getValue(unsigned Index) const {
+    if (Index >= MaxCounterChunks * CountersPerChunk)
+      return 0;
+    std::atomic<unsigned> *Counters =
+        Chunks[Index / CountersPerChunk].load(std::memory_order_acquire);
+    if (!Counters)
+      return 0;
+    return Counters[Index % CountersPerChunk].load(std::memory_order_relaxed);
+  }
+};
+
 /// StatisticInfo - This class is used in a ManagedStatic so that it is created
 /// on demand (when the first statistic is bumped) and destroyed only when
 /// llvm_shutdown is called.  We print statistics from the destructor.
@@ -59,17 +114,67 @@ class StatisticInfo {
   /// Sort statistics by debugtype,name,description.
   void sort();
 public:
+  /// The number of statistics that were given an index.
+  unsigned NumIndices = 0;
+
+  /// The counters of every thread and module, including the threads that
+  /// have exited.
+  std::vector<std::unique_ptr<StatisticCounters>> Counters;
+
+  /// The identifiers of the modules. Module 0 stands for the work done
+  /// outside of any StatisticModuleScope.
+  std::vector<std::string> Modules;
+  StringMap<unsigned> ModuleIDs;
+
+  StatisticInfo() : Modules(1) {}
   ~StatisticInfo();
 
   void addStatistic(const Statistic *S) {
     Stats.push_back(S);
   }
+
+  /// Return the value of \p S in module \p Module, or in all the modules if
+  /// \p Module is -1.
+  unsigned getValue(const Statistic &S, unsigned Module = -1u) const;
 };
 }
 
 static ManagedStatic<StatisticInfo> StatInfo;
 static ManagedStatic<sys::SmartMutex<true> > StatLock;
 
+/// Incremented when StatInfo is destroyed, so that the threads drop their
+/// pointers to its counters.
+static std::atomic<unsigned> StatInfoGeneration(0);
+
+/// The counters of the current thread, for each module it worked on.
+static LLVM_THREAD_LOCAL StatisticCounters *ThreadCounters = nullptr;
+/// The counters of the current thread for CurrentModule, if already looked
+/// up.
+static LLVM_THREAD_LOCAL StatisticCounters *CurrentCounters = nullptr;
+static LLVM_THREAD_LOCAL unsigned CurrentModule = 0;
+static LLVM_THREAD_LOCAL unsigned ThreadGeneration = 0;
+
+/// Return the counters of the current thread for the current module.
+static StatisticCounters &getCurrentCounters() {
+  unsigned Generation = StatInfoGeneration.load(std::memory_order_relaxed);
+  if (LLVM_UNLIKELY(ThreadGeneration != Generation)) {
+    ThreadCounters = CurrentCounters = nullptr;
+    ThreadGeneration = Generation;
+  }
+  if (LLVM_LIKELY(CurrentCounters != nullptr))
+    return *CurrentCounters;
+
+  for (StatisticCounters *C = ThreadCounters; C; C = C->NextInThread)
+    if (C->Module == CurrentModule)
+      return *(CurrentCounters = C);
+
+  sys::SmartScopedLock<true> Writer(*StatLock);
+  StatInfo->Counters.emplace_back(
+      new StatisticCounters(CurrentModule, ThreadCounters));
+  ThreadCounters = CurrentCounters = StatInfo->Counters.back().get();
+  return *CurrentCounters;
+}
+
 /// RegisterStatistic - The first time a statistic is bumped, this method is
 /// called.
 void Statistic::RegisterStatistic() {
@@ -79,6 +184,7 @@ void Statistic::RegisterStatistic() {
   if (!Initialized) {
     if (Enabled)
       StatInfo->addStatistic(this);
+    Index = StatInfo->NumIndices++;
 
     TsanHappensBefore(this);
     sys::MemoryFence();
@@ -89,9 +195,74 @@ void Statistic::RegisterStatistic() {
   }
 }
 
+void Statistic::addValue(unsigned Delta) {
+  if (Index >= MaxCounterChunks * CountersPerChunk) {
+    Value.fetch_add(Delta, std::memory_order_relaxed);
+    return;
+  }
+  // Only this thread writes its counter: no need for an atomic add.
+  std::atomic<unsigned> &Counter = getCurrentCounters().getCounter(Index);
+  Counter.store(Counter.load(std::memory_order_relaxed) + Delta,
+                std::memory_order_relaxed);
+}
+
+void Statistic::setValue(unsigned Val) {
+  sys::SmartScopedLock<true> Writer(*StatLock);
+  for (auto &C : StatInfo->Counters)
+    if (Index < MaxCounterChunks * CountersPerChunk)
+      if (std::atomic<unsigned> *Chunk =
+              C->Chunks[Index / CountersPerChunk].load(
+                  std::memory_order_acquire))
+        Chunk[Index % CountersPerChunk].store(0, std::memory_order_relaxed);
+  Value.store(Val, std::memory_order_relaxed);
+}
+
+unsigned Statistic::getValue() const {
+  unsigned Val = Value.load(std::memory_order_relaxed);
+  if (!Initialized)
+    return Val;
+  sys::SmartScopedLock<true> Reader(*StatLock);
+  return Val + StatInfo->getValue(*this);
+}
+
+unsigned StatisticInfo::getValue(const Statistic &S, unsigned Module) const {
+  unsigned Val = 0;
+  for (auto &C : Counters)
+    if (Module == -1u || C->Module == Module)
+      Val += C->getValue(S.Index);
+  return Val;
+}
+
+StatisticModuleScope::StatisticModuleScope(StringRef Name)
+    : PrevModule(CurrentModule) {
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
+  // Only -stats prints the statistics of each module. Without it, do not
+  // take the lock nor record the module.
+  if (!Enabled)
+    return;
+  {
+    sys::SmartScopedLock<true> Writer(*StatLock);
+    auto Inserted = StatInfo->ModuleIDs.insert(
+        std::make_pair(Name, unsigned(StatInfo->Modules.size())));
+    if (Inserted.second)
+      StatInfo->Modules.push_back(Name);
+    CurrentModule = Inserted.first->second;
+  }
+  CurrentCounters = nullptr;
+#endif
+}
+
+StatisticModuleScope::~StatisticModuleScope() {
+  if (CurrentModule == PrevModule)
+    return;
+  CurrentModule = PrevModule;
+  CurrentCounters = nullptr;
+}
+
 // Print information when destroyed, iff command line option is specified.
 StatisticInfo::~StatisticInfo() {
   llvm::PrintStatistics();
+  StatInfoGeneration.fetch_add(1, std::memory_order_relaxed);
 }
 
 void llvm::EnableStatistics() {
@@ -116,6 +287,7 @@ void StatisticInfo::sort() {
 }
 
 void llvm::PrintStatistics(raw_ostream &OS) {
+  sys::SmartScopedLock<true> Reader(*StatLock);
   StatisticInfo &Stats = *StatInfo;
 
   // Figure out how long the biggest Value and Name fields are.
@@ -145,34 +317,50 @@ void llvm::PrintStatistics(raw_ostream &OS) {
   OS.flush();
 }
 
-static void write_json_string_escaped(raw_ostream &OS, const char *string) {
-  // Out current usage should not need any escaping. Keep it simple and just
-  // check that the input is pure ASCII without special characers.
-#ifndef NDEBUG
-  for (const unsigned char *c = (const unsigned char*)string; *c != '\0'; ++c) {
-    assert(*c != '\\' && *c != '\"' && *c >= 0x20 && *c < 0x80);
+/// Print the statistics of \p Module, or the totals if \p Module is -1, as
+/// the members of a JSON object. Statistics that are zero in a module are
+/// left out of its object.
+static void printStatisticsJSON(raw_ostream &OS, const StatisticInfo &Info,
+                                ArrayRef<const Statistic *> Stats,
+                                unsigned Module, const char *Indent) {
+  const char *delim = "";
+  for (const Statistic *Stat : Stats) {
+    unsigned Value = Info.getValue(*Stat, Module);
+    if (Module == -1u)
+      Value += Stat->Value.load(std::memory_order_relaxed);
+    else if (Value == 0)
+      continue;
+    OS << delim << Indent;
+    OS.write_json_string(std::string(Stat->getDebugType()) + '.' +
+                         Stat->getName());
+    OS << ": " << Value;
+    delim = ",\n";
   }
-#endif
-  OS << string;
 }
 
 void llvm::PrintStatisticsJSON(raw_ostream &OS) {
+  sys::SmartScopedLock<true> Reader(*StatLock);
   StatisticInfo &Stats = *StatInfo;
 
   Stats.sort();
 
-  // Print all of the statistics.
+  // Print the totals, then the statistics of each module that had any.
   OS << "{\n";
-  const char *delim = "";
-  for (const Statistic *Stat : Stats.Stats) {
-    OS << delim;
-    OS << "\t\"";
-    write_json_string_escaped(OS, Stat->getDebugType());
-    OS << '.';
-    write_json_string_escaped(OS, Stat->getName());
-    OS << "\": " << Stat->getValue();
-    delim = ",\n";
+  printStatisticsJSON(OS, Stats, Stats.Stats, -1u, "\t");
+  bool HasModules = false;
+  for (unsigned M = 1, E = Stats.Modules.size(); M != E; ++M) {
+    std::string ModuleStats;
+    raw_string_ostream MOS(ModuleStats);
+    printStatisticsJSON(MOS, Stats, Stats.Stats, M, "\t\t\t");
+    if (MOS.str().empty())
+      continue;
+    OS << (HasModules ? ",\n\t\t" : ",\n\t\"modules\": {\n\t\t");
+    OS.write_json_string(Stats.Modules[M]);
+    OS << ": {\n" << ModuleStats << "\n\t\t}";
+    HasModules = true;
   }
+  if (HasModules)
+    OS << "\n\t}";
   OS << "\n}\n";
   OS.flush();
 }
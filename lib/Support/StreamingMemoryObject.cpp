@@ -8,6 +8,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/StreamingMemoryObject.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Memory.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstring>
@@ -36,6 +39,16 @@ private:
   const uint8_t* const FirstChar;
   const uint8_t* const LastChar;
 
+  /// The bitstream reader mostly reads forward. Ask the host to read in the
+  /// next PrefetchWindow bytes whenever the reads get within half a window of
+  /// the end of the range already requested, so that a large mapped file is
+  /// not faulted in one page at a time.
+  enum : uint64_t { PrefetchWindow = 8 << 20 };
+  mutable uint64_t PrefetchBegin = 0;
+  mutable uint64_t PrefetchEnd = 0;
+
+  void prefetchFrom(uint64_t Address) const;
+
   // These are implemented as inline functions here to avoid multiple virtual
   // calls per public function
   bool validAddress(uint64_t address) const {
@@ -58,10 +71,29 @@ uint64_t RawMemoryObject::readBytes(uint8_t *Buf, uint64_t Size,
 
   assert(static_cast<int64_t>(End - Address) >= 0);
   Size = End - Address;
+  if (LLVM_UNLIKELY(Address < PrefetchBegin ||
+                    (PrefetchEnd < BufferSize &&
+                     Address + PrefetchWindow / 2 > PrefetchEnd)) &&
+      BufferSize > PrefetchWindow)
+    prefetchFrom(Address);
   memcpy(Buf, Address + FirstChar, Size);
   return Size;
 }
 
+void RawMemoryObject::prefetchFrom(uint64_t Address) const {
+  // Extend the current window if the reads are still inside it, or start a
+  // new one after a jump.
+  uint64_t Start = Address;
+  if (Address >= PrefetchBegin && Address < PrefetchEnd)
+    Start = PrefetchEnd;
+  else
+    PrefetchBegin = Address;
+  PrefetchEnd = std::min<uint64_t>(Address + PrefetchWindow,
+                                   LastChar - FirstChar);
+  if (PrefetchEnd > Start)
+    sys::Memory::prefetchRange(FirstChar + Start, PrefetchEnd - Start);
+}
+
 const uint8_t *RawMemoryObject::getPointer(uint64_t address,
                                            uint64_t size) const {
   return FirstChar + address;
@@ -7,136 +7,197 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file implements a crude C++11 based thread pool.
+// This file implements a C++11 based work-stealing thread pool.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/ThreadPool.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <iterator>
 
 using namespace llvm;
 
-#if LLVM_ENABLE_THREADS
+/// The pool the current thread belongs to, if any, and the index of its deque.
+static LLVM_THREAD_LOCAL const ThreadPool *CurrentPool = nullptr;
+static LLVM_THREAD_LOCAL unsigned CurrentIndex = 0;
 
+#if LLVM_ENABLE_THREADS
 // Default to std::thread::hardware_concurrency
 ThreadPool::ThreadPool() : ThreadPool(std::thread::hardware_concurrency()) {}
-
-ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0), EnableFlag(true) {
-  // Create ThreadCount threads that will loop forever, wait on QueueCondition
-  // for tasks to be queued or the Pool to be destroyed.
-  Threads.reserve(ThreadCount);
-  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
-    Threads.emplace_back([&] {
-      while (true) {
-        PackagedTaskTy Task;
-        {
-          std::unique_lock<std::mutex> LockGuard(QueueLock);
-          // Wait for tasks to be pushed in the queue
-          QueueCondition.wait(LockGuard,
-                              [&] { return !EnableFlag || !Tasks.empty(); });
-          // Exit condition
-          if (!EnableFlag && Tasks.empty())
-            return;
-          // Yeah, we have a task, grab it and release the lock on the queue
-
-          // We first need to signal that we are active before popping the queue
-          // in order for wait() to properly detect that even if the queue is
-          // empty, there is still a task in flight.
-          {
-            ++ActiveThreads;
-            std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          }
-          Task = std::move(Tasks.front());
-          Tasks.pop();
-        }
-        // Run the task we just grabbed
-#ifndef _MSC_VER
-        Task();
 #else
-        Task(/* unused */ false);
+ThreadPool::ThreadPool() : ThreadPool(0) {}
 #endif
 
-        {
-          // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
-          std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          --ActiveThreads;
-        }
-
-        // Notify task completion, in case someone waits on ThreadPool::wait()
-        CompletionCondition.notify_all();
-      }
-    });
+ThreadPool::ThreadPool(unsigned ThreadCount)
+    : NextQueue(0), QueuedTasks(0), UnfinishedTasks(0), SleepingThreads(0),
+      Waiters(0), EnableFlag(true) {
+#if !LLVM_ENABLE_THREADS
+  // No threads are launched, issue a warning if ThreadCount is not 0
+  if (ThreadCount) {
+    errs() << "Warning: request a ThreadPool with " << ThreadCount
+           << " threads, but LLVM_ENABLE_THREADS has been turned off\n";
+    ThreadCount = 0;
   }
+#endif
+  // Without threads, the tasks wait in a single deque for wait() to run them.
+  unsigned NumQueues = std::max(1u, ThreadCount);
+  Queues.reserve(NumQueues);
+  for (unsigned I = 0; I != NumQueues; ++I)
+    Queues.push_back(llvm::make_unique<WorkerQueue>());
+
+  // Create ThreadCount threads that will loop until the Pool is destroyed,
+  // running tasks or waiting on QueueCondition for some to be queued.
+  Threads.reserve(ThreadCount);
+  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID)
+    Threads.emplace_back([this, ThreadID] { work(ThreadID); });
 }
 
-void ThreadPool::wait() {
-  // Wait for all threads to complete and the queue to be empty
-  std::unique_lock<std::mutex> LockGuard(CompletionLock);
-  // The order of the checks for ActiveThreads and Tasks.empty() matters because
-  // any active threads might be modifying the Tasks queue, and this would be a
-  // race.
-  CompletionCondition.wait(LockGuard,
-                           [&] { return !ActiveThreads && Tasks.empty(); });
+bool ThreadPool::isWorkerThread() const { return CurrentPool == this; }
+
+void ThreadPool::work(unsigned Index) {
+  CurrentPool = this;
+  CurrentIndex = Index;
+  while (true) {
+    if (runOneTask(nullptr))
+      continue;
+
+    // Nothing to do: sleep until a task is queued or the pool is destroyed.
+    // The counter tells asyncImpl() to take the lock and signal.
+    bool Exit;
+    ++SleepingThreads;
+    {
+      std::unique_lock<std::mutex> LockGuard(QueueLock);
+      QueueCondition.wait(LockGuard,
+                          [&] { return !EnableFlag || QueuedTasks; });
+      Exit = !EnableFlag && !QueuedTasks;
+    }
+    --SleepingThreads;
+    if (Exit) {
+      // Hand the slabs the tasks freed on this thread over to the others.
+      SlabCacheAllocator::releaseThreadCache();
+      return;
+    }
+  }
 }
 
-std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
-  /// Wrap the Task in a packaged_task to return a future object.
-  PackagedTaskTy PackagedTask(std::move(Task));
-  auto Future = PackagedTask.get_future();
-  {
-    // Lock the queue and push the new task
-    std::unique_lock<std::mutex> LockGuard(QueueLock);
+bool ThreadPool::runOneTask(ThreadPoolTaskGroup *Group) {
+  if (Group ? !Group->Queued : !QueuedTasks)
+    return false;
+
+  // A thread of the pool looks at its own deque first and uses it as a
+  // stack: the task it queued last is the most likely to be in its caches.
+  // It steals from the other end of the other deques.
+  bool IsWorker = isWorkerThread();
+  unsigned NumQueues = Queues.size();
+  unsigned Start = IsWorker ? CurrentIndex : NextQueue.load() % NumQueues;
+  auto IsInGroup = [Group](const QueuedTask &T) { return T.Group == Group; };
+  QueuedTask Task;
+  bool Found = false;
+  for (unsigned I = 0; I != NumQueues && !Found; ++I) {
+    WorkerQueue &Queue = *Queues[(Start + I) % NumQueues];
+    std::unique_lock<std::mutex> LockGuard(Queue.Lock);
+    if (Queue.Tasks.empty())
+      continue;
+    if (Group) {
+      // Look for the task of the group closest to the end we take from.
+      auto It = Queue.Tasks.end();
+      if (IsWorker && I == 0) {
+        auto RIt = std::find_if(Queue.Tasks.rbegin(), Queue.Tasks.rend(),
+                                IsInGroup);
+        if (RIt != Queue.Tasks.rend())
+          It = std::prev(RIt.base());
+      } else {
+        It = std::find_if(Queue.Tasks.begin(), Queue.Tasks.end(), IsInGroup);
+      }
+      if (It == Queue.Tasks.end())
+        continue;
+      Task = std::move(*It);
+      Queue.Tasks.erase(It);
+    } else if (IsWorker && I == 0) {
+      Task = std::move(Queue.Tasks.back());
+      Queue.Tasks.pop_back();
+    } else {
+      Task = std::move(Queue.Tasks.front());
+      Queue.Tasks.pop_front();
+    }
+    Found = true;
+  }
+  if (!Found)
+    return false;
+  if (Task.Group)
+    --Task.Group->Queued;
+  --QueuedTasks;
 
-    // Don't allow enqueueing after disabling the pool
-    assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+  // Run the task we just grabbed
+#ifndef _MSC_VER
+  Task.Task();
+#else
+  Task.Task(/* unused */ false);
+#endif
 
-    Tasks.push(std::move(PackagedTask));
-  }
-  QueueCondition.notify_one();
-  return Future.share();
+  // The group may be destroyed as soon as its last task is done.
+  if (Task.Group)
+    --Task.Group->Pending;
+  --UnfinishedTasks;
+  notifyWaiters();
+  return true;
 }
 
-// The destructor joins all threads, waiting for completion.
-ThreadPool::~ThreadPool() {
-  {
-    std::unique_lock<std::mutex> LockGuard(QueueLock);
-    EnableFlag = false;
-  }
-  QueueCondition.notify_all();
-  for (auto &Worker : Threads)
-    Worker.join();
+void ThreadPool::notifyWaiters() {
+  // The waiters register before checking for completion, so either they see
+  // the update or we see them.
+  if (!Waiters)
+    return;
+  { std::unique_lock<std::mutex> LockGuard(CompletionLock); }
+  CompletionCondition.notify_all();
 }
 
-#else // LLVM_ENABLE_THREADS Disabled
-
-ThreadPool::ThreadPool() : ThreadPool(0) {}
-
-// No threads are launched, issue a warning if ThreadCount is not 0
-ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0) {
-  if (ThreadCount) {
-    errs() << "Warning: request a ThreadPool with " << ThreadCount
-           << " threads, but LLVM_ENABLE_THREADS has been turned off\n";
+void ThreadPool::wait() {
+  assert(!isWorkerThread() && "ThreadPool::wait() called from a task");
+  // Help running the tasks, then wait for the ones running on other threads.
+  while (UnfinishedTasks) {
+    if (runOneTask(nullptr))
+      continue;
+    ++Waiters;
+    {
+      std::unique_lock<std::mutex> LockGuard(CompletionLock);
+      CompletionCondition.wait(
+          LockGuard, [&] { return !UnfinishedTasks || QueuedTasks; });
+    }
+    --Waiters;
   }
 }
 
-void ThreadPool::wait() {
-  // Sequential implementation running the tasks
-  while (!Tasks.empty()) {
-    auto Task = std::move(Tasks.front());
-    Tasks.pop();
-#ifndef _MSC_VER
-        Task();
-#else
-        Task(/* unused */ false);
-#endif
+void ThreadPool::wait(ThreadPoolTaskGroup &Group) {
+  // Only the tasks of the group are run here: another task could take long,
+  // or wait for the current thread. The tasks of the group that are already
+  // running on other threads are waited for.
+  while (Group.Pending) {
+    if (runOneTask(&Group))
+      continue;
+    ++Waiters;
+    {
+      std::unique_lock<std::mutex> LockGuard(CompletionLock);
+      CompletionCondition.wait(
+          LockGuard, [&] { return !Group.Pending || Group.Queued; });
+    }
+    --Waiters;
   }
 }
 
-std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
+std::shared_future<ThreadPool::VoidTy>
+ThreadPool::asyncImpl(TaskTy Task, ThreadPoolTaskGroup *Group) {
+#if LLVM_ENABLE_THREADS
+  /// Wrap the Task in a packaged_task to return a future object.
+  PackagedTaskTy PackagedTask(std::move(Task));
+  auto Future = PackagedTask.get_future().share();
+#else
 #ifndef _MSC_VER
   // Get a Future with launch::deferred execution using std::async
   auto Future = std::async(std::launch::deferred, std::move(Task)).share();
@@ -147,12 +208,43 @@ std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
   auto Future = std::async(std::launch::deferred, std::move(Task), false).share();
   PackagedTaskTy PackagedTask([Future](bool) -> bool { Future.get(); return false; });
 #endif
-  Tasks.push(std::move(PackagedTask));
+#endif
+
+  // Don't allow enqueueing after disabling the pool
+  assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+  if (Group)
+    ++Group->Pending;
+  ++UnfinishedTasks;
+  // Count the task before it is visible, so the counters never go below the
+  // number of tasks in the deques.
+  if (Group)
+    ++Group->Queued;
+  ++QueuedTasks;
+  WorkerQueue &Queue = isWorkerThread()
+                           ? *Queues[CurrentIndex]
+                           : *Queues[NextQueue++ % Queues.size()];
+  {
+    std::unique_lock<std::mutex> LockGuard(Queue.Lock);
+    Queue.Tasks.emplace_back(std::move(PackagedTask), Group);
+  }
+
+  // Wake up a sleeping thread and the waiters, which help running tasks.
+  if (SleepingThreads) {
+    { std::unique_lock<std::mutex> LockGuard(QueueLock); }
+    QueueCondition.notify_one();
+  }
+  notifyWaiters();
   return Future;
 }
 
+// The destructor joins all threads, waiting for completion.
 ThreadPool::~ThreadPool() {
   wait();
+  {
+    std::unique_lock<std::mutex> LockGuard(QueueLock);
+    EnableFlag = false;
+  }
+  QueueCondition.notify_all();
+  for (auto &Worker : Threads)
+    Worker.join();
 }
-
-#endif
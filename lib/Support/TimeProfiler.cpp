@@ -0,0 +1,256 @@
+//===-- TimeProfiler.cpp - Hierarchical Time Profiler ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the hierarchical time profiler, which writes the
+// sections it records in the Chrome trace event format.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace llvm;
+using namespace std::chrono;
+
+namespace llvm {
+TimeTraceProfiler *TimeTraceProfilerInstance = nullptr;
+}
+
+namespace {
+typedef steady_clock ClockType;
+typedef ClockType::time_point TimePointType;
+typedef microseconds DurationType;
+
+/// A section of the trace.
+struct Entry {
+  TimePointType Start;
+  DurationType Duration;
+  std::string Name;
+  std::string Detail;
+
+  Entry(TimePointType Start, std::string Name, std::string Detail)
+      : Start(Start), Duration(0), Name(std::move(Name)),
+        Detail(std::move(Detail)) {}
+};
+
+/// The sections of one thread.
+struct ThreadTrace {
+  /// The profiler this trace belongs to, see CurrentThread.
+  unsigned Generation;
+  /// The sections that have begun but not ended yet, innermost last.
+  SmallVector<Entry, 16> Stack;
+  /// The sections that ended and are long enough to be written.
+  std::vector<Entry> Entries;
+  /// The number of outermost sections of each name and their total duration.
+  StringMap<std::pair<size_t, DurationType>> CountAndTotal;
+
+  explicit ThreadTrace(unsigned Generation) : Generation(Generation) {}
+};
+
+/// The trace of the current thread, which may belong to a profiler that has
+/// been cleaned up since.
+LLVM_THREAD_LOCAL ThreadTrace *CurrentThread = nullptr;
+
+/// Distinguishes the profilers, so that a thread notices CurrentThread is
+/// stale after a cleanup, even if a new profiler has the same address.
+unsigned LastGeneration = 0;
+} // end anonymous namespace
+
+namespace llvm {
+struct TimeTraceProfiler {
+  TimeTraceProfiler(unsigned TimeTraceGranularity, StringRef ProcName)
+      : Generation(++LastGeneration), StartTime(ClockType::now()),
+        BeginningOfTime(system_clock::now()), ProcName(ProcName),
+        TimeTraceGranularity(TimeTraceGranularity) {}
+
+  ThreadTrace &getThreadTrace() {
+    ThreadTrace *T = CurrentThread;
+    if (T && T->Generation == Generation)
+      return *T;
+    std::lock_guard<std::mutex> Lock(ThreadsLock);
+    Threads.push_back(llvm::make_unique<ThreadTrace>(Generation));
+    CurrentThread = Threads.back().get();
+    return *CurrentThread;
+  }
+
+  void begin(std::string Name, std::string Detail) {
+    getThreadTrace().Stack.emplace_back(ClockType::now(), std::move(Name),
+                                        std::move(Detail));
+  }
+
+  void end() {
+    ThreadTrace &T = getThreadTrace();
+    assert(!T.Stack.empty() && "Must call begin() first");
+    Entry &E = T.Stack.back();
+    E.Duration = duration_cast<DurationType>(ClockType::now() - E.Start);
+
+    // Only count a section once if it is nested in one of the same name, as
+    // when a pass manager runs another.
+    auto IsSameName = [&](const Entry &Outer) { return Outer.Name == E.Name; };
+    if (std::none_of(T.Stack.begin(), T.Stack.end() - 1, IsSameName)) {
+      auto &CountAndTotal = T.CountAndTotal[E.Name];
+      CountAndTotal.first++;
+      CountAndTotal.second += E.Duration;
+    }
+
+    // Only keep the sections that are at least TimeTraceGranularity long.
+    if (E.Duration.count() >= TimeTraceGranularity)
+      T.Entries.push_back(std::move(E));
+    T.Stack.pop_back();
+  }
+
+  void write(raw_ostream &OS) {
+    std::lock_guard<std::mutex> Lock(ThreadsLock);
+    auto Since = [&](TimePointType Time) {
+      return duration_cast<DurationType>(Time - StartTime).count();
+    };
+    bool First = true;
+    auto BeginEvent = [&](unsigned Tid, StringRef Phase, StringRef Name) {
+      OS << (First ? "\n" : ",\n") << "{\"pid\":1,\"tid\":" << Tid
+         << ",\"ph\":\"" << Phase << "\",\"name\":";
+      OS.write_json_string(Name);
+      First = false;
+    };
+
+    OS << "{\"traceEvents\":[";
+    StringMap<std::pair<size_t, DurationType>> AllCountAndTotal;
+    for (unsigned Tid = 0, NumThreads = Threads.size(); Tid != NumThreads;
+         ++Tid) {
+      ThreadTrace &T = *Threads[Tid];
+      assert(T.Stack.empty() && "All sections must have ended");
+      for (const Entry &E : T.Entries) {
+        BeginEvent(Tid, "X", E.Name);
+        OS << ",\"ts\":" << Since(E.Start) << ",\"dur\":" << E.Duration.count()
+           << ",\"args\":{\"detail\":";
+        OS.write_json_string(E.Detail);
+        OS << "}}";
+      }
+      for (auto &CountAndTotal : T.CountAndTotal) {
+        auto &Sum = AllCountAndTotal[CountAndTotal.getKey()];
+        Sum.first += CountAndTotal.getValue().first;
+        Sum.second += CountAndTotal.getValue().second;
+      }
+      BeginEvent(Tid, "M", "thread_name");
+      OS << ",\"args\":{\"name\":";
+      OS.write_json_string(Tid == 0 ? ProcName
+                                    : ProcName + " worker " +
+                                          std::to_string(Tid));
+      OS << "}}";
+    }
+
+    // Emit the totals, longest first, each on a line of its own after the
+    // threads.
+    std::vector<std::pair<std::string, std::pair<size_t, DurationType>>>
+        SortedTotals;
+    for (auto &Total : AllCountAndTotal)
+      SortedTotals.emplace_back(Total.getKey(), Total.getValue());
+    std::sort(SortedTotals.begin(), SortedTotals.end(),
+              [](const std::pair<std::string,
+                                 std::pair<size_t, DurationType>> &A,
+                 const std::pair<std::string,
+                                 std::pair<size_t, DurationType>> &B) {
+                if (A.second.second != B.second.second)
+                  return A.second.second > B.second.second;
+                return A.first < B.first;
+              });
+    unsigned Tid = Threads.size();
+    for (auto &Total : SortedTotals) {
+      size_t Count = Total.second.first;
+      DurationType Duration = Total.second.second;
+      BeginEvent(Tid, "X", "Total " + Total.first);
+      OS << ",\"ts\":0,\"dur\":" << Duration.count()
+         << ",\"args\":{\"count\":" << Count << ",\"avg ms\":"
+         << format("%.3f", Duration.count() / 1000.0 / Count) << "}}";
+      BeginEvent(Tid, "M", "thread_name");
+      OS << ",\"args\":{\"name\":";
+      OS.write_json_string("Total " + Total.first);
+      OS << "}}";
+      ++Tid;
+    }
+
+    BeginEvent(0, "M", "process_name");
+    OS << ",\"args\":{\"name\":";
+    OS.write_json_string(ProcName);
+    OS << "}}\n],\"beginningOfTime\":"
+       << duration_cast<microseconds>(BeginningOfTime.time_since_epoch())
+              .count()
+       << "}\n";
+  }
+
+  const unsigned Generation;
+  const TimePointType StartTime;
+  const system_clock::time_point BeginningOfTime;
+  const std::string ProcName;
+  const unsigned TimeTraceGranularity;
+
+  std::mutex ThreadsLock;
+  /// The traces of the threads, in the order they began their first section.
+  std::vector<std::unique_ptr<ThreadTrace>> Threads;
+};
+} // end namespace llvm
+
+void llvm::timeTraceProfilerInitialize(unsigned TimeTraceGranularity,
+                                       StringRef ProcName) {
+  assert(TimeTraceProfilerInstance == nullptr &&
+         "Profiler should not be initialized");
+  TimeTraceProfilerInstance = new TimeTraceProfiler(
+      TimeTraceGranularity, sys::path::filename(ProcName));
+  // The initializing thread is the first in the trace.
+  TimeTraceProfilerInstance->getThreadTrace();
+}
+
+void llvm::timeTraceProfilerCleanup() {
+  delete TimeTraceProfilerInstance;
+  TimeTraceProfilerInstance = nullptr;
+}
+
+void llvm::timeTraceProfilerWrite(raw_ostream &OS) {
+  assert(TimeTraceProfilerInstance != nullptr &&
+         "Profiler object can't be null");
+  TimeTraceProfilerInstance->write(OS);
+}
+
+std::error_code llvm::timeTraceProfilerWrite(StringRef PreferredFileName,
+                                             StringRef FallbackFileName) {
+  assert(TimeTraceProfilerInstance != nullptr &&
+         "Profiler object can't be null");
+  std::string Path = PreferredFileName;
+  if (Path.empty())
+    Path = (FallbackFileName + ".time-trace").str();
+
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::F_Text);
+  if (EC)
+    return EC;
+  timeTraceProfilerWrite(OS);
+  return std::error_code();
+}
+
+void llvm::timeTraceProfilerBegin(StringRef Name, StringRef Detail) {
+  if (TimeTraceProfilerInstance != nullptr)
+    TimeTraceProfilerInstance->begin(Name, Detail);
+}
+
+void llvm::timeTraceProfilerEnd() {
+  if (TimeTraceProfilerInstance != nullptr)
+    TimeTraceProfilerInstance->end();
+}
@@ -109,6 +109,9 @@ const char *Triple::getArchTypePrefix(ArchType Kind) {
   case sparcel:
   case sparc:       return "sparc";
 
+  case riscv:
+  case riscv64:     return "riscv";
+
   case systemz:     return "s390";
 
   case x86:
@@ -219,6 +219,33 @@ raw_ostream &raw_ostream::write_escaped(StringRef Str,
   return *this;
 }
 
+raw_ostream &raw_ostream::write_json_string(StringRef Str) {
+  *this << '"';
+  for (unsigned char c : Str) {
+    switch (c) {
+    case '"':
+      *this << '\\' << '"';
+      break;
+    case '\\':
+      *this << '\\' << '\\';
+      break;
+    case '\n':
+      *this << '\\' << 'n';
+      break;
+    case '\t':
+      *this << '\\' << 't';
+      break;
+    default:
+      if (c >= 0x20) {
+        *this << c;
+        break;
+      }
+      *this << "\\u00" << hexdigit(c >> 4, true) << hexdigit(c & 0xF, true);
+    }
+  }
+  return *this << '"';
+}
+
 raw_ostream &raw_ostream::operator<<(const void *P) {
   *this << '0' << 'x';
 
@@ -0,0 +1,176 @@
+//===- xxhash.cpp - Fast non-cryptographic hashing ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements xxHash64, following the reference implementation at
+// https://github.com/Cyan4973/xxHash, which is under the BSD 2-Clause
+// license.
+//
+// The data is read in stripes of 32 bytes, which feed four independent
+// accumulators of 8 bytes: the multiplications of the four lanes do not
+// depend on each other, so they run in parallel on out-of-order processors.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/xxhash.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace llvm;
+using namespace support;
+
+static const uint64_t Prime64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t Prime64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t Prime64_5 = 0x27D4EB2F165667C5ULL;
+
+static uint64_t rotl64(uint64_t X, unsigned R) {
+  return (X << R) | (X >> (64 - R));
+}
+
+static uint64_t xxRound(uint64_t Acc, uint64_t Input) {
+  Acc += Input * Prime64_2;
+  Acc = rotl64(Acc, 31);
+  return Acc * Prime64_1;
+}
+
+static uint64_t mergeRound(uint64_t Acc, uint64_t Val) {
+  Acc ^= xxRound(0, Val);
+  return Acc * Prime64_1 + Prime64_4;
+}
+
+static void initAccumulators(uint64_t Acc[4], uint64_t Seed) {
+  Acc[0] = Seed + Prime64_1 + Prime64_2;
+  Acc[1] = Seed + Prime64_2;
+  Acc[2] = Seed;
+  Acc[3] = Seed - Prime64_1;
+}
+
+/// Feed the stripes of 32 bytes of [\p P, \p End) to the accumulators, and
+/// return the end of the last one.
+static const uint8_t *consumeStripes(uint64_t Acc[4], const uint8_t *P,
+                                     const uint8_t *End) {
+  uint64_t A0 = Acc[0], A1 = Acc[1], A2 = Acc[2], A3 = Acc[3];
+  for (; End - P >= 32; P += 32) {
+    A0 = xxRound(A0, endian::read64le(P));
+    A1 = xxRound(A1, endian::read64le(P + 8));
+    A2 = xxRound(A2, endian::read64le(P + 16));
+    A3 = xxRound(A3, endian::read64le(P + 24));
+  }
+  Acc[0] = A0;
+  Acc[1] = A1;
+  Acc[2] = A2;
+  Acc[3] = A3;
+  return P;
+}
+
+/// Finish the hash of \p Length bytes from the accumulators, or from the seed
+/// if there was no complete stripe, and the last bytes [\p P, \p End).
+static uint64_t finalize(const uint64_t Acc[4], uint64_t Seed,
+                         uint64_t Length, const uint8_t *P,
+                         const uint8_t *End) {
+  uint64_t H64;
+  if (Length >= 32) {
+    H64 = rotl64(Acc[0], 1) + rotl64(Acc[1], 7) + rotl64(Acc[2], 12) +
+          rotl64(Acc[3], 18);
+    for (unsigned I = 0; I != 4; ++I)
+      H64 = mergeRound(H64, Acc[I]);
+  } else {
+    H64 = Seed + Prime64_5;
+  }
+  H64 += Length;
+
+  for (; End - P >= 8; P += 8) {
+    H64 ^= xxRound(0, endian::read64le(P));
+    H64 = rotl64(H64, 27) * Prime64_1 + Prime64_4;
+  }
+  if (End - P >= 4) {
+    H64 ^= uint64_t(endian::read32le(P)) * Prime64_1;
+    H64 = rotl64(H64, 23) * Prime64_2 + Prime64_3;
+    P += 4;
+  }
+  for (; P != End; ++P) {
+    H64 ^= *P * Prime64_5;
+    H64 = rotl64(H64, 11) * Prime64_1;
+  }
+
+  H64 ^= H64 >> 33;
+  H64 *= Prime64_2;
+  H64 ^= H64 >> 29;
+  H64 *= Prime64_3;
+  H64 ^= H64 >> 32;
+  return H64;
+}
+
+uint64_t llvm::xxHash64(ArrayRef<uint8_t> Data, uint64_t Seed) {
+  const uint8_t *P = Data.data();
+  const uint8_t *End = P + Data.size();
+  uint64_t Acc[4];
+  if (Data.size() >= 32) {
+    initAccumulators(Acc, Seed);
+    P = consumeStripes(Acc, P, End);
+  }
+  return finalize(Acc, Seed, Data.size(), P, End);
+}
+
+void XXHash64::init(uint64_t NewSeed) {
+  Seed = NewSeed;
+  initAccumulators(Acc, Seed);
+  TotalLength = 0;
+  BufferSize = 0;
+}
+
+void XXHash64::update(ArrayRef<uint8_t> Data) {
+  const uint8_t *P = Data.data();
+  const uint8_t *End = P + Data.size();
+  TotalLength += Data.size();
+
+  // Complete the buffered stripe first.
+  if (BufferSize) {
+    size_t Count = std::min<size_t>(sizeof(Buffer) - BufferSize, End - P);
+    memcpy(Buffer + BufferSize, P, Count);
+    BufferSize += Count;
+    P += Count;
+    if (BufferSize < sizeof(Buffer))
+      return;
+    consumeStripes(Acc, Buffer, Buffer + sizeof(Buffer));
+    BufferSize = 0;
+  }
+
+  P = consumeStripes(Acc, P, End);
+  memcpy(Buffer, P, End - P);
+  BufferSize = End - P;
+}
+
+uint64_t XXHash64::digest() const {
+  return finalize(Acc, Seed, TotalLength, Buffer, Buffer + BufferSize);
+}
+
+/// The seeds of the two halves of the 128-bit hash.
+static const uint64_t HighSeed = 0;
+static const uint64_t LowSeed = Prime64_3;
+
+void XXHash128::init() {
+  HighHash.init(HighSeed);
+  LowHash.init(LowSeed);
+}
+
+XXHash128Result llvm::xxHash128(ArrayRef<uint8_t> Data) {
+  return XXHash128Result{xxHash64(Data, HighSeed), xxHash64(Data, LowSeed)};
+}
+
+std::string XXHash128Result::toHex() const {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  OS << format_hex_no_prefix(High, 16) << format_hex_no_prefix(Low, 16);
+  return OS.str();
+}
@@ -46,7 +46,8 @@ public:
     FP64Reg,
     PairFP64Reg,
     PairFP128Reg,
-    FP128Reg
+    FP128Reg,
+    VRReg
   };
 
 private:
@@ -213,9 +214,15 @@ public:
   bool isPairFP64() const { return isReg(PairFP64Reg); }
   bool isPairFP128() const { return isReg(PairFP128Reg); }
   bool isFP128() const { return isReg(FP128Reg); }
+  bool isVR() const { return isReg(VRReg); }
   bool isU4Imm() const { return isImm(0, 15); }
+  bool isU5Imm() const { return isImm(0, 31); }
+  bool isVTypeIImm() const { return isImm(0, 2047); }
   bool isU12Imm() const { return isImm(0, 4096); }
   bool isS12Imm() const { return isImm(-2048, 2047); }
+  bool isS12Align32Imm() const {
+    return isS12Imm() && cast<MCConstantExpr>(Imm)->getValue() % 32 == 0;
+  }
   bool isU20Imm() const { return isImm(0, 1048576); }
   bool isS20Imm() const { return isImm(-524288, 524287); }
   bool isU32Imm() const { return isImm(0, (1LL << 32) - 1); }
@@ -279,6 +286,15 @@ static const unsigned PairFP128Regs[] = {
   RISCV::fa0_p128, RISCV::fa1_p128, RISCV::fa2_p128, RISCV::fa3_p128
 };
 
+static const unsigned VRRegs[] = {
+  RISCV::v0,  RISCV::v1,  RISCV::v2,  RISCV::v3,  RISCV::v4,  RISCV::v5,
+  RISCV::v6,  RISCV::v7,  RISCV::v8,  RISCV::v9,  RISCV::v10, RISCV::v11,
+  RISCV::v12, RISCV::v13, RISCV::v14, RISCV::v15, RISCV::v16, RISCV::v17,
+  RISCV::v18, RISCV::v19, RISCV::v20, RISCV::v21, RISCV::v22, RISCV::v23,
+  RISCV::v24, RISCV::v25, RISCV::v26, RISCV::v27, RISCV::v28, RISCV::v29,
+  RISCV::v30, RISCV::v31
+};
+
 static const unsigned PCRRegs[] = {
   RISCV::status, RISCV::epc, RISCV::evec, RISCV::ptbr, RISCV::asid,
   RISCV::count, RISCV::compare, RISCV::sup0, RISCV::sup1, RISCV::tohost, RISCV::fromhost,
@@ -390,6 +406,10 @@ public:
                          RISCVOperand::PairFP128Reg);
   }
 
+  OperandMatchResultTy parseVR(OperandVector &Operands) {
+    return parseRegister(Operands, 'v', VRRegs, RISCVOperand::VRReg);
+  }
+
   OperandMatchResultTy parsePCRReg(OperandVector &Operands) {
     const AsmToken &Tok = Parser.getTok();
     if(Tok.is(AsmToken::Identifier) && Tok.getIdentifier().equals("ASM_CR")) {
@@ -730,6 +750,11 @@ bool RISCVAsmParser::ParseInstruction(ParseInstructionInfo &Info,
     if( getLexer().is(AsmToken::LBrac) )
       return true;
 
+    // Single memory operand instructions (e.g. prefetch.r 64(x10))
+    if( getLexer().is(AsmToken::LParen) &&
+               parseParenSuffix(Name,Operands))
+      return true;
+
     while (getLexer().is(AsmToken::Comma)) {
 
       Parser.Lex(); // Eat the comma.
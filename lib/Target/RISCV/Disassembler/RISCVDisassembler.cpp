@@ -0,0 +1,230 @@
+//===-- RISCVDisassembler.cpp - Disassembler for RISCV ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MCTargetDesc/RISCVMCTargetDesc.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCFixedLenDisassembler.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/TargetRegistry.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "riscv-disassembler"
+
+typedef MCDisassembler::DecodeStatus DecodeStatus;
+
+namespace {
+class RISCVDisassembler : public MCDisassembler {
+public:
+  RISCVDisassembler(const MCSubtargetInfo &STI, MCContext &Ctx)
+    : MCDisassembler(STI, Ctx) {}
+  ~RISCVDisassembler() override {}
+
+  DecodeStatus getInstruction(MCInst &instr, uint64_t &Size,
+                              ArrayRef<uint8_t> Bytes, uint64_t Address,
+                              raw_ostream &VStream,
+                              raw_ostream &CStream) const override;
+};
+} // end anonymous namespace
+
+static MCDisassembler *createRISCVDisassembler(const Target &T,
+                                               const MCSubtargetInfo &STI,
+                                               MCContext &Ctx) {
+  return new RISCVDisassembler(STI, Ctx);
+}
+
+extern "C" void LLVMInitializeRISCVDisassembler() {
+  // Register the disassembler.
+  TargetRegistry::RegisterMCDisassembler(TheRISCVTarget,
+                                         createRISCVDisassembler);
+  TargetRegistry::RegisterMCDisassembler(TheRISCV64Target,
+                                         createRISCVDisassembler);
+}
+
+static const unsigned GR32Regs[] = {
+  RISCV::zero, RISCV::ra, RISCV::sp, RISCV::gp, RISCV::tp,
+  RISCV::t0, RISCV::t1, RISCV::t2,
+  RISCV::s0, RISCV::s1,
+  RISCV::a0, RISCV::a1, RISCV::a2, RISCV::a3, RISCV::a4, RISCV::a5, RISCV::a6, RISCV::a7,
+  RISCV::s2, RISCV::s3, RISCV::s4, RISCV::s5, RISCV::s6, RISCV::s7, RISCV::s8, RISCV::s9, RISCV::s10, RISCV::s11,
+  RISCV::t3, RISCV::t4, RISCV::t5, RISCV::t6
+};
+
+static const unsigned GR64Regs[] = {
+  RISCV::zero_64, RISCV::ra_64, RISCV::sp_64, RISCV::gp_64, RISCV::tp_64,
+  RISCV::t0_64, RISCV::t1_64, RISCV::t2_64,
+  RISCV::s0_64, RISCV::s1_64,
+  RISCV::a0_64, RISCV::a1_64, RISCV::a2_64, RISCV::a3_64, RISCV::a4_64, RISCV::a5_64, RISCV::a6_64, RISCV::a7_64,
+  RISCV::s2_64, RISCV::s3_64, RISCV::s4_64, RISCV::s5_64, RISCV::s6_64, RISCV::s7_64, RISCV::s8_64, RISCV::s9_64, RISCV::s10_64, RISCV::s11_64,
+  RISCV::t3_64, RISCV::t4_64, RISCV::t5_64, RISCV::t6_64
+};
+
+static const unsigned FP32Regs[] = {
+  RISCV::ft0, RISCV::ft1, RISCV::ft2, RISCV::ft3, RISCV::ft4, RISCV::ft5, RISCV::ft6, RISCV::ft7,
+  RISCV::fs0, RISCV::fs1,
+  RISCV::fa0, RISCV::fa1, RISCV::fa2, RISCV::fa3, RISCV::fa4, RISCV::fa5, RISCV::fa6, RISCV::fa7,
+  RISCV::fs2, RISCV::fs3, RISCV::fs4, RISCV::fs5, RISCV::fs6, RISCV::fs7, RISCV::fs8, RISCV::fs9, RISCV::fs10, RISCV::fs11,
+  RISCV::ft8, RISCV::ft9, RISCV::ft10, RISCV::ft11
+};
+
+static const unsigned FP64Regs[] = {
+  RISCV::ft0_64, RISCV::ft1_64, RISCV::ft2_64, RISCV::ft3_64, RISCV::ft4_64, RISCV::ft5_64, RISCV::ft6_64, RISCV::ft7_64,
+  RISCV::fs0_64, RISCV::fs1_64,
+  RISCV::fa0_64, RISCV::fa1_64, RISCV::fa2_64, RISCV::fa3_64, RISCV::fa4_64, RISCV::fa5_64, RISCV::fa6_64, RISCV::fa7_64,
+  RISCV::fs2_64, RISCV::fs3_64, RISCV::fs4_64, RISCV::fs5_64, RISCV::fs6_64, RISCV::fs7_64, RISCV::fs8_64, RISCV::fs9_64, RISCV::fs10_64, RISCV::fs11_64,
+  RISCV::ft8_64, RISCV::ft9_64, RISCV::ft10_64, RISCV::ft11_64
+};
+
+static const unsigned VRRegs[] = {
+  RISCV::v0,  RISCV::v1,  RISCV::v2,  RISCV::v3,  RISCV::v4,  RISCV::v5,
+  RISCV::v6,  RISCV::v7,  RISCV::v8,  RISCV::v9,  RISCV::v10, RISCV::v11,
+  RISCV::v12, RISCV::v13, RISCV::v14, RISCV::v15, RISCV::v16, RISCV::v17,
+  RISCV::v18, RISCV::v19, RISCV::v20, RISCV::v21, RISCV::v22, RISCV::v23,
+  RISCV::v24, RISCV::v25, RISCV::v26, RISCV::v27, RISCV::v28, RISCV::v29,
+  RISCV::v30, RISCV::v31
+};
+
+// Some formats carry a register in a field wider than five bits, anything
+// that does not name a register is not a valid encoding.
+static DecodeStatus decodeRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                        const unsigned *Regs) {
+  if (RegNo >= 32)
+    return MCDisassembler::Fail;
+  Inst.addOperand(MCOperand::createReg(Regs[RegNo]));
+  return MCDisassembler::Success;
+}
+
+static DecodeStatus DecodeGR32BitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                               uint64_t Address,
+                                               const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, GR32Regs);
+}
+
+static DecodeStatus DecodeGR64BitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                               uint64_t Address,
+                                               const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, GR64Regs);
+}
+
+static DecodeStatus DecodeFP32BitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                               uint64_t Address,
+                                               const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, FP32Regs);
+}
+
+static DecodeStatus DecodeFP64BitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                               uint64_t Address,
+                                               const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, FP64Regs);
+}
+
+static DecodeStatus DecodeVRBitRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                             uint64_t Address,
+                                             const void *Decoder) {
+  return decodeRegisterClass(Inst, RegNo, VRRegs);
+}
+
+template<unsigned N>
+static DecodeStatus decodeSImmOperand(MCInst &Inst, uint64_t Imm,
+                                      uint64_t Address, const void *Decoder) {
+  Inst.addOperand(MCOperand::createImm(SignExtend64<N>(Imm)));
+  return MCDisassembler::Success;
+}
+
+// Call targets are encoded in halfwords, see getPCRelEncoding.
+template<unsigned N>
+static DecodeStatus decodePCRelOperand(MCInst &Inst, uint64_t Imm,
+                                       uint64_t Address, const void *Decoder) {
+  Inst.addOperand(MCOperand::createImm(SignExtend64<N>(Imm) * 2));
+  return MCDisassembler::Success;
+}
+
+// Constant branch and jump offsets are encoded doubled, see
+// getBranchTargetEncoding.
+template<unsigned N>
+static DecodeStatus decodeBranchTargetOperand(MCInst &Inst, uint64_t Imm,
+                                              uint64_t Address,
+                                              const void *Decoder) {
+  Inst.addOperand(MCOperand::createImm(SignExtend64<N>(Imm) / 2));
+  return MCDisassembler::Success;
+}
+
+// Prefetch addresses are encoded as (base << 12) | offset, see
+// getPrefetchMemEncoding.
+template<bool Is64>
+static DecodeStatus decodePrefetchMemOperand(MCInst &Inst, uint64_t Imm,
+                                             uint64_t Address,
+                                             const void *Decoder) {
+  Inst.addOperand(MCOperand::createImm(SignExtend64<12>(Imm)));
+  return decodeRegisterClass(Inst, Imm >> 12, Is64 ? GR64Regs : GR32Regs);
+}
+
+static DecodeStatus decodeBranch(MCInst &Inst, uint64_t Insn,
+                                 uint64_t Address, const void *Decoder,
+                                 const unsigned *Regs) {
+  uint64_t Target = ((Insn >> 27) & 0x1f) << 7 | ((Insn >> 10) & 0x7f);
+  decodeBranchTargetOperand<12>(Inst, Target, Address, Decoder);
+  if (decodeRegisterClass(Inst, (Insn >> 22) & 0x1f, Regs) ==
+      MCDisassembler::Fail)
+    return MCDisassembler::Fail;
+  return decodeRegisterClass(Inst, (Insn >> 17) & 0x1f, Regs);
+}
+
+static DecodeStatus decodeBranchInstruction(MCInst &Inst, uint64_t Insn,
+                                            uint64_t Address,
+                                            const void *Decoder) {
+  return decodeBranch(Inst, Insn, Address, Decoder, GR32Regs);
+}
+
+static DecodeStatus decodeBranch64Instruction(MCInst &Inst, uint64_t Insn,
+                                              uint64_t Address,
+                                              const void *Decoder) {
+  return decodeBranch(Inst, Insn, Address, Decoder, GR64Regs);
+}
+
+#include "RISCVGenDisassemblerTables.inc"
+
+DecodeStatus RISCVDisassembler::getInstruction(MCInst &MI, uint64_t &Size,
+                                               ArrayRef<uint8_t> Bytes,
+                                               uint64_t Address,
+                                               raw_ostream &OS,
+                                               raw_ostream &CS) const {
+  // All instructions are four bytes, stored little-endian.
+  Size = 0;
+  if (Bytes.size() < 4)
+    return MCDisassembler::Fail;
+  Size = 4;
+
+  uint32_t Inst = (Bytes[3] << 24) | (Bytes[2] << 16) | (Bytes[1] << 8) |
+                  Bytes[0];
+
+  // The prefetch hints are encodings of ori with rd=x0.
+  if (STI.getFeatureBits()[RISCV::FeatureZicbop]) {
+    bool Is64 = STI.getFeatureBits()[RISCV::FeatureRV64];
+    DecodeStatus Result =
+        decodeInstruction(Is64 ? DecoderTableZicbop6432 : DecoderTableZicbop32,
+                          MI, Inst, Address, this, STI);
+    if (Result != MCDisassembler::Fail)
+      return Result;
+    MI.clear();
+  }
+
+  // The RV64 forms of the base instructions share their encodings with the
+  // RV32 ones, so look them up first to get the 64-bit register classes.
+  if (STI.getFeatureBits()[RISCV::FeatureRV64]) {
+    DecodeStatus Result = decodeInstruction(DecoderTableRISCV6432, MI, Inst,
+                                            Address, this, STI);
+    if (Result != MCDisassembler::Fail)
+      return Result;
+    MI.clear();
+  }
+  return decodeInstruction(DecoderTable32, MI, Inst, Address, this, STI);
+}
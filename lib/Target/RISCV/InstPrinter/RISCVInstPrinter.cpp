@@ -71,6 +71,13 @@ void RISCVInstPrinter::printMemRegOperand(const MCInst *MI, int opNum,
      OS << ")";
 }
 
+void RISCVInstPrinter::printU5ImmOperand(const MCInst *MI, int OpNum,
+                                          raw_ostream &O) {
+  int64_t Value = MI->getOperand(OpNum).getImm();
+  assert(isUInt<5>(Value) && "Invalid u5imm argument");
+  O << Value;
+}
+
 void RISCVInstPrinter::printS12ImmOperand(const MCInst *MI, int OpNum,
                                            raw_ostream &O) {
   if(MI->getOperand(OpNum).isImm()){
@@ -158,6 +165,22 @@ void RISCVInstPrinter::printAccessRegOperand(const MCInst *MI, int OpNum,
   O << "%a" << (unsigned int)Value;
 }
 
+void RISCVInstPrinter::printVTypeIImmOperand(const MCInst *MI, int OpNum,
+                                              raw_ostream &O) {
+  unsigned VType = MI->getOperand(OpNum).getImm();
+  unsigned SEW = 8 << ((VType & RISCVMC::VTypeSEWMask) >>
+                       RISCVMC::VTypeSEWShift);
+  unsigned LMUL = VType & RISCVMC::VTypeLMULMask;
+  O << "e" << SEW << ", ";
+  // Encodings 5-7 are the fractional LMULs 1/8, 1/4 and 1/2.
+  if (LMUL < 4)
+    O << "m" << (1 << LMUL);
+  else
+    O << "mf" << (1 << (8 - LMUL));
+  O << ((VType & RISCVMC::VTypeTA) ? ", ta" : ", tu");
+  O << ((VType & RISCVMC::VTypeMA) ? ", ma" : ", mu");
+}
+
 void RISCVInstPrinter::printCallOperand(const MCInst *MI, int OpNum,
                                           raw_ostream &O) {
   printOperand(MI, OpNum, O);
@@ -45,6 +45,7 @@ private:
   void printBranchTarget(const MCInst *MI, int OpNum, raw_ostream &O);
   void printBDAddrOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printBDXAddrOperand(const MCInst *MI, int OpNum, raw_ostream &O);
+  void printU5ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printS12ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printU12ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printS20ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
@@ -56,6 +57,7 @@ private:
   void printU32ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printS64ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printU64ImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
+  void printVTypeIImmOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printCallOperand(const MCInst *MI, int OpNum, raw_ostream &O);
   void printAccessRegOperand(const MCInst *MI, int OpNum, raw_ostream &O);
 
@@ -75,7 +75,7 @@ RISCVMCAsmBackend::getFixupKindInfo(MCFixupKind Kind) const {
   const static MCFixupKindInfo Infos[RISCV::NumTargetFixupKinds] = {
     { "fixup_riscv_brlo",  10, 7, MCFixupKindInfo::FKF_IsPCRel },
     { "fixup_riscv_brhi",  27, 5, MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_riscv_jal", 0, 20, MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_riscv_jal",  12, 20, MCFixupKindInfo::FKF_IsPCRel },
     // target offset(0) doesn't make sense here: bits are non continuous
   };
 
@@ -107,9 +107,37 @@ private:
                             unsigned Kind, int64_t Offset) const;
 
   unsigned getCallEncoding(const MCInst &MI, unsigned int OpNum,
-                               SmallVectorImpl<MCFixup> &Fixups) const {
+                           SmallVectorImpl<MCFixup> &Fixups,
+                           const MCSubtargetInfo &STI) const {
     return getPCRelEncoding(MI, OpNum, Fixups, RISCV::fixup_riscv_call, 0);
   }
+
+  // Encode the target of an InstJAL as imm[20|10:1|11|19:12].  Symbolic
+  // targets are left to the linker.
+  unsigned getJALTargetEncoding(const MCInst &MI, unsigned int OpNum,
+                                SmallVectorImpl<MCFixup> &Fixups,
+                                const MCSubtargetInfo &STI) const {
+    const MCOperand &MO = MI.getOperand(OpNum);
+    if (MO.isImm()) {
+      uint32_t Imm = MO.getImm();
+      return (((Imm >> 20) & 0x1) << 19) | (((Imm >> 1) & 0x3ff) << 9) |
+             (((Imm >> 11) & 0x1) << 8) | ((Imm >> 12) & 0xff);
+    }
+    Fixups.push_back(MCFixup::create(0, MO.getExpr(),
+          (MCFixupKind)RISCV::fixup_riscv_jal));
+    return 0;
+  }
+
+  // Encode the offset and base register of a prefetch address as
+  // (base << 12) | offset, see prefetchmem.
+  unsigned getPrefetchMemEncoding(const MCInst &MI, unsigned int OpNum,
+                                  SmallVectorImpl<MCFixup> &Fixups,
+                                  const MCSubtargetInfo &STI) const {
+    uint64_t Offset = getMachineOpValue(MI, MI.getOperand(OpNum), Fixups, STI);
+    uint64_t Base = getMachineOpValue(MI, MI.getOperand(OpNum + 1), Fixups,
+                                      STI);
+    return (Base << 12) | (Offset & 0xfff);
+  }
 };
 }
 
@@ -46,6 +46,19 @@ namespace RISCVMC {
 
   // The offset of the DWARF CFA from the incoming stack pointer.
   const int64_t CFAOffsetFromInitialSP = CallFrameSize;
+
+  // Fields of the vtype immediate of vsetvli and vsetivli.
+  const unsigned VTypeLMULMask = 0x7;
+  const unsigned VTypeSEWShift = 3;
+  const unsigned VTypeSEWMask  = 0x7 << VTypeSEWShift;
+  const unsigned VTypeTA       = 1 << 6;
+  const unsigned VTypeMA       = 1 << 7;
+
+  // Return the tail and mask agnostic LMUL=1 vtype for elements of
+  // 1 << Log2SEW bits.
+  inline unsigned encodeVType(unsigned Log2SEW) {
+    return ((Log2SEW - 3) << VTypeSEWShift) | VTypeTA | VTypeMA;
+  }
 }
 } // end namespace llvm
 
@@ -74,5 +74,6 @@ namespace llvm {
   FunctionPass *createRISCVISelDag(RISCVTargetMachine &TM,
                                      CodeGenOpt::Level OptLevel);
   FunctionPass *createRISCVBranchSelectionPass();
+  FunctionPass *createRISCVInsertVSETVLIPass();
 } // end namespace llvm;
 #endif
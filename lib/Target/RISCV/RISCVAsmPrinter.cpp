@@ -18,14 +18,39 @@
 #include "RISCVMCInstLower.h"
 #include "llvm/CodeGen/MachineModuleInfoImpls.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
+#include "llvm/IR/Function.h"
+#include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCExpr.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCSectionELF.h"
 #include "llvm/MC/MCStreamer.h"
-#include "llvm/MC/MCSymbol.h"
+#include "llvm/MC/MCSymbolELF.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ELF.h"
 #include "llvm/Support/TargetRegistry.h"
 
 using namespace llvm;
 
+static cl::opt<bool>
+EmitSaveRestoreLibCalls("riscv-emit-save-restore-libcalls", cl::Hidden,
+  cl::desc("Emit the __riscv_save_N/__riscv_restore_N routines called by "
+           "the module as weak COMDAT functions"),
+  cl::init(true));
+
 void RISCVAsmPrinter::EmitInstruction(const MachineInstr *MI) {
+  switch (MI->getOpcode()) {
+  case TargetOpcode::PATCHABLE_FUNCTION_ENTER:
+    return LowerPATCHABLE_FUNCTION_ENTER(*MI);
+  case TargetOpcode::PATCHABLE_FUNCTION_EXIT:
+    return LowerPATCHABLE_FUNCTION_EXIT(*MI);
+  case RISCV::SAVE_LIBCALL:
+  case RISCV::SAVE_LIBCALL64:
+  case RISCV::RESTORE_LIBCALL:
+  case RISCV::RESTORE_LIBCALL64:
+    SaveRestoreLibCalls.insert(MI->getOperand(0).getSymbolName());
+    break;
+  }
+
   RISCVMCInstLower Lower(MF->getContext(), *this);
   MCInst LoweredMI;
   Lower.lower(MI, LoweredMI);
@@ -119,8 +144,176 @@ void RISCVAsmPrinter::printMemOperand(const MachineInstr *MI, int opNum,
     OS << ")";
 }
 
+// Emit the body of the save or restore routine Name, matching the frame
+// layout RISCVFrameLowering assumes: ra and s0..s(N-1) are stored in
+// consecutive slots from the top of a 16-byte aligned area that the save
+// routine allocates and the restore routine frees.  The save routine returns
+// through t0, the restore routine returns to the caller of its caller.
+void RISCVAsmPrinter::emitSaveRestoreLibCall(StringRef Name, bool IsRV64) {
+  static const unsigned GPR32[] = {
+    RISCV::ra, RISCV::fp, RISCV::s1, RISCV::s2, RISCV::s3, RISCV::s4,
+    RISCV::s5, RISCV::s6, RISCV::s7, RISCV::s8, RISCV::s9, RISCV::s10,
+    RISCV::s11
+  };
+  static const unsigned GPR64[] = {
+    RISCV::ra_64, RISCV::fp_64, RISCV::s1_64, RISCV::s2_64, RISCV::s3_64,
+    RISCV::s4_64, RISCV::s5_64, RISCV::s6_64, RISCV::s7_64, RISCV::s8_64,
+    RISCV::s9_64, RISCV::s10_64, RISCV::s11_64
+  };
+  const unsigned *Regs = IsRV64 ? GPR64 : GPR32;
+  unsigned SP = IsRV64 ? RISCV::sp_64 : RISCV::sp;
+
+  bool IsSave = Name.startswith("__riscv_save_");
+  unsigned NumSRegs;
+  if (Name.substr(Name.rfind('_') + 1).getAsInteger(10, NumSRegs) ||
+      NumSRegs > 12)
+    llvm_unreachable("Unexpected save/restore libcall");
+  int64_t SlotSize = IsRV64 ? 8 : 4;
+  int64_t FrameSize = alignTo((NumSRegs + 1) * SlotSize, 16);
+
+  MCSectionELF *Section = OutContext.getELFSection(
+      (".text." + Name).str(), ELF::SHT_PROGBITS,
+      ELF::SHF_ALLOC | ELF::SHF_EXECINSTR | ELF::SHF_GROUP, 0, Name);
+  OutStreamer->SwitchSection(Section);
+  EmitAlignment(2);
+  MCSymbol *Sym = OutContext.getOrCreateSymbol(Name);
+  OutStreamer->EmitSymbolAttribute(Sym, MCSA_Weak);
+  OutStreamer->EmitSymbolAttribute(Sym, MCSA_Hidden);
+  OutStreamer->EmitSymbolAttribute(Sym, MCSA_ELF_TypeFunction);
+  OutStreamer->EmitLabel(Sym);
+
+  const MCSubtargetInfo &STI = *TM.getMCSubtargetInfo();
+  auto EmitAddSP = [&](int64_t Amount) {
+    MCInst Inst;
+    Inst.setOpcode(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI);
+    Inst.addOperand(MCOperand::createReg(SP));
+    Inst.addOperand(MCOperand::createReg(SP));
+    Inst.addOperand(MCOperand::createImm(Amount));
+    OutStreamer->EmitInstruction(Inst, STI);
+  };
+
+  if (IsSave)
+    EmitAddSP(-FrameSize);
+
+  for (unsigned I = 0; I <= NumSRegs; ++I) {
+    MCInst Inst;
+    if (IsSave)
+      Inst.setOpcode(IsRV64 ? RISCV::SD : RISCV::SW);
+    else
+      Inst.setOpcode(IsRV64 ? RISCV::LD : RISCV::LW);
+    Inst.addOperand(MCOperand::createReg(Regs[I]));
+    Inst.addOperand(MCOperand::createImm(FrameSize - (I + 1) * SlotSize));
+    Inst.addOperand(MCOperand::createReg(SP));
+    OutStreamer->EmitInstruction(Inst, STI);
+  }
+
+  MCInst Ret;
+  if (IsSave) {
+    // jr t0
+    Ret.setOpcode(IsRV64 ? RISCV::JALR64 : RISCV::JALR);
+    Ret.addOperand(MCOperand::createReg(IsRV64 ? RISCV::zero_64 : RISCV::zero));
+    Ret.addOperand(MCOperand::createImm(0));
+    Ret.addOperand(MCOperand::createReg(IsRV64 ? RISCV::t0_64 : RISCV::t0));
+  } else {
+    EmitAddSP(FrameSize);
+    Ret.setOpcode(IsRV64 ? RISCV::RET64 : RISCV::RET);
+  }
+  OutStreamer->EmitInstruction(Ret, STI);
+
+  MCSymbol *End = OutContext.createTempSymbol();
+  OutStreamer->EmitLabel(End);
+  OutStreamer->emitELFSize(cast<MCSymbolELF>(Sym), MCBinaryExpr::createSub(
+      MCSymbolRefExpr::create(End, OutContext),
+      MCSymbolRefExpr::create(Sym, OutContext), OutContext));
+}
+
+// Emit an XRay sled of Kind for MI and record it for the xray_instr_map
+// section:
+//
+// .Lxray_sled_N:
+//   j 44 (RV32) or 68 (RV64)    # to the end of the sled
+//   # 10 (RV32) or 16 (RV64) nops
+//
+// At run time the sled is patched into a sequence that spills ra, loads the
+// function id and the trampoline address into registers and calls the
+// trampoline.  The jump takes a constant offset because the sled has a fixed
+// size and must be emitted identically to assembly and object files.
+void RISCVAsmPrinter::emitXRaySled(const MachineInstr &MI, SledKind Kind) {
+  bool IsRV64 = Subtarget->isRV64();
+  const MCSubtargetInfo &STI = getSubtargetInfo();
+  unsigned SledSize = Subtarget->getInstrInfo()->getXRaySledSize();
+  MCSymbol *CurSled = OutContext.createTempSymbol("xray_sled_", true);
+  OutStreamer->EmitLabel(CurSled);
+
+  MCInst Jump;
+  Jump.setOpcode(IsRV64 ? RISCV::J64 : RISCV::J);
+  Jump.addOperand(MCOperand::createImm(SledSize));
+  OutStreamer->EmitInstruction(Jump, STI);
+
+  unsigned NumNops = SledSize / 4 - 1;
+  unsigned Zero = IsRV64 ? RISCV::zero_64 : RISCV::zero;
+  for (unsigned I = 0; I < NumNops; ++I) {
+    MCInst Nop;
+    Nop.setOpcode(IsRV64 ? RISCV::ADDI64 : RISCV::ADDI);
+    Nop.addOperand(MCOperand::createReg(Zero));
+    Nop.addOperand(MCOperand::createReg(Zero));
+    Nop.addOperand(MCOperand::createImm(0));
+    OutStreamer->EmitInstruction(Nop, STI);
+  }
+
+  const Function *Fn = MI.getParent()->getParent()->getFunction();
+  Attribute Attr = Fn->getFnAttribute("function-instrument");
+  bool AlwaysInstrument =
+      Attr.isStringAttribute() && Attr.getValueAsString() == "xray-always";
+  Sleds.push_back(
+      XRayFunctionEntry{CurSled, CurrentFnSym, Kind, AlwaysInstrument});
+}
+
+void RISCVAsmPrinter::LowerPATCHABLE_FUNCTION_ENTER(const MachineInstr &MI) {
+  emitXRaySled(MI, SledKind::FUNCTION_ENTER);
+}
+
+// The XRay pass puts PATCHABLE_FUNCTION_EXIT in front of every return,
+// including the tail call into a __riscv_restore_N routine, so that the
+// patched call falls through to the return.
+void RISCVAsmPrinter::LowerPATCHABLE_FUNCTION_EXIT(const MachineInstr &MI) {
+  emitXRaySled(MI, SledKind::FUNCTION_EXIT);
+}
+
+// Emit the xray_instr_map entries for the sleds of the current function in a
+// section grouped with the function.  Addresses are pointer-sized and each
+// entry is padded to four pointers.
+void RISCVAsmPrinter::EmitXRayTable() {
+  if (Sleds.empty())
+    return;
+  if (TM.getTargetTriple().isOSBinFormatELF()) {
+    unsigned PtrSize = Subtarget->isRV64() ? 8 : 4;
+    MCSection *Section = OutContext.getELFSection(
+        "xray_instr_map", ELF::SHT_PROGBITS,
+        ELF::SHF_ALLOC | ELF::SHF_GROUP | ELF::SHF_MERGE, 0,
+        CurrentFnSym->getName());
+    MCSection *PrevSection = OutStreamer->getCurrentSectionOnly();
+    OutStreamer->SwitchSection(Section);
+    for (const XRayFunctionEntry &Sled : Sleds) {
+      OutStreamer->EmitSymbolValue(Sled.Sled, PtrSize);
+      OutStreamer->EmitSymbolValue(Sled.Function, PtrSize);
+      OutStreamer->EmitIntValue(static_cast<uint8_t>(Sled.Kind), 1);
+      OutStreamer->EmitIntValue(Sled.AlwaysInstrument, 1);
+      OutStreamer->EmitZeros(2 * PtrSize - 2);
+    }
+    OutStreamer->SwitchSection(PrevSection);
+  }
+  Sleds.clear();
+}
+
 void RISCVAsmPrinter::EmitEndOfAsmFile(Module &M) {
   const Triple &TT = TM.getTargetTriple();
+  if (TT.isOSBinFormatELF() && EmitSaveRestoreLibCalls) {
+    for (const std::string &Name : SaveRestoreLibCalls)
+      emitSaveRestoreLibCall(Name, TT.isArch64Bit());
+  }
+  SaveRestoreLibCalls.clear();
+
   if (TT.isOSBinFormatELF()) {
     const TargetLoweringObjectFileELF &TLOFELF =
       static_cast<const TargetLoweringObjectFileELF &>(getObjFileLowering());
@@ -145,7 +338,9 @@ void RISCVAsmPrinter::EmitEndOfAsmFile(Module &M) {
 
 bool RISCVAsmPrinter::runOnMachineFunction(MachineFunction &MF) {
   Subtarget = &MF.getSubtarget<RISCVSubtarget>();
-  return AsmPrinter::runOnMachineFunction(MF);
+  AsmPrinter::runOnMachineFunction(MF);
+  EmitXRayTable();
+  return false;
 }
 
 // Force static initialization.
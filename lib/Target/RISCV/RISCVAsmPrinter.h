@@ -13,9 +13,13 @@
 #include "RISCVTargetMachine.h"
 #include "llvm/CodeGen/AsmPrinter.h"
 #include "llvm/Support/Compiler.h"
+#include <set>
+#include <string>
+#include <vector>
 
 namespace llvm {
 class MCStreamer;
+class MCSymbol;
 class MachineBasicBlock;
 class MachineInstr;
 class Module;
@@ -25,6 +29,38 @@ class LLVM_LIBRARY_VISIBILITY RISCVAsmPrinter : public AsmPrinter {
 private:
   const RISCVSubtarget *Subtarget;
 
+  // Names of the callee-saved register save/restore routines called from
+  // this module, emitted by EmitEndOfAsmFile.
+  std::set<std::string> SaveRestoreLibCalls;
+
+  void emitSaveRestoreLibCall(StringRef Name, bool IsRV64);
+
+  // The kind of an XRay sled, as recorded in the xray_instr_map section.
+  enum class SledKind : uint8_t {
+    FUNCTION_ENTER = 0,
+    FUNCTION_EXIT = 1,
+    TAIL_CALL = 2,
+  };
+
+  // An entry of the xray_instr_map section: the address of the sled, the
+  // function containing it, the kind of sled and whether the function
+  // should always be instrumented.
+  struct XRayFunctionEntry {
+    const MCSymbol *Sled;
+    const MCSymbol *Function;
+    SledKind Kind;
+    bool AlwaysInstrument;
+  };
+
+  // The sleds emitted for the current function.
+  std::vector<XRayFunctionEntry> Sleds;
+
+  // XRay-specific lowering.
+  void emitXRaySled(const MachineInstr &MI, SledKind Kind);
+  void LowerPATCHABLE_FUNCTION_ENTER(const MachineInstr &MI);
+  void LowerPATCHABLE_FUNCTION_EXIT(const MachineInstr &MI);
+  void EmitXRayTable();
+
 public:
   RISCVAsmPrinter(TargetMachine &TM, std::unique_ptr<MCStreamer> Streamer)
     : AsmPrinter(TM, std::move(Streamer)) {}
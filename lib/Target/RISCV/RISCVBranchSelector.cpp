@@ -70,6 +70,7 @@ bool RISCVBSel::runOnMachineFunction(MachineFunction &Fn) {
 
   // Measure each MBB and compute a size for the entire function.
   unsigned FuncSize = 0;
+  bool HasColdSection = false;
   for (MachineFunction::iterator MFI = Fn.begin(), E = Fn.end(); MFI != E;
        ++MFI) {
     MachineBasicBlock &MBB = *MFI;
@@ -81,12 +82,14 @@ bool RISCVBSel::runOnMachineFunction(MachineFunction &Fn) {
     
     BlockSizes[MBB.getNumber()] = BlockSize;
     FuncSize += BlockSize;
+    HasColdSection |= MBB.isColdSection();
   }
   
   // If the entire function is smaller than the displacement of a branch field,
   // we know we don't need to shrink any branches in this function.  This is a
-  // common case.
-  if (FuncSize < (1 << 11)) {
+  // common case.  Branches to the cold section of a split function may have to
+  // go anywhere, though.
+  if (FuncSize < (1 << 11) && !HasColdSection) {
     BlockSizes.clear();
     return false;
   }
@@ -118,8 +121,11 @@ bool RISCVBSel::runOnMachineFunction(MachineFunction &Fn) {
         Cond.push_back(MachineOperand::CreateImm(0));
         const MachineOperand *DestOp;
 
-        //const MachineInstr *const_i = I;
-        if (!TII->isBranch(I, Cond, DestOp)){
+        // Only conditional branches are limited to 12 bits; jumps and calls,
+        // which analyzeBranch would describe with the conditional branch of
+        // the block, are left alone.
+        if (!TII->isBranch(I, Cond, DestOp) ||
+            Cond[0].getImm() == RISCV::CCMASK_ANY) {
           MBBStartOffset += TII->GetInstSizeInBytes(I);
           continue;
         }
@@ -157,8 +163,11 @@ bool RISCVBSel::runOnMachineFunction(MachineFunction &Fn) {
             BranchSize += BlockSizes[i];
         }
 
-        // If this branch is in range, ignore it.
-        if (isInt<12>(BranchSize)) {
+        // If this branch is in range, ignore it.  The linker places the
+        // sections of a split function, so branches between them always need
+        // the long form.
+        if (isInt<12>(BranchSize) &&
+            Dest->isColdSection() == MBB.isColdSection()) {
           MBBStartOffset += 4;
           continue;
         }
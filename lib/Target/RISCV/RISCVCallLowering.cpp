@@ -0,0 +1,123 @@
+//===-- llvm/lib/Target/RISCV/RISCVCallLowering.cpp - Call lowering -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file implements the lowering of LLVM calls to machine code calls for
+/// GlobalISel.
+///
+/// Only integer values that fit in a GPR are supported for now. They are
+/// passed in a0-a7 and returned in a0, following CC_RISCV32/CC_RISCV64:
+/// values narrower than XLEN are promoted, so the upper bits of the register
+/// are undefined on entry and on return.
+///
+//===----------------------------------------------------------------------===//
+
+#include "RISCVCallLowering.h"
+#include "RISCVISelLowering.h"
+#include "RISCVSubtarget.h"
+
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "This shouldn't be built without GISel"
+#endif
+
+static const MCPhysReg ArgGPRs32[] = {
+  RISCV::a0, RISCV::a1, RISCV::a2, RISCV::a3,
+  RISCV::a4, RISCV::a5, RISCV::a6, RISCV::a7
+};
+
+static const MCPhysReg ArgGPRs64[] = {
+  RISCV::a0_64, RISCV::a1_64, RISCV::a2_64, RISCV::a3_64,
+  RISCV::a4_64, RISCV::a5_64, RISCV::a6_64, RISCV::a7_64
+};
+
+RISCVCallLowering::RISCVCallLowering(const RISCVTargetLowering &TLI)
+  : CallLowering(&TLI) {
+}
+
+/// Return the width of the GPRs of the function being built.
+static unsigned getXLen(const MachineFunction &MF) {
+  return MF.getSubtarget<RISCVSubtarget>().isRV64() ? 64 : 32;
+}
+
+bool RISCVCallLowering::lowerReturn(MachineIRBuilder &MIRBuilder,
+                                    const Value *Val, unsigned VReg) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  unsigned XLen = getXLen(MF);
+
+  assert(((Val && VReg) || (!Val && !VReg)) && "Return value without a vreg");
+  if (VReg) {
+    Type *Ty = Val->getType();
+    if (!Ty->isIntegerTy() || Ty->getPrimitiveSizeInBits() > XLen)
+      return false;
+    // The caller only looks at the bits of the original type, so any
+    // extension to XLEN will do.
+    if (Ty->getPrimitiveSizeInBits() != XLen) {
+      unsigned ExtReg = MRI.createGenericVirtualRegister(XLen);
+      MIRBuilder.buildInstr(TargetOpcode::G_ANYEXT,
+                            IntegerType::get(Ty->getContext(), XLen), ExtReg,
+                            VReg);
+      VReg = ExtReg;
+    }
+  }
+
+  MachineInstr *Return = MIRBuilder.buildInstr(RISCV::RET);
+  assert(Return && "Unable to build a return instruction?!");
+
+  if (VReg) {
+    unsigned ResReg = XLen == 64 ? RISCV::a0_64 : RISCV::a0;
+    // Set the insertion point to be right before Return.
+    MIRBuilder.setInstr(*Return, /* Before */ true);
+    MIRBuilder.buildInstr(TargetOpcode::COPY, ResReg, VReg);
+    MachineInstrBuilder(MF, Return).addReg(ResReg, RegState::Implicit);
+  }
+  return true;
+}
+
+bool RISCVCallLowering::lowerFormalArguments(
+    MachineIRBuilder &MIRBuilder, const Function::ArgumentListType &Args,
+    const SmallVectorImpl<unsigned> &VRegs) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  const Function &F = *MF.getFunction();
+  unsigned XLen = getXLen(MF);
+  ArrayRef<MCPhysReg> ArgGPRs =
+      XLen == 64 ? makeArrayRef(ArgGPRs64) : makeArrayRef(ArgGPRs32);
+
+  // Arguments passed on the stack are not supported yet.
+  if (F.isVarArg() || Args.size() > ArgGPRs.size())
+    return false;
+
+  unsigned i = 0;
+  for (const Argument &Arg : Args) {
+    Type *Ty = Arg.getType();
+    if (!Ty->isIntegerTy() || Ty->getPrimitiveSizeInBits() > XLen)
+      return false;
+
+    // Transform the arguments in physical registers into virtual ones.
+    unsigned PhysReg = ArgGPRs[i];
+    MIRBuilder.getMBB().addLiveIn(PhysReg);
+    if (Ty->getPrimitiveSizeInBits() == XLen) {
+      MIRBuilder.buildInstr(TargetOpcode::COPY, VRegs[i], PhysReg);
+    } else {
+      // Narrower arguments have been promoted to XLEN by the caller.
+      unsigned WideReg = MRI.createGenericVirtualRegister(XLen);
+      MIRBuilder.buildInstr(TargetOpcode::COPY, WideReg, PhysReg);
+      MIRBuilder.buildInstr(TargetOpcode::G_TRUNC, Ty, VRegs[i], WideReg);
+    }
+    ++i;
+  }
+  return true;
+}
@@ -13,6 +13,7 @@
 #include "RISCVInstrInfo.h"
 #include "RISCVMachineFunctionInfo.h"
 #include "RISCVSubtarget.h"
+#include "llvm/ADT/SmallSet.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/RegisterScavenging.h"
@@ -77,6 +78,73 @@ unsigned RISCVFrameLowering::ehDataReg(unsigned I) const {
   return EhDataReg[I];
 }
 
+// The __riscv_save_N routines store ra and s0..s(N-1) in consecutive slots
+// directly below the incoming stack pointer, ra in the highest one.  Return
+// the slot Reg occupies in that area, or -1 if the routines don't handle Reg.
+static int getLibCallSlot(unsigned Reg) {
+  switch (Reg) {
+  case RISCV::ra:  case RISCV::ra_64:  return 0;
+  case RISCV::fp:  case RISCV::fp_64:
+  case RISCV::s0:  case RISCV::s0_64:  return 1;
+  case RISCV::s1:  case RISCV::s1_64:  return 2;
+  case RISCV::s2:  case RISCV::s2_64:  return 3;
+  case RISCV::s3:  case RISCV::s3_64:  return 4;
+  case RISCV::s4:  case RISCV::s4_64:  return 5;
+  case RISCV::s5:  case RISCV::s5_64:  return 6;
+  case RISCV::s6:  case RISCV::s6_64:  return 7;
+  case RISCV::s7:  case RISCV::s7_64:  return 8;
+  case RISCV::s8:  case RISCV::s8_64:  return 9;
+  case RISCV::s9:  case RISCV::s9_64:  return 10;
+  case RISCV::s10: case RISCV::s10_64: return 11;
+  case RISCV::s11: case RISCV::s11_64: return 12;
+  default:
+    return -1;
+  }
+}
+
+// Return the highest libcall slot used by CSI, which is also the number of
+// s-registers the routines have to save, or -1 if no libcall is needed.
+static int getLibCallMaxSlot(const std::vector<CalleeSavedInfo> &CSI) {
+  int MaxSlot = -1;
+  for (const auto &I : CSI)
+    MaxSlot = std::max(MaxSlot, getLibCallSlot(I.getReg()));
+  return MaxSlot;
+}
+
+static const char *const SaveLibCalls[] = {
+  "__riscv_save_0", "__riscv_save_1", "__riscv_save_2", "__riscv_save_3",
+  "__riscv_save_4", "__riscv_save_5", "__riscv_save_6", "__riscv_save_7",
+  "__riscv_save_8", "__riscv_save_9", "__riscv_save_10", "__riscv_save_11",
+  "__riscv_save_12"
+};
+
+static const char *const RestoreLibCalls[] = {
+  "__riscv_restore_0", "__riscv_restore_1", "__riscv_restore_2",
+  "__riscv_restore_3", "__riscv_restore_4", "__riscv_restore_5",
+  "__riscv_restore_6", "__riscv_restore_7", "__riscv_restore_8",
+  "__riscv_restore_9", "__riscv_restore_10", "__riscv_restore_11",
+  "__riscv_restore_12"
+};
+
+// Return true if Reg is saved and restored by the libcalls in this function.
+static bool isSavedByLibCall(const MachineFunction &MF, unsigned Reg) {
+  return MF.getInfo<RISCVFunctionInfo>()->getLibCallStackSize() &&
+         getLibCallSlot(Reg) >= 0;
+}
+
+bool
+RISCVFrameLowering::useSaveRestoreLibCalls(const MachineFunction &MF) const {
+  const Function *F = MF.getFunction();
+
+  // The routines own the top of the frame, which is where the register
+  // varargs and eh data would otherwise be saved.
+  if (F->isVarArg() || MF.getInfo<RISCVFunctionInfo>()->getCallsEhReturn())
+    return false;
+
+  return MF.getSubtarget<RISCVSubtarget>().enableSaveRestore() ||
+         F->optForMinSize();
+}
+
 void RISCVFrameLowering::emitPrologue(MachineFunction &MF, MachineBasicBlock &MBB) const {
   assert(&MBB == &MF.front() && "Shrink-wrapping not yet implemented");
   MachineFrameInfo *MFI    = MF.getFrameInfo();
@@ -95,6 +163,8 @@ void RISCVFrameLowering::emitPrologue(MachineFunction &MF, MachineBasicBlock &MB
 
   // First, compute final stack size.
   uint64_t StackSize = MFI->getStackSize();
+  // The part of it that the save libcall allocates, if any.
+  uint64_t LibCallStackSize = RISCVFI->getLibCallStackSize();
 
   // No need to allocate space on the stack.
   if (StackSize == 0 && !MFI->adjustsStack()) return;
@@ -103,26 +173,58 @@ void RISCVFrameLowering::emitPrologue(MachineFunction &MF, MachineBasicBlock &MB
   const MCRegisterInfo *MRI = MMI.getContext().getRegisterInfo();
   MachineLocation DstML, SrcML;
 
-  // Adjust stack.
-  TII.adjustStackPtr(SP, -StackSize, MBB, MBBI);
+  const std::vector<CalleeSavedInfo> &CSI = MFI->getCalleeSavedInfo();
 
-  // emit ".cfi_def_cfa_offset StackSize"
-  unsigned CFIIndex = MMI.addFrameInst(
-      MCCFIInstruction::createDefCfaOffset(nullptr, -StackSize));
-  BuildMI(MBB, MBBI, dl, TII.get(TargetOpcode::CFI_INSTRUCTION))
-      .addCFIIndex(CFIIndex);
+  if (LibCallStackSize) {
+    // Skip the call to the save routine, it has already moved the stack
+    // pointer and stored the registers it handles.
+    ++MBBI;
 
-  const std::vector<CalleeSavedInfo> &CSI = MFI->getCalleeSavedInfo();
+    // emit ".cfi_def_cfa_offset LibCallStackSize"
+    unsigned CFIIndex = MMI.addFrameInst(
+        MCCFIInstruction::createDefCfaOffset(nullptr, -LibCallStackSize));
+    BuildMI(MBB, MBBI, dl, TII.get(TargetOpcode::CFI_INSTRUCTION))
+        .addCFIIndex(CFIIndex);
+
+    // fp and s0 name the same register, only describe it once.
+    SmallSet<unsigned, 16> Described;
+    for (const auto &I: CSI) {
+      if (!isSavedByLibCall(MF, I.getReg()))
+        continue;
+      unsigned DwarfReg = MRI->getDwarfRegNum(I.getReg(), 1);
+      if (!Described.insert(DwarfReg).second)
+        continue;
+      int64_t Offset = MFI->getObjectOffset(I.getFrameIdx());
+      unsigned CFIIndex = MMI.addFrameInst(MCCFIInstruction::createOffset(
+          nullptr, DwarfReg, Offset));
+      BuildMI(MBB, MBBI, dl, TII.get(TargetOpcode::CFI_INSTRUCTION))
+          .addCFIIndex(CFIIndex);
+    }
+  }
+
+  if (StackSize != LibCallStackSize || !LibCallStackSize) {
+    // Adjust stack.
+    TII.adjustStackPtr(SP, -(StackSize - LibCallStackSize), MBB, MBBI);
+
+    // emit ".cfi_def_cfa_offset StackSize"
+    unsigned CFIIndex = MMI.addFrameInst(
+        MCCFIInstruction::createDefCfaOffset(nullptr, -StackSize));
+    BuildMI(MBB, MBBI, dl, TII.get(TargetOpcode::CFI_INSTRUCTION))
+        .addCFIIndex(CFIIndex);
+  }
 
   if (CSI.size()) {
     // Find the instruction past the last instruction that saves a callee-saved
     // register to the stack.
-    for (unsigned i = 0; i < CSI.size(); ++i)
-      ++MBBI;
+    for (const auto &I: CSI)
+      if (!isSavedByLibCall(MF, I.getReg()))
+        ++MBBI;
 
     // Iterate over list of callee-saved registers and emit .cfi_offset
     // directives.
     for (const auto &I: CSI) {
+      if (isSavedByLibCall(MF, I.getReg()))
+        continue;
       int64_t Offset = MFI->getObjectOffset(I.getFrameIdx());
       unsigned Reg = I.getReg();
 
@@ -193,8 +295,9 @@ void RISCVFrameLowering::emitEpilogue(MachineFunction &MF,
     // Find the first instruction that restores a callee-saved register.
     MachineBasicBlock::iterator I = MBBI;
 
-    for (unsigned i = 0; i < MFI->getCalleeSavedInfo().size(); ++i)
-      --I;
+    for (const auto &CS : MFI->getCalleeSavedInfo())
+      if (!isSavedByLibCall(MF, CS.getReg()))
+        --I;
 
     // Insert instruction "move $sp, $fp" at this location.
     BuildMI(MBB, I, dl, TII.get(ADDu), SP).addReg(FP).addReg(ZERO);
@@ -215,8 +318,9 @@ void RISCVFrameLowering::emitEpilogue(MachineFunction &MF,
     }
   }
 
-  // Get the number of bytes from FrameInfo
-  uint64_t StackSize = MFI->getStackSize();
+  // Get the number of bytes from FrameInfo, less the part that the restore
+  // libcall frees.
+  uint64_t StackSize = MFI->getStackSize() - RISCVFI->getLibCallStackSize();
 
   if (!StackSize)
     return;
@@ -233,6 +337,18 @@ spillCalleeSavedRegisters(MachineBasicBlock &MBB,
   MachineFunction *MF = MBB.getParent();
   MachineBasicBlock &EntryBlock = *(MF->begin());
   const TargetInstrInfo &TII = *MF->getSubtarget().getInstrInfo();
+  const RISCVSubtarget &STI = MF->getSubtarget<RISCVSubtarget>();
+  DebugLoc DL = MI != EntryBlock.end() ? MI->getDebugLoc() : DebugLoc();
+
+  // Call the save routine first.  It gets its own part of the frame, the
+  // remaining registers are stored once emitPrologue has allocated the rest.
+  MachineInstrBuilder LibCall;
+  if (MF->getInfo<RISCVFunctionInfo>()->getLibCallStackSize())
+    LibCall = BuildMI(EntryBlock, MI, DL,
+                      TII.get(STI.isRV64() ? RISCV::SAVE_LIBCALL64
+                                           : RISCV::SAVE_LIBCALL))
+                  .addExternalSymbol(SaveLibCalls[getLibCallMaxSlot(CSI)])
+                  .setMIFlag(MachineInstr::FrameSetup);
 
   for (unsigned i = 0, e = CSI.size(); i != e; ++i) {
     // Add the callee-saved register as live-in. Do not add if the register is
@@ -246,6 +362,11 @@ spillCalleeSavedRegisters(MachineBasicBlock &MBB,
     if (!IsRAAndRetAddrIsTaken)
       EntryBlock.addLiveIn(Reg);
 
+    if (isSavedByLibCall(*MF, Reg)) {
+      LibCall.addReg(Reg, RegState::Implicit);
+      continue;
+    }
+
     // Insert the spill to the stack frame.
     bool IsKill = !IsRAAndRetAddrIsTaken;
     const TargetRegisterClass *RC = TRI->getMinimalPhysRegClass(Reg);
@@ -256,6 +377,87 @@ spillCalleeSavedRegisters(MachineBasicBlock &MBB,
   return true;
 }
 
+bool RISCVFrameLowering::
+restoreCalleeSavedRegisters(MachineBasicBlock &MBB,
+                            MachineBasicBlock::iterator MI,
+                            const std::vector<CalleeSavedInfo> &CSI,
+                            const TargetRegisterInfo *TRI) const {
+  MachineFunction *MF = MBB.getParent();
+  if (!MF->getInfo<RISCVFunctionInfo>()->getLibCallStackSize())
+    return false;
+
+  const TargetInstrInfo &TII = *MF->getSubtarget().getInstrInfo();
+  const RISCVSubtarget &STI = MF->getSubtarget<RISCVSubtarget>();
+  DebugLoc DL = MI != MBB.end() ? MI->getDebugLoc() : DebugLoc();
+
+  // Reload the registers that were spilled inline, in reverse order.
+  for (unsigned i = CSI.size(); i != 0; --i) {
+    unsigned Reg = CSI[i - 1].getReg();
+    if (isSavedByLibCall(*MF, Reg))
+      continue;
+    const TargetRegisterClass *RC = TRI->getMinimalPhysRegClass(Reg);
+    TII.loadRegFromStackSlot(MBB, MI, Reg, CSI[i - 1].getFrameIdx(), RC, TRI);
+  }
+
+  // The restore routine reloads the rest, frees its part of the frame and
+  // returns to our caller, so it takes the place of the return.
+  MachineInstrBuilder LibCall =
+    BuildMI(MBB, MI, DL, TII.get(STI.isRV64() ? RISCV::RESTORE_LIBCALL64
+                                              : RISCV::RESTORE_LIBCALL))
+        .addExternalSymbol(RestoreLibCalls[getLibCallMaxSlot(CSI)])
+        .setMIFlag(MachineInstr::FrameDestroy);
+  for (const auto &I : CSI)
+    if (isSavedByLibCall(*MF, I.getReg()))
+      LibCall.addReg(I.getReg(), RegState::ImplicitDefine);
+
+  if (MI != MBB.end() && MI->isReturn()) {
+    LibCall->copyImplicitOps(*MF, *MI);
+    MI->eraseFromParent();
+  }
+
+  return true;
+}
+
+bool RISCVFrameLowering::
+assignCalleeSavedSpillSlots(MachineFunction &MF, const TargetRegisterInfo *TRI,
+                            std::vector<CalleeSavedInfo> &CSI) const {
+  int MaxSlot = getLibCallMaxSlot(CSI);
+  if (MaxSlot < 0 || !useSaveRestoreLibCalls(MF))
+    return false;
+
+  MachineFrameInfo *MFI = MF.getFrameInfo();
+  const RISCVSubtarget &STI = MF.getSubtarget<RISCVSubtarget>();
+  int64_t SlotSize = STI.isRV64() ? 8 : 4;
+  int64_t SaveAreaSize = (MaxSlot + 1) * SlotSize;
+  int64_t LibCallStackSize = alignTo(SaveAreaSize, getStackAlignment());
+  MF.getInfo<RISCVFunctionInfo>()->setLibCallStackSize(LibCallStackSize);
+
+  // Registers handled by the routines live at the fixed offsets the routines
+  // store them to, the rest are spilled wherever is convenient.
+  for (auto &CS : CSI) {
+    unsigned Reg = CS.getReg();
+    int Slot = getLibCallSlot(Reg);
+    int FrameIdx;
+    if (Slot >= 0) {
+      FrameIdx = MFI->CreateFixedSpillStackObject(SlotSize,
+                                                  -(Slot + 1) * SlotSize);
+    } else {
+      const TargetRegisterClass *RC = TRI->getMinimalPhysRegClass(Reg);
+      unsigned Align = std::min(RC->getAlignment(), getStackAlignment());
+      FrameIdx = MFI->CreateStackObject(RC->getSize(), Align, true);
+    }
+    CS.setFrameIdx(FrameIdx);
+  }
+
+  // Keep the rest of the frame clear of the padding the routines allocate
+  // below their save area.
+  if (LibCallStackSize != SaveAreaSize)
+    MFI->CreateFixedSpillStackObject(LibCallStackSize - SaveAreaSize,
+                                     -LibCallStackSize);
+
+  return true;
+}
+
 bool
 RISCVFrameLowering::hasReservedCallFrame(const MachineFunction &MF) const {
   const MachineFrameInfo *MFI = MF.getFrameInfo();
@@ -301,6 +503,17 @@ void RISCVFrameLowering::determineCalleeSaves(MachineFunction &MF, BitVector &Sa
   if (hasFP(MF))
     SavedRegs.set(FP);
 
+  // The save routines always store ra, so describe it as saved whenever one
+  // of them is going to be called.
+  if (useSaveRestoreLibCalls(MF)) {
+    for (int Reg = SavedRegs.find_first(); Reg != -1;
+         Reg = SavedRegs.find_next(Reg))
+      if (getLibCallSlot(Reg) > 0) {
+        SavedRegs.set(STI.isRV64() ? RISCV::ra_64 : RISCV::ra);
+        break;
+      }
+  }
+
   // Create spill slots for eh data registers if function calls eh_return.
   if (RISCVFI->getCallsEhReturn())
     RISCVFI->createEhDataRegsFI();
@@ -37,6 +37,21 @@ public:
                                  const std::vector<CalleeSavedInfo> &CSI,
                                  const TargetRegisterInfo *TRI) const;
 
+  bool restoreCalleeSavedRegisters(MachineBasicBlock &MBB,
+                                   MachineBasicBlock::iterator MI,
+                                   const std::vector<CalleeSavedInfo> &CSI,
+                                   const TargetRegisterInfo *TRI) const override;
+
+  bool assignCalleeSavedSpillSlots(MachineFunction &MF,
+                                   const TargetRegisterInfo *TRI,
+                                   std::vector<CalleeSavedInfo> &CSI) const
+                                   override;
+
+  /// useSaveRestoreLibCalls - Return true if the callee-saved GPRs of MF are
+  /// saved and restored by the shared __riscv_save_N/__riscv_restore_N
+  /// routines rather than by inline stores and loads.
+  bool useSaveRestoreLibCalls(const MachineFunction &MF) const;
+
   bool hasReservedCallFrame(const MachineFunction &MF) const;
 
   void determineCalleeSaves(MachineFunction &MF, BitVector &SavedRegs,
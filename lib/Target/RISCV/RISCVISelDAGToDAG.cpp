@@ -128,6 +128,24 @@ class RISCVDAGToDAGISel : public SelectionDAGISel {
     return true;
   }
 
+  // Like selectMemRegAddr, but for the Zicbop prefetch hints, whose offset
+  // must be a multiple of 32.  Frame indices are left in a register, since
+  // eliminating them could produce an offset the hints can't encode.
+  bool selectPrefetchAddr(SDValue Addr, SDValue &Offset, SDValue &Base) {
+    EVT ValTy = Addr.getValueType();
+    if (CurDAG->isBaseWithConstantOffset(Addr)) {
+      int64_t Imm = cast<ConstantSDNode>(Addr.getOperand(1))->getSExtValue();
+      if (isInt<12>(Imm) && (Imm & 31) == 0) {
+        Base = Addr.getOperand(0);
+        Offset = CurDAG->getTargetConstant(Imm, SDLoc(Addr), ValTy);
+        return true;
+      }
+    }
+    Base = Addr;
+    Offset = CurDAG->getTargetConstant(0, SDLoc(Addr), ValTy);
+    return true;
+  }
+
   bool selectRegAddr(SDValue Addr, SDValue &Base) {
     //always just register
     Base = Addr;
@@ -427,6 +445,36 @@ void RISCVDAGToDAGISel::Select(SDNode *Node) {
     ReplaceNode(Node, CurDAG->getMachineNode(Opc, DL, VT, TFI, imm));
     return;
   }
+  case ISD::ConstantFP: {
+    // isFPImmLegal accepts +0.0, matched by the fpimm0 patterns, and values
+    // whose bits take at most two integer instructions.  Build the latter
+    // in a GPR with li, which the assembler expands to lui/addi/slli, and
+    // move them across with fmv.
+    const APFloat &Val = cast<ConstantFPSDNode>(Node)->getValueAPF();
+    if (Val.isPosZero())
+      break;
+    EVT VT = Node->getValueType(0);
+    bool IsDouble = VT == MVT::f64;
+    MVT IntVT = IsDouble ? MVT::i64 : MVT::i32;
+    SDValue Bits = CurDAG->getTargetConstant(
+        Val.bitcastToAPInt().getZExtValue(), DL, IntVT);
+    SDNode *Int = CurDAG->getMachineNode(IsDouble ? RISCV::LI64 : RISCV::LI,
+                                         DL, IntVT, Bits);
+    ReplaceNode(Node, CurDAG->getMachineNode(
+                          IsDouble ? RISCV::FMV_D_X : RISCV::FMV_S_X, DL, VT,
+                          SDValue(Int, 0)));
+    return;
+  }
+  case ISD::BITCAST: {
+    //vectors of the same size share the V registers, nothing to do
+    SDValue Src = Node->getOperand(0);
+    if (Node->getValueType(0).isVector() && Src.getValueType().isVector()) {
+      ReplaceUses(SDValue(Node, 0), Src);
+      CurDAG->RemoveDeadNode(Node);
+      return;
+    }
+    break;
+  }
   }//end special selections
 
   // Select the default instruction
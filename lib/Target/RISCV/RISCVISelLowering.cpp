@@ -67,6 +67,12 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &tm,
     addRegisterClass(MVT::f32,  &RISCV::FP32BitRegClass);
   }else if(Subtarget.hasF())
     addRegisterClass(MVT::f32,  &RISCV::FP32BitRegClass);
+  //Fixed-length vectors that fit in one V register
+  if(Subtarget.hasV()) {
+    for (MVT VT : MVT::vector_valuetypes())
+      if (isLegalRVVType(VT))
+        addRegisterClass(VT, &RISCV::VRBitRegClass);
+  }
 
 
   // Set up special registers.
@@ -397,6 +403,42 @@ RISCVTargetLowering::RISCVTargetLowering(const TargetMachine &tm,
   setOperationAction(ISD::VACOPY , MVT::Other, Expand);
   setOperationAction(ISD::VAEND  , MVT::Other, Expand);
 
+  // Handle vector types, only the operations with a pattern in
+  // RISCVInstrInfoV.td are legal, everything else is expanded.
+  for (MVT VT : MVT::vector_valuetypes()) {
+    for (MVT InnerVT : MVT::vector_valuetypes()) {
+      setTruncStoreAction(VT, InnerVT, Expand);
+      setLoadExtAction(ISD::SEXTLOAD, VT, InnerVT, Expand);
+      setLoadExtAction(ISD::ZEXTLOAD, VT, InnerVT, Expand);
+      setLoadExtAction(ISD::EXTLOAD, VT, InnerVT, Expand);
+    }
+    if (!isTypeLegal(VT))
+      continue;
+    for (unsigned Opc = 0; Opc < ISD::BUILTIN_OP_END; ++Opc)
+      setOperationAction(Opc, VT, Expand);
+    setOperationAction(ISD::UNDEF,   VT, Legal);
+    setOperationAction(ISD::LOAD,    VT, Legal);
+    setOperationAction(ISD::STORE,   VT, Legal);
+    //only free between vectors of the same size
+    setOperationAction(ISD::BITCAST, VT, Custom);
+    if (VT.isInteger()) {
+      setOperationAction(ISD::ADD, VT, Legal);
+      setOperationAction(ISD::SUB, VT, Legal);
+      setOperationAction(ISD::MUL, VT, Legal);
+    } else {
+      setOperationAction(ISD::FADD, VT, Legal);
+      setOperationAction(ISD::FMUL, VT, Legal);
+    }
+    //splats and element 0 have their own instructions
+    setOperationAction(ISD::BUILD_VECTOR,       VT, Custom);
+    setOperationAction(ISD::EXTRACT_VECTOR_ELT, VT, Custom);
+  }
+  if (Subtarget.hasV())
+    setTargetDAGCombine(ISD::EXTRACT_VECTOR_ELT);
+
+  // llvm.prefetch is dropped unless we have the Zicbop hints.
+  if (Subtarget.hasZicbop())
+    setOperationAction(ISD::PREFETCH, MVT::Other, Legal);
 
   // Compute derived properties from the register classes
   computeRegisterProperties(STI.getRegisterInfo());
@@ -427,9 +469,69 @@ bool RISCVTargetLowering::isOffsetFoldingLegal(const GlobalAddressSDNode *GA) co
   return false;
 }
 
+// Return the number of instructions the assembler needs to expand
+// "li Reg, Val": an addi or lui for 12-bit and 4K-aligned 32-bit values, a
+// lui/addi pair for other 32-bit values and, on RV64, one more slli for a
+// 32-bit value shifted left.  Return a large cost for anything longer.
+static unsigned getIntMatCost(int64_t Val, bool IsRV64) {
+  if (isInt<12>(Val) || (isInt<32>(Val) && (Val & 0xfff) == 0))
+    return 1;
+  if (isInt<32>(Val) || !IsRV64)
+    return 2;
+  unsigned Shift = countTrailingZeros(uint64_t(Val));
+  int64_t Hi = Val >> Shift;
+  if (isInt<32>(Hi))
+    return getIntMatCost(Hi, IsRV64) + 1;
+  return 8;
+}
+
 bool RISCVTargetLowering::isFPImmLegal(const APFloat &Imm, EVT VT) const {
-  // We can load zero using LZ?R and negative zero using LZ?R;LC?BR.
-  return Imm.isPosZero();
+  // We can load positive zero by converting x0.
+  if (Imm.isPosZero())
+    return true;
+  // Other constants are built in a GPR and moved across with fmv, provided
+  // that takes no more integer instructions than the lui/addi addressing a
+  // constant pool entry, so the load is saved.
+  bool HasMove = (VT == MVT::f32 && (Subtarget.hasF() || Subtarget.hasD())) ||
+                 (VT == MVT::f64 && Subtarget.hasD() && Subtarget.isRV64());
+  return HasMove &&
+         getIntMatCost(Imm.bitcastToAPInt().getSExtValue(),
+                       Subtarget.isRV64()) <= 2;
+}
+
+bool RISCVTargetLowering::isLegalRVVType(MVT VT) const {
+  //the element count has to fit the 5-bit immediate of vsetivli
+  if (!VT.isVector() || VT.getVectorNumElements() > 16)
+    return false;
+  switch (VT.getVectorElementType().SimpleTy) {
+  case MVT::i8: case MVT::i16: case MVT::i32: case MVT::i64:
+  case MVT::f32: case MVT::f64:
+    break;
+  default:
+    return false;
+  }
+  unsigned Size = VT.getSizeInBits();
+  return Size >= 64 && Size <= Subtarget.getMinRVVVectorSizeInBits();
+}
+
+EVT RISCVTargetLowering::getSetCCResultType(const DataLayout &, LLVMContext &,
+                                            EVT VT) const {
+  if (VT.isVector())
+    return VT.changeVectorElementTypeToInteger();
+  return MVT::i32;
+}
+
+bool RISCVTargetLowering::allowsMisalignedMemoryAccesses(EVT VT,
+                                                         unsigned AddrSpace,
+                                                         unsigned Align,
+                                                         bool *Fast) const {
+  // Vector loads and stores only need their elements to be aligned.
+  if (!VT.isVector() || !isTypeLegal(VT) ||
+      Align < VT.getScalarSizeInBits() / 8)
+    return false;
+  if (Fast)
+    *Fast = true;
+  return true;
 }
 
 //===----------------------------------------------------------------------===//
@@ -787,6 +889,8 @@ LowerFormalArguments(SDValue Chain, CallingConv::ID CallConv, bool IsVarArg,
             RC = &RISCV::GR64BitRegClass;
           else
             RC = &RISCV::PairGR64BitRegClass;
+      } else if (RegVT.isVector() && Subtarget.hasV()) {
+          RC = &RISCV::VRBitRegClass;
       } else
         llvm_unreachable("RegVT not supported by FormalArguments Lowering");
 
@@ -1380,6 +1484,38 @@ lowerFRAMEADDR(SDValue Op, SelectionDAG &DAG) const {
   return FrameAddr;
 }
 
+// A splat of a scalar held in a general purpose register is a vmv.v.x,
+// anything else goes through the stack.
+SDValue RISCVTargetLowering::lowerBUILD_VECTOR(SDValue Op,
+                                               SelectionDAG &DAG) const {
+  BuildVectorSDNode *BV = cast<BuildVectorSDNode>(Op);
+  EVT VT = Op.getValueType();
+  SDValue Splat = BV->getSplatValue();
+  if (!Splat || !VT.isInteger() || !isTypeLegal(Splat.getValueType()) ||
+      (VT.getScalarSizeInBits() == 64 && Subtarget.isRV32()))
+    return SDValue();
+  return DAG.getNode(RISCVISD::VMV_V_X, SDLoc(Op), VT, Splat);
+}
+
+// Element 0 can be read directly with vmv.x.s, other elements go through
+// the stack.
+SDValue RISCVTargetLowering::lowerEXTRACT_VECTOR_ELT(SDValue Op,
+                                                     SelectionDAG &DAG) const {
+  SDValue Vec = Op.getOperand(0);
+  ConstantSDNode *Idx = dyn_cast<ConstantSDNode>(Op.getOperand(1));
+  if (!Idx || Idx->getZExtValue() != 0 || !Op.getValueType().isInteger() ||
+      (Vec.getValueType().getScalarSizeInBits() == 64 && Subtarget.isRV32()))
+    return SDValue();
+  return DAG.getNode(RISCVISD::VMV_X_S, SDLoc(Op), Op.getValueType(), Vec);
+}
+
+SDValue RISCVTargetLowering::lowerBITCAST(SDValue Op, SelectionDAG &DAG) const {
+  // Bitcasts between vectors of the same size are free, leave them alone.
+  if (Op.getOperand(0).getValueType().isVector())
+    return Op;
+  return SDValue();
+}
+
 SDValue RISCVTargetLowering::LowerOperation(SDValue Op,
                                               SelectionDAG &DAG) const {
   switch (Op.getOpcode()) {
@@ -1409,11 +1545,67 @@ SDValue RISCVTargetLowering::LowerOperation(SDValue Op,
     return lowerSTACKRESTORE(Op, DAG);
   case ISD::FRAMEADDR:
     return lowerFRAMEADDR(Op, DAG);
+  case ISD::BITCAST:
+    return lowerBITCAST(Op, DAG);
+  case ISD::BUILD_VECTOR:
+    return lowerBUILD_VECTOR(Op, DAG);
+  case ISD::EXTRACT_VECTOR_ELT:
+    return lowerEXTRACT_VECTOR_ELT(Op, DAG);
   default:
     llvm_unreachable("Unexpected node to lower");
   }
 }
 
+// Match the shuffle-and-add pyramid the loop vectorizer emits for an
+// integer sum reduction:
+//   (extract_vector_elt (add X, (vector_shuffle X, <1, u, u, u>)), 0)
+// where X is itself (add Y, (vector_shuffle Y, <2, 3, u, u>)) and so on,
+// halving the live elements each step.  The whole tree is a vredsum.vs.
+static SDValue performReductionCombine(SDNode *N, SelectionDAG &DAG,
+                                       const RISCVTargetLowering &TLI,
+                                       const RISCVSubtarget &Subtarget) {
+  ConstantSDNode *Idx = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  SDValue Vec = N->getOperand(0);
+  EVT VT = Vec.getValueType();
+  if (!Idx || Idx->getZExtValue() != 0 || !VT.isInteger() ||
+      !TLI.isTypeLegal(VT) ||
+      (VT.getScalarSizeInBits() == 64 && Subtarget.isRV32()))
+    return SDValue();
+
+  unsigned NumElts = VT.getVectorNumElements();
+  for (unsigned Half = 1; Half < NumElts; Half <<= 1) {
+    if (Vec.getOpcode() != ISD::ADD)
+      return SDValue();
+    SDValue LHS = Vec.getOperand(0), RHS = Vec.getOperand(1);
+    if (LHS.getOpcode() == ISD::VECTOR_SHUFFLE)
+      std::swap(LHS, RHS);
+    ShuffleVectorSDNode *Shuf = dyn_cast<ShuffleVectorSDNode>(RHS);
+    if (!Shuf || Shuf->getOperand(0) != LHS)
+      return SDValue();
+    for (unsigned I = 0; I != Half; ++I)
+      if (Shuf->getMaskElt(I) != int(I + Half))
+        return SDValue();
+    Vec = LHS;
+  }
+
+  SDLoc DL(N);
+  EVT ResVT = N->getValueType(0);
+  EVT SumVT = VT.getScalarSizeInBits() == 64 ? MVT::i64 : MVT::i32;
+  SDValue Sum = DAG.getNode(RISCVISD::VREDSUM, DL, SumVT, Vec);
+  if (ResVT.bitsLT(SumVT))
+    return DAG.getNode(ISD::TRUNCATE, DL, ResVT, Sum);
+  return Sum;
+}
+
+SDValue RISCVTargetLowering::PerformDAGCombine(SDNode *N,
+                                               DAGCombinerInfo &DCI) const {
+  switch (N->getOpcode()) {
+  case ISD::EXTRACT_VECTOR_ELT:
+    return performReductionCombine(N, DCI.DAG, *this, Subtarget);
+  }
+  return SDValue();
+}
+
 const char *RISCVTargetLowering::getTargetNodeName(unsigned Opcode) const {
 #define OPCODE(NAME) case RISCVISD::NAME: return "RISCVISD::" #NAME
   switch (Opcode) {
@@ -1424,6 +1616,9 @@ const char *RISCVTargetLowering::getTargetNodeName(unsigned Opcode) const {
     OPCODE(Lo);
     OPCODE(FENCE);
     OPCODE(SELECT_CC);
+    OPCODE(VMV_V_X);
+    OPCODE(VMV_X_S);
+    OPCODE(VREDSUM);
   }
   return NULL;
 #undef OPCODE
@@ -71,6 +71,13 @@ namespace RISCVISD {
 
     FENCE,
 
+    // Fixed-length vector operations.  VMV_V_X splats scalar operand 0,
+    // VMV_X_S reads element 0 of vector operand 0 and VREDSUM sums all
+    // elements of vector operand 0.
+    VMV_V_X,
+    VMV_X_S,
+    VREDSUM,
+
     // Wrappers around the inner loop of an 8- or 16-bit ATOMIC_SWAP or
     // ATOMIC_LOAD_<op>.
     //
@@ -105,9 +112,11 @@ public:
   MVT getScalarShiftAmountTy(const DataLayout &, EVT LHSTy) const override {
     return LHSTy.getSizeInBits() <= 32 ? MVT::i32 : MVT::i64;
   }
-  EVT getSetCCResultType(const DataLayout &, LLVMContext &, EVT VT) const override {
-    return MVT::i32;
-  }
+  EVT getSetCCResultType(const DataLayout &, LLVMContext &,
+                         EVT VT) const override;
+  bool allowsMisalignedMemoryAccesses(EVT VT, unsigned AddrSpace,
+                                      unsigned Align,
+                                      bool *Fast) const override;
   bool isFMAFasterThanFMulAndFAdd(EVT) const override {
     return true;
   }
@@ -141,6 +150,7 @@ public:
   EmitInstrWithCustomInserter(MachineInstr &MI,
                               MachineBasicBlock *BB) const override;
   SDValue LowerOperation(SDValue Op, SelectionDAG &DAG) const override;
+  SDValue PerformDAGCombine(SDNode *N, DAGCombinerInfo &DCI) const override;
   SDValue LowerFormalArguments(SDValue Chain, CallingConv::ID CallConv,
                                bool isVarArg,
                                const SmallVectorImpl<ISD::InputArg> &Ins,
@@ -180,6 +190,8 @@ private:
 public:
   bool IsRV32;
 private:
+  // True if VT is a fixed-length vector that fits in one V register.
+  bool isLegalRVVType(MVT VT) const;
 
   // Implement LowerOperation for individual opcodes.
   SDValue lowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const;
@@ -203,6 +215,8 @@ private:
   SDValue lowerSTACKSAVE(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerSTACKRESTORE(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerFRAMEADDR(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerBUILD_VECTOR(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerEXTRACT_VECTOR_ELT(SDValue Op, SelectionDAG &DAG) const;
 
   // Helper functions for above
   SDValue getTargetNode(SDValue Op, SelectionDAG &DAG, unsigned Flag) const;
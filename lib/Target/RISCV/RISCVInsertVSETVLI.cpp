@@ -0,0 +1,208 @@
+//===-- RISCVInsertVSETVLI.cpp - Insert vsetivli instructions -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains a pass that sets up vl and vtype for the vector
+// pseudos produced by instruction selection.  Each pseudo carries the
+// vector length and log2(SEW) it needs as its last two operands.  A forward
+// dataflow over the function tracks the configuration that is known to be
+// active, a vsetivli is inserted only where it differs from what the
+// pseudo needs, and the pseudo is then rewritten to the real instruction.
+//
+// The pass runs after register allocation, so spill code created by the
+// allocator is covered as well.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "riscv-insert-vsetvli"
+#include "RISCV.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVSubtarget.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace llvm;
+
+STATISTIC(NumInserted, "Number of vsetivli instructions inserted");
+STATISTIC(NumRemoved, "Number of redundant vsetivli instructions avoided");
+
+namespace llvm {
+  void initializeRISCVInsertVSETVLIPass(PassRegistry&);
+}
+
+namespace {
+  // The vl/vtype configuration known to be active at a point.
+  struct VConfig {
+    enum StateKind { Uninit, Known, Unknown };
+    StateKind State;
+    unsigned AVL;
+    unsigned Log2SEW;
+
+    VConfig() : State(Uninit), AVL(0), Log2SEW(0) {}
+    VConfig(unsigned AVL, unsigned Log2SEW)
+      : State(Known), AVL(AVL), Log2SEW(Log2SEW) {}
+
+    static VConfig unknown() {
+      VConfig C;
+      C.State = Unknown;
+      return C;
+    }
+
+    bool operator==(const VConfig &Other) const {
+      if (State != Other.State)
+        return false;
+      return State != Known ||
+             (AVL == Other.AVL && Log2SEW == Other.Log2SEW);
+    }
+    bool operator!=(const VConfig &Other) const { return !(*this == Other); }
+
+    // Combine the configurations flowing in from two predecessors.
+    VConfig meet(const VConfig &Other) const {
+      if (State == Uninit)
+        return Other;
+      if (Other.State == Uninit || *this == Other)
+        return *this;
+      return unknown();
+    }
+  };
+
+  struct RISCVInsertVSETVLI : public MachineFunctionPass {
+    static char ID;
+    RISCVInsertVSETVLI() : MachineFunctionPass(ID) {
+      initializeRISCVInsertVSETVLIPass(*PassRegistry::getPassRegistry());
+    }
+
+    bool runOnMachineFunction(MachineFunction &MF) override;
+
+    const char *getPassName() const override {
+      return "RISCV Insert VSETVLI";
+    }
+
+  private:
+    const RISCVInstrInfo *TII;
+    bool IsRV64;
+    // The configuration at the end of each block, indexed by block number.
+    std::vector<VConfig> BlockExit;
+
+    VConfig computeEntry(const MachineBasicBlock &MBB) const;
+    VConfig transfer(const MachineInstr &MI, const VConfig &In) const;
+    bool emitBlock(MachineBasicBlock &MBB);
+  };
+  char RISCVInsertVSETVLI::ID = 0;
+}
+
+INITIALIZE_PASS(RISCVInsertVSETVLI, "riscv-insert-vsetvli",
+                "RISCV Insert VSETVLI", false, false)
+
+/// createRISCVInsertVSETVLIPass - returns an instance of the vsetivli
+/// insertion pass
+///
+FunctionPass *llvm::createRISCVInsertVSETVLIPass() {
+  return new RISCVInsertVSETVLI();
+}
+
+static bool hasSEWOp(const MachineInstr &MI) {
+  return MI.getDesc().TSFlags & RISCVII::HasSEWOp;
+}
+
+// Return the configuration MI needs.
+static VConfig getNeededConfig(const MachineInstr &MI) {
+  unsigned NumOps = MI.getDesc().getNumOperands();
+  return VConfig(MI.getOperand(NumOps - 2).getImm(),
+                 MI.getOperand(NumOps - 1).getImm());
+}
+
+VConfig RISCVInsertVSETVLI::computeEntry(const MachineBasicBlock &MBB) const {
+  // Nothing is known on function entry.
+  if (MBB.pred_empty())
+    return VConfig::unknown();
+  VConfig In;
+  for (const MachineBasicBlock *Pred : MBB.predecessors())
+    In = In.meet(BlockExit[Pred->getNumber()]);
+  return In;
+}
+
+VConfig RISCVInsertVSETVLI::transfer(const MachineInstr &MI,
+                                     const VConfig &In) const {
+  if (hasSEWOp(MI))
+    return getNeededConfig(MI);
+  // Callees and inline asm may change vl and vtype behind our back.
+  if (MI.isCall() || MI.isInlineAsm() ||
+      MI.modifiesRegister(RISCV::VL, nullptr) ||
+      MI.modifiesRegister(RISCV::VTYPE, nullptr))
+    return VConfig::unknown();
+  return In;
+}
+
+bool RISCVInsertVSETVLI::emitBlock(MachineBasicBlock &MBB) {
+  MachineFunction &MF = *MBB.getParent();
+  bool Changed = false;
+  VConfig Cur = computeEntry(MBB);
+
+  for (MachineInstr &MI : MBB) {
+    if (!hasSEWOp(MI)) {
+      Cur = transfer(MI, Cur);
+      continue;
+    }
+
+    VConfig Need = getNeededConfig(MI);
+    if (Cur != Need) {
+      BuildMI(MBB, MI, MI.getDebugLoc(),
+              TII->get(IsRV64 ? RISCV::VSETIVLI64 : RISCV::VSETIVLI))
+        .addReg(IsRV64 ? RISCV::zero_64 : RISCV::zero, RegState::Define)
+        .addImm(Need.AVL)
+        .addImm(RISCVMC::encodeVType(Need.Log2SEW));
+      ++NumInserted;
+    } else
+      ++NumRemoved;
+    Cur = Need;
+
+    // Drop the vl and sew operands and switch to the real instruction.
+    int Real = RISCV::getVBaseOpcode(MI.getOpcode());
+    assert(Real != -1 && "Vector pseudo without a real instruction");
+    unsigned NumOps = MI.getDesc().getNumOperands();
+    MI.RemoveOperand(NumOps - 1);
+    MI.RemoveOperand(NumOps - 2);
+    MI.setDesc(TII->get(Real));
+    MI.addImplicitDefUseOperands(MF);
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool RISCVInsertVSETVLI::runOnMachineFunction(MachineFunction &MF) {
+  const RISCVSubtarget &STI = MF.getSubtarget<RISCVSubtarget>();
+  if (!STI.hasV())
+    return false;
+  TII = static_cast<const RISCVInstrInfo *>(STI.getInstrInfo());
+  IsRV64 = STI.isRV64();
+
+  // Compute the configuration at the end of every block, iterating until
+  // the exit states stop changing.
+  BlockExit.assign(MF.getNumBlockIDs(), VConfig());
+  bool Updated = true;
+  while (Updated) {
+    Updated = false;
+    for (MachineBasicBlock &MBB : MF) {
+      VConfig Cur = computeEntry(MBB);
+      for (const MachineInstr &MI : MBB)
+        Cur = transfer(MI, Cur);
+      if (Cur != BlockExit[MBB.getNumber()]) {
+        BlockExit[MBB.getNumber()] = Cur;
+        Updated = true;
+      }
+    }
+  }
+
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : MF)
+    Changed |= emitBlock(MBB);
+  return Changed;
+}
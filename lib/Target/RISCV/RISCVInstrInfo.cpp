@@ -23,7 +23,8 @@
 using namespace llvm;
 
 RISCVInstrInfo::RISCVInstrInfo(RISCVSubtarget &sti)
-  : RISCVGenInstrInfo(RISCV::ADJCALLSTACKDOWN, RISCV::ADJCALLSTACKUP),
+  : RISCVGenInstrInfo(RISCV::ADJCALLSTACKDOWN, RISCV::ADJCALLSTACKUP,
+                       /*CatchRetOpcode=*/~0u, /*ReturnOpcode=*/RISCV::RET),
     RI(sti), STI(sti) {
 }
 
@@ -72,11 +73,22 @@ void RISCVInstrInfo::adjustStackPtr(unsigned SP, int64_t Amount,
 }
 
 unsigned RISCVInstrInfo::GetInstSizeInBytes(MachineInstr *I) const {
+  switch (I->getOpcode()) {
+  case TargetOpcode::PATCHABLE_FUNCTION_ENTER:
+  case TargetOpcode::PATCHABLE_FUNCTION_EXIT:
+    return getXRaySledSize();
+  }
   //Since we don't have variable length instructions this just looks at the subtarget
   //TODO:check for C
   return (STI.isRV64() || STI.isRV32()) ? 4 : 4;
 }
 
+unsigned RISCVInstrInfo::getXRaySledSize() const {
+  // Spilling ra, loading the function id and calling the trampoline takes
+  // 10 instructions on RV32; a 64-bit trampoline address needs 6 more.
+  return STI.isRV64() ? 68 : 44;
+}
+
 bool RISCVInstrInfo::analyzeBranch(MachineBasicBlock &MBB,
                                      MachineBasicBlock *&TBB,
                                      MachineBasicBlock *&FBB,
@@ -414,6 +426,10 @@ RISCVInstrInfo::copyPhysReg(MachineBasicBlock &MBB,
     BuildMI(MBB, MBBI, DL, get(Opcode), DestReg)
       .addReg(SrcReg, getKillRegState(KillSrc));
     return;
+  }else if (RISCV::VRBitRegClass.contains(DestReg, SrcReg)) {
+    BuildMI(MBB, MBBI, DL, get(RISCV::VMV1R_V), DestReg)
+      .addReg(SrcReg, getKillRegState(KillSrc));
+    return;
   }else
     llvm_unreachable("Impossible reg-to-reg copy");
 
@@ -431,6 +447,11 @@ RISCVInstrInfo::storeRegToStackSlot(MachineBasicBlock &MBB,
 				      const TargetRegisterInfo *TRI) const {
   DebugLoc DL = MBBI != MBB.end() ? MBBI->getDebugLoc() : DebugLoc();
 
+  if (RC == &RISCV::VRBitRegClass) {
+    storeVRToStackSlot(MBB, MBBI, DL, SrcReg, isKill, FrameIdx);
+    return;
+  }
+
   // Callers may expect a single instruction, so keep 128-bit moves
   // together for now and lower them after register allocation.
   unsigned LoadOpcode, StoreOpcode;
@@ -447,6 +468,11 @@ RISCVInstrInfo::loadRegFromStackSlot(MachineBasicBlock &MBB,
 				       const TargetRegisterInfo *TRI) const {
   DebugLoc DL = MBBI != MBB.end() ? MBBI->getDebugLoc() : DebugLoc();
 
+  if (RC == &RISCV::VRBitRegClass) {
+    loadVRFromStackSlot(MBB, MBBI, DL, DestReg, FrameIdx);
+    return;
+  }
+
   // Callers may expect a single instruction, so keep 128-bit moves
   // together for now and lower them after register allocation.
   unsigned LoadOpcode, StoreOpcode;
@@ -455,6 +481,52 @@ RISCVInstrInfo::loadRegFromStackSlot(MachineBasicBlock &MBB,
                     FrameIdx);
 }
 
+// The vector spill slot has to hold the largest vector the subtarget
+// keeps in a register.  The actual VLEN may be larger, so rather than
+// a whole-register move, spill exactly VLENMin bits as 64-bit elements.
+static MachineMemOperand *getVRSpillMemOperand(MachineFunction &MF, int FI,
+                                               unsigned Bytes,
+                                               MachineMemOperand::Flags F) {
+  MachineFrameInfo *MFI = MF.getFrameInfo();
+  if (MFI->getObjectSize(FI) < Bytes)
+    MFI->setObjectSize(FI, Bytes);
+  return MF.getMachineMemOperand(MachinePointerInfo::getFixedStack(MF, FI), F,
+                                 Bytes, MFI->getObjectAlignment(FI));
+}
+
+void RISCVInstrInfo::storeVRToStackSlot(MachineBasicBlock &MBB,
+                                        MachineBasicBlock::iterator MBBI,
+                                        const DebugLoc &DL, unsigned SrcReg,
+                                        bool isKill, int FrameIdx) const {
+  MachineFunction &MF = *MBB.getParent();
+  unsigned Bytes = STI.getMinRVVVectorSizeInBits() / 8;
+  unsigned Opcode = STI.isRV64() ? RISCV::VSE64_V64_PSEUDO
+                                 : RISCV::VSE64_V_PSEUDO;
+  BuildMI(MBB, MBBI, DL, get(Opcode))
+    .addReg(SrcReg, getKillRegState(isKill))
+    .addFrameIndex(FrameIdx)
+    .addImm(Bytes / 8)
+    .addImm(6)
+    .addMemOperand(getVRSpillMemOperand(MF, FrameIdx, Bytes,
+                                        MachineMemOperand::MOStore));
+}
+
+void RISCVInstrInfo::loadVRFromStackSlot(MachineBasicBlock &MBB,
+                                         MachineBasicBlock::iterator MBBI,
+                                         const DebugLoc &DL, unsigned DestReg,
+                                         int FrameIdx) const {
+  MachineFunction &MF = *MBB.getParent();
+  unsigned Bytes = STI.getMinRVVVectorSizeInBits() / 8;
+  unsigned Opcode = STI.isRV64() ? RISCV::VLE64_V64_PSEUDO
+                                 : RISCV::VLE64_V_PSEUDO;
+  BuildMI(MBB, MBBI, DL, get(Opcode), DestReg)
+    .addFrameIndex(FrameIdx)
+    .addImm(Bytes / 8)
+    .addImm(6)
+    .addMemOperand(getVRSpillMemOperand(MF, FrameIdx, Bytes,
+                                        MachineMemOperand::MOLoad));
+}
+
 bool
 RISCVInstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
   switch (MI.getOpcode()) {
@@ -29,7 +29,8 @@ namespace RISCVII {
   enum {
     // See comments in RISCVInstrFormats.td.
     SimpleLoad  = (1 << 0),
-    SimpleStore = (1 << 1)
+    SimpleStore = (1 << 1),
+    HasSEWOp    = (1 << 2)
   };
   // RISCV MachineOperand target flags.
   enum {
@@ -41,6 +42,12 @@ namespace RISCVII {
   };
 }
 
+namespace RISCV {
+  // Return the real instruction a vector _PSEUDO becomes once vl and vtype
+  // are set up, or -1 if Opcode is not one.  Generated by TableGen.
+  int getVBaseOpcode(uint16_t Opcode);
+}
+
 class RISCVSubtarget;
 class RISCVInstrInfo : public RISCVGenInstrInfo {
   const RISCVRegisterInfo RI;
@@ -48,6 +55,12 @@ class RISCVInstrInfo : public RISCVGenInstrInfo {
 
   void splitMove(MachineBasicBlock::iterator MI, unsigned NewOpcode) const;
   void splitAdjDynAlloc(MachineBasicBlock::iterator MI) const;
+  void storeVRToStackSlot(MachineBasicBlock &MBB,
+                          MachineBasicBlock::iterator MBBI, const DebugLoc &DL,
+                          unsigned SrcReg, bool isKill, int FrameIdx) const;
+  void loadVRFromStackSlot(MachineBasicBlock &MBB,
+                           MachineBasicBlock::iterator MBBI, const DebugLoc &DL,
+                           unsigned DestReg, int FrameIdx) const;
 
 public:
   explicit RISCVInstrInfo(RISCVSubtarget &STI);
@@ -61,6 +74,10 @@ public:
                                      MachineBasicBlock &MBB,
                                      MachineBasicBlock::iterator I) const;
   unsigned GetInstSizeInBytes(MachineInstr *I) const;
+
+  // Return the size in bytes of an XRay sled: a jump over enough nops to
+  // be patched at run time into a call to the XRay trampoline.
+  unsigned getXRaySledSize() const;
   bool analyzeBranch(MachineBasicBlock &MBB, MachineBasicBlock *&TBB,
                      MachineBasicBlock *&FBB,
                      SmallVectorImpl<MachineOperand> &Cond,
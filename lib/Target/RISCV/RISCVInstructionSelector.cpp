@@ -0,0 +1,137 @@
+//===- RISCVInstructionSelector.cpp ------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the InstructionSelector class for
+/// RISCV.
+///
+/// Most of the work is done by the match table TableGen imports from the
+/// SelectionDAG patterns; this file only deals with what those patterns
+/// cannot describe: copies, branches and the conversions between the 32 and
+/// 64-bit views of the GPRs.
+//===----------------------------------------------------------------------===//
+
+#include "RISCVInstructionSelector.h"
+#include "RISCVInstrInfo.h"
+#include "RISCVRegisterBankInfo.h"
+#include "RISCVRegisterInfo.h"
+#include "RISCVSubtarget.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "riscv-isel"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+#define GET_GLOBALISEL_IMPL
+#include "RISCVGenGlobalISel.inc"
+#undef GET_GLOBALISEL_IMPL
+
+RISCVInstructionSelector::RISCVInstructionSelector(
+    const RISCVSubtarget &STI, const RISCVRegisterBankInfo &RBI)
+    : InstructionSelector(), Subtarget(STI), TII(*STI.getInstrInfo()),
+      TRI(*STI.getRegisterInfo()), RBI(RBI) {}
+
+/// Give the GPR class of width \p Size to \p Reg, or check that the class
+/// it already has is compatible with it.
+static bool constrainGPR(unsigned Reg, unsigned Size,
+                         MachineRegisterInfo &MRI) {
+  const TargetRegisterClass *RC;
+  switch (Size) {
+  case 32:
+    RC = &RISCV::GR32BitRegClass;
+    break;
+  case 64:
+    RC = &RISCV::GR64BitRegClass;
+    break;
+  default:
+    DEBUG(dbgs() << "Unexpected GPR size: " << Size << '\n');
+    return false;
+  }
+  if (!MRI.getRegClassOrNull(Reg)) {
+    MRI.setRegClass(Reg, RC);
+    return true;
+  }
+  return MRI.constrainRegClass(Reg, RC);
+}
+
+bool RISCVInstructionSelector::selectCopy(MachineInstr &I) const {
+  MachineRegisterInfo &MRI = I.getParent()->getParent()->getRegInfo();
+  for (const MachineOperand &MO : I.operands()) {
+    unsigned Reg = MO.getReg();
+    // Physical registers and virtual registers that already went through
+    // selection are fine as they are.
+    if (TargetRegisterInfo::isPhysicalRegister(Reg) ||
+        MRI.getRegClassOrNull(Reg))
+      continue;
+    if (!constrainGPR(Reg, MRI.getSize(Reg), MRI))
+      return false;
+  }
+  return true;
+}
+
+bool RISCVInstructionSelector::selectConversion(MachineInstr &I) const {
+  MachineRegisterInfo &MRI = I.getParent()->getParent()->getRegInfo();
+  unsigned DstReg = I.getOperand(0).getReg();
+  unsigned SrcReg = I.getOperand(1).getReg();
+  unsigned DstSize = MRI.getSize(DstReg);
+  unsigned SrcSize = MRI.getSize(SrcReg);
+
+  if (I.getOpcode() == TargetOpcode::G_ANYEXT) {
+    if (SrcSize != 32 || DstSize != 64)
+      return false;
+    // Same as the SelectionDAG anyext pattern.
+    BuildMI(*I.getParent(), I, I.getDebugLoc(),
+            TII.get(TargetOpcode::SUBREG_TO_REG), DstReg)
+        .addImm(0)
+        .addReg(SrcReg)
+        .addImm(RISCV::sub_32);
+  } else {
+    if (SrcSize != 64 || DstSize != 32)
+      return false;
+    BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(TargetOpcode::COPY),
+            DstReg)
+        .addReg(SrcReg, 0, RISCV::sub_32);
+  }
+  I.eraseFromParent();
+  return constrainGPR(DstReg, DstSize, MRI) &&
+         constrainGPR(SrcReg, SrcSize, MRI);
+}
+
+bool RISCVInstructionSelector::select(MachineInstr &I) const {
+  assert(I.getParent() && "Instruction should be in a basic block!");
+  assert(I.getParent()->getParent() && "Instruction should be in a function!");
+
+  if (!isPreISelGenericOpcode(I.getOpcode()))
+    return !I.isCopy() || selectCopy(I);
+
+  switch (I.getOpcode()) {
+  case TargetOpcode::G_BR: {
+    unsigned Opc = Subtarget.isRV64() ? RISCV::J64 : RISCV::J;
+    BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(Opc))
+        .addOperand(I.getOperand(0));
+    I.eraseFromParent();
+    return true;
+  }
+  case TargetOpcode::G_ANYEXT:
+  case TargetOpcode::G_TRUNC:
+    return selectConversion(I);
+  default:
+    return selectImpl(I);
+  }
+}
@@ -0,0 +1,53 @@
+//===- RISCVInstructionSelector --------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file declares the targeting of the InstructionSelector class for
+/// RISCV.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_RISCV_RISCVINSTRUCTIONSELECTOR_H
+#define LLVM_LIB_TARGET_RISCV_RISCVINSTRUCTIONSELECTOR_H
+
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+
+namespace llvm {
+
+class RISCVInstrInfo;
+class RISCVRegisterBankInfo;
+class RISCVRegisterInfo;
+class RISCVSubtarget;
+
+class RISCVInstructionSelector : public InstructionSelector {
+public:
+  RISCVInstructionSelector(const RISCVSubtarget &STI,
+                           const RISCVRegisterBankInfo &RBI);
+
+  bool select(MachineInstr &I) const override;
+
+private:
+  /// Select \p I with the match table imported from the SelectionDAG
+  /// patterns. Defined in RISCVGenGlobalISel.inc.
+  bool selectImpl(MachineInstr &I) const;
+  bool checkPredicates(unsigned PredicatesID) const override;
+  bool checkImmPredicate(unsigned PredicateID,
+                         const ConstantInt &Imm) const override;
+
+  /// Select the copies and conversions between the 32 and 64-bit views of
+  /// the GPRs, which have no pattern of their own.
+  bool selectCopy(MachineInstr &I) const;
+  bool selectConversion(MachineInstr &I) const;
+
+  const RISCVSubtarget &Subtarget;
+  const RISCVInstrInfo &TII;
+  const RISCVRegisterInfo &TRI;
+  const RISCVRegisterBankInfo &RBI;
+};
+
+} // End llvm namespace.
+#endif
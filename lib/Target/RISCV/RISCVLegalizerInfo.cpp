@@ -0,0 +1,54 @@
+//===- RISCVLegalizerInfo.cpp ------------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the LegalizerInfo class for RISCV.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "RISCVLegalizerInfo.h"
+#include "RISCVSubtarget.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+RISCVLegalizerInfo::RISCVLegalizerInfo(const RISCVSubtarget &ST) {
+  // RV32 only has 32-bit operations. RV64 keeps them as the W forms and adds
+  // the full-width ones, so narrower types are widened to 32 bits on both.
+  SmallVector<unsigned, 2> Sizes;
+  Sizes.push_back(32);
+  if (ST.isRV64())
+    Sizes.push_back(64);
+
+  for (unsigned Size : Sizes) {
+    for (unsigned BinOp : {TargetOpcode::G_ADD, TargetOpcode::G_SUB,
+                           TargetOpcode::G_AND, TargetOpcode::G_OR,
+                           TargetOpcode::G_XOR, TargetOpcode::G_SHL,
+                           TargetOpcode::G_LSHR, TargetOpcode::G_ASHR})
+      setAction(BinOp, Size, Legal);
+
+    if (ST.hasM())
+      setAction(TargetOpcode::G_MUL, Size, Legal);
+
+    setAction(TargetOpcode::G_CONSTANT, Size, Legal);
+  }
+
+  // The only conversions the selector knows about are between the two
+  // register widths.
+  if (ST.isRV64()) {
+    setAction(TargetOpcode::G_ANYEXT, 64, Legal);
+    setAction(TargetOpcode::G_TRUNC, 32, Legal);
+  }
+
+  setAction(TargetOpcode::G_BR, 0, Legal);
+
+  computeTables();
+}
@@ -36,11 +36,16 @@ class RISCVFunctionInfo : public MachineFunctionInfo {
   // Frame objects for spilling eh data registers.
   int EhDataRegFI[2];
 
+  // Size of the frame area allocated by the __riscv_save_N libcall, or 0 if
+  // the callee-saved registers are spilled inline.
+  unsigned LibCallStackSize;
+
 public:
   explicit RISCVFunctionInfo(MachineFunction &MF)
     : MF(MF), SavedGPRFrameSize(0), LowSavedGPR(0), HighSavedGPR(0), VarArgsFirstGPR(0),
       VarArgsFirstFPR(0), VarArgsFrameIndex(0), RegSaveFrameIndex(0),
-      ManipulatesSP(false), CallsEhReturn(false) {}
+      ManipulatesSP(false), HasByvalArg(false), IncomingArgSize(0),
+      CallsEhReturn(false), LibCallStackSize(0) {}
 
   // Get and set the number of bytes allocated by generic code to store
   // call-saved GPRs.
@@ -96,6 +101,10 @@ public:
   void createEhDataRegsFI();
   int getEhDataRegFI(unsigned Reg) const { return EhDataRegFI[Reg]; };
   bool isEhDataRegFI(int FI) const;
+
+  // Get and set the number of bytes allocated by the save libcall.
+  unsigned getLibCallStackSize() const { return LibCallStackSize; }
+  void setLibCallStackSize(unsigned Size) { LibCallStackSize = Size; }
 };
 
 } // end llvm namespace
@@ -0,0 +1,50 @@
+//===- RISCVRegisterBankInfo.cpp ---------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the RegisterBankInfo class for
+/// RISCV.
+/// \todo This should be generated by TableGen.
+//===----------------------------------------------------------------------===//
+
+#include "RISCVRegisterBankInfo.h"
+#include "RISCVInstrInfo.h" // For XXXRegClassID.
+#include "llvm/CodeGen/GlobalISel/RegisterBank.h"
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+RISCVRegisterBankInfo::RISCVRegisterBankInfo(const TargetRegisterInfo &TRI)
+    : RegisterBankInfo(RISCV::NumRegisterBanks) {
+  // Initialize the GPR bank.
+  createRegisterBank(RISCV::GPRRegBankID, "GPR");
+  // The GPR register bank is fully defined by all the registers in
+  // GR64Bit + its subclasses, which bring in GR32Bit through sub_32.
+  addRegBankCoverage(RISCV::GPRRegBankID, RISCV::GR64BitRegClassID, TRI);
+  const RegisterBank &RBGPR = getRegBank(RISCV::GPRRegBankID);
+  (void)RBGPR;
+  assert(RBGPR.covers(*TRI.getRegClass(RISCV::GR32BitRegClassID)) &&
+         "Subclass not added?");
+  assert(RBGPR.getSize() == 64 && "GPRs should hold up to 64-bit");
+
+  assert(verify(TRI) && "Invalid register bank information");
+}
+
+const RegisterBank &RISCVRegisterBankInfo::getRegBankFromRegClass(
+    const TargetRegisterClass &RC) const {
+  const TargetRegisterClass &GR32 = RISCV::GR32BitRegClass;
+  const TargetRegisterClass &GR64 = RISCV::GR64BitRegClass;
+  if (GR32.hasSubClassEq(&RC) || GR64.hasSubClassEq(&RC))
+    return getRegBank(RISCV::GPRRegBankID);
+  llvm_unreachable("Register class not supported");
+}
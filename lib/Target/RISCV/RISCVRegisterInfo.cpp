@@ -22,6 +22,23 @@
 
 using namespace llvm;
 
+// Return the operand holding the immediate that is added to the frame index
+// in operand FIOperandNum.  Loads and stores have the immediate before the
+// FI, everything else (i.e. ADDI) after it.
+static unsigned getFrameIndexImmOperand(const MachineInstr &MI,
+                                        unsigned FIOperandNum) {
+  return MI.mayLoadOrStore() ? FIOperandNum - 1 : FIOperandNum + 1;
+}
+
+static unsigned getFrameIndexOperand(const MachineInstr &MI) {
+  unsigned i = 0;
+  while (!MI.getOperand(i).isFI()) {
+    ++i;
+    assert(i < MI.getNumOperands() && "Instr doesn't have FrameIndex operand!");
+  }
+  return i;
+}
+
 RISCVRegisterInfo::RISCVRegisterInfo(const RISCVSubtarget &STI)
     : RISCVGenRegisterInfo(RISCV::ra), Subtarget(STI) {}
 
@@ -63,6 +80,13 @@ RISCVRegisterInfo::getCallPreservedMask(const MachineFunction &MF,
 
 }
 
+const TargetRegisterClass *
+RISCVRegisterInfo::getPointerRegClass(const MachineFunction &MF,
+                                      unsigned Kind) const {
+  return Subtarget.isRV64() ? &RISCV::GR64BitRegClass
+                            : &RISCV::GR32BitRegClass;
+}
+
 BitVector
 RISCVRegisterInfo::getReservedRegs(const MachineFunction &MF) const {
   BitVector Reserved(getNumRegs());
@@ -89,6 +113,9 @@ RISCVRegisterInfo::getReservedRegs(const MachineFunction &MF) const {
   // gp shouldn't be used eitehr
   Reserved.set(RISCV::gp);
   Reserved.set(RISCV::gp_64);
+  // vl and vtype are only written by vsetvli, see RISCVInsertVSETVLI
+  Reserved.set(RISCV::VL);
+  Reserved.set(RISCV::VTYPE);
   return Reserved;
 }
 
@@ -101,14 +128,12 @@ void RISCVRegisterInfo::eliminateFI(MachineBasicBlock::iterator II,
   MachineFrameInfo *MFI = MF.getFrameInfo();
   RISCVFunctionInfo *RISCVFI = MF.getInfo<RISCVFunctionInfo>();
 
-  const std::vector<CalleeSavedInfo> &CSI = MFI->getCalleeSavedInfo();
-  int MinCSFI = 0;
-  int MaxCSFI = -1;
-
-  if (CSI.size()) {
-    MinCSFI = CSI[0].getFrameIdx();
-    MaxCSFI = CSI[CSI.size() - 1].getFrameIdx();
-  }
+  // Callee-saved registers handled by the save/restore libcalls live in fixed
+  // objects, so the spill slots don't necessarily form a contiguous range.
+  bool CSRegFI = false;
+  for (const auto &I : MFI->getCalleeSavedInfo())
+    if (I.getFrameIdx() == FrameIndex)
+      CSRegFI = true;
 
   bool EhDataRegFI = RISCVFI->isEhDataRegFI(FrameIndex);
 
@@ -121,7 +146,7 @@ void RISCVRegisterInfo::eliminateFI(MachineBasicBlock::iterator II,
   // getFrameRegister() returns.
   unsigned FrameReg;
 
-  if ((FrameIndex >= MinCSFI && FrameIndex <= MaxCSFI) || EhDataRegFI)
+  if (CSRegFI || EhDataRegFI)
     FrameReg = Subtarget.isRV64() ? RISCV::sp_64 : RISCV::sp;
   else
     FrameReg = getFrameRegister(MF);
@@ -137,12 +162,39 @@ void RISCVRegisterInfo::eliminateFI(MachineBasicBlock::iterator II,
   int64_t Offset;
 
   Offset = SPOffset + (int64_t)StackSize;
-  // loads and stores have the immediate before the FI
-  // FIXME: this is a bit hacky
-  if(MI.mayLoadOrStore())
-    Offset += MI.getOperand(OpNo - 1).getImm();
-  else
-    Offset += MI.getOperand(OpNo + 1).getImm();
+
+  // Vector loads and stores take a bare base register, so materialize the
+  // address if there is an offset.
+  if (MI.getDesc().TSFlags & RISCVII::HasSEWOp) {
+    if (Offset != 0) {
+      MachineBasicBlock &MBB = *MI.getParent();
+      DebugLoc DL = II->getDebugLoc();
+      const RISCVInstrInfo &TII =
+          *static_cast<const RISCVInstrInfo *>(
+              MBB.getParent()->getSubtarget().getInstrInfo());
+      unsigned Reg;
+      if (isInt<12>(Offset)) {
+        const TargetRegisterClass *RC = Subtarget.isRV64() ?
+          &RISCV::GR64BitRegClass : &RISCV::GR32BitRegClass;
+        Reg = MF.getRegInfo().createVirtualRegister(RC);
+        BuildMI(MBB, II, DL,
+                TII.get(Subtarget.isRV64() ? RISCV::ADDI64 : RISCV::ADDI), Reg)
+          .addReg(FrameReg).addImm(Offset);
+      } else {
+        TII.loadImmediate(MBB, II, &Reg, Offset);
+        BuildMI(MBB, II, DL,
+                TII.get(Subtarget.isRV64() ? RISCV::ADD64 : RISCV::ADD), Reg)
+          .addReg(FrameReg).addReg(Reg, RegState::Kill);
+      }
+      FrameReg = Reg;
+      IsKill = true;
+    }
+    MI.getOperand(OpNo).ChangeToRegister(FrameReg, false, false, IsKill);
+    return;
+  }
+
+  unsigned ImmOpNo = getFrameIndexImmOperand(MI, OpNo);
+  Offset += MI.getOperand(ImmOpNo).getImm();
 
   DEBUG(errs() << "Offset     : " << Offset << "\n" << "<--------->\n");
 
@@ -167,12 +219,7 @@ void RISCVRegisterInfo::eliminateFI(MachineBasicBlock::iterator II,
   }
 
   MI.getOperand(OpNo).ChangeToRegister(FrameReg, false, false, IsKill);
-  // loads and stores have the immediate before the FI
-  // FIXME: this is a bit hacky
-  if(MI.mayLoadOrStore())
-    MI.getOperand(OpNo - 1).ChangeToImmediate(Offset);
-  else
-    MI.getOperand(OpNo + 1).ChangeToImmediate(Offset);
+  MI.getOperand(ImmOpNo).ChangeToImmediate(Offset);
 }
 
 void
@@ -203,3 +250,74 @@ RISCVRegisterInfo::getFrameRegister(const MachineFunction &MF) const {
       (Subtarget.isRV64() ? RISCV::fp_64 : RISCV::fp) : 
       (Subtarget.isRV64() ? RISCV::sp_64 : RISCV::sp);
 }
+
+int64_t RISCVRegisterInfo::getFrameIndexInstrOffset(const MachineInstr *MI,
+                                                    int Idx) const {
+  if (MI->getDesc().TSFlags & RISCVII::HasSEWOp)
+    return 0;
+  return MI->getOperand(getFrameIndexImmOperand(*MI, Idx)).getImm();
+}
+
+/// needsFrameBaseReg - Returns true if the frame reference in MI is likely to
+/// end up more than 12 bits away from sp/fp, in which case eliminateFI would
+/// have to build the full address for it.  Offset is the object's offset in
+/// the local block, which is negative.
+bool RISCVRegisterInfo::needsFrameBaseReg(MachineInstr *MI,
+                                          int64_t Offset) const {
+  unsigned ADDI = Subtarget.isRV64() ? RISCV::ADDI64 : RISCV::ADDI;
+  if (MI->isInlineAsm() || (MI->getDesc().TSFlags & RISCVII::HasSEWOp))
+    return false;
+  if (!MI->mayLoadOrStore() && MI->getOpcode() != ADDI)
+    return false;
+
+  unsigned FIOperandNum = getFrameIndexOperand(*MI);
+  unsigned ImmOpNo = getFrameIndexImmOperand(*MI, FIOperandNum);
+  if (ImmOpNo >= MI->getNumOperands() || !MI->getOperand(ImmOpNo).isImm())
+    return false;
+
+  // Both sp and fp point at the bottom of the frame (see eliminateFI), so
+  // estimate the distance from there.  Spill slots and outgoing arguments
+  // aren't known before register allocation; assume some.
+  const MachineFunction &MF = *MI->getParent()->getParent();
+  Offset += MF.getFrameInfo()->getLocalFrameSize();
+  Offset += 128;
+
+  return !isFrameOffsetLegal(MI, getFrameRegister(MF), Offset);
+}
+
+bool RISCVRegisterInfo::isFrameOffsetLegal(const MachineInstr *MI,
+                                           unsigned BaseReg,
+                                           int64_t Offset) const {
+  unsigned FIOperandNum = getFrameIndexOperand(*MI);
+  return isInt<12>(Offset + getFrameIndexInstrOffset(MI, FIOperandNum));
+}
+
+/// Insert an ADDI defining BaseReg as FrameIdx + Offset at the start of MBB.
+/// The frame index is eliminated later like any other, so the large offset
+/// is only built once.
+void RISCVRegisterInfo::materializeFrameBaseRegister(MachineBasicBlock *MBB,
+                                                     unsigned BaseReg,
+                                                     int FrameIdx,
+                                                     int64_t Offset) const {
+  MachineBasicBlock::iterator Ins = MBB->begin();
+  DebugLoc DL;
+  if (Ins != MBB->end())
+    DL = Ins->getDebugLoc();
+  const TargetInstrInfo &TII = *MBB->getParent()->getSubtarget().getInstrInfo();
+  unsigned ADDI = Subtarget.isRV64() ? RISCV::ADDI64 : RISCV::ADDI;
+
+  BuildMI(*MBB, Ins, DL, TII.get(ADDI), BaseReg)
+    .addFrameIndex(FrameIdx)
+    .addImm(Offset);
+}
+
+void RISCVRegisterInfo::resolveFrameIndex(MachineInstr &MI, unsigned BaseReg,
+                                          int64_t Offset) const {
+  unsigned FIOperandNum = getFrameIndexOperand(MI);
+  unsigned ImmOpNo = getFrameIndexImmOperand(MI, FIOperandNum);
+  Offset += MI.getOperand(ImmOpNo).getImm();
+  assert(isInt<12>(Offset) && "Unable to resolve frame index!");
+
+  MI.getOperand(FIOperandNum).ChangeToRegister(BaseReg, false);
+  MI.getOperand(ImmOpNo).ChangeToImmediate(Offset);
+}
@@ -10,7 +10,9 @@
 #include "RISCVSubtarget.h"
 #include "RISCV.h"
 #include "llvm/IR/GlobalValue.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
 
 #define DEBUG_TYPE "riscv-subtarget"
 
@@ -20,6 +22,12 @@
 
 using namespace llvm;
 
+static cl::opt<unsigned> RVVVectorBitsMin(
+    "riscv-v-vector-bits-min", cl::Hidden,
+    cl::desc("Assume V registers are at least this many bits wide (VLEN), "
+             "a power of two between 128 and 512"),
+    cl::init(128));
+
 RISCVSubtarget &RISCVSubtarget::initializeSubtargetDependencies(StringRef CPU,
                                                                 StringRef FS) {
   std::string CPUName = CPU;
@@ -36,8 +44,40 @@ RISCVSubtarget &RISCVSubtarget::initializeSubtargetDependencies(StringRef CPU,
 RISCVSubtarget::RISCVSubtarget(const Triple &TT, const std::string &CPU,
                                const std::string &FS, const TargetMachine &TM)
     : RISCVGenSubtargetInfo(TT, CPU, FS), RISCVArchVersion(RV32), HasM(false),
-      HasA(false), HasF(false), HasD(false), TargetTriple(TT),
-      InstrInfo(initializeSubtargetDependencies(CPU,FS)), TLInfo(TM, *this), TSInfo(), FrameLowering() {}
+      HasA(false), HasF(false), HasD(false), HasV(false), HasZicbop(false),
+      UseSoftFloat(false),
+      EnableSaveRestore(false), TargetTriple(TT),
+      InstrInfo(initializeSubtargetDependencies(CPU,FS)), TLInfo(TM, *this), TSInfo(), FrameLowering(),
+      GISel() {}
+
+const CallLowering *RISCVSubtarget::getCallLowering() const {
+  assert(GISel && "Access to GlobalISel APIs not set");
+  return GISel->getCallLowering();
+}
+
+const InstructionSelector *RISCVSubtarget::getInstructionSelector() const {
+  assert(GISel && "Access to GlobalISel APIs not set");
+  return GISel->getInstructionSelector();
+}
+
+const LegalizerInfo *RISCVSubtarget::getLegalizerInfo() const {
+  assert(GISel && "Access to GlobalISel APIs not set");
+  return GISel->getLegalizerInfo();
+}
+
+const RegisterBankInfo *RISCVSubtarget::getRegBankInfo() const {
+  assert(GISel && "Access to GlobalISel APIs not set");
+  return GISel->getRegBankInfo();
+}
+
+unsigned RISCVSubtarget::getMinRVVVectorSizeInBits() const {
+  if (!hasV())
+    return 0;
+  // V guarantees VLEN >= 128.  Larger types would need more than the 31
+  // elements a single vsetivli can describe, so cap the size at 512.
+  unsigned Bits = PowerOf2Floor(RVVVectorBitsMin);
+  return std::min(std::max(Bits, 128U), 512U);
+}
 
 // Return true if GV binds locally under reloc model RM.
 static bool bindsLocally(const GlobalValue *GV, Reloc::Model RM) {
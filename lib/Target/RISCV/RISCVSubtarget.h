@@ -18,6 +18,7 @@
 #include "RISCVISelLowering.h"
 #include "RISCVInstrInfo.h"
 #include "RISCVRegisterInfo.h"
+#include "llvm/CodeGen/GlobalISel/GISelAccessor.h"
 #include "llvm/CodeGen/SelectionDAGTargetInfo.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/ADT/Triple.h"
@@ -45,15 +46,23 @@ protected:
   bool HasA;
   bool HasF;
   bool HasD;
+  bool HasV;
+  bool HasZicbop;
 
   bool UseSoftFloat;
 
+  bool EnableSaveRestore;
+
 private:
   Triple TargetTriple;
   RISCVInstrInfo InstrInfo;
   RISCVTargetLowering TLInfo;
   SelectionDAGTargetInfo TSInfo;
   RISCVFrameLowering FrameLowering;
+  /// Gather the accessor points to GlobalISel-related APIs.
+  /// This is used to avoid ifndefs spreading around while GISel is
+  /// an optional library.
+  std::unique_ptr<GISelAccessor> GISel;
 
   RISCVSubtarget &initializeSubtargetDependencies(StringRef CPU, StringRef FS);
 
@@ -68,6 +77,15 @@ public:
   }
   const RISCVTargetLowering *getTargetLowering() const { return &TLInfo; }
   const SelectionDAGTargetInfo *getSelectionDAGInfo() const { return &TSInfo; }
+  const CallLowering *getCallLowering() const override;
+  const InstructionSelector *getInstructionSelector() const override;
+  const LegalizerInfo *getLegalizerInfo() const override;
+  const RegisterBankInfo *getRegBankInfo() const override;
+
+  /// This object will take ownership of \p GISelAccessor.
+  void setGISelAccessor(GISelAccessor &GISel) {
+    this->GISel.reset(&GISel);
+  }
 
   bool isRV32() const { return RISCVArchVersion == RV32; };
   bool isRV64() const { return RISCVArchVersion == RV64; };
@@ -76,9 +94,26 @@ public:
   bool hasA() const { return HasA; };
   bool hasF() const { return HasF; };
   bool hasD() const { return HasD; };
+  bool hasV() const { return HasV; };
+  bool hasZicbop() const { return HasZicbop; };
 
   bool useSoftFloat() const { return UseSoftFloat; }
 
+  bool enableSaveRestore() const { return EnableSaveRestore; }
+
+  // Return the number of bits every V register is guaranteed to hold.
+  // Fixed-length vector types up to this size are kept in a single
+  // register (LMUL=1); 0 means no fixed-length vectors are legal.
+  unsigned getMinRVVVectorSizeInBits() const;
+
+  // Software prefetch tuning for LoopDataPrefetch, in bytes and
+  // instructions.  The pass does nothing while the distance is zero, which
+  // keeps it off for cores without Zicbop.  In-order cores have no hardware
+  // prefetcher to cover unit-stride streams, so any stride is prefetched.
+  unsigned getCacheLineSize() const { return 64; }
+  unsigned getPrefetchDistance() const { return HasZicbop ? 128 : 0; }
+  unsigned getMinPrefetchStride() const { return 1; }
+
   // Automatically generated by tblgen.
   void ParseSubtargetFeatures(StringRef CPU, StringRef FS);
 
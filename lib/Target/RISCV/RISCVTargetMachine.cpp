@@ -8,17 +8,35 @@
 //===----------------------------------------------------------------------===//
 
 #include "RISCVTargetMachine.h"
+#include "RISCVCallLowering.h"
+#include "RISCVInstructionSelector.h"
+#include "RISCVLegalizerInfo.h"
+#include "RISCVRegisterBankInfo.h"
+#include "RISCVTargetTransformInfo.h"
+#include "llvm/CodeGen/GlobalISel/IRTranslator.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelect.h"
+#include "llvm/CodeGen/GlobalISel/Legalizer.h"
+#include "llvm/CodeGen/GlobalISel/RegBankSelect.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Transforms/Scalar.h"
 
 using namespace llvm;
 
+static cl::opt<bool>
+EnableLoopDataPrefetch("riscv-loop-data-prefetch", cl::Hidden,
+                       cl::desc("Enable the loop data prefetch pass"),
+                       cl::init(true));
+
 extern "C" void LLVMInitializeRISCVTarget() {
   // Register the target.
   RegisterTargetMachine<RISCVTargetMachine> A(TheRISCVTarget);
   RegisterTargetMachine<RISCV64TargetMachine> B(TheRISCV64Target);
+  initializeGlobalISel(*PassRegistry::getPassRegistry());
 }
 
 static std::string computeDataLayout(const Triple &TT) {
@@ -55,6 +73,28 @@ RISCV64TargetMachine::RISCV64TargetMachine(const Target &T, const Triple &TT,
                                        CodeGenOpt::Level OL)
   :RISCVTargetMachine(T, TT, CPU, FS, Options, RM, CM, OL) {}
 
+#ifdef LLVM_BUILD_GLOBAL_ISEL
+namespace {
+struct RISCVGISelActualAccessor : public GISelAccessor {
+  std::unique_ptr<CallLowering> CallLoweringInfo;
+  std::unique_ptr<InstructionSelector> InstSelector;
+  std::unique_ptr<LegalizerInfo> Legalizer;
+  std::unique_ptr<RegisterBankInfo> RegBankInfo;
+  const CallLowering *getCallLowering() const override {
+    return CallLoweringInfo.get();
+  }
+  const InstructionSelector *getInstructionSelector() const override {
+    return InstSelector.get();
+  }
+  const LegalizerInfo *getLegalizerInfo() const override {
+    return Legalizer.get();
+  }
+  const RegisterBankInfo *getRegBankInfo() const override {
+    return RegBankInfo.get();
+  }
+};
+} // End anonymous namespace.
+#endif
 
 const RISCVSubtarget *
 RISCVTargetMachine::getSubtargetImpl(const Function &F) const {
@@ -75,32 +115,94 @@ RISCVTargetMachine::getSubtargetImpl(const Function &F) const {
     // function that reside in TargetOptions.
     resetTargetOptions(F);
     I = llvm::make_unique<RISCVSubtarget>(TargetTriple, CPU, FS, *this);
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+    GISelAccessor *GISel = new GISelAccessor();
+#else
+    RISCVGISelActualAccessor *GISel = new RISCVGISelActualAccessor();
+    GISel->CallLoweringInfo.reset(
+        new RISCVCallLowering(*I->getTargetLowering()));
+    GISel->Legalizer.reset(new RISCVLegalizerInfo(*I));
+    auto *RBI = new RISCVRegisterBankInfo(*I->getRegisterInfo());
+    // The accessor is not installed yet, so hand the bank info over
+    // directly.
+    GISel->InstSelector.reset(new RISCVInstructionSelector(*I, *RBI));
+    GISel->RegBankInfo.reset(RBI);
+#endif
+    I->setGISelAccessor(*GISel);
   }
   return I.get();
 }
 
+TargetIRAnalysis RISCVTargetMachine::getTargetIRAnalysis() {
+  return TargetIRAnalysis([this](const Function &F) {
+    return TargetTransformInfo(RISCVTTIImpl(this, F));
+  });
+}
+
 namespace {
 /// RISCV Code Generator Pass Configuration Options.
 class RISCVPassConfig : public TargetPassConfig {
 public:
   RISCVPassConfig(RISCVTargetMachine *TM, PassManagerBase &PM)
-    : TargetPassConfig(TM, PM) {}
+    : TargetPassConfig(TM, PM) {
+    // XRay sleds are inserted from addPreEmitPass instead, so that branch
+    // selection sees their size.
+    disablePass(&XRayInstrumentationID);
+  }
 
   RISCVTargetMachine &getRISCVTargetMachine() const {
     return getTM<RISCVTargetMachine>();
   }
 
+  void addIRPasses() override;
   bool addInstSelector() override;
+#ifdef LLVM_BUILD_GLOBAL_ISEL
+  bool addIRTranslator() override;
+  bool addLegalizeMachineIR() override;
+  bool addRegBankSelect() override;
+  bool addGlobalInstructionSelect() override;
+#endif
   void addPreEmitPass() override;
 };
 } // end anonymous namespace
 
+void RISCVPassConfig::addIRPasses() {
+  // Insert software prefetches for strided loads.  This does nothing unless
+  // the subtarget reports a prefetch distance, see
+  // RISCVSubtarget::getPrefetchDistance.
+  if (TM->getOptLevel() != CodeGenOpt::None && EnableLoopDataPrefetch)
+    addPass(createLoopDataPrefetchPass());
+
+  TargetPassConfig::addIRPasses();
+}
+
 bool RISCVPassConfig::addInstSelector() {
   addPass(createRISCVISelDag(getRISCVTargetMachine(), getOptLevel()));
   return false;
 }
 
+#ifdef LLVM_BUILD_GLOBAL_ISEL
+bool RISCVPassConfig::addIRTranslator() {
+  addPass(new IRTranslator());
+  return false;
+}
+bool RISCVPassConfig::addLegalizeMachineIR() {
+  addPass(new Legalizer());
+  return false;
+}
+bool RISCVPassConfig::addRegBankSelect() {
+  addPass(new RegBankSelect());
+  return false;
+}
+bool RISCVPassConfig::addGlobalInstructionSelect() {
+  addPass(new InstructionSelect());
+  return false;
+}
+#endif
+
 void RISCVPassConfig::addPreEmitPass(){
+  addPass(createRISCVInsertVSETVLIPass());
+  addPass(Pass::createPass(&XRayInstrumentationID));
   addPass(createRISCVBranchSelectionPass());
 }
 
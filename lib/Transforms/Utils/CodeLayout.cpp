@@ -0,0 +1,756 @@
+//===- CodeLayout.cpp - Implementation of code layout algorithms ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// ExtTSP - layout of basic blocks with i-cache optimization.
+//
+// The algorithm tries to find a layout of nodes (basic blocks) of a given CFG
+// optimizing jump locality and thus processor I-cache utilization. This is
+// achieved via increasing the number of fall-through jumps and co-locating
+// frequently executed nodes together. The name follows the underlying
+// optimization problem, Extended-TSP, which is a generalization of the
+// classical (maximum) Traveling Salesmen Problem.
+//
+// The algorithm is a greedy heuristic that works with chains (ordered lists)
+// of basic blocks. Initially all chains are isolated basic blocks. On every
+// iteration, we pick a pair of chains whose merging yields the biggest
+// increase in the ExtTSP score, which models how i-cache "friendly" a
+// specific layout is. A pair of chains may be merged as they are or after
+// splitting one of them in two. Once no pair of chains can be merged
+// profitably, the chains of cold blocks are merged along their original
+// fall-throughs, and the remaining chains are ordered by decreasing density
+// of execution.
+//
+// Reference:
+//   * A. Newell and S. Pupyrev, Improved Basic Block Reordering,
+//     IEEE Transactions on Computers, 2020
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/CodeLayout.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "code-layout"
+
+// Algorithm-specific constants. The values are tuned for the best performance
+// of large-scale front-end bound binaries.
+static cl::opt<double>
+    ForwardWeight("ext-tsp-forward-weight", cl::Hidden, cl::init(0.1),
+                  cl::desc("The weight of forward jumps for ExtTSP value"));
+
+static cl::opt<double>
+    BackwardWeight("ext-tsp-backward-weight", cl::Hidden, cl::init(0.1),
+                   cl::desc("The weight of backward jumps for ExtTSP value"));
+
+static cl::opt<unsigned> ForwardDistance(
+    "ext-tsp-forward-distance", cl::Hidden, cl::init(1024),
+    cl::desc("The maximum distance (in bytes) of a forward jump for ExtTSP"));
+
+static cl::opt<unsigned> BackwardDistance(
+    "ext-tsp-backward-distance", cl::Hidden, cl::init(640),
+    cl::desc("The maximum distance (in bytes) of a backward jump for ExtTSP"));
+
+// The maximum size of a chain for splitting. Larger values of the threshold
+// may yield better quality at the cost of worsen run-time.
+static cl::opt<unsigned> ChainSplitThreshold(
+    "ext-tsp-chain-split-threshold", cl::Hidden, cl::init(128),
+    cl::desc("The maximum size of a chain to apply splitting"));
+
+namespace {
+
+// Epsilon for comparison of doubles.
+const double EPS = 1e-8;
+
+// Compute the Ext-TSP score for a jump between a given pair of blocks,
+// using their sizes, (estimated) addresses and the jump execution count.
+double extTSPScore(uint64_t SrcAddr, uint64_t SrcSize, uint64_t DstAddr,
+                   uint64_t Count) {
+  // Fallthrough
+  if (SrcAddr + SrcSize == DstAddr)
+    return static_cast<double>(Count);
+  // Forward
+  if (SrcAddr + SrcSize < DstAddr) {
+    const uint64_t Dist = DstAddr - (SrcAddr + SrcSize);
+    if (Dist <= ForwardDistance) {
+      double Prob = 1.0 - static_cast<double>(Dist) / ForwardDistance;
+      return ForwardWeight * Prob * Count;
+    }
+    return 0;
+  }
+  // Backward
+  const uint64_t Dist = SrcAddr + SrcSize - DstAddr;
+  if (Dist <= BackwardDistance) {
+    double Prob = 1.0 - static_cast<double>(Dist) / BackwardDistance;
+    return BackwardWeight * Prob * Count;
+  }
+  return 0;
+}
+
+/// A type of merging two chains, X and Y. The former chain is split into
+/// X1 and X2 and then concatenated with Y in the order specified by the type.
+enum class MergeTypeTy : int { X_Y, X1_Y_X2, Y_X2_X1, X2_X1_Y };
+
+/// The gain of merging two chains, that is, the Ext-TSP score of the merge
+/// together with the corresponding merge 'type' and 'offset'.
+struct MergeGainTy {
+  double Score = -1;
+  size_t MergeOffset = 0;
+  MergeTypeTy MergeType = MergeTypeTy::X_Y;
+
+  MergeGainTy() = default;
+  MergeGainTy(double Score, size_t MergeOffset, MergeTypeTy MergeType)
+      : Score(Score), MergeOffset(MergeOffset), MergeType(MergeType) {}
+
+  bool operator<(const MergeGainTy &Other) const {
+    return (Other.Score > EPS && Other.Score > Score + EPS);
+  }
+};
+
+struct Jump;
+class Chain;
+class ChainEdge;
+
+/// A node in the graph, typically corresponding to a basic block in CFG.
+struct Block {
+  // An original index of the block in CFG.
+  size_t Index = 0;
+  // The index of the block in the current chain.
+  size_t CurIndex = 0;
+  // Size of the block in the binary.
+  uint64_t Size = 0;
+  // Execution count of the block in the profile data.
+  uint64_t ExecutionCount = 0;
+  // Current chain of the node.
+  Chain *CurChain = nullptr;
+  // An offset of the block in the current chain.
+  mutable uint64_t EstimatedAddr = 0;
+  // Jumps to the block.
+  std::vector<Jump *> InJumps;
+  // Jumps from the block.
+  std::vector<Jump *> OutJumps;
+
+  Block(size_t Index, uint64_t Size, uint64_t EC)
+      : Index(Index), Size(Size), ExecutionCount(EC) {}
+  bool isEntry() const { return Index == 0; }
+};
+
+/// An arc in the graph, typically corresponding to a jump between two blocks.
+struct Jump {
+  // Source block of the jump.
+  Block *Source;
+  // Target block of the jump.
+  Block *Target;
+  // Execution count of the arc in the profile data.
+  uint64_t ExecutionCount;
+
+  Jump(Block *Source, Block *Target, uint64_t ExecutionCount)
+      : Source(Source), Target(Target), ExecutionCount(ExecutionCount) {}
+};
+
+typedef std::vector<Jump *> JumpList;
+
+/// A chain (ordered sequence) of blocks.
+class Chain {
+public:
+  Chain(uint64_t Id, Block *B)
+      : Id(Id), Score(0), Blocks(1, B), ExecutionCount(B->ExecutionCount),
+        Size(B->Size) {}
+
+  uint64_t id() const { return Id; }
+  bool isEntry() const { return Blocks[0]->Index == 0; }
+  bool isCold() const { return ExecutionCount == 0; }
+  double score() const { return Score; }
+  void setScore(double NewScore) { Score = NewScore; }
+  double density() const { return static_cast<double>(ExecutionCount) / Size; }
+
+  const std::vector<Block *> &blocks() const { return Blocks; }
+  const std::vector<std::pair<Chain *, ChainEdge *>> &edges() const {
+    return Edges;
+  }
+
+  ChainEdge *getEdge(Chain *Other) const {
+    for (auto It : Edges)
+      if (It.first == Other)
+        return It.second;
+    return nullptr;
+  }
+
+  void removeEdge(Chain *Other) {
+    for (auto It = Edges.begin(), E = Edges.end(); It != E; ++It)
+      if (It->first == Other) {
+        Edges.erase(It);
+        return;
+      }
+  }
+
+  void addEdge(Chain *Other, ChainEdge *Edge) {
+    Edges.push_back(std::make_pair(Other, Edge));
+  }
+
+  void merge(Chain *Other, const std::vector<Block *> &MergedBlocks) {
+    Blocks = MergedBlocks;
+    ExecutionCount += Other->ExecutionCount;
+    Size += Other->Size;
+    // Update the block's chains.
+    for (size_t Idx = 0; Idx < Blocks.size(); Idx++) {
+      Blocks[Idx]->CurChain = this;
+      Blocks[Idx]->CurIndex = Idx;
+    }
+  }
+
+  void mergeEdges(Chain *Other);
+
+  void clear() {
+    Blocks.clear();
+    Blocks.shrink_to_fit();
+    Edges.clear();
+    Edges.shrink_to_fit();
+  }
+
+private:
+  // Unique chain identifier.
+  uint64_t Id;
+  // Cached ext-tsp score for the chain.
+  double Score;
+  // Blocks of the chain.
+  std::vector<Block *> Blocks;
+  // Total execution count of the chain.
+  uint64_t ExecutionCount;
+  // Total size of the chain in bytes.
+  uint64_t Size;
+  // Adjacent chains and corresponding edges (lists of jumps).
+  std::vector<std::pair<Chain *, ChainEdge *>> Edges;
+};
+
+/// An edge in CFG representing jumps between two chains.
+/// When blocks are merged into chains, the edges are combined too so that
+/// there is always at most one edge between a pair of chains
+class ChainEdge {
+public:
+  explicit ChainEdge(Jump *J)
+      : SrcChain(J->Source->CurChain), DstChain(J->Target->CurChain),
+        Jumps(1, J) {}
+
+  const JumpList &jumps() const { return Jumps; }
+
+  void changeEndpoint(Chain *From, Chain *To) {
+    if (From == SrcChain)
+      SrcChain = To;
+    if (From == DstChain)
+      DstChain = To;
+  }
+
+  void appendJump(Jump *J) { Jumps.push_back(J); }
+
+  void moveJumps(ChainEdge *Other) {
+    Jumps.insert(Jumps.end(), Other->Jumps.begin(), Other->Jumps.end());
+    Other->Jumps.clear();
+    Other->Jumps.shrink_to_fit();
+  }
+
+  bool hasCachedMergeGain(Chain *Src, Chain *Dst) const {
+    return Src == SrcChain ? CacheValidForward : CacheValidBackward;
+  }
+
+  MergeGainTy getCachedMergeGain(Chain *Src, Chain *Dst) const {
+    return Src == SrcChain ? CachedGainForward : CachedGainBackward;
+  }
+
+  void setCachedMergeGain(Chain *Src, Chain *Dst, MergeGainTy MergeGain) {
+    if (Src == SrcChain) {
+      CachedGainForward = MergeGain;
+      CacheValidForward = true;
+    } else {
+      CachedGainBackward = MergeGain;
+      CacheValidBackward = true;
+    }
+  }
+
+  void invalidateCache() {
+    CacheValidForward = false;
+    CacheValidBackward = false;
+  }
+
+private:
+  // Source chain.
+  Chain *SrcChain;
+  // Destination chain.
+  Chain *DstChain;
+  // Original jumps in the binary with corresponding execution counts.
+  JumpList Jumps;
+  // Cached ext-tsp value for merging the pair of chains.
+  // Since the gain of merging (Src, Dst) and (Dst, Src) might be different,
+  // we store both values here.
+  MergeGainTy CachedGainForward;
+  MergeGainTy CachedGainBackward;
+  // Whether the cached value must be recomputed.
+  bool CacheValidForward = false;
+  bool CacheValidBackward = false;
+};
+
+void Chain::mergeEdges(Chain *Other) {
+  assert(this != Other && "cannot merge a chain with itself");
+
+  // Update edges adjacent to chain Other.
+  for (auto EdgeIt : Other->Edges) {
+    Chain *DstChain = EdgeIt.first;
+    ChainEdge *DstEdge = EdgeIt.second;
+    Chain *TargetChain = DstChain == Other ? this : DstChain;
+    ChainEdge *CurEdge = getEdge(TargetChain);
+    if (CurEdge == nullptr) {
+      DstEdge->changeEndpoint(Other, this);
+      this->addEdge(TargetChain, DstEdge);
+      if (DstChain != this && DstChain != Other)
+        DstChain->addEdge(this, DstEdge);
+    } else {
+      CurEdge->moveJumps(DstEdge);
+    }
+    // Cleanup leftover edge.
+    if (DstChain != Other)
+      DstChain->removeEdge(Other);
+  }
+}
+
+/// The implementation of the ExtTSP algorithm.
+class ExtTSPImpl {
+public:
+  ExtTSPImpl(const std::vector<uint64_t> &NodeSizes,
+             const std::vector<uint64_t> &NodeCounts,
+             const std::vector<EdgeCountT> &EdgeCounts)
+      : NumNodes(NodeSizes.size()) {
+    initialize(NodeSizes, NodeCounts, EdgeCounts);
+  }
+
+  /// Run the algorithm and return an optimized ordering of blocks.
+  void run(std::vector<uint64_t> &Result) {
+    // Merge pairs of chains while improving the ExtTSP objective.
+    mergeChainPairs();
+
+    // Attach the cold chains along their original fall-throughs.
+    mergeColdChains();
+
+    // Collect blocks from all chains.
+    concatChains(Result);
+  }
+
+private:
+  /// Initialize the algorithm's data structures.
+  void initialize(const std::vector<uint64_t> &NodeSizes,
+                  const std::vector<uint64_t> &NodeCounts,
+                  const std::vector<EdgeCountT> &EdgeCounts) {
+    // Initialize blocks. Empty blocks get a size of 1 so that the density of
+    // every chain is defined.
+    AllBlocks.reserve(NumNodes);
+    for (uint64_t Node = 0; Node < NumNodes; Node++)
+      AllBlocks.emplace_back(Node, std::max<uint64_t>(NodeSizes[Node], 1),
+                             NodeCounts[Node]);
+
+    // Initialize jumps between blocks. Self-loops do not depend on the
+    // layout and are ignored.
+    SuccNodes.resize(NumNodes);
+    AllJumps.reserve(EdgeCounts.size());
+    for (const EdgeCountT &It : EdgeCounts) {
+      uint64_t Pred = It.first.first;
+      uint64_t Succ = It.first.second;
+      if (Pred == Succ)
+        continue;
+      SuccNodes[Pred].push_back(Succ);
+      Block &PredBlock = AllBlocks[Pred];
+      Block &SuccBlock = AllBlocks[Succ];
+      AllJumps.emplace_back(&PredBlock, &SuccBlock, It.second);
+      SuccBlock.InJumps.push_back(&AllJumps.back());
+      PredBlock.OutJumps.push_back(&AllJumps.back());
+    }
+
+    // Initialize chains.
+    AllChains.reserve(NumNodes);
+    HotChains.reserve(NumNodes);
+    for (Block &B : AllBlocks) {
+      AllChains.emplace_back(B.Index, &B);
+      B.CurChain = &AllChains.back();
+      if (B.ExecutionCount > 0)
+        HotChains.push_back(&AllChains.back());
+    }
+
+    // Initialize chain edges. There is at most one edge for every jump, so
+    // AllEdges never reallocates.
+    AllEdges.reserve(AllJumps.size());
+    for (Block &B : AllBlocks) {
+      for (Jump *J : B.OutJumps) {
+        Block &SuccBlock = *J->Target;
+        ChainEdge *CurEdge = B.CurChain->getEdge(SuccBlock.CurChain);
+        // This edge is already present in the graph.
+        if (CurEdge != nullptr) {
+          assert(SuccBlock.CurChain->getEdge(B.CurChain) != nullptr);
+          CurEdge->appendJump(J);
+          continue;
+        }
+        // This is a new edge.
+        AllEdges.emplace_back(J);
+        B.CurChain->addEdge(SuccBlock.CurChain, &AllEdges.back());
+        SuccBlock.CurChain->addEdge(B.CurChain, &AllEdges.back());
+      }
+    }
+  }
+
+  /// Merge pairs of chains while improving the ExtTSP objective.
+  void mergeChainPairs() {
+    /// Deterministically compare pairs of chains.
+    auto compareChainPairs = [](const Chain *A1, const Chain *B1,
+                                const Chain *A2, const Chain *B2) {
+      if (A1 != A2)
+        return A1->id() < A2->id();
+      return B1->id() < B2->id();
+    };
+
+    while (HotChains.size() > 1) {
+      Chain *BestChainPred = nullptr;
+      Chain *BestChainSucc = nullptr;
+      MergeGainTy BestGain;
+      // Iterate over all pairs of chains.
+      for (Chain *ChainPred : HotChains) {
+        // Get candidates for merging with the current chain.
+        for (auto EdgeIter : ChainPred->edges()) {
+          Chain *ChainSucc = EdgeIter.first;
+          ChainEdge *Edge = EdgeIter.second;
+          // Ignore loop edges.
+          if (ChainPred == ChainSucc)
+            continue;
+
+          // Compute the gain of merging the two chains.
+          MergeGainTy CurGain = getBestMergeGain(ChainPred, ChainSucc, Edge);
+          if (CurGain.Score <= EPS)
+            continue;
+
+          if (BestGain < CurGain ||
+              (std::abs(CurGain.Score - BestGain.Score) < EPS &&
+               compareChainPairs(ChainPred, ChainSucc, BestChainPred,
+                                 BestChainSucc))) {
+            BestGain = CurGain;
+            BestChainPred = ChainPred;
+            BestChainSucc = ChainSucc;
+          }
+        }
+      }
+
+      // Stop merging when there is no improvement.
+      if (BestGain.Score <= EPS)
+        break;
+
+      // Merge the best pair of chains.
+      mergeChains(BestChainPred, BestChainSucc, BestGain.MergeOffset,
+                  BestGain.MergeType);
+    }
+  }
+
+  /// Merge remaining blocks into chains w/o taking jump counts into
+  /// consideration. This allows to maintain the original block order in the
+  /// absence of profile data.
+  void mergeColdChains() {
+    for (size_t SrcBB = 0; SrcBB < NumNodes; SrcBB++) {
+      // Iterating in reverse order to make sure original fallthrough jumps are
+      // merged first; this might be beneficial for code size.
+      size_t NumSuccs = SuccNodes[SrcBB].size();
+      for (size_t Idx = 0; Idx < NumSuccs; Idx++) {
+        uint64_t DstBB = SuccNodes[SrcBB][NumSuccs - Idx - 1];
+        Chain *SrcChain = AllBlocks[SrcBB].CurChain;
+        Chain *DstChain = AllBlocks[DstBB].CurChain;
+        if (SrcChain != DstChain && !DstChain->isEntry() &&
+            SrcChain->blocks().back()->Index == SrcBB &&
+            DstChain->blocks().front()->Index == DstBB &&
+            SrcChain->isCold() == DstChain->isCold()) {
+          mergeChains(SrcChain, DstChain, 0, MergeTypeTy::X_Y);
+        }
+      }
+    }
+  }
+
+  /// Compute the Ext-TSP score for a given block order and a list of jumps.
+  double extTSPScore(const std::vector<Block *> &Blocks,
+                     const JumpList &Jumps) const {
+    if (Jumps.empty())
+      return 0.0;
+    uint64_t CurAddr = 0;
+    for (const Block *B : Blocks) {
+      B->EstimatedAddr = CurAddr;
+      CurAddr += B->Size;
+    }
+
+    double Score = 0;
+    for (const Jump *J : Jumps) {
+      const Block *SrcBlock = J->Source;
+      const Block *DstBlock = J->Target;
+      Score += ::extTSPScore(SrcBlock->EstimatedAddr, SrcBlock->Size,
+                             DstBlock->EstimatedAddr, J->ExecutionCount);
+    }
+    return Score;
+  }
+
+  /// Compute the gain of merging two chains.
+  ///
+  /// The function considers all possible ways of merging two chains and
+  /// computes the one having the largest increase in ExtTSP objective. The
+  /// result is a pair with the first element being the gain and the second
+  /// element being the corresponding merging type.
+  MergeGainTy getBestMergeGain(Chain *ChainPred, Chain *ChainSucc,
+                               ChainEdge *Edge) const {
+    if (Edge->hasCachedMergeGain(ChainPred, ChainSucc))
+      return Edge->getCachedMergeGain(ChainPred, ChainSucc);
+
+    // Precompute jumps between ChainPred and ChainSucc.
+    JumpList Jumps = Edge->jumps();
+    ChainEdge *EdgePP = ChainPred->getEdge(ChainPred);
+    if (EdgePP != nullptr)
+      Jumps.insert(Jumps.end(), EdgePP->jumps().begin(), EdgePP->jumps().end());
+    assert(!Jumps.empty() && "trying to merge chains w/o jumps");
+
+    // The object holds the best currently chosen gain of merging the two
+    // chains.
+    MergeGainTy Gain = MergeGainTy();
+
+    /// Given a merge offset and a list of merge types, try to merge two chains
+    /// and update Gain with a better alternative.
+    auto tryChainMerging = [&](size_t Offset,
+                               const std::vector<MergeTypeTy> &MergeTypes) {
+      // Skip merging corresponding to concatenation w/o splitting.
+      if (Offset == 0 || Offset == ChainPred->blocks().size())
+        return;
+      for (MergeTypeTy MergeType : MergeTypes) {
+        MergeGainTy NewGain =
+            computeMergeGain(ChainPred, ChainSucc, Jumps, Offset, MergeType);
+        if (Gain < NewGain)
+          Gain = NewGain;
+      }
+    };
+
+    // Try to concatenate two chains w/o splitting.
+    Gain = computeMergeGain(ChainPred, ChainSucc, Jumps, 0, MergeTypeTy::X_Y);
+
+    // Try to break ChainPred in various ways and concatenate with ChainSucc.
+    if (ChainPred->blocks().size() <= ChainSplitThreshold) {
+      for (size_t Offset = 1; Offset < ChainPred->blocks().size(); Offset++) {
+        // Try to split the chain in different ways. In practice, applying
+        // X2_Y_X1 merging is almost never provides benefits; thus, we exclude
+        // it from consideration to reduce the search space.
+        tryChainMerging(Offset, {MergeTypeTy::X1_Y_X2, MergeTypeTy::Y_X2_X1,
+                                 MergeTypeTy::X2_X1_Y});
+      }
+    }
+
+    Edge->setCachedMergeGain(ChainPred, ChainSucc, Gain);
+    return Gain;
+  }
+
+  /// Compute the score gain of merging two chains, respecting a given
+  /// merge 'type' and 'offset'.
+  ///
+  /// The two chains are not modified in the method.
+  MergeGainTy computeMergeGain(const Chain *ChainPred, const Chain *ChainSucc,
+                               const JumpList &Jumps, size_t MergeOffset,
+                               MergeTypeTy MergeType) const {
+    std::vector<Block *> MergedBlocks = mergeBlocks(
+        ChainPred->blocks(), ChainSucc->blocks(), MergeOffset, MergeType);
+
+    // Do not allow a merge that does not preserve the original entry block.
+    if ((ChainPred->isEntry() || ChainSucc->isEntry()) &&
+        !MergedBlocks.front()->isEntry())
+      return MergeGainTy();
+
+    // The gain for the new chain.
+    double NewGainScore = extTSPScore(MergedBlocks, Jumps) - ChainPred->score();
+    return MergeGainTy(NewGainScore, MergeOffset, MergeType);
+  }
+
+  /// Merge two chains of blocks respecting a given merge 'type' and 'offset'.
+  ///
+  /// If MergeType == X_Y, then the result is a concatenation of two chains.
+  /// Otherwise, the first chain is cut into two sub-chains at the offset,
+  /// and merged using all possible ways of concatenating three chains.
+  static std::vector<Block *> mergeBlocks(const std::vector<Block *> &X,
+                                          const std::vector<Block *> &Y,
+                                          size_t MergeOffset,
+                                          MergeTypeTy MergeType) {
+    // Split the first chain, X, into X1 and X2.
+    auto BeginX1 = X.begin();
+    auto EndX1 = X.begin() + MergeOffset;
+    auto BeginX2 = X.begin() + MergeOffset;
+    auto EndX2 = X.end();
+
+    std::vector<Block *> Result;
+    Result.reserve(X.size() + Y.size());
+    auto append = [&](std::vector<Block *>::const_iterator Begin,
+                      std::vector<Block *>::const_iterator End) {
+      Result.insert(Result.end(), Begin, End);
+    };
+
+    // Construct a new chain from the three existing ones.
+    switch (MergeType) {
+    case MergeTypeTy::X_Y:
+      append(X.begin(), X.end());
+      append(Y.begin(), Y.end());
+      break;
+    case MergeTypeTy::X1_Y_X2:
+      append(BeginX1, EndX1);
+      append(Y.begin(), Y.end());
+      append(BeginX2, EndX2);
+      break;
+    case MergeTypeTy::Y_X2_X1:
+      append(Y.begin(), Y.end());
+      append(BeginX2, EndX2);
+      append(BeginX1, EndX1);
+      break;
+    case MergeTypeTy::X2_X1_Y:
+      append(BeginX2, EndX2);
+      append(BeginX1, EndX1);
+      append(Y.begin(), Y.end());
+      break;
+    }
+    return Result;
+  }
+
+  /// Merge chain From into chain Into, update the list of active chains,
+  /// adjacency information, and the corresponding cached values.
+  void mergeChains(Chain *Into, Chain *From, size_t MergeOffset,
+                   MergeTypeTy MergeType) {
+    assert(Into != From && "a chain cannot be merged with itself");
+
+    // Merge the blocks.
+    std::vector<Block *> MergedBlocks =
+        mergeBlocks(Into->blocks(), From->blocks(), MergeOffset, MergeType);
+    Into->merge(From, MergedBlocks);
+    Into->mergeEdges(From);
+    From->clear();
+
+    // Update cached ext-tsp score for the new chain.
+    ChainEdge *SelfEdge = Into->getEdge(Into);
+    if (SelfEdge != nullptr)
+      Into->setScore(extTSPScore(Into->blocks(), SelfEdge->jumps()));
+
+    // Remove the chain from the list of active chains.
+    auto It = std::find(HotChains.begin(), HotChains.end(), From);
+    if (It != HotChains.end())
+      HotChains.erase(It);
+
+    // Invalidate caches.
+    for (auto EdgeIter : Into->edges())
+      EdgeIter.second->invalidateCache();
+  }
+
+  /// Concatenate all chains into the final order of blocks.
+  void concatChains(std::vector<uint64_t> &Order) {
+    // Collect chains and calculate some stats for their sorting.
+    std::vector<Chain *> SortedChains;
+    for (Chain &C : AllChains)
+      if (!C.blocks().empty())
+        SortedChains.push_back(&C);
+
+    // Sorting chains by density in the decreasing order.
+    std::stable_sort(SortedChains.begin(), SortedChains.end(),
+                     [](const Chain *C1, const Chain *C2) {
+                       // Make sure the original entry block is at the
+                       // beginning of the order.
+                       if (C1->isEntry() != C2->isEntry())
+                         return C1->isEntry();
+
+                       const double D1 = C1->density();
+                       const double D2 = C2->density();
+                       // Compare by density and break ties by chain
+                       // identifiers.
+                       return (D1 != D2) ? (D1 > D2) : (C1->id() < C2->id());
+                     });
+
+    // Collect the blocks in the order specified by their chains.
+    Order.reserve(NumNodes);
+    for (const Chain *C : SortedChains)
+      for (const Block *B : C->blocks())
+        Order.push_back(B->Index);
+  }
+
+private:
+  /// The number of nodes in the graph.
+  const size_t NumNodes;
+
+  /// Successors of each node.
+  std::vector<std::vector<uint64_t>> SuccNodes;
+
+  /// All basic blocks.
+  std::vector<Block> AllBlocks;
+
+  /// All jumps between blocks.
+  std::vector<Jump> AllJumps;
+
+  /// All chains of basic blocks.
+  std::vector<Chain> AllChains;
+
+  /// All edges between chains.
+  std::vector<ChainEdge> AllEdges;
+
+  /// Active chains. The vector gets updated at runtime when chains are merged.
+  std::vector<Chain *> HotChains;
+};
+
+} // end anonymous namespace
+
+std::vector<uint64_t>
+llvm::applyExtTspLayout(const std::vector<uint64_t> &NodeSizes,
+                        const std::vector<uint64_t> &NodeCounts,
+                        const std::vector<EdgeCountT> &EdgeCounts) {
+  size_t NumNodes = NodeSizes.size();
+
+  // Verify correctness of the input data.
+  assert(NodeCounts.size() == NodeSizes.size() && "Incorrect input");
+  assert(NumNodes > 2 && "Incorrect input");
+
+  // Apply the reordering algorithm.
+  ExtTSPImpl Alg(NodeSizes, NodeCounts, EdgeCounts);
+  std::vector<uint64_t> Result;
+  Alg.run(Result);
+
+  // Verify correctness of the output.
+  assert(Result.front() == 0 && "Original entry point is not preserved");
+  assert(Result.size() == NumNodes && "Incorrect size of reordered layout");
+  return Result;
+}
+
+double llvm::calcExtTspScore(const std::vector<uint64_t> &Order,
+                             const std::vector<uint64_t> &NodeSizes,
+                             const std::vector<uint64_t> &NodeCounts,
+                             const std::vector<EdgeCountT> &EdgeCounts) {
+  // Estimate addresses of the blocks in memory, with the sizes used by the
+  // layout algorithm.
+  auto sizeOf = [&](uint64_t Node) {
+    return std::max<uint64_t>(NodeSizes[Node], 1);
+  };
+  std::vector<uint64_t> Addr(NodeSizes.size(), 0);
+  for (size_t Idx = 1; Idx < Order.size(); Idx++)
+    Addr[Order[Idx]] = Addr[Order[Idx - 1]] + sizeOf(Order[Idx - 1]);
+
+  // Increase the score for each jump.
+  double Score = 0;
+  for (const EdgeCountT &It : EdgeCounts) {
+    uint64_t Pred = It.first.first;
+    uint64_t Succ = It.first.second;
+    uint64_t Count = It.second;
+    Score += extTSPScore(Addr[Pred], sizeOf(Pred), Addr[Succ], Count);
+  }
+  return Score;
+}
+
+double llvm::calcExtTspScore(const std::vector<uint64_t> &NodeSizes,
+                             const std::vector<uint64_t> &NodeCounts,
+                             const std::vector<EdgeCountT> &EdgeCounts) {
+  std::vector<uint64_t> Order(NodeSizes.size());
+  for (size_t Idx = 0; Idx < NodeSizes.size(); Idx++)
+    Order[Idx] = Idx;
+  return calcExtTspScore(Order, NodeSizes, NodeCounts, EdgeCounts);
+}
@@ -0,0 +1,70 @@
+; RUN: llc -march=riscv64 -mcpu=RV64I -global-isel -stop-after=legalizer %s -o - | FileCheck %s
+; REQUIRES: global-isel
+
+; Operations narrower than 32 bits are widened, and the conversions glueing
+; them to the 64-bit argument and return registers are kept at the edges.
+
+; CHECK-LABEL: name: add8
+; CHECK: [[A:%[0-9]+]](64) = COPY %a0_64
+; CHECK: [[B:%[0-9]+]](64) = COPY %a1_64
+; CHECK: [[A32:%[0-9]+]](32) = G_TRUNC i32 [[A]]
+; CHECK: [[B32:%[0-9]+]](32) = G_TRUNC i32 [[B]]
+; CHECK: [[R:%[0-9]+]](32) = G_ADD i32 [[A32]], [[B32]]
+; CHECK: [[R64:%[0-9]+]](64) = G_ANYEXT i64 [[R]]
+; CHECK: %a0_64 = COPY [[R64]]
+; CHECK: RET
+define i8 @add8(i8 %a, i8 %b) {
+  %r = add i8 %a, %b
+  ret i8 %r
+}
+
+; Legal operations are left alone.
+
+; CHECK-LABEL: name: addi
+; CHECK: [[A:%[0-9]+]](64) = COPY %a0_64
+; CHECK: [[C:%[0-9]+]](64) = G_CONSTANT i64 i64 42
+; CHECK: [[R:%[0-9]+]](64) = G_ADD i64 [[A]], [[C]]
+; CHECK: %a0_64 = COPY [[R]]
+define i64 @addi(i64 %a) {
+  %r = add i64 %a, 42
+  ret i64 %r
+}
+
+; Narrow shifts are widened too. The high bits of the wide value are
+; shifted into the result by right shifts, so the value is zero-extended
+; with a mask for G_LSHR and sign-extended with a shift pair for G_ASHR.
+
+; CHECK-LABEL: name: shl8
+; CHECK: [[A32:%[0-9]+]](32) = G_TRUNC i32 {{%[0-9]+}}
+; CHECK: [[B32:%[0-9]+]](32) = G_TRUNC i32 {{%[0-9]+}}
+; CHECK-NEXT: [[R:%[0-9]+]](32) = G_SHL i32 [[A32]], [[B32]]
+; CHECK-NEXT: {{%[0-9]+}}(64) = G_ANYEXT i64 [[R]]
+define i8 @shl8(i8 %a, i8 %b) {
+  %r = shl i8 %a, %b
+  ret i8 %r
+}
+
+; CHECK-LABEL: name: lshr16
+; CHECK: [[A32:%[0-9]+]](32) = G_TRUNC i32 {{%[0-9]+}}
+; CHECK: [[B32:%[0-9]+]](32) = G_TRUNC i32 {{%[0-9]+}}
+; CHECK-NEXT: [[M:%[0-9]+]](32) = G_CONSTANT i32 i32 65535
+; CHECK-NEXT: [[Z:%[0-9]+]](32) = G_AND i32 [[A32]], [[M]]
+; CHECK-NEXT: [[R:%[0-9]+]](32) = G_LSHR i32 [[Z]], [[B32]]
+; CHECK-NEXT: {{%[0-9]+}}(64) = G_ANYEXT i64 [[R]]
+define i16 @lshr16(i16 %a, i16 %b) {
+  %r = lshr i16 %a, %b
+  ret i16 %r
+}
+
+; CHECK-LABEL: name: ashr8
+; CHECK: [[A32:%[0-9]+]](32) = G_TRUNC i32 {{%[0-9]+}}
+; CHECK: [[B32:%[0-9]+]](32) = G_TRUNC i32 {{%[0-9]+}}
+; CHECK-NEXT: [[C:%[0-9]+]](32) = G_CONSTANT i32 i32 24
+; CHECK-NEXT: [[H:%[0-9]+]](32) = G_SHL i32 [[A32]], [[C]]
+; CHECK-NEXT: [[S:%[0-9]+]](32) = G_ASHR i32 [[H]], [[C]]
+; CHECK-NEXT: [[R:%[0-9]+]](32) = G_ASHR i32 [[S]], [[B32]]
+; CHECK-NEXT: {{%[0-9]+}}(64) = G_ANYEXT i64 [[R]]
+define i8 @ashr8(i8 %a, i8 %b) {
+  %r = ashr i8 %a, %b
+  ret i8 %r
+}
@@ -0,0 +1,88 @@
+; RUN: llc -march=riscv64 -mcpu=RV64IMAFD -global-isel < %s | FileCheck %s
+; REQUIRES: global-isel
+
+; Most of the selection comes from the table imported from the SelectionDAG
+; patterns, including the folding of immediates into the I-type forms.
+
+; CHECK-LABEL: add:
+; CHECK: add x10, x10, x11
+; CHECK-NEXT: ret
+define i64 @add(i64 %a, i64 %b) {
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+; CHECK-LABEL: addi:
+; CHECK: addi x10, x10, 42
+; CHECK-NEXT: ret
+define i64 @addi(i64 %a) {
+  %r = add i64 %a, 42
+  ret i64 %r
+}
+
+; CHECK-LABEL: sub32:
+; CHECK: subw x10, x10, x11
+define i32 @sub32(i32 %a, i32 %b) {
+  %r = sub i32 %a, %b
+  ret i32 %r
+}
+
+; CHECK-LABEL: logic:
+; CHECK: and [[T0:x[0-9]+]], x10, x11
+; CHECK-NEXT: ori [[T1:x[0-9]+]], [[T0]], 7
+; CHECK-NEXT: xor [[T2:x[0-9]+]], [[T1]], x10
+; CHECK-NEXT: sll x10, [[T2]], x11
+define i64 @logic(i64 %a, i64 %b) {
+  %x = and i64 %a, %b
+  %y = or i64 %x, 7
+  %z = xor i64 %y, %a
+  %s = shl i64 %z, %b
+  ret i64 %s
+}
+
+; CHECK-LABEL: mul:
+; CHECK: mul x10, x10, x11
+define i64 @mul(i64 %a, i64 %b) {
+  %r = mul i64 %a, %b
+  ret i64 %r
+}
+
+; CHECK-LABEL: cst:
+; CHECK: li x10, 5
+; CHECK-NEXT: ret
+define i64 @cst() {
+  ret i64 5
+}
+
+; i8 is computed in 32 bits.
+; CHECK-LABEL: add8:
+; CHECK: addw x10, x10, x11
+define i8 @add8(i8 %a, i8 %b) {
+  %r = add i8 %a, %b
+  ret i8 %r
+}
+
+; CHECK-LABEL: shl8:
+; CHECK: sllw x10, x10, x11
+define i8 @shl8(i8 %a, i8 %b) {
+  %r = shl i8 %a, %b
+  ret i8 %r
+}
+
+; CHECK-LABEL: lshr16:
+; CHECK: li [[M:x[0-9]+]], 65535
+; CHECK-NEXT: and [[Z:x[0-9]+]], x10, [[M]]
+; CHECK-NEXT: srlw x10, [[Z]], x11
+define i16 @lshr16(i16 %a, i16 %b) {
+  %r = lshr i16 %a, %b
+  ret i16 %r
+}
+
+; CHECK-LABEL: ashr8:
+; CHECK: slliw [[H:x[0-9]+]], x10, 24
+; CHECK-NEXT: sraiw [[S:x[0-9]+]], [[H]], 24
+; CHECK-NEXT: sraw x10, [[S]], x11
+define i8 @ashr8(i8 %a, i8 %b) {
+  %r = ashr i8 %a, %b
+  ret i8 %r
+}
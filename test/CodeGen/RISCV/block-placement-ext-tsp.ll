@@ -0,0 +1,65 @@
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I | FileCheck %s -check-prefix=CHAIN
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -enable-ext-tsp-block-placement \
+; RUN:   | FileCheck %s -check-prefix=EXTTSP
+
+; The hot path is entry -> b3 -> (b4 ->) b5. The chain-based placement keeps
+; the rarely executed b1 and b2 between b3 and its successors, while the
+; Ext-TSP layout lets every hot edge fall through and moves b1 and b2 last.
+
+declare void @g0()
+declare void @g1()
+declare void @g2()
+declare void @g3()
+declare void @g4()
+declare void @g5()
+
+define void @f(i32 %x) !prof !0 {
+; CHAIN-LABEL: f:
+; CHAIN: # %entry
+; CHAIN: # %b3
+; CHAIN: # %b1
+; CHAIN: # %b2
+; CHAIN: # %b4
+; CHAIN: # %b5
+
+; EXTTSP-LABEL: f:
+; EXTTSP: # %entry
+; EXTTSP: # %b3
+; EXTTSP: # %b4
+; EXTTSP: # %b5
+; EXTTSP: # %b1
+; EXTTSP: # %b2
+entry:
+  call void @g0()
+  %c0 = icmp eq i32 %x, 0
+  br i1 %c0, label %b3, label %b1, !prof !1
+
+b1:
+  call void @g1()
+  %c1 = icmp eq i32 %x, 1
+  br i1 %c1, label %b2, label %b5, !prof !2
+
+b2:
+  call void @g2()
+  %c2 = icmp eq i32 %x, 2
+  br i1 %c2, label %b3, label %b4, !prof !3
+
+b3:
+  call void @g3()
+  %c3 = icmp eq i32 %x, 3
+  br i1 %c3, label %b5, label %b4, !prof !4
+
+b4:
+  call void @g4()
+  br label %b5
+
+b5:
+  call void @g5()
+  ret void
+}
+
+!0 = !{!"function_entry_count", i64 1000}
+!1 = !{!"branch_weights", i32 900, i32 100}
+!2 = !{!"branch_weights", i32 500, i32 500}
+!3 = !{!"branch_weights", i32 100, i32 900}
+!4 = !{!"branch_weights", i32 500, i32 500}
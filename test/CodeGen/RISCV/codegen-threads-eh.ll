@@ -0,0 +1,54 @@
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I > %t.serial.s
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -codegen-threads=4 > %t.threaded.s
+; RUN: diff %t.serial.s %t.threaded.s
+; RUN: FileCheck %s < %t.threaded.s
+
+; Instruction selection creates the labels of invokes and landing pads before
+; the machine passes run on threads, and the AsmPrinter creates more when it
+; emits each function. They must be numbered as in the serial pipeline.
+
+declare void @may_throw(i64)
+declare i32 @__gxx_personality_v0(...)
+
+; CHECK-LABEL: catch_all:
+; CHECK: Ltmp0:
+; CHECK: Call between Ltmp0 and Ltmp{{[0-9]+}}
+define i64 @catch_all(i64 %n) personality i32 (...)* @__gxx_personality_v0 {
+entry:
+  invoke void @may_throw(i64 %n)
+          to label %next unwind label %lpad
+
+next:
+  invoke void @may_throw(i64 1)
+          to label %done unwind label %lpad
+
+done:
+  ret i64 %n
+
+lpad:
+  %lp = landingpad { i8*, i32 }
+          catch i8* null
+  ret i64 0
+}
+
+; CHECK-LABEL: no_eh:
+define i64 @no_eh(i64 %a, i64 %b) {
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+; CHECK-LABEL: cleanup:
+; CHECK: Call between Ltmp{{[0-9]+}} and Ltmp{{[0-9]+}}
+define i64 @cleanup(i64 %n) personality i32 (...)* @__gxx_personality_v0 {
+entry:
+  invoke void @may_throw(i64 2)
+          to label %done unwind label %lpad
+
+done:
+  ret i64 %n
+
+lpad:
+  %lp = landingpad { i8*, i32 }
+          cleanup
+  ret i64 1
+}
@@ -0,0 +1,79 @@
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I > %t.serial.s
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -codegen-threads=4 > %t.threaded.s
+; RUN: diff %t.serial.s %t.threaded.s
+; RUN: FileCheck %s < %t.threaded.s
+
+; The machine passes running on several threads must produce the same code,
+; emitted in the same order, as the serial pipeline.
+
+declare void @use(i8*)
+
+; CHECK-LABEL: add:
+define i64 @add(i64 %a, i64 %b) {
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+; CHECK-LABEL: sum:
+define i64 @sum(i64* %p, i64 %n) {
+entry:
+  %empty = icmp eq i64 %n, 0
+  br i1 %empty, label %exit, label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %addr = getelementptr i64, i64* %p, i64 %i
+  %v = load i64, i64* %addr
+  %acc.next = add i64 %acc, %v
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  ret i64 %r
+}
+
+; CHECK-LABEL: protected:
+; CHECK: __stack_chk_guard
+define void @protected() sspreq {
+  %buf = alloca [64 x i8]
+  %p = getelementptr [64 x i8], [64 x i8]* %buf, i64 0, i64 0
+  call void @use(i8* %p)
+  ret void
+}
+
+; CHECK-LABEL: select:
+define i64 @select(i64 %x) {
+entry:
+  switch i64 %x, label %def [
+    i64 0, label %a
+    i64 1, label %b
+    i64 2, label %c
+    i64 3, label %d
+    i64 4, label %e
+  ]
+a:
+  ret i64 10
+b:
+  ret i64 21
+c:
+  ret i64 32
+d:
+  ret i64 43
+e:
+  ret i64 54
+def:
+  ret i64 0
+}
+
+; CHECK-LABEL: frame:
+define void @frame(i64 %n) {
+  %a = alloca i8, i64 %n
+  call void @use(i8* %a)
+  %b = alloca [16 x i8]
+  %q = getelementptr [16 x i8], [16 x i8]* %b, i64 0, i64 0
+  call void @use(i8* %q)
+  ret void
+}
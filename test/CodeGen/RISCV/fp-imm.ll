@@ -0,0 +1,74 @@
+; RUN: llc -march=riscv64 -mcpu=RV64IMAFD < %s | FileCheck %s
+
+; FP constants whose bits take at most two integer instructions are built in
+; a GPR and moved across; others still come from the constant pool.
+
+; CHECK-LABEL: f32_one:
+; CHECK: li [[R:x[0-9]+]], 1065353216
+; CHECK-NEXT: fmv.s.x {{f[0-9]+}}, [[R]]
+; CHECK-NOT: flw
+define float @f32_one(float %x) {
+  %r = fadd float %x, 1.0
+  ret float %r
+}
+
+; CHECK-LABEL: f32_neg_zero:
+; CHECK: li [[R:x[0-9]+]], -2147483648
+; CHECK-NEXT: fmv.s.x {{f[0-9]+}}, [[R]]
+define float @f32_neg_zero(float %x) {
+  %r = fmul float %x, -0.0
+  ret float %r
+}
+
+; CHECK-LABEL: f64_half:
+; CHECK: li [[R:x[0-9]+]], 4602678819172646912
+; CHECK-NEXT: fmv.d.x {{f[0-9]+}}, [[R]]
+; CHECK-NOT: fld
+define double @f64_half(double %x) {
+  %r = fmul double %x, 0.5
+  ret double %r
+}
+
+; CHECK-LABEL: f64_tenth:
+; CHECK-NOT: fmv.d.x
+; CHECK: %lo(.LCPI{{[0-9_]+}})
+; CHECK: fld
+define double @f64_tenth(double %x) {
+  %r = fmul double %x, 0.1
+  ret double %r
+}
+
+; CHECK-LABEL: f64_zero:
+; CHECK: fcvt.d.w {{f[0-9]+}}, x0
+define double @f64_zero() {
+  ret double 0.0
+}
+
+; The constant is materialized once, outside the loop.
+; CHECK-LABEL: f64_loop:
+; CHECK: li [[R:x[0-9]+]], 4609434218613702656
+; CHECK-NEXT: fmv.d.x [[F:f[0-9]+]], [[R]]
+; CHECK: LBB{{[0-9_]+}}:
+; CHECK-NOT: fmv.d.x
+; CHECK: fmul.d {{f[0-9]+}}, {{f[0-9]+}}, [[F]]
+; CHECK-NOT: fmv.d.x
+; CHECK: fmul.d {{f[0-9]+}}, {{f[0-9]+}}, [[F]]
+; CHECK-NOT: fmv.d.x
+; CHECK: blt
+define double @f64_loop(double* %p, i64 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i64 [0, %entry], [%i1, %loop]
+  %acc = phi double [0.0, %entry], [%acc1, %loop]
+  %a = getelementptr double, double* %p, i64 %i
+  %v = load double, double* %a
+  %m = fmul double %v, 1.5
+  %m2 = fmul double %m, 1.5
+  %acc1 = fadd double %acc, %m2
+  %i1 = add i64 %i, 1
+  %c = icmp slt i64 %i1, %n
+  br i1 %c, label %loop, label %exit
+exit:
+  ret double %acc1
+}
@@ -0,0 +1,51 @@
+; RUN: llc -march=riscv64 -mcpu=RV64I < %s | FileCheck %s
+
+; Locals beyond the reach of a 12-bit offset from sp share one base register
+; instead of rebuilding the address for every access.
+
+declare void @use(i8*)
+
+; CHECK-LABEL: far_locals:
+; CHECK: li [[OFF:x[0-9]+]], 8204
+; CHECK: add [[ADDR:x[0-9]+]], x2, [[OFF]]
+; CHECK: addi [[BASE:x[0-9]+]], [[ADDR]], 0
+; CHECK: jalr
+; CHECK-NOT: li
+; CHECK: sw {{x[0-9]+}}, 8([[BASE]])
+; CHECK-NEXT: sw {{x[0-9]+}}, 4([[BASE]])
+; CHECK-NEXT: sw {{x[0-9]+}}, 0([[BASE]])
+; CHECK-NEXT: lw {{x[0-9]+}}, 8([[BASE]])
+; CHECK-NEXT: lw {{x[0-9]+}}, 4([[BASE]])
+; CHECK: lw {{x[0-9]+}}, 0([[BASE]])
+define i32 @far_locals(i32 %x) {
+  %a = alloca i32
+  %b = alloca i32
+  %c = alloca i32
+  %buf = alloca [8192 x i8], align 4
+  %p = getelementptr [8192 x i8], [8192 x i8]* %buf, i32 0, i32 0
+  call void @use(i8* %p)
+  store volatile i32 %x, i32* %a
+  store volatile i32 %x, i32* %b
+  store volatile i32 %x, i32* %c
+  %va = load volatile i32, i32* %a
+  %vb = load volatile i32, i32* %b
+  %vc = load volatile i32, i32* %c
+  %s1 = add i32 %va, %vb
+  %s2 = add i32 %s1, %vc
+  ret i32 %s2
+}
+
+; Locals close to sp are still addressed from it directly.
+; CHECK-LABEL: near_locals:
+; CHECK: sw {{x[0-9]+}}, {{[0-9]+}}(x2)
+; CHECK: lw {{x[0-9]+}}, {{[0-9]+}}(x2)
+define i32 @near_locals(i32 %x) {
+  %a = alloca i32
+  %b = alloca i32
+  store volatile i32 %x, i32* %a
+  store volatile i32 %x, i32* %b
+  %va = load volatile i32, i32* %a
+  %vb = load volatile i32, i32* %b
+  %s = add i32 %va, %vb
+  ret i32 %s
+}
@@ -0,0 +1,73 @@
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -split-machine-functions \
+; RUN:   | FileCheck %s
+
+; The subprogram and compile unit of a split function cover both of its parts.
+
+; CHECK-LABEL: foo:
+; CHECK: Lfunc_begin0:
+; CHECK: Lfunc_hot_end0:
+; CHECK: foo.cold:
+; CHECK: .loc 1 6 5
+; CHECK: Lfunc_end0:
+
+; CHECK: .long Ldebug_ranges1 # DW_AT_ranges
+; CHECK: .long Ldebug_ranges0 # DW_AT_ranges
+
+; CHECK-LABEL: .section .debug_ranges
+; CHECK-NEXT: Ldebug_range:
+; CHECK-NEXT: Ldebug_ranges0:
+; CHECK-NEXT: .quad Lfunc_begin0
+; CHECK-NEXT: .quad Lfunc_hot_end0
+; CHECK-NEXT: .quad foo.cold
+; CHECK-NEXT: .quad Lfunc_end0
+; CHECK-NEXT: .quad 0
+; CHECK-NEXT: .quad 0
+; CHECK-NEXT: Ldebug_ranges1:
+; CHECK-NEXT: .quad Lfunc_begin0
+; CHECK-NEXT: .quad Lfunc_hot_end0
+; CHECK-NEXT: .quad foo.cold
+; CHECK-NEXT: .quad Lfunc_end0
+
+declare void @hot1()
+declare void @cold1()
+declare void @llvm.dbg.value(metadata, i64, metadata, metadata)
+
+define i64 @foo(i64 %x) !prof !20 !dbg !4 {
+entry:
+  call void @llvm.dbg.value(metadata i64 %x, i64 0, metadata !11, metadata !12), !dbg !10
+  %c = icmp eq i64 %x, 0, !dbg !10
+  br i1 %c, label %cold, label %hot, !prof !21, !dbg !10
+
+hot:
+  call void @hot1(), !dbg !13
+  br label %exit, !dbg !13
+
+cold:
+  call void @cold1(), !dbg !14
+  br label %exit, !dbg !14
+
+exit:
+  %r = phi i64 [ 1, %cold ], [ 2, %hot ]
+  ret i64 %r, !dbg !15
+}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!8, !9}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "", isOptimized: true, emissionKind: FullDebug)
+!1 = !DIFile(filename: "test.c", directory: "/tmp")
+!2 = !{}
+!4 = distinct !DISubprogram(name: "foo", scope: !1, file: !1, line: 2, type: !5, isLocal: false, isDefinition: true, scopeLine: 3, flags: DIFlagPrototyped, isOptimized: true, unit: !0, variables: !2)
+!5 = !DISubroutineType(types: !6)
+!6 = !{!7, !7}
+!7 = !DIBasicType(name: "long", size: 64, align: 64, encoding: DW_ATE_signed)
+!8 = !{i32 2, !"Dwarf Version", i32 4}
+!9 = !{i32 2, !"Debug Info Version", i32 3}
+!10 = !DILocation(line: 4, column: 5, scope: !4)
+!11 = !DILocalVariable(name: "x", arg: 1, scope: !4, file: !1, line: 2, type: !7)
+!12 = !DIExpression()
+!13 = !DILocation(line: 5, column: 5, scope: !4)
+!14 = !DILocation(line: 6, column: 5, scope: !4)
+!15 = !DILocation(line: 7, column: 5, scope: !4)
+!20 = !{!"function_entry_count", i64 1000}
+!21 = !{!"branch_weights", i32 0, i32 1000}
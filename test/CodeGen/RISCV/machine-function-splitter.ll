@@ -0,0 +1,88 @@
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -split-machine-functions \
+; RUN:   | FileCheck %s -check-prefix=CHECK -check-prefix=UNLIKELY
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -split-machine-functions \
+; RUN:   -function-sections | FileCheck %s -check-prefix=CHECK -check-prefix=SPLIT
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I | FileCheck %s -check-prefix=NOSPLIT
+
+; The blocks the profile never saw run move to a separate section, under a
+; local symbol of their own with its own frame description. Conditional
+; branches into the cold section take the long form.
+
+declare void @hot1()
+declare void @cold1()
+declare void @cold2()
+
+define i64 @foo(i64 %x) !prof !0 {
+; CHECK-LABEL: foo:
+; CHECK: .cfi_startproc
+; CHECK: .cfi_def_cfa_offset 16
+; CHECK: bne x5, x0, .+8
+; CHECK-NEXT: j [[COLD:LBB0_[0-9]+]]
+; CHECK: bne x5, x6, .+8
+; CHECK-NEXT: j [[COLD2:LBB0_[0-9]+]]
+; CHECK: [[EXIT:LBB0_[0-9]+]]: # %exit
+; CHECK: ret
+; CHECK-NEXT: [[HOTEND:Lfunc_hot_end0]]:
+; CHECK-NEXT: .size foo, [[HOTEND]]-foo
+; CHECK-NEXT: .cfi_endproc
+; UNLIKELY-NEXT: .section .text.unlikely,"ax",@progbits
+; SPLIT-NEXT: .section .text.split.foo,"ax",@progbits
+; CHECK-NEXT: .p2align 2
+; CHECK-NEXT: .type foo.cold,@function
+; CHECK-NEXT: foo.cold:
+; CHECK-NEXT: .cfi_startproc
+; CHECK: .cfi_def_cfa_offset 16
+; CHECK: [[COLD]]: # %cold
+; CHECK: j [[EXIT]]
+; CHECK: [[COLD2]]: # %cold2
+; CHECK: j [[EXIT]]
+; CHECK-NEXT: [[END:Lfunc_end0]]:
+; CHECK-NEXT: .size foo.cold, [[END]]-foo.cold
+; CHECK-NEXT: .cfi_endproc
+
+; NOSPLIT-LABEL: foo:
+; NOSPLIT-NOT: .section
+; NOSPLIT-NOT: foo.cold
+; NOSPLIT: .size foo, Lfunc_end0-foo
+entry:
+  %c = icmp eq i64 %x, 0
+  br i1 %c, label %cold, label %hot, !prof !1
+
+hot:
+  call void @hot1()
+  %d = icmp eq i64 %x, 5
+  br i1 %d, label %cold2, label %exit, !prof !1
+
+cold:
+  call void @cold1()
+  br label %exit
+
+cold2:
+  call void @cold2()
+  ret i64 7
+
+exit:
+  %r = phi i64 [ 1, %cold ], [ 2, %hot ]
+  ret i64 %r
+}
+
+; Without a profile, nothing is known to be cold.
+define i64 @bar(i64 %x) {
+; CHECK-LABEL: bar:
+; CHECK-NOT: bar.cold
+; CHECK: .size bar, Lfunc_end1-bar
+entry:
+  %c = icmp eq i64 %x, 0
+  br i1 %c, label %cold, label %hot
+
+hot:
+  call void @hot1()
+  ret i64 1
+
+cold:
+  call void @cold1()
+  ret i64 2
+}
+
+!0 = !{!"function_entry_count", i64 1000}
+!1 = !{!"branch_weights", i32 0, i32 1000}
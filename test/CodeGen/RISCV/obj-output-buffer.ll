@@ -0,0 +1,23 @@
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -filetype=obj -o - > %t.stream.o
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -filetype=obj -o %t.memory.o
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -filetype=obj \
+; RUN:     -map-output-threshold=0 -o %t.mapped.o
+; RUN: cmp %t.stream.o %t.memory.o
+; RUN: cmp %t.stream.o %t.mapped.o
+
+; Object files written to stdout, laid out in memory and written into a mapped
+; output file must be identical.
+
+@data = global [4 x i64] [i64 1, i64 2, i64 3, i64 4], align 8
+@bss = global [64 x i64] zeroinitializer, align 8
+@str = unnamed_addr constant [6 x i8] c"hello\00", align 1
+
+define i64 @add(i64 %a, i64 %b) {
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+define i64 @sub(i64 %a, i64 %b) {
+  %r = sub i64 %a, %b
+  ret i64 %r
+}
@@ -0,0 +1,44 @@
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -mattr=+zicbop | FileCheck %s
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I | FileCheck %s --check-prefix=NOEXT
+
+declare void @llvm.prefetch(i8*, i32, i32, i32)
+
+; CHECK-LABEL: prefetch_hints:
+; CHECK: prefetch.r 0(x10)
+; CHECK: prefetch.w 64(x10)
+; CHECK: addi [[REG:x[0-9]+]], x10, 65
+; CHECK: prefetch.i 0([[REG]])
+; NOEXT-LABEL: prefetch_hints:
+; NOEXT-NOT: prefetch.{{[irw]}}
+define void @prefetch_hints(i8* %p) {
+  call void @llvm.prefetch(i8* %p, i32 0, i32 3, i32 1)
+  %q = getelementptr i8, i8* %p, i64 64
+  call void @llvm.prefetch(i8* %q, i32 1, i32 3, i32 1)
+  %r = getelementptr i8, i8* %p, i64 65
+  call void @llvm.prefetch(i8* %r, i32 0, i32 3, i32 0)
+  ret void
+}
+
+; Loop data prefetching inserts a read prefetch ahead of the strided load.
+; CHECK-LABEL: sum:
+; CHECK: LBB1_1:
+; CHECK: addi [[PF:x[0-9]+]], x10, {{[0-9]+}}
+; CHECK-NEXT: prefetch.r 0([[PF]])
+; CHECK-NEXT: ld
+; NOEXT-LABEL: sum:
+; NOEXT-NOT: prefetch.{{[irw]}}
+define i64 @sum(i64* %a, i64 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i64 [0, %entry], [%i.next, %loop]
+  %s = phi i64 [0, %entry], [%s.next, %loop]
+  %p = getelementptr i64, i64* %a, i64 %i
+  %v = load i64, i64* %p
+  %s.next = add i64 %s, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %loop, label %exit
+exit:
+  ret i64 %s.next
+}
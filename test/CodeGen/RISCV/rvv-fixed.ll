@@ -0,0 +1,83 @@
+; RUN: llc -march=riscv64 -mcpu=RV64I -mattr=+v < %s | FileCheck %s
+
+; CHECK-LABEL: add:
+; CHECK: vsetivli x0, 4, e32, m1, ta, ma
+; CHECK-NEXT: vle32.v v1, 0(x11)
+; CHECK-NEXT: vle32.v v2, 0(x10)
+; CHECK-NEXT: vadd.vv v2, v2, v1
+; CHECK-NEXT: vmul.vv v1, v2, v1
+; CHECK-NEXT: vse32.v v1, 0(x12)
+; CHECK-NEXT: ret
+define void @add(<4 x i32>* %a, <4 x i32>* %b, <4 x i32>* %c) {
+  %x = load <4 x i32>, <4 x i32>* %a, align 4
+  %y = load <4 x i32>, <4 x i32>* %b, align 4
+  %s = add <4 x i32> %x, %y
+  %m = mul <4 x i32> %s, %y
+  store <4 x i32> %m, <4 x i32>* %c, align 4
+  ret void
+}
+
+; The configuration only changes once.
+; CHECK-LABEL: mixed:
+; CHECK: vsetivli x0, 4, e32, m1, ta, ma
+; CHECK-NOT: vsetivli
+; CHECK: vse32.v
+; CHECK-NEXT: vsetivli x0, 8, e16, m1, ta, ma
+; CHECK-NOT: vsetivli
+; CHECK: vse16.v
+define void @mixed(<4 x i32>* %a, <8 x i16>* %b) {
+  %x = load <4 x i32>, <4 x i32>* %a
+  %y = load <8 x i16>, <8 x i16>* %b
+  %s = add <4 x i32> %x, %x
+  %t = sub <8 x i16> %y, %y
+  store <4 x i32> %s, <4 x i32>* %a
+  store <8 x i16> %t, <8 x i16>* %b
+  ret void
+}
+
+; CHECK-LABEL: reduce:
+; CHECK: vle32.v v1, 0(x10)
+; CHECK-NEXT: vmv.s.x v2, x0
+; CHECK-NEXT: vredsum.vs v1, v1, v2
+; CHECK-NEXT: vmv.x.s x10, v1
+define i32 @reduce(<4 x i32>* %a) {
+  %v = load <4 x i32>, <4 x i32>* %a
+  %rdx.shuf = shufflevector <4 x i32> %v, <4 x i32> undef, <4 x i32> <i32 2, i32 3, i32 undef, i32 undef>
+  %bin.rdx = add <4 x i32> %v, %rdx.shuf
+  %rdx.shuf1 = shufflevector <4 x i32> %bin.rdx, <4 x i32> undef, <4 x i32> <i32 1, i32 undef, i32 undef, i32 undef>
+  %bin.rdx2 = add <4 x i32> %bin.rdx, %rdx.shuf1
+  %r = extractelement <4 x i32> %bin.rdx2, i32 0
+  ret i32 %r
+}
+
+; CHECK-LABEL: splat:
+; CHECK: vsetivli x0, 2, e64, m1, ta, ma
+; CHECK-NEXT: vmv.v.x v1, x11
+define void @splat(<2 x i64>* %a, i64 %x) {
+  %i = insertelement <2 x i64> undef, i64 %x, i32 0
+  %s = shufflevector <2 x i64> %i, <2 x i64> undef, <2 x i32> zeroinitializer
+  %v = load <2 x i64>, <2 x i64>* %a
+  %r = add <2 x i64> %v, %s
+  store <2 x i64> %r, <2 x i64>* %a
+  ret void
+}
+
+; Vector arguments and results are passed in v8 and up.
+; CHECK-LABEL: fargs:
+; CHECK: vfadd.vv v1, v8, v9
+; CHECK-NEXT: vfmul.vv v8, v1, v9
+define <4 x float> @fargs(<4 x float> %a, <4 x float> %b) {
+  %r = fadd <4 x float> %a, %b
+  %m = fmul <4 x float> %r, %b
+  ret <4 x float> %m
+}
+
+; CHECK-LABEL: bc:
+; CHECK: vsetivli x0, 4, e32, m1, ta, ma
+; CHECK-NEXT: vadd.vv v8, v8, v8
+; CHECK-NEXT: ret
+define <4 x i32> @bc(<2 x i64> %a) {
+  %r = bitcast <2 x i64> %a to <4 x i32>
+  %s = add <4 x i32> %r, %r
+  ret <4 x i32> %s
+}
@@ -0,0 +1,22 @@
+; RUN: llc -march=riscv64 -mcpu=RV64I -mattr=+save-restore -show-mc-encoding < %s | FileCheck %s
+; RUN: llc -march=riscv64 -mcpu=RV64I -mattr=+save-restore -filetype=obj < %s \
+; RUN:   | llvm-readobj -r | FileCheck %s -check-prefix=RELOC
+
+; The save routine is called with its return address in t0 (x5), so rd of
+; the jal must be 5.  The tail call into the restore routine links nothing.
+
+; CHECK-LABEL: indirect:
+; CHECK: jal t0, __riscv_save_0 # encoding: [0xef,0bAAAA0010,A,A]
+; CHECK-NEXT: fixup A - offset: 0, value: __riscv_save_0, kind: fixup_riscv_jal
+; CHECK: jalr x1, x10, 0
+; CHECK-NEXT: j __riscv_restore_0 # encoding: [0x6f,0bAAAA0000,A,A]
+; CHECK-NEXT: fixup A - offset: 0, value: __riscv_restore_0, kind: fixup_riscv_jal
+
+; RELOC: Section ({{[0-9]+}}) .rela.text {
+; RELOC-NEXT: 0x0 R_RISCV_JAL __riscv_save_0 0x0
+; RELOC-NEXT: 0x8 R_RISCV_JAL __riscv_restore_0 0x0
+; RELOC-NEXT: }
+define void @indirect(void ()* %f) {
+  call void %f()
+  ret void
+}
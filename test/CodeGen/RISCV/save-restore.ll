@@ -0,0 +1,56 @@
+; RUN: llc -march=riscv64 -mcpu=RV64I -mattr=+save-restore < %s | FileCheck %s
+; RUN: llc -march=riscv64 -mcpu=RV64I < %s | FileCheck %s -check-prefix=MINSIZE
+
+declare void @v()
+
+; CHECK-LABEL: ra_only:
+; CHECK: jal t0, __riscv_save_0
+; CHECK-NEXT: Ltmp{{[0-9]+}}:
+; CHECK-NEXT: .cfi_def_cfa_offset 16
+; CHECK-NOT: addi x2, x2
+; CHECK: j __riscv_restore_0
+; MINSIZE-LABEL: ra_only:
+; MINSIZE: sd x1, 8(x2)
+; MINSIZE-NOT: __riscv_save
+; MINSIZE: ret
+define void @ra_only() {
+  call void @v()
+  ret void
+}
+
+; CHECK-LABEL: callee_saved:
+; CHECK: jal t0, __riscv_save_2
+; CHECK: .cfi_def_cfa_offset 32
+; CHECK: .cfi_offset x9, -24
+; CHECK: addi x2, x2, -128
+; CHECK: .cfi_def_cfa_offset 160
+; CHECK: addi x2, x2, 128
+; CHECK-NEXT: j __riscv_restore_2
+; MINSIZE-LABEL: callee_saved:
+; MINSIZE: jal t0, __riscv_save_2
+; MINSIZE: j __riscv_restore_2
+define void @callee_saved() minsize {
+  %a = alloca [16 x i64]
+  %p = getelementptr [16 x i64], [16 x i64]* %a, i64 0, i64 3
+  store volatile i64 1, i64* %p
+  call void asm sideeffect "", "~{x9}"()
+  call void @v()
+  ret void
+}
+
+; The routines themselves are emitted once per used entry point.
+; CHECK: .section .text.__riscv_restore_0,"axG",@progbits,__riscv_restore_0,comdat
+; CHECK: .weak __riscv_restore_0
+; CHECK: .hidden __riscv_restore_0
+; CHECK: __riscv_restore_2:
+; CHECK-NEXT: ld x1, 24(x2)
+; CHECK-NEXT: ld x8, 16(x2)
+; CHECK-NEXT: ld x9, 8(x2)
+; CHECK-NEXT: addi x2, x2, 32
+; CHECK-NEXT: ret
+; CHECK: __riscv_save_2:
+; CHECK-NEXT: addi x2, x2, -32
+; CHECK-NEXT: sd x1, 24(x2)
+; CHECK-NEXT: sd x8, 16(x2)
+; CHECK-NEXT: sd x9, 8(x2)
+; CHECK-NEXT: jalr x0, x5, 0
@@ -0,0 +1,27 @@
+; RUN: llc < %s -march=riscv64 -mcpu=RV64I -time-trace \
+; RUN:   -time-trace-granularity=0 -time-trace-file=%t.json -o /dev/null
+; RUN: FileCheck %s < %t.json
+
+; -time-trace writes a begin/end section for parsing, for code generation,
+; and for every pass on every function, in Chrome trace event format.
+
+; CHECK: "traceEvents":[
+; CHECK-DAG: "name":"ParseIR"
+; CHECK-DAG: "name":"CodeGen"
+; CHECK-DAG: "name":"RunFunction","ts":{{[0-9]+}},"dur":{{[0-9]+}},"args":{"detail":"f"}
+; CHECK-DAG: "name":"RunFunction","ts":{{[0-9]+}},"dur":{{[0-9]+}},"args":{"detail":"g"}
+; CHECK-DAG: "name":"RunPass","ts":{{[0-9]+}},"dur":{{[0-9]+}},"args":{"detail":"RISCV Branch Selector"}
+; CHECK-DAG: "name":"RunModulePass","ts":{{[0-9]+}},"dur":{{[0-9]+}},"args":{"detail":"Function Pass Manager"}
+; CHECK-DAG: "name":"Total RunPass","ts":0,"dur":{{[0-9]+}},"args":{"count":{{[0-9]+}},"avg ms":
+; CHECK-DAG: "ph":"M","name":"process_name","args":{"name":"llc"}
+; CHECK: "beginningOfTime":{{[0-9]+}}
+
+define i64 @f(i64 %a, i64 %b) {
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+define i64 @g(i64 %a) {
+  %r = call i64 @f(i64 %a, i64 1)
+  ret i64 %r
+}
@@ -0,0 +1,107 @@
+; RUN: llc -march=riscv64 -mcpu=RV64I -show-mc-encoding < %s | FileCheck %s
+
+; The entry and exit sleds are a jump over 16 nops, 68 bytes in all.
+
+; CHECK-LABEL: foo:
+; CHECK: Lxray_sled_0:
+; CHECK-NEXT: j 68 # encoding: [0x67,0x44,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addiw x10, x10, 1
+; CHECK-NEXT: Lxray_sled_1:
+; CHECK-NEXT: j 68 # encoding: [0x67,0x44,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: addi x0, x0, 0 # encoding: [0x13,0x00,0x00,0x00]
+; CHECK-NEXT: ret
+define i32 @foo(i32 %a) "function-instrument"="xray-always" {
+  %b = add i32 %a, 1
+  ret i32 %b
+}
+
+; CHECK: .section xray_instr_map,"aGM",@progbits,foo,comdat
+; CHECK-NEXT: .quad Lxray_sled_0
+; CHECK-NEXT: .quad foo
+; CHECK-NEXT: .byte 0
+; CHECK-NEXT: .byte 1
+; CHECK-NEXT: .space 14
+; CHECK-NEXT: .quad Lxray_sled_1
+; CHECK-NEXT: .quad foo
+; CHECK-NEXT: .byte 1
+; CHECK-NEXT: .byte 1
+; CHECK-NEXT: .space 14
+
+; Every return gets an exit sled; functions instrumented because of their size
+; are not marked always-instrument.
+; CHECK-LABEL: bar:
+; CHECK: Lxray_sled_2:
+; CHECK: Lxray_sled_3:
+; CHECK-NEXT: j 68
+; CHECK: ret
+; CHECK: Lxray_sled_4:
+; CHECK-NEXT: j 68
+; CHECK: ret
+; CHECK: .section xray_instr_map,"aGM",@progbits,bar,comdat
+; CHECK-NEXT: .quad Lxray_sled_2
+; CHECK-NEXT: .quad bar
+; CHECK-NEXT: .byte 0
+; CHECK-NEXT: .byte 0
+define i64 @bar(i64 %a, i64 %b) "xray-instruction-threshold"="1" {
+  %c = icmp slt i64 %a, %b
+  br i1 %c, label %t, label %f
+t:
+  ret i64 %a
+f:
+  ret i64 %b
+}
+
+; The tail call into the callee-saved register restore routine returns too,
+; so it gets an exit sled as well.
+; CHECK-LABEL: libcall:
+; CHECK: Lxray_sled_5:
+; CHECK-NEXT: j 68
+; CHECK: jal t0, __riscv_save_0
+; CHECK: Lxray_sled_6:
+; CHECK-NEXT: j 68
+; CHECK: j __riscv_restore_0
+; CHECK: .section xray_instr_map,"aGM",@progbits,libcall,comdat
+; CHECK-NEXT: .quad Lxray_sled_5
+; CHECK-NEXT: .quad libcall
+; CHECK-NEXT: .byte 0
+; CHECK-NEXT: .byte 1
+; CHECK-NEXT: .space 14
+; CHECK-NEXT: .quad Lxray_sled_6
+; CHECK-NEXT: .quad libcall
+; CHECK-NEXT: .byte 1
+; CHECK-NEXT: .byte 1
+define void @libcall(void ()* %f) "function-instrument"="xray-always" "target-features"="+save-restore" {
+  call void %f()
+  ret void
+}
@@ -0,0 +1,11 @@
+# RUN: not llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV64I -mattr=+zicbop 2>&1 | FileCheck %s
+# RUN: not llvm-mc %s -triple=riscv-unknown-linux -mcpu=RV64I 2>&1 | FileCheck %s --check-prefix=NOEXT
+
+# The offset must be a multiple of 32 that fits in 12 bits.
+# CHECK: error: invalid operand for instruction
+	prefetch.r	65(x10)
+# CHECK: error: invalid operand for instruction
+	prefetch.w	2048(x10)
+
+# NOEXT: error: invalid operand for instruction
+	prefetch.i	0(x10)
@@ -0,0 +1,13 @@
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -show-encoding -mcpu=RV32I -mattr=+zicbop | FileCheck %s
+# RUN: llvm-mc %s -triple=riscv-unknown-linux -show-encoding -mcpu=RV64I -mattr=+zicbop | FileCheck %s
+
+# CHECK: prefetch.i	0(x2)           # encoding: [0x13,0x60,0x01,0x00]
+	prefetch.i	0(x2)
+# CHECK: prefetch.r	64(x10)         # encoding: [0x13,0x60,0x15,0x04]
+	prefetch.r	64(x10)
+# CHECK: prefetch.w	-32(x11)        # encoding: [0x13,0xe0,0x35,0xfe]
+	prefetch.w	-32(x11)
+# CHECK: prefetch.r	2016(x5)        # encoding: [0x13,0xe0,0x12,0x7e]
+	prefetch.r	2016(x5)
+# CHECK: prefetch.w	-2048(x6)       # encoding: [0x13,0x60,0x33,0x80]
+	prefetch.w	-2048(x6)
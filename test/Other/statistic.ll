@@ -5,7 +5,12 @@
 ; REQUIRES: asserts
 
 ; JSON: {
-; JSON:   "instsimplify.NumSimplified": 1
+; JSON:   "instsimplify.NumSimplified": 1,
+; JSON:   "modules": {
+; JSON:     "<stdin>": {
+; JSON:       "instsimplify.NumSimplified": 1
+; JSON:     }
+; JSON:   }
 ; JSON: }
 
 ; DEFAULT: 1 instsimplify - Number of redundant instructions removed
@@ -0,0 +1,5 @@
+# RUN: not llvm-mca -triple=riscv64-unknown-linux -mcpu=RV64I %s 2>&1 | FileCheck %s
+
+# CHECK: error: the selected CPU has no scheduling model
+
+add x10, x10, x11
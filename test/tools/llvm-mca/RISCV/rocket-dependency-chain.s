@@ -0,0 +1,42 @@
+# RUN: llvm-mca -triple=riscv64-unknown-linux -mcpu=Rocket -iterations=100 %s | FileCheck %s
+
+# Rocket is in-order, so the load waits behind the multiply that produces
+# its address and the whole block serializes.
+
+add x10, x10, x11
+mul x12, x10, x10
+ld x13, 0(x12)
+addi x11, x11, 1
+
+# CHECK:      Iterations:        100
+# CHECK-NEXT: Instructions:      400
+# CHECK-NEXT: Total Cycles:      701
+# CHECK-NEXT: Total uOps:        400
+# CHECK-NEXT: Dispatch Width:    1
+# CHECK-NEXT: Cycles/Iteration:  7.01
+
+# CHECK:      Bounds per iteration:
+# CHECK-NEXT:   Dispatch:        4.00
+# CHECK-NEXT:   Resources:       2.00
+# CHECK-NEXT:   Dependencies:    1.00
+
+# CHECK:      [1]    [2]    [3]    Instructions:
+# CHECK-NEXT: 1      1      1.00   add	x10, x10, x11
+# CHECK-NEXT: 1      4      1.00   mul	x12, x10, x10
+# CHECK-NEXT: 1      3      1.00   ld	x13, 0(x12)
+# CHECK-NEXT: 1      1      1.00   addi	x11, x11, 1
+
+# CHECK:      Resource pressure per iteration:
+# CHECK-NEXT: [0] 2.00   {{.*}}
+# CHECK-NEXT: [1] 0.00   {{.*}}
+# CHECK-NEXT: [2] 0.00   {{.*}}
+# CHECK-NEXT: [3] 0.00   {{.*}}
+# CHECK-NEXT: [4] 0.00   {{.*}}
+# CHECK-NEXT: [5] 1.00   {{.*}}
+# CHECK-NEXT: [6] 1.00   {{.*}}
+
+# CHECK:      Critical dependency chain (8 cycles):
+# CHECK-NEXT:  [0] 1     add	x10, x10, x11
+# CHECK-NEXT:  [1] 4     mul	x12, x10, x10
+# CHECK-NEXT:  [2] 3     ld	x13, 0(x12)
+# CHECK-NEXT:  Loop-carried: depends on [3] of the previous iteration.
@@ -0,0 +1,22 @@
+# RUN: llvm-mca -triple=riscv64-unknown-linux -mcpu=Rocket -iterations=10 %s | FileCheck %s
+
+# The divider is not pipelined, so independent divisions are bound by it
+# rather than by their dependencies.
+
+divw x10, x11, x12
+divw x13, x11, x12
+
+# CHECK:      Cycles/Iteration:  68.00
+
+# CHECK:      Bounds per iteration:
+# CHECK-NEXT:   Dispatch:        2.00
+# CHECK-NEXT:   Resources:       68.00
+# CHECK-NEXT:   Dependencies:    0.00
+
+# CHECK:      1      34     34.00  divw	x10, x11, x12
+# CHECK-NEXT: 1      34     34.00  divw	x13, x11, x12
+
+# CHECK:      [4] 68.00  {{.*}}
+
+# CHECK:      Critical dependency chain (34 cycles):
+# CHECK-NEXT:  [0] 34    divw	x10, x11, x12
@@ -37,6 +37,7 @@
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/Host.h"
@@ -47,6 +48,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
@@ -118,6 +120,29 @@ static cl::opt<bool> DiscardValueNames(
     cl::desc("Discard names from Value (other than GlobalValue)."),
     cl::init(false), cl::Hidden);
 
+static cl::opt<unsigned> MapOutputThreshold(
+    "map-output-threshold",
+    cl::desc("Write object files of at least this many bytes directly into a "
+             "mapped output file"),
+    cl::init(1 << 20), cl::Hidden);
+
+static cl::opt<bool> TimeTrace(
+    "time-trace",
+    cl::desc("Record the time of each pass on each function in Chrome trace "
+             "event format"));
+
+static cl::opt<unsigned> TimeTraceGranularity(
+    "time-trace-granularity",
+    cl::desc("Minimum duration, in microseconds, of the sections written "
+             "by -time-trace"),
+    cl::init(500), cl::Hidden);
+
+static cl::opt<std::string>
+    TimeTraceFile("time-trace-file",
+                  cl::desc("Write the -time-trace output to this file instead "
+                           "of <output>.time-trace"),
+                  cl::value_desc("filename"));
+
 namespace {
 static ManagedStatic<std::vector<std::string>> RunPassNames;
 
@@ -142,9 +167,7 @@ static cl::opt<RunPassOption, true, cl::parser<std::string>> RunPass(
 
 static int compileModule(char **, LLVMContext &);
 
-static std::unique_ptr<tool_output_file>
-GetOutputStream(const char *TargetName, Triple::OSType OS,
-                const char *ProgName) {
+static void SetOutputFilename(const char *TargetName, Triple::OSType OS) {
   // If we don't yet have an output filename, make one.
   if (OutputFilename.empty()) {
     if (InputFilename == "-")
@@ -183,7 +206,9 @@ GetOutputStream(const char *TargetName, Triple::OSType OS,
       }
     }
   }
+}
 
+static std::unique_ptr<tool_output_file> GetOutputStream() {
   // Decide if we need "binary" output.
   bool Binary = false;
   switch (FileType) {
@@ -255,6 +280,9 @@ int main(int argc, char **argv) {
 
   Context.setDiscardValueNames(DiscardValueNames);
 
+  if (TimeTrace)
+    timeTraceProfilerInitialize(TimeTraceGranularity, argv[0]);
+
   // Set a diagnostic handler that doesn't exit on the first error
   bool HasError = false;
   Context.setDiagnosticHandler(DiagnosticHandler, &HasError);
@@ -264,6 +292,18 @@ int main(int argc, char **argv) {
   for (unsigned I = TimeCompilations; I; --I)
     if (int RetVal = compileModule(argv, Context))
       return RetVal;
+
+  if (TimeTrace) {
+    // Name the trace after the input when the output goes to stdout.
+    StringRef TraceBase = OutputFilename == "-" ? InputFilename
+                                                : OutputFilename;
+    if (std::error_code EC = timeTraceProfilerWrite(TimeTraceFile, TraceBase)) {
+      errs() << argv[0] << ": could not write the time trace: " << EC.message()
+             << '\n';
+      return 1;
+    }
+    timeTraceProfilerCleanup();
+  }
   return 0;
 }
 
@@ -383,10 +423,21 @@ static int compileModule(char **argv, LLVMContext &Context) {
   if (FloatABIForCalls != FloatABI::Default)
     Options.FloatABIType = FloatABIForCalls;
 
-  // Figure out where we are going to send the output.
-  std::unique_ptr<tool_output_file> Out =
-      GetOutputStream(TheTarget->getName(), TheTriple.getOS(), argv[0]);
-  if (!Out) return 1;
+  // Figure out where we are going to send the output. Object files written
+  // to a named file are laid out in memory and only written once complete,
+  // with the section contents produced directly in the output. That stream
+  // creates the file itself.
+  SetOutputFilename(TheTarget->getName(), TheTriple.getOS());
+  std::unique_ptr<raw_output_buffer_ostream> MOS;
+  std::unique_ptr<tool_output_file> Out;
+  if (FileType == TargetMachine::CGFT_ObjectFile && !CompileTwice &&
+      OutputFilename != "-") {
+    MOS = make_unique<raw_output_buffer_ostream>(OutputFilename,
+                                                 MapOutputThreshold);
+  } else {
+    Out = GetOutputStream();
+    if (!Out) return 1;
+  }
 
   // Build up all of the passes that we want to do to the module.
   legacy::PassManager PM;
@@ -412,15 +463,16 @@ static int compileModule(char **argv, LLVMContext &Context) {
              << ": warning: ignoring -mc-relax-all because filetype != obj";
 
   {
-    raw_pwrite_stream *OS = &Out->os();
+    raw_pwrite_stream *OS = MOS ? static_cast<raw_pwrite_stream *>(MOS.get())
+                                : &Out->os();
 
     // Manually do the buffering rather than using buffer_ostream,
     // so we can memcmp the contents in CompileTwice mode
     SmallVector<char, 0> Buffer;
     std::unique_ptr<raw_svector_ostream> BOS;
-    if ((FileType != TargetMachine::CGFT_AssemblyFile &&
-         !Out->os().supportsSeeking()) ||
-        CompileTwice) {
+    if (Out && ((FileType != TargetMachine::CGFT_AssemblyFile &&
+                 !Out->os().supportsSeeking()) ||
+                CompileTwice)) {
       BOS = make_unique<raw_svector_ostream>(Buffer);
       OS = BOS.get();
     }
@@ -494,7 +546,10 @@ static int compileModule(char **argv, LLVMContext &Context) {
       Buffer.clear();
     }
 
-    PM.run(*M);
+    {
+      TimeTraceScope TimeScope("CodeGen", M->getModuleIdentifier());
+      PM.run(*M);
+    }
 
     auto HasError = *static_cast<bool *>(Context.getDiagnosticContext());
     if (HasError)
@@ -519,10 +574,19 @@ static int compileModule(char **argv, LLVMContext &Context) {
     if (BOS) {
       Out->os() << Buffer;
     }
+
+    if (MOS) {
+      if (std::error_code EC = MOS->commit()) {
+        errs() << argv[0] << ": " << OutputFilename << ": " << EC.message()
+               << '\n';
+        return 1;
+      }
+    }
   }
 
   // Declare success.
-  Out->keep();
+  if (Out)
+    Out->keep();
 
   return 0;
 }
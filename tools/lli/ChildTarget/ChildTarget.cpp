@@ -13,6 +13,8 @@ using namespace llvm::sys;
 
 #ifdef __x86_64__
 typedef OrcX86_64_SysV HostOrcArch;
+#elif defined(__riscv) && __riscv_xlen == 64
+typedef OrcRISCV64 HostOrcArch;
 #else
 typedef OrcGenericABI HostOrcArch;
 #endif
@@ -20,6 +20,7 @@
 #include "llvm/Object/RelocVisitor.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -90,8 +91,13 @@ static void DumpObjectFile(ObjectFile &Obj, Twine Filename) {
 }
 
 static void DumpInput(StringRef Filename) {
+  // All of the debug info sections are going to be read, in no particular
+  // order: start reading the whole file in right away.
   ErrorOr<std::unique_ptr<MemoryBuffer>> BuffOrErr =
-      MemoryBuffer::getFileOrSTDIN(Filename);
+      MemoryBuffer::getFileOrSTDIN(
+          Filename,
+          MemoryBuffer::FileHints(sys::fs::mapped_file_region::huge_pages,
+                                  uint64_t(-1)));
   error(Filename, BuffOrErr.getError());
   std::unique_ptr<MemoryBuffer> Buff = std::move(BuffOrErr.get());
 
@@ -114,8 +114,14 @@ static std::unique_ptr<Module> loadFile(const char *argv0,
                                         bool MaterializeMetadata = true) {
   SMDiagnostic Err;
   if (Verbose) errs() << "Loading '" << FN << "'\n";
+  // A module that is linked in is read in full, but in the order its
+  // functions are materialized: have the whole file read in while mapping
+  // it. Only a few functions are imported from the other modules.
+  MemoryBuffer::FileHints Hints(
+      MaterializeMetadata ? sys::fs::mapped_file_region::populate
+                          : sys::fs::mapped_file_region::random);
   std::unique_ptr<Module> Result =
-      getLazyIRFileModule(FN, Err, Context, !MaterializeMetadata);
+      getLazyIRFileModule(FN, Err, Context, Hints, !MaterializeMetadata);
   if (!Result) {
     Err.print(argv0, errs());
     return nullptr;
@@ -0,0 +1,554 @@
+//===-- llvm-mca.cpp - Machine Code Analyzer --------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This utility statically estimates the throughput of a block of assembly
+// code on a given CPU.  The block is treated as the body of a loop and run
+// for a number of iterations through a simple simulation of the subtarget's
+// machine model (MCSchedModel): instructions dispatch at most IssueWidth
+// micro-ops per cycle, wait for their register operands and for a free unit
+// of each processor resource they consume.
+//
+// The report gives the cycles per iteration, the pressure on each processor
+// resource and the critical chain of register dependencies.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCParser/MCTargetAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSchedule.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetOptionsCommandFlags.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include <algorithm>
+
+using namespace llvm;
+
+static cl::opt<std::string>
+InputFilename(cl::Positional, cl::desc("<input file>"), cl::init("-"));
+
+static cl::opt<std::string>
+OutputFilename("o", cl::desc("Output filename"), cl::value_desc("filename"),
+               cl::init("-"));
+
+static cl::opt<std::string>
+TripleName("triple", cl::desc("Target triple to analyze for, "
+                              "see -version for available targets"));
+
+static cl::opt<std::string>
+MCPU("mcpu",
+     cl::desc("Target a specific cpu type (-mcpu=help for details)"),
+     cl::value_desc("cpu-name"),
+     cl::init(""));
+
+static cl::list<std::string>
+MAttrs("mattr",
+  cl::CommaSeparated,
+  cl::desc("Target specific attributes (-mattr=help for details)"),
+  cl::value_desc("a1,+a2,-a3,..."));
+
+static cl::opt<unsigned>
+Iterations("iterations", cl::desc("Number of iterations to simulate"),
+           cl::init(100));
+
+namespace {
+
+/// Collect the instructions produced by the assembly parser.
+class InstCollector : public MCStreamer {
+  std::vector<MCInst> &Insts;
+
+public:
+  InstCollector(MCContext &Ctx, std::vector<MCInst> &Insts)
+      : MCStreamer(Ctx), Insts(Insts) {}
+
+  void EmitInstruction(const MCInst &Inst,
+                       const MCSubtargetInfo &STI) override {
+    Insts.push_back(Inst);
+  }
+
+  bool EmitSymbolAttribute(MCSymbol *Symbol,
+                           MCSymbolAttr Attribute) override {
+    return true;
+  }
+  void EmitCommonSymbol(MCSymbol *Symbol, uint64_t Size,
+                        unsigned ByteAlignment) override {}
+  void EmitZerofill(MCSection *Section, MCSymbol *Symbol = nullptr,
+                    uint64_t Size = 0, unsigned ByteAlignment = 0) override {}
+};
+
+/// The static scheduling properties of one instruction of the block.
+struct InstrInfo {
+  const MCSchedClassDesc *SCDesc; // Null if the model has no information.
+  unsigned NumMicroOps;
+  unsigned Latency;
+  double RThroughput;
+  SmallVector<unsigned, 4> DefUnits; // Register units written.
+  SmallVector<unsigned, 4> UseUnits; // Register units read.
+};
+
+// The index of a dynamic instruction, i.e. Iteration * Insts.size() + Idx.
+typedef uint64_t DynIdx;
+const DynIdx NoProducer = ~DynIdx(0);
+
+/// Simulate a block of instructions against a machine model.
+class BlockAnalysis {
+  const MCSubtargetInfo &STI;
+  const MCSchedModel &SM;
+  const MCRegisterInfo &MRI;
+  const MCInstrInfo &MCII;
+  const std::vector<MCInst> &Insts;
+  std::vector<InstrInfo> Infos;
+
+  void computeInstrInfo(const MCInst &Inst, InstrInfo &Info);
+
+public:
+  BlockAnalysis(const MCSubtargetInfo &STI, const MCRegisterInfo &MRI,
+                const MCInstrInfo &MCII, const std::vector<MCInst> &Insts)
+      : STI(STI), SM(STI.getSchedModel()), MRI(MRI), MCII(MCII),
+        Insts(Insts) {}
+
+  /// Compute the static properties of each instruction. Return false if
+  /// the machine model cannot describe one of them.
+  bool initialize(raw_ostream &ErrOS);
+
+  /// Simulate Iterations runs of the block with resource and issue width
+  /// constraints. Return the cycle the last instruction completes in.
+  uint64_t simulate(unsigned Iterations) const;
+
+  /// Simulate Iterations runs of the block limited by register dependencies
+  /// only. Fill in the completion cycle and the critical producer of each
+  /// dynamic instruction.
+  void simulateDependencies(unsigned Iterations,
+                            std::vector<uint64_t> &Complete,
+                            std::vector<DynIdx> &Producer) const;
+
+  void printReport(raw_ostream &OS, MCInstPrinter &IP, unsigned Iterations);
+};
+
+} // end anonymous namespace
+
+void BlockAnalysis::computeInstrInfo(const MCInst &Inst, InstrInfo &Info) {
+  const MCInstrDesc &MCID = MCII.get(Inst.getOpcode());
+
+  // Explicit defs come first, followed by explicit uses.
+  for (unsigned I = 0, E = Inst.getNumOperands(); I != E; ++I) {
+    const MCOperand &MO = Inst.getOperand(I);
+    if (!MO.isReg() || !MO.getReg())
+      continue;
+    SmallVectorImpl<unsigned> &Units =
+        I < MCID.getNumDefs() ? Info.DefUnits : Info.UseUnits;
+    for (MCRegUnitIterator Unit(MO.getReg(), &MRI); Unit.isValid(); ++Unit)
+      Units.push_back(*Unit);
+  }
+  for (unsigned I = 0, E = MCID.getNumImplicitDefs(); I != E; ++I)
+    for (MCRegUnitIterator Unit(MCID.getImplicitDefs()[I], &MRI);
+         Unit.isValid(); ++Unit)
+      Info.DefUnits.push_back(*Unit);
+  for (unsigned I = 0, E = MCID.getNumImplicitUses(); I != E; ++I)
+    for (MCRegUnitIterator Unit(MCID.getImplicitUses()[I], &MRI);
+         Unit.isValid(); ++Unit)
+      Info.UseUnits.push_back(*Unit);
+
+  const MCSchedClassDesc *SCDesc =
+      SM.getSchedClassDesc(MCID.getSchedClass());
+  if (!SCDesc->isValid()) {
+    // Assume a single cycle, single micro-op instruction.
+    Info.SCDesc = nullptr;
+    Info.NumMicroOps = 1;
+    Info.Latency = 1;
+    Info.RThroughput = 1.0 / SM.IssueWidth;
+    return;
+  }
+  Info.SCDesc = SCDesc;
+  Info.NumMicroOps = SCDesc->NumMicroOps;
+  Info.Latency = MCSchedModel::computeInstrLatency(STI, *SCDesc);
+  Info.RThroughput = MCSchedModel::getReciprocalThroughput(STI, *SCDesc);
+}
+
+bool BlockAnalysis::initialize(raw_ostream &ErrOS) {
+  if (!SM.hasInstrSchedModel()) {
+    ErrOS << "error: the selected CPU has no scheduling model\n";
+    return false;
+  }
+
+  Infos.resize(Insts.size());
+  for (unsigned I = 0, E = Insts.size(); I != E; ++I) {
+    const MCInst &Inst = Insts[I];
+    unsigned SchedClass = MCII.get(Inst.getOpcode()).getSchedClass();
+    if (SM.getSchedClassDesc(SchedClass)->isVariant()) {
+      ErrOS << "error: unable to resolve the variant scheduling class of '"
+            << MCII.getName(Inst.getOpcode()) << "'\n";
+      return false;
+    }
+    computeInstrInfo(Inst, Infos[I]);
+    if (!Infos[I].SCDesc)
+      ErrOS << "warning: no scheduling information for '"
+            << MCII.getName(Inst.getOpcode())
+            << "', assuming a latency of 1\n";
+  }
+  return true;
+}
+
+uint64_t BlockAnalysis::simulate(unsigned Iterations) const {
+  // The cycle at which each register unit becomes available.
+  std::vector<uint64_t> RegReady(MRI.getNumRegUnits(), 0);
+  // The cycle at which each unit of each processor resource becomes free.
+  std::vector<SmallVector<uint64_t, 2>> ResourceFree(
+      SM.getNumProcResourceKinds());
+  for (unsigned I = 1, E = SM.getNumProcResourceKinds(); I != E; ++I)
+    ResourceFree[I].resize(SM.getProcResource(I)->NumUnits, 0);
+
+  // In-order machines issue in program order; out-of-order machines only
+  // dispatch in program order.
+  bool InOrder = !SM.isOutOfOrder();
+  uint64_t DispatchCycle = 0;
+  unsigned DispatchedMicroOps = 0;
+  uint64_t LastComplete = 0;
+
+  for (unsigned It = 0; It != Iterations; ++It) {
+    for (const InstrInfo &Info : Infos) {
+      // Dispatch at most IssueWidth micro-ops per cycle.
+      if (DispatchedMicroOps &&
+          DispatchedMicroOps + Info.NumMicroOps > SM.IssueWidth) {
+        ++DispatchCycle;
+        DispatchedMicroOps = 0;
+      }
+
+      uint64_t Cycle = DispatchCycle;
+      for (unsigned Unit : Info.UseUnits)
+        Cycle = std::max(Cycle, RegReady[Unit]);
+
+      // Find the first cycle in which every resource has a free unit.
+      SmallVector<unsigned, 4> UnitIdx;
+      for (;;) {
+        UnitIdx.clear();
+        uint64_t NextCycle = Cycle;
+        if (Info.SCDesc) {
+          for (const MCWriteProcResEntry *
+                   PRI = STI.getWriteProcResBegin(Info.SCDesc),
+                  *PRE = STI.getWriteProcResEnd(Info.SCDesc);
+               PRI != PRE; ++PRI) {
+            const SmallVectorImpl<uint64_t> &Units =
+                ResourceFree[PRI->ProcResourceIdx];
+            auto Best = std::min_element(Units.begin(), Units.end());
+            UnitIdx.push_back(Best - Units.begin());
+            NextCycle = std::max(NextCycle, *Best);
+          }
+        }
+        if (NextCycle == Cycle)
+          break;
+        Cycle = NextCycle;
+      }
+
+      if (Info.SCDesc) {
+        unsigned N = 0;
+        for (const MCWriteProcResEntry *
+                 PRI = STI.getWriteProcResBegin(Info.SCDesc),
+                *PRE = STI.getWriteProcResEnd(Info.SCDesc);
+             PRI != PRE; ++PRI, ++N)
+          ResourceFree[PRI->ProcResourceIdx][UnitIdx[N]] =
+              Cycle + PRI->Cycles;
+      }
+
+      uint64_t Complete = Cycle + Info.Latency;
+      for (unsigned Unit : Info.DefUnits)
+        RegReady[Unit] = Complete;
+      LastComplete = std::max(LastComplete, Complete);
+
+      if (InOrder && Cycle > DispatchCycle) {
+        // The stall holds back everything behind this instruction.
+        DispatchCycle = Cycle;
+        DispatchedMicroOps = 0;
+      }
+      DispatchedMicroOps += Info.NumMicroOps;
+    }
+  }
+  return LastComplete;
+}
+
+void BlockAnalysis::simulateDependencies(unsigned Iterations,
+                                         std::vector<uint64_t> &Complete,
+                                         std::vector<DynIdx> &Producer) const {
+  std::vector<uint64_t> RegReady(MRI.getNumRegUnits(), 0);
+  std::vector<DynIdx> RegProducer(MRI.getNumRegUnits(), NoProducer);
+  Complete.clear();
+  Producer.clear();
+
+  for (unsigned It = 0; It != Iterations; ++It) {
+    for (const InstrInfo &Info : Infos) {
+      uint64_t Ready = 0;
+      DynIdx Pred = NoProducer;
+      for (unsigned Unit : Info.UseUnits) {
+        if (RegProducer[Unit] != NoProducer && RegReady[Unit] >= Ready) {
+          Ready = RegReady[Unit];
+          Pred = RegProducer[Unit];
+        }
+      }
+      DynIdx Idx = Complete.size();
+      Complete.push_back(Ready + Info.Latency);
+      Producer.push_back(Pred);
+      for (unsigned Unit : Info.DefUnits) {
+        RegReady[Unit] = Complete.back();
+        RegProducer[Unit] = Idx;
+      }
+    }
+  }
+}
+
+static void printResourceName(raw_ostream &OS, const MCProcResourceDesc &Desc,
+                              unsigned Idx) {
+#ifndef NDEBUG
+  OS << Desc.Name;
+#else
+  OS << "Resource" << Idx;
+#endif
+}
+
+static void printInst(raw_ostream &OS, MCInstPrinter &IP, const MCInst &Inst,
+                      const MCSubtargetInfo &STI) {
+  std::string Str;
+  raw_string_ostream SS(Str);
+  IP.printInst(&Inst, SS, "", STI);
+  OS << StringRef(SS.str()).trim();
+}
+
+void BlockAnalysis::printReport(raw_ostream &OS, MCInstPrinter &IP,
+                                unsigned Iterations) {
+  unsigned NumInsts = Insts.size();
+  unsigned MicroOps = 0;
+  for (const InstrInfo &Info : Infos)
+    MicroOps += Info.NumMicroOps;
+
+  uint64_t TotalCycles = simulate(Iterations);
+
+  // Lower bounds on the cycles per iteration.
+  double DispatchBound = double(MicroOps) / SM.IssueWidth;
+  std::vector<double> Pressure(SM.getNumProcResourceKinds(), 0.0);
+  for (const InstrInfo &Info : Infos) {
+    if (!Info.SCDesc)
+      continue;
+    for (const MCWriteProcResEntry *PRI = STI.getWriteProcResBegin(Info.SCDesc),
+                                   *PRE = STI.getWriteProcResEnd(Info.SCDesc);
+         PRI != PRE; ++PRI)
+      Pressure[PRI->ProcResourceIdx] +=
+          double(PRI->Cycles) /
+          SM.getProcResource(PRI->ProcResourceIdx)->NumUnits;
+  }
+  double ResourceBound = 0.0;
+  for (double P : Pressure)
+    ResourceBound = std::max(ResourceBound, P);
+
+  // The dependency bound is the growth of the longest chain per iteration
+  // once loop-carried dependencies are taken into account.
+  unsigned DepIterations = std::max(Iterations, 2U);
+  std::vector<uint64_t> Complete;
+  std::vector<DynIdx> Producer;
+  simulateDependencies(DepIterations, Complete, Producer);
+  auto iterationEnd = [&](unsigned It) {
+    return *std::max_element(Complete.begin() + It * NumInsts,
+                             Complete.begin() + (It + 1) * NumInsts);
+  };
+  uint64_t LastEnd = iterationEnd(DepIterations - 1);
+  uint64_t DependencyBound = LastEnd - iterationEnd(DepIterations - 2);
+
+  OS << "Iterations:        " << Iterations << '\n';
+  OS << "Instructions:      " << uint64_t(NumInsts) * Iterations << '\n';
+  OS << "Total Cycles:      " << TotalCycles << '\n';
+  OS << "Total uOps:        " << uint64_t(MicroOps) * Iterations << '\n';
+  OS << "Dispatch Width:    " << SM.IssueWidth << '\n';
+  OS << "Cycles/Iteration:  "
+     << format("%.2f", double(TotalCycles) / Iterations) << '\n';
+  OS << '\n';
+
+  OS << "Bounds per iteration:\n";
+  OS << "  Dispatch:        " << format("%.2f", DispatchBound) << '\n';
+  OS << "  Resources:       " << format("%.2f", ResourceBound) << '\n';
+  OS << "  Dependencies:    " << format("%.2f", double(DependencyBound))
+     << '\n';
+  OS << '\n';
+
+  OS << "Instruction Info:\n";
+  OS << "[1]: #uOps\n[2]: Latency\n[3]: RThroughput\n\n";
+  OS << "[1]    [2]    [3]    Instructions:\n";
+  for (unsigned I = 0; I != NumInsts; ++I) {
+    const InstrInfo &Info = Infos[I];
+    OS << format("%-7u%-7u%-7.2f", Info.NumMicroOps, Info.Latency,
+                 Info.RThroughput);
+    printInst(OS, IP, Insts[I], STI);
+    OS << '\n';
+  }
+  OS << '\n';
+
+  OS << "Resource pressure per iteration:\n";
+  for (unsigned I = 1, E = SM.getNumProcResourceKinds(); I != E; ++I) {
+    OS << format("[%u] %-6.2f ", I - 1, Pressure[I]);
+    printResourceName(OS, *SM.getProcResource(I), I);
+    OS << '\n';
+  }
+  OS << '\n';
+
+  // Walk back from the instruction that completes last in the final
+  // iteration to recover the chain that determines it.
+  DynIdx First = DynIdx(DepIterations - 1) * NumInsts;
+  DynIdx Last = First;
+  for (DynIdx Idx = First; Idx != Complete.size(); ++Idx)
+    if (Complete[Idx] > Complete[Last])
+      Last = Idx;
+  SmallVector<DynIdx, 8> Chain;
+  DynIdx Carried = NoProducer;
+  for (DynIdx Idx = Last; Idx != NoProducer; Idx = Producer[Idx]) {
+    if (Idx < First) {
+      Carried = Idx;
+      break;
+    }
+    Chain.push_back(Idx);
+  }
+  uint64_t Start = Carried == NoProducer ? 0 : Complete[Carried];
+
+  OS << "Critical dependency chain (" << LastEnd - Start << " cycles):\n";
+  for (auto I = Chain.rbegin(), E = Chain.rend(); I != E; ++I) {
+    unsigned Idx = *I % NumInsts;
+    OS << format(" [%u] %-6u", Idx, Infos[Idx].Latency);
+    printInst(OS, IP, Insts[Idx], STI);
+    OS << '\n';
+  }
+  if (Carried != NoProducer)
+    OS << " Loop-carried: depends on [" << Carried % NumInsts
+       << "] of the previous iteration.\n";
+}
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y; // Call llvm_shutdown() on exit.
+
+  // Initialize targets and assembly parsers.
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllAsmParsers();
+
+  // Register the target printer for --version.
+  cl::AddExtraVersionPrinter(TargetRegistry::printRegisteredTargetsForVersion);
+
+  cl::ParseCommandLineOptions(argc, argv, "llvm machine code analyzer\n");
+  const char *ProgName = argv[0];
+
+  if (Iterations == 0) {
+    errs() << ProgName << ": error: -iterations must be at least 1\n";
+    return 1;
+  }
+
+  // Figure out the target triple.
+  if (TripleName.empty())
+    TripleName = sys::getDefaultTargetTriple();
+  Triple TheTriple(Triple::normalize(TripleName));
+  std::string Error;
+  const Target *TheTarget = TargetRegistry::lookupTarget("", TheTriple, Error);
+  if (!TheTarget) {
+    errs() << ProgName << ": " << Error;
+    return 1;
+  }
+  TripleName = TheTriple.getTriple();
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
+      MemoryBuffer::getFileOrSTDIN(InputFilename);
+  if (std::error_code EC = BufferPtr.getError()) {
+    errs() << InputFilename << ": " << EC.message() << '\n';
+    return 1;
+  }
+
+  SourceMgr SrcMgr;
+  SrcMgr.AddNewSourceBuffer(std::move(*BufferPtr), SMLoc());
+
+  std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
+  assert(MRI && "Unable to create target register info!");
+
+  std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
+  assert(MAI && "Unable to create target asm info!");
+
+  MCObjectFileInfo MOFI;
+  MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
+  MOFI.InitMCObjectFileInfo(TheTriple, /*PIC*/ false, CodeModel::Default, Ctx);
+
+  // Package up features to be passed to target/subtarget
+  std::string FeaturesStr;
+  if (MAttrs.size()) {
+    SubtargetFeatures Features;
+    for (unsigned i = 0; i != MAttrs.size(); ++i)
+      Features.AddFeature(MAttrs[i]);
+    FeaturesStr = Features.getString();
+  }
+
+  std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
+  std::unique_ptr<MCSubtargetInfo> STI(
+      TheTarget->createMCSubtargetInfo(TripleName, MCPU, FeaturesStr));
+
+  // Parse the input into a list of instructions.
+  std::vector<MCInst> Insts;
+  InstCollector Str(Ctx, Insts);
+  std::unique_ptr<MCAsmParser> Parser(
+      createMCAsmParser(SrcMgr, Ctx, Str, *MAI));
+  MCTargetOptions MCOptions = InitMCTargetOptionsFromFlags();
+  std::unique_ptr<MCTargetAsmParser> TAP(
+      TheTarget->createMCAsmParser(*STI, *Parser, *MCII, MCOptions));
+  if (!TAP) {
+    errs() << ProgName
+           << ": error: this target does not support assembly parsing.\n";
+    return 1;
+  }
+  Parser->setTargetParser(*TAP);
+  if (Parser->Run(false))
+    return 1;
+
+  if (Insts.empty()) {
+    errs() << ProgName << ": error: no instructions to analyze\n";
+    return 1;
+  }
+
+  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
+      TheTriple, MAI->getAssemblerDialect(), *MAI, *MCII, *MRI));
+  if (!IP) {
+    errs() << ProgName << ": error: unable to create an instruction printer\n";
+    return 1;
+  }
+
+  BlockAnalysis Analysis(*STI, *MRI, *MCII, Insts);
+  if (!Analysis.initialize(errs()))
+    return 1;
+
+  std::error_code EC;
+  tool_output_file Out(OutputFilename, EC, sys::fs::F_None);
+  if (EC) {
+    errs() << EC.message() << '\n';
+    return 1;
+  }
+  Analysis.printReport(Out.os(), *IP, Iterations);
+  Out.keep();
+  return 0;
+}
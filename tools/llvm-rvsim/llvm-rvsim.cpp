@@ -0,0 +1,1154 @@
+//===-- llvm-rvsim.cpp - RISC-V instruction set simulator -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This utility runs a statically linked RV32/RV64 IMAFD ELF program and
+// reports how many instructions it executed, broken down per opcode.  It is
+// meant to turn codegen changes into numbers on machines without RISC-V
+// hardware, not to be a complete system emulator.
+//
+// Instructions are decoded with the RISC-V MCDisassembler and interpreted
+// according to their opcode.  When the selected CPU has a scheduling model
+// the simulator also estimates the number of cycles the program takes on an
+// in-order core: every instruction waits for its register operands and for
+// the processor resources it uses, and taken branches that a static
+// backward-taken/forward-not-taken predictor gets wrong pay the model's
+// misprediction penalty.
+//
+// Only a handful of Linux system calls (exit, write, brk, ...) are provided,
+// which is enough for freestanding test kernels.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSchedule.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace llvm;
+using namespace llvm::object;
+
+static cl::opt<std::string>
+InputFilename(cl::Positional, cl::desc("<input ELF file>"), cl::Required);
+
+static cl::opt<std::string>
+MCPU("mcpu",
+     cl::desc("CPU whose scheduling model estimates cycles "
+              "(-mcpu=help for details)"),
+     cl::value_desc("cpu-name"),
+     cl::init(""));
+
+static cl::list<std::string>
+MAttrs("mattr",
+  cl::CommaSeparated,
+  cl::desc("Target specific attributes (-mattr=help for details)"),
+  cl::value_desc("a1,+a2,-a3,..."));
+
+static cl::opt<uint64_t>
+MaxInstructions("max-instructions",
+                cl::desc("Stop after executing this many instructions "
+                         "(0 means no limit)"),
+                cl::init(0));
+
+static cl::opt<unsigned>
+StackSize("stack-size", cl::desc("Size of the program stack in KiB"),
+          cl::init(1024));
+
+static cl::opt<bool>
+Trace("trace", cl::desc("Print every executed instruction"));
+
+static cl::opt<bool>
+NoHistogram("no-histogram", cl::desc("Do not print the opcode histogram"));
+
+static const char *ProgName;
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Instruction semantics
+//===----------------------------------------------------------------------===//
+
+/// What an opcode does.  Opcodes that only differ in register class (the
+/// RV64 "64" variants) or in the static rounding mode share a kind.
+enum OpKind {
+  Unsupported,
+  // Integer register-register and register-immediate.
+  Add, Sub, And, Or, Xor, Sll, Srl, Sra, Slt, Sltu,
+  AddI, AndI, OrI, XorI, SllI, SrlI, SraI, SltI, SltIU,
+  AddW, SubW, SllW, SrlW, SraW, AddIW, SllIW, SrlIW, SraIW,
+  Lui, Auipc,
+  // M extension.
+  Mul, MulH, MulHU, MulW, Div, DivU, Rem, RemU, DivW, DivUW, RemW, RemUW,
+  // Memory.
+  LB, LBU, LH, LHU, LW, LWU, LD, SB, SH, SW, SD, Fence,
+  // A extension.
+  LRW, LRD, SCW, SCD,
+  AmoSwapW, AmoAddW, AmoAndW, AmoOrW, AmoXorW,
+  AmoMinW, AmoMaxW, AmoMinUW, AmoMaxUW,
+  AmoSwapD, AmoAddD, AmoAndD, AmoOrD, AmoXorD,
+  AmoMinD, AmoMaxD, AmoMinUD, AmoMaxUD,
+  // Control flow.
+  Beq, Bne, Blt, Bge, Bltu, Bgeu, Bgt, Ble, Bgtu, Bleu,
+  Jump, Jal, Jalr, Ret,
+  // System.
+  Scall, Sbreak, RdCycle, RdTime, RdInstret,
+  // F and D extensions.
+  FLW, FLD, FSW, FSD,
+  FAddS, FSubS, FMulS, FDivS, FAddD, FSubD, FMulD, FDivD,
+  FSgnjS, FSgnjnS, FSgnjxS, FSgnjD, FSgnjnD, FSgnjxD,
+  FEqS, FLtS, FLeS, FEqD, FLtD, FLeD,
+  FCvtWS, FCvtWUS, FCvtLS, FCvtLUS, FCvtWD, FCvtWUD, FCvtLD, FCvtLUD,
+  FCvtSW, FCvtSWU, FCvtSL, FCvtSLU, FCvtDW, FCvtDWU, FCvtDL, FCvtDLU,
+  FCvtSD, FCvtDS,
+  FMvXS, FMvSX, FMvXD, FMvDX
+};
+
+/// Static rounding modes, as encoded in the rm field.
+enum RoundingMode { RNE, RTZ, RDN, RUP, RMM, DYN };
+
+struct OpInfo {
+  OpKind Kind;
+  RoundingMode RM;
+};
+
+/// Map an opcode name to its semantics.
+static OpInfo classifyOpcode(StringRef Name) {
+  OpInfo Info;
+  Info.RM = DYN;
+
+  // Strip the rounding mode suffix of the floating-point instructions.
+  if (Name.size() > 4 && Name[Name.size() - 4] == '_' &&
+      Name[Name.size() - 3] == 'R') {
+    StringRef Suffix = Name.substr(Name.size() - 2);
+    Info.RM = StringSwitch<RoundingMode>(Suffix)
+                  .Case("NE", RNE).Case("TZ", RTZ).Case("DN", RDN)
+                  .Case("UP", RUP).Case("MM", RMM).Default(DYN);
+    Name = Name.drop_back(4);
+  }
+  // The RV64 forms of the base instructions only differ in register class.
+  if (Name.endswith("_32"))
+    Name = Name.drop_back(3);
+  if (Name.endswith("64"))
+    Name = Name.drop_back(2);
+
+  Info.Kind = StringSwitch<OpKind>(Name)
+    .Case("ADD", Add).Case("SUB", Sub).Case("AND", And).Case("OR", Or)
+    .Case("XOR", Xor).Case("SLL", Sll).Case("SRL", Srl).Case("SRA", Sra)
+    .Case("SLT", Slt).Case("SLTU", Sltu)
+    .Case("ADDI", AddI).Case("ANDI", AndI).Case("ORI", OrI)
+    .Case("XORI", XorI).Case("SLLI", SllI).Case("SRLI", SrlI)
+    .Case("SRAI", SraI).Case("SLTI", SltI).Case("SLTIU", SltIU)
+    .Case("ADDW", AddW).Case("SUBW", SubW).Case("SLLW", SllW)
+    .Case("SRLW", SrlW).Case("SRAW", SraW).Case("ADDIW", AddIW)
+    .Case("SLLIW", SllIW).Case("SRLIW", SrlIW).Case("SRAIW", SraIW)
+    .Case("LUI", Lui).Case("AUIPC", Auipc)
+    .Case("MUL", Mul).Case("MULH", MulH).Case("MULHU", MulHU)
+    .Case("MULW", MulW).Case("DIV", Div).Case("DIVU", DivU)
+    .Case("REM", Rem).Case("REMU", RemU).Case("DIVW", DivW)
+    .Case("DIVUW", DivUW).Case("REMW", RemW).Case("REMUW", RemUW)
+    .Case("LB", LB).Case("LBU", LBU).Case("LH", LH).Case("LHU", LHU)
+    .Case("LW", LW).Case("LWU", LWU).Case("LD", LD)
+    .Case("SB", SB).Case("SH", SH).Case("SW", SW).Case("SD", SD)
+    .Cases("FENCE", "FENCE_I", "FENCE64_I", Fence)
+    .Case("LR_W", LRW).Case("LR_D", LRD).Case("SC_W", SCW).Case("SC_D", SCD)
+    .Case("AMOSWAP_W", AmoSwapW).Case("AMOADD_W", AmoAddW)
+    .Case("AMOAND_W", AmoAndW).Case("AMOOR_W", AmoOrW)
+    .Case("AMOXOR_W", AmoXorW).Case("AMOMIN_W", AmoMinW)
+    .Case("AMOMAX_W", AmoMaxW).Case("AMOMINU_W", AmoMinUW)
+    .Case("AMOMAXU_W", AmoMaxUW)
+    .Case("AMOSWAP_D", AmoSwapD).Case("AMOADD_D", AmoAddD)
+    .Case("AMOAND_D", AmoAndD).Case("AMOOR_D", AmoOrD)
+    .Case("AMOXOR_D", AmoXorD).Case("AMOMIN_D", AmoMinD)
+    .Case("AMOMAX_D", AmoMaxD).Case("AMOMINU_D", AmoMinUD)
+    .Case("AMOMAXU_D", AmoMaxUD)
+    .Case("BEQ", Beq).Case("BNE", Bne).Case("BLT", Blt).Case("BGE", Bge)
+    .Case("BLTU", Bltu).Case("BGEU", Bgeu).Case("BGT", Bgt).Case("BLE", Ble)
+    .Case("BGTU", Bgtu).Case("BLEU", Bleu)
+    .Case("J", Jump).Case("JAL", Jal).Case("JALR", Jalr).Case("RET", Ret)
+    .Case("SCALL", Scall).Case("SBREAK", Sbreak)
+    .Cases("RDCYCLE", "RDCYCLEH", RdCycle)
+    .Cases("RDTIME", "RDTIMEH", RdTime)
+    .Cases("RDINSTRET", "RDINSTRETH", RdInstret)
+    .Case("FLW", FLW).Case("FLD", FLD).Case("FSW", FSW).Case("FSD", FSD)
+    .Case("FADD_S", FAddS).Case("FSUB_S", FSubS).Case("FMUL_S", FMulS)
+    .Case("FDIV_S", FDivS).Case("FADD_D", FAddD).Case("FSUB_D", FSubD)
+    .Case("FMUL_D", FMulD).Case("FDIV_D", FDivD)
+    .Case("FSGNJ_S", FSgnjS).Case("FSGNJN_S", FSgnjnS)
+    .Case("FSGNJX_S", FSgnjxS).Case("FSGNJ_D", FSgnjD)
+    .Case("FSGNJN_D", FSgnjnD).Case("FSGNJX_D", FSgnjxD)
+    // The unordered comparisons share the encodings of the ordered ones.
+    .Cases("FEQ_S", "FUEQ_S", FEqS).Cases("FLT_S", "FULT_S", FLtS)
+    .Cases("FLE_S", "FULE_S", FLeS).Cases("FEQ_D", "FUEQ_D", FEqD)
+    .Cases("FLT_D", "FULT_D", FLtD).Cases("FLE_D", "FULE_D", FLeD)
+    .Case("FCVT_W_S", FCvtWS).Case("FCVT_WU_S", FCvtWUS)
+    .Case("FCVT_L_S", FCvtLS).Case("FCVT_LU_S", FCvtLUS)
+    .Case("FCVT_W_D", FCvtWD).Case("FCVT_WU_D", FCvtWUD)
+    .Case("FCVT_L_D", FCvtLD).Case("FCVT_LU_D", FCvtLUD)
+    .Case("FCVT_S_W", FCvtSW).Case("FCVT_S_WU", FCvtSWU)
+    .Case("FCVT_S_L", FCvtSL).Case("FCVT_S_LU", FCvtSLU)
+    .Case("FCVT_D_W", FCvtDW).Case("FCVT_D_WU", FCvtDWU)
+    .Case("FCVT_D_L", FCvtDL).Case("FCVT_D_LU", FCvtDLU)
+    .Case("FCVT_S_D", FCvtSD).Case("FCVT_D_S", FCvtDS)
+    .Case("FMV_X_S", FMvXS).Case("FMV_S_X", FMvSX)
+    .Case("FMV_X_D", FMvXD).Case("FMV_D_X", FMvDX)
+    .Default(Unsupported);
+  return Info;
+}
+
+//===----------------------------------------------------------------------===//
+// Memory
+//===----------------------------------------------------------------------===//
+
+/// A sparse, page granular, little-endian address space.  Only pages that
+/// were explicitly mapped may be accessed.
+class Memory {
+  enum { PageSize = 4096 };
+  DenseMap<uint64_t, std::unique_ptr<uint8_t[]>> Pages;
+
+  uint8_t *getPage(uint64_t Addr) const {
+    auto I = Pages.find(Addr / PageSize);
+    return I == Pages.end() ? nullptr : I->second.get();
+  }
+
+public:
+  void map(uint64_t Addr, uint64_t Size) {
+    if (Size == 0)
+      return;
+    for (uint64_t P = Addr / PageSize, E = (Addr + Size - 1) / PageSize;
+         P <= E; ++P) {
+      std::unique_ptr<uint8_t[]> &Page = Pages[P];
+      if (!Page) {
+        Page.reset(new uint8_t[PageSize]);
+        std::memset(Page.get(), 0, PageSize);
+      }
+    }
+  }
+
+  bool read(uint64_t Addr, void *Dst, uint64_t Size) const {
+    uint8_t *Out = static_cast<uint8_t *>(Dst);
+    while (Size) {
+      uint8_t *Page = getPage(Addr);
+      if (!Page)
+        return false;
+      uint64_t Offset = Addr % PageSize;
+      uint64_t N = std::min<uint64_t>(Size, PageSize - Offset);
+      std::memcpy(Out, Page + Offset, N);
+      Out += N;
+      Addr += N;
+      Size -= N;
+    }
+    return true;
+  }
+
+  bool write(uint64_t Addr, const void *Src, uint64_t Size) {
+    const uint8_t *In = static_cast<const uint8_t *>(Src);
+    while (Size) {
+      uint8_t *Page = getPage(Addr);
+      if (!Page)
+        return false;
+      uint64_t Offset = Addr % PageSize;
+      uint64_t N = std::min<uint64_t>(Size, PageSize - Offset);
+      std::memcpy(Page + Offset, In, N);
+      In += N;
+      Addr += N;
+      Size -= N;
+    }
+    return true;
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// Simulator
+//===----------------------------------------------------------------------===//
+
+/// A decoded instruction together with everything the simulator needs to
+/// know about it, cached per address.
+struct DecodedInst {
+  MCInst Inst;
+  OpInfo Info;
+  // Scheduling properties.  Instructions the model does not describe are
+  // a single micro-op with unit latency that uses no resources.
+  const MCWriteProcResEntry *ResBegin, *ResEnd;
+  unsigned NumMicroOps;
+  unsigned Latency;
+};
+
+// Register numbers of the integer calling convention.
+enum { RegRA = 1, RegSP = 2, RegA0 = 10, RegA1 = 11, RegA2 = 12, RegA7 = 17 };
+
+class Simulator {
+  const MCSubtargetInfo &STI;
+  const MCInstrInfo &MII;
+  const MCRegisterInfo &MRI;
+  const MCDisassembler &Dis;
+  const MCSchedModel &SM;
+  Memory &Mem;
+  bool Is64;
+
+  uint64_t X[32];
+  uint64_t F[32];
+  uint64_t PC;
+  uint64_t Brk;
+  uint64_t Reservation;
+  bool HasReservation;
+
+  std::vector<OpInfo> OpInfos;
+  DenseMap<uint64_t, DecodedInst> DecodeCache;
+
+  // Timing state of the in-order core model.
+  uint64_t Cycle;
+  unsigned SlotsUsed;
+  uint64_t LastCompletion;
+  std::vector<uint64_t> RegUnitReady;
+  std::vector<uint64_t> ResourceFree;
+
+public:
+  uint64_t NumInstructions;
+  std::vector<uint64_t> OpcodeCounts;
+  int ExitCode;
+
+  Simulator(const MCSubtargetInfo &STI, const MCInstrInfo &MII,
+            const MCRegisterInfo &MRI, const MCDisassembler &Dis,
+            Memory &Mem, bool Is64, uint64_t Entry, uint64_t StackTop,
+            uint64_t Brk);
+
+  bool hasCycleModel() const { return SM.hasInstrSchedModel(); }
+  uint64_t getCycles() const {
+    return std::max(Cycle + (SlotsUsed ? 1 : 0), LastCompletion);
+  }
+
+  /// Run until the program exits.  Returns false on a simulation error,
+  /// which has already been reported.
+  bool run();
+
+private:
+  uint64_t canonical(uint64_t V) const {
+    return Is64 ? V : uint64_t(int64_t(int32_t(V)));
+  }
+  uint64_t xu(unsigned R) const { return Is64 ? X[R] : uint32_t(X[R]); }
+  int64_t xs(unsigned R) const { return int64_t(X[R]); }
+  void setX(unsigned R, uint64_t V) {
+    if (R != 0)
+      X[R] = canonical(V);
+  }
+  unsigned xlen() const { return Is64 ? 64 : 32; }
+  uint64_t address(uint64_t A) const { return Is64 ? A : uint32_t(A); }
+
+  unsigned reg(const MCInst &Inst, unsigned Op) const {
+    return MRI.getEncodingValue(Inst.getOperand(Op).getReg());
+  }
+  int64_t imm(const MCInst &Inst, unsigned Op) const {
+    return Inst.getOperand(Op).getImm();
+  }
+
+  float getS(unsigned R) const {
+    uint32_t Bits = uint32_t(F[R]);
+    float V;
+    std::memcpy(&V, &Bits, sizeof(V));
+    return V;
+  }
+  double getD(unsigned R) const {
+    double V;
+    std::memcpy(&V, &F[R], sizeof(V));
+    return V;
+  }
+  void setS(unsigned R, float V) {
+    uint32_t Bits;
+    std::memcpy(&Bits, &V, sizeof(V));
+    // Single-precision values are NaN-boxed in the 64-bit registers.
+    F[R] = 0xffffffff00000000ULL | Bits;
+  }
+  void setD(unsigned R, double V) { std::memcpy(&F[R], &V, sizeof(V)); }
+
+  bool error(const Twine &Msg) const {
+    errs() << ProgName << ": error: " << Msg << " at pc 0x"
+           << Twine::utohexstr(PC) << '\n';
+    return false;
+  }
+
+  const DecodedInst *decode(uint64_t Addr);
+  bool load(uint64_t Addr, unsigned Size, bool Signed, uint64_t &Value);
+  bool store(uint64_t Addr, unsigned Size, uint64_t Value);
+  bool amo(const MCInst &Inst, OpKind Kind);
+  bool syscall(bool &Exited);
+  int64_t fpToInt(double V, RoundingMode RM, bool Signed, unsigned Bits) const;
+  bool execute(const DecodedInst &DI, bool &Taken, bool &Exited);
+  void account(const DecodedInst &DI, bool Taken);
+};
+
+} // end anonymous namespace
+
+Simulator::Simulator(const MCSubtargetInfo &STI, const MCInstrInfo &MII,
+                     const MCRegisterInfo &MRI, const MCDisassembler &Dis,
+                     Memory &Mem, bool Is64, uint64_t Entry, uint64_t StackTop,
+                     uint64_t Brk)
+    : STI(STI), MII(MII), MRI(MRI), Dis(Dis), SM(STI.getSchedModel()),
+      Mem(Mem), Is64(Is64), PC(Entry), Brk(Brk), Reservation(0),
+      HasReservation(false), Cycle(0), SlotsUsed(0), LastCompletion(0),
+      RegUnitReady(MRI.getNumRegUnits(), 0),
+      ResourceFree(SM.getNumProcResourceKinds(), 0), NumInstructions(0),
+      OpcodeCounts(MII.getNumOpcodes(), 0), ExitCode(0) {
+  std::memset(X, 0, sizeof(X));
+  std::memset(F, 0, sizeof(F));
+  X[RegSP] = canonical(StackTop);
+
+  for (unsigned Opc = 0, E = MII.getNumOpcodes(); Opc != E; ++Opc)
+    OpInfos.push_back(classifyOpcode(MII.getName(Opc)));
+}
+
+const DecodedInst *Simulator::decode(uint64_t Addr) {
+  auto I = DecodeCache.find(Addr);
+  if (I != DecodeCache.end())
+    return &I->second;
+
+  uint8_t Bytes[4];
+  if (!Mem.read(Addr, Bytes, sizeof(Bytes))) {
+    error("instruction fetch from unmapped address");
+    return nullptr;
+  }
+  DecodedInst DI;
+  uint64_t Size;
+  if (Dis.getInstruction(DI.Inst, Size, Bytes, Addr, nulls(), nulls()) !=
+      MCDisassembler::Success) {
+    error("invalid instruction encoding");
+    return nullptr;
+  }
+  DI.Info = OpInfos[DI.Inst.getOpcode()];
+  DI.ResBegin = DI.ResEnd = nullptr;
+  DI.NumMicroOps = 1;
+  DI.Latency = 1;
+  if (SM.hasInstrSchedModel()) {
+    unsigned SchedClass = MII.get(DI.Inst.getOpcode()).getSchedClass();
+    const MCSchedClassDesc *SCDesc = SM.getSchedClassDesc(SchedClass);
+    if (SCDesc->isValid() && !SCDesc->isVariant()) {
+      DI.ResBegin = STI.getWriteProcResBegin(SCDesc);
+      DI.ResEnd = STI.getWriteProcResEnd(SCDesc);
+      DI.NumMicroOps = std::max<unsigned>(SCDesc->NumMicroOps, 1);
+      DI.Latency = MCSchedModel::computeInstrLatency(STI, *SCDesc);
+    }
+  }
+  return &DecodeCache.insert(std::make_pair(Addr, DI)).first->second;
+}
+
+bool Simulator::load(uint64_t Addr, unsigned Size, bool Signed,
+                     uint64_t &Value) {
+  uint8_t Bytes[8];
+  if (!Mem.read(address(Addr), Bytes, Size))
+    return error("load from unmapped address 0x" +
+                 Twine::utohexstr(address(Addr)));
+  Value = 0;
+  for (unsigned I = Size; I != 0; --I)
+    Value = (Value << 8) | Bytes[I - 1];
+  if (Signed && Size < 8)
+    Value = uint64_t(SignExtend64(Value, Size * 8));
+  return true;
+}
+
+bool Simulator::store(uint64_t Addr, unsigned Size, uint64_t Value) {
+  uint8_t Bytes[8];
+  for (unsigned I = 0; I != Size; ++I)
+    Bytes[I] = uint8_t(Value >> (8 * I));
+  if (!Mem.write(address(Addr), Bytes, Size))
+    return error("store to unmapped address 0x" +
+                 Twine::utohexstr(address(Addr)));
+  return true;
+}
+
+bool Simulator::amo(const MCInst &Inst, OpKind Kind) {
+  // Operands are: dst, src, address register.
+  unsigned Rd = reg(Inst, 0), Rs = reg(Inst, 1), Ra = reg(Inst, 2);
+  bool IsWord = Kind <= AmoMaxUW;
+  unsigned Size = IsWord ? 4 : 8;
+  uint64_t Old;
+  if (!load(X[Ra], Size, /*Signed=*/true, Old))
+    return false;
+  uint64_t Src = IsWord ? uint64_t(int64_t(int32_t(X[Rs]))) : X[Rs];
+  uint64_t OldU = IsWord ? uint32_t(Old) : Old;
+  uint64_t SrcU = IsWord ? uint32_t(Src) : Src;
+  uint64_t New;
+  switch (Kind) {
+  case AmoSwapW: case AmoSwapD: New = Src; break;
+  case AmoAddW: case AmoAddD: New = Old + Src; break;
+  case AmoAndW: case AmoAndD: New = Old & Src; break;
+  case AmoOrW: case AmoOrD: New = Old | Src; break;
+  case AmoXorW: case AmoXorD: New = Old ^ Src; break;
+  case AmoMinW: case AmoMinD: New = std::min(int64_t(Old), int64_t(Src)); break;
+  case AmoMaxW: case AmoMaxD: New = std::max(int64_t(Old), int64_t(Src)); break;
+  case AmoMinUW: case AmoMinUD: New = OldU < SrcU ? Old : Src; break;
+  case AmoMaxUW: case AmoMaxUD: New = OldU > SrcU ? Old : Src; break;
+  default: llvm_unreachable("not an AMO");
+  }
+  if (!store(X[Ra], Size, New))
+    return false;
+  setX(Rd, Old);
+  return true;
+}
+
+bool Simulator::syscall(bool &Exited) {
+  uint64_t Ret;
+  switch (X[RegA7]) {
+  case 93: // exit
+  case 94: // exit_group
+    ExitCode = int(X[RegA0]);
+    Exited = true;
+    return true;
+  case 64: { // write
+    uint64_t FD = X[RegA0], Buf = address(X[RegA1]), Len = xu(RegA2);
+    if (FD != 1 && FD != 2) {
+      Ret = uint64_t(-9); // EBADF
+      break;
+    }
+    std::vector<char> Data(Len);
+    if (!Mem.read(Buf, Data.data(), Len))
+      return error("write from unmapped address 0x" + Twine::utohexstr(Buf));
+    raw_ostream &OS = FD == 1 ? outs() : errs();
+    OS.write(Data.data(), Len);
+    OS.flush();
+    Ret = Len;
+    break;
+  }
+  case 57: // close
+    Ret = 0;
+    break;
+  case 80: // fstat
+    Ret = uint64_t(-9); // EBADF
+    break;
+  case 214: { // brk
+    uint64_t Req = address(X[RegA0]);
+    if (Req > Brk) {
+      Mem.map(Brk, Req - Brk);
+      Brk = Req;
+    }
+    Ret = Brk;
+    break;
+  }
+  default:
+    return error("unsupported system call " + Twine(X[RegA7]));
+  }
+  setX(RegA0, Ret);
+  return true;
+}
+
+// Convert to an integer the way fcvt does: round according to RM, saturate
+// out-of-range values and turn NaN into the largest value.
+int64_t Simulator::fpToInt(double V, RoundingMode RM, bool Signed,
+                           unsigned Bits) const {
+  switch (RM) {
+  case RTZ: V = std::trunc(V); break;
+  case RDN: V = std::floor(V); break;
+  case RUP: V = std::ceil(V); break;
+  case RMM: V = std::round(V); break;
+  case RNE: case DYN: V = std::nearbyint(V); break;
+  }
+  double Min, Max;
+  if (Signed) {
+    Max = std::ldexp(1.0, Bits - 1) - 1;
+    Min = -std::ldexp(1.0, Bits - 1);
+  } else {
+    Max = std::ldexp(1.0, Bits) - 1;
+    Min = 0;
+  }
+  uint64_t MaxBits = Signed ? maxUIntN(Bits - 1) : maxUIntN(Bits);
+  uint64_t MinBits = Signed ? uint64_t(minIntN(Bits)) : 0;
+  uint64_t R;
+  if (std::isnan(V) || V >= Max)
+    R = MaxBits;
+  else if (V <= Min)
+    R = MinBits;
+  else if (Signed)
+    R = uint64_t(int64_t(V));
+  else
+    R = uint64_t(V);
+  // 32-bit results are sign-extended, even the unsigned ones.
+  return Bits == 32 ? int64_t(int32_t(R)) : int64_t(R);
+}
+
+static uint64_t mulhu64(uint64_t A, uint64_t B) {
+  uint64_t ALo = uint32_t(A), AHi = A >> 32;
+  uint64_t BLo = uint32_t(B), BHi = B >> 32;
+  uint64_t LoLo = ALo * BLo, HiLo = AHi * BLo;
+  uint64_t LoHi = ALo * BHi, HiHi = AHi * BHi;
+  uint64_t Cross = (LoLo >> 32) + uint32_t(HiLo) + LoHi;
+  return HiHi + (HiLo >> 32) + (Cross >> 32);
+}
+
+bool Simulator::execute(const DecodedInst &DI, bool &Taken, bool &Exited) {
+  const MCInst &I = DI.Inst;
+  OpKind Kind = DI.Info.Kind;
+  uint64_t NextPC = PC + 4;
+  unsigned XLen = xlen();
+  unsigned ShMask = XLen - 1;
+  uint64_t V;
+
+  switch (Kind) {
+  case Unsupported:
+    return error("unsupported instruction '" +
+                 Twine(MII.getName(I.getOpcode())) + "'");
+
+  // Operands are: dst, src1, src2 (register or immediate).
+#define BINOP(K, EXPR)                                                         \
+  case K: {                                                                    \
+    unsigned Rd = reg(I, 0), Rs1 = reg(I, 1);                                  \
+    const MCOperand &Op2 = I.getOperand(2);                                    \
+    uint64_t B = Op2.isImm() ? uint64_t(Op2.getImm())                          \
+                             : X[MRI.getEncodingValue(Op2.getReg())];          \
+    uint64_t A = X[Rs1];                                                       \
+    (void)A; (void)B;                                                          \
+    setX(Rd, (EXPR));                                                          \
+    break;                                                                     \
+  }
+  BINOP(Add, A + B)
+  BINOP(AddI, A + B)
+  BINOP(Sub, A - B)
+  BINOP(And, A & B)
+  BINOP(AndI, A & B)
+  BINOP(Or, A | B)
+  BINOP(OrI, A | B)
+  BINOP(Xor, A ^ B)
+  BINOP(XorI, A ^ B)
+  BINOP(Sll, A << (B & ShMask))
+  BINOP(SllI, A << (B & ShMask))
+  BINOP(Srl, (Is64 ? A : uint32_t(A)) >> (B & ShMask))
+  BINOP(SrlI, (Is64 ? A : uint32_t(A)) >> (B & ShMask))
+  BINOP(Sra, uint64_t(int64_t(A) >> (B & ShMask)))
+  BINOP(SraI, uint64_t(int64_t(A) >> (B & ShMask)))
+  BINOP(Slt, int64_t(A) < int64_t(B))
+  BINOP(SltI, int64_t(A) < int64_t(B))
+  BINOP(Sltu, (Is64 ? A : uint32_t(A)) < (Is64 ? B : uint32_t(B)))
+  BINOP(SltIU, (Is64 ? A : uint32_t(A)) < (Is64 ? B : uint32_t(B)))
+  BINOP(AddW, int64_t(int32_t(A + B)))
+  BINOP(AddIW, int64_t(int32_t(A + B)))
+  BINOP(SubW, int64_t(int32_t(A - B)))
+  BINOP(SllW, int64_t(int32_t(uint32_t(A) << (B & 31))))
+  BINOP(SllIW, int64_t(int32_t(uint32_t(A) << (B & 31))))
+  BINOP(SrlW, int64_t(int32_t(uint32_t(A) >> (B & 31))))
+  BINOP(SrlIW, int64_t(int32_t(uint32_t(A) >> (B & 31))))
+  BINOP(SraW, int64_t(int32_t(A) >> (B & 31)))
+  BINOP(SraIW, int64_t(int32_t(A) >> (B & 31)))
+  BINOP(Mul, A * B)
+  BINOP(MulW, int64_t(int32_t(A * B)))
+  BINOP(MulHU, Is64 ? mulhu64(A, B)
+                    : (uint64_t(uint32_t(A)) * uint32_t(B)) >> 32)
+  BINOP(MulH, Is64 ? mulhu64(A, B) - (int64_t(A) < 0 ? B : 0) -
+                         (int64_t(B) < 0 ? A : 0)
+                   : uint64_t((int64_t(A) * int64_t(B)) >> 32))
+  BINOP(Div, B == 0 ? ~uint64_t(0)
+             : (int64_t(A) == minIntN(XLen) && int64_t(B) == -1)
+                 ? A : uint64_t(int64_t(A) / int64_t(B)))
+  BINOP(DivU, B == 0 ? ~uint64_t(0)
+              : Is64 ? A / B : uint64_t(uint32_t(A) / uint32_t(B)))
+  BINOP(Rem, B == 0 ? A
+             : (int64_t(A) == minIntN(XLen) && int64_t(B) == -1)
+                 ? 0 : uint64_t(int64_t(A) % int64_t(B)))
+  BINOP(RemU, B == 0 ? A
+              : Is64 ? A % B : uint64_t(uint32_t(A) % uint32_t(B)))
+  BINOP(DivW, int32_t(B) == 0 ? ~uint64_t(0)
+              : (int32_t(A) == INT32_MIN && int32_t(B) == -1)
+                  ? uint64_t(int64_t(int32_t(A)))
+                  : uint64_t(int64_t(int32_t(A) / int32_t(B))))
+  BINOP(DivUW, uint32_t(B) == 0 ? ~uint64_t(0)
+               : uint64_t(int64_t(int32_t(uint32_t(A) / uint32_t(B)))))
+  BINOP(RemW, int32_t(B) == 0 ? uint64_t(int64_t(int32_t(A)))
+              : (int32_t(A) == INT32_MIN && int32_t(B) == -1)
+                  ? 0 : uint64_t(int64_t(int32_t(A) % int32_t(B))))
+  BINOP(RemUW, uint32_t(B) == 0 ? uint64_t(int64_t(int32_t(A)))
+               : uint64_t(int64_t(int32_t(uint32_t(A) % uint32_t(B)))))
+#undef BINOP
+
+  case Lui:
+    setX(reg(I, 0), uint64_t(int64_t(int32_t(uint32_t(imm(I, 1)) << 12))));
+    break;
+  case Auipc:
+    setX(reg(I, 0),
+         PC + uint64_t(int64_t(int32_t(uint32_t(imm(I, 1)) << 12))));
+    break;
+
+  // Loads and stores take the value register, then the displacement and the
+  // base register.
+#define LOAD(K, SIZE, SIGNED)                                                  \
+  case K:                                                                      \
+    if (!load(X[reg(I, 2)] + imm(I, 1), SIZE, SIGNED, V))                      \
+      return false;                                                            \
+    setX(reg(I, 0), V);                                                        \
+    break;
+  LOAD(LB, 1, true)
+  LOAD(LBU, 1, false)
+  LOAD(LH, 2, true)
+  LOAD(LHU, 2, false)
+  LOAD(LW, 4, true)
+  LOAD(LWU, 4, false)
+  LOAD(LD, 8, true)
+#undef LOAD
+  case SB: case SH: case SW: case SD: {
+    unsigned Size = Kind == SB ? 1 : Kind == SH ? 2 : Kind == SW ? 4 : 8;
+    if (!store(X[reg(I, 2)] + imm(I, 1), Size, X[reg(I, 0)]))
+      return false;
+    break;
+  }
+  case Fence:
+    break;
+
+  case LRW: case LRD: {
+    // Operands are: dst, address register.
+    uint64_t Addr = X[reg(I, 1)];
+    if (!load(Addr, Kind == LRW ? 4 : 8, true, V))
+      return false;
+    setX(reg(I, 0), V);
+    Reservation = address(Addr);
+    HasReservation = true;
+    break;
+  }
+  case SCW: case SCD: {
+    // Operands are: dst, src, address register.
+    uint64_t Addr = X[reg(I, 2)];
+    bool Success = HasReservation && Reservation == address(Addr);
+    if (Success && !store(Addr, Kind == SCW ? 4 : 8, X[reg(I, 1)]))
+      return false;
+    HasReservation = false;
+    setX(reg(I, 0), Success ? 0 : 1);
+    break;
+  }
+  case AmoSwapW: case AmoAddW: case AmoAndW: case AmoOrW: case AmoXorW:
+  case AmoMinW: case AmoMaxW: case AmoMinUW: case AmoMaxUW:
+  case AmoSwapD: case AmoAddD: case AmoAndD: case AmoOrD: case AmoXorD:
+  case AmoMinD: case AmoMaxD: case AmoMinUD: case AmoMaxUD:
+    if (!amo(I, Kind))
+      return false;
+    break;
+
+  // Branches take the pc-relative target first, then the two sources.
+  case Beq: case Bne: case Blt: case Bge: case Bltu: case Bgeu:
+  case Bgt: case Ble: case Bgtu: case Bleu: {
+    unsigned Rs1 = reg(I, 1), Rs2 = reg(I, 2);
+    int64_t S1 = xs(Rs1), S2 = xs(Rs2);
+    uint64_t U1 = xu(Rs1), U2 = xu(Rs2);
+    switch (Kind) {
+    case Beq: Taken = U1 == U2; break;
+    case Bne: Taken = U1 != U2; break;
+    case Blt: Taken = S1 < S2; break;
+    case Bge: Taken = S1 >= S2; break;
+    case Bltu: Taken = U1 < U2; break;
+    case Bgeu: Taken = U1 >= U2; break;
+    case Bgt: Taken = S1 > S2; break;
+    case Ble: Taken = S1 <= S2; break;
+    case Bgtu: Taken = U1 > U2; break;
+    default: Taken = U1 <= U2; break;
+    }
+    if (Taken)
+      NextPC = PC + imm(I, 0);
+    break;
+  }
+  case Jump:
+    NextPC = PC + imm(I, 0);
+    Taken = true;
+    break;
+  case Jal:
+    // The call form links through ra implicitly.
+    if (I.getNumOperands() == 2) {
+      setX(reg(I, 0), PC + 4);
+      NextPC = PC + imm(I, 1);
+    } else {
+      setX(RegRA, PC + 4);
+      NextPC = PC + imm(I, 0);
+    }
+    Taken = true;
+    break;
+  case Jalr:
+    // Operands are: dst, displacement, base register.
+    NextPC = (X[reg(I, 2)] + imm(I, 1)) & ~uint64_t(1);
+    setX(reg(I, 0), PC + 4);
+    Taken = true;
+    break;
+  case Ret:
+    NextPC = X[RegRA];
+    Taken = true;
+    break;
+
+  case Scall:
+    if (!syscall(Exited))
+      return false;
+    break;
+  case Sbreak:
+    return error("breakpoint");
+  case RdCycle:
+    setX(reg(I, 0), getCycles());
+    break;
+  case RdTime:
+    setX(reg(I, 0), getCycles());
+    break;
+  case RdInstret:
+    setX(reg(I, 0), NumInstructions);
+    break;
+
+  case FLW:
+    if (!load(X[reg(I, 2)] + imm(I, 1), 4, false, V))
+      return false;
+    F[reg(I, 0)] = 0xffffffff00000000ULL | V;
+    break;
+  case FLD:
+    if (!load(X[reg(I, 2)] + imm(I, 1), 8, false, V))
+      return false;
+    F[reg(I, 0)] = V;
+    break;
+  case FSW:
+    if (!store(X[reg(I, 2)] + imm(I, 1), 4, F[reg(I, 0)]))
+      return false;
+    break;
+  case FSD:
+    if (!store(X[reg(I, 2)] + imm(I, 1), 8, F[reg(I, 0)]))
+      return false;
+    break;
+
+  // Arithmetic operands are: dst, src1, src2.  Arithmetic uses the host's
+  // round-to-nearest-even regardless of the instruction's rounding mode.
+  case FAddS: setS(reg(I, 0), getS(reg(I, 1)) + getS(reg(I, 2))); break;
+  case FSubS: setS(reg(I, 0), getS(reg(I, 1)) - getS(reg(I, 2))); break;
+  case FMulS: setS(reg(I, 0), getS(reg(I, 1)) * getS(reg(I, 2))); break;
+  case FDivS: setS(reg(I, 0), getS(reg(I, 1)) / getS(reg(I, 2))); break;
+  case FAddD: setD(reg(I, 0), getD(reg(I, 1)) + getD(reg(I, 2))); break;
+  case FSubD: setD(reg(I, 0), getD(reg(I, 1)) - getD(reg(I, 2))); break;
+  case FMulD: setD(reg(I, 0), getD(reg(I, 1)) * getD(reg(I, 2))); break;
+  case FDivD: setD(reg(I, 0), getD(reg(I, 1)) / getD(reg(I, 2))); break;
+
+  // Sign injection and comparisons list src2 before src1.
+  case FSgnjS: case FSgnjnS: case FSgnjxS: {
+    uint32_t S1 = uint32_t(F[reg(I, 2)]), S2 = uint32_t(F[reg(I, 1)]);
+    uint32_t Sign = Kind == FSgnjS ? S2 : Kind == FSgnjnS ? ~S2 : S1 ^ S2;
+    F[reg(I, 0)] =
+        0xffffffff00000000ULL | (S1 & 0x7fffffffU) | (Sign & 0x80000000U);
+    break;
+  }
+  case FSgnjD: case FSgnjnD: case FSgnjxD: {
+    uint64_t S1 = F[reg(I, 2)], S2 = F[reg(I, 1)];
+    uint64_t Sign = Kind == FSgnjD ? S2 : Kind == FSgnjnD ? ~S2 : S1 ^ S2;
+    const uint64_t SignBit = 1ULL << 63;
+    F[reg(I, 0)] = (S1 & ~SignBit) | (Sign & SignBit);
+    break;
+  }
+  case FEqS: setX(reg(I, 0), getS(reg(I, 2)) == getS(reg(I, 1))); break;
+  case FLtS: setX(reg(I, 0), getS(reg(I, 2)) < getS(reg(I, 1))); break;
+  case FLeS: setX(reg(I, 0), getS(reg(I, 2)) <= getS(reg(I, 1))); break;
+  case FEqD: setX(reg(I, 0), getD(reg(I, 2)) == getD(reg(I, 1))); break;
+  case FLtD: setX(reg(I, 0), getD(reg(I, 2)) < getD(reg(I, 1))); break;
+  case FLeD: setX(reg(I, 0), getD(reg(I, 2)) <= getD(reg(I, 1))); break;
+
+  // Conversions and moves take: dst, src.
+#define FTOI(K, GET, SIGNED, BITS)                                             \
+  case K:                                                                      \
+    setX(reg(I, 0), fpToInt(GET(reg(I, 1)), DI.Info.RM, SIGNED, BITS));        \
+    break;
+  FTOI(FCvtWS, getS, true, 32)
+  FTOI(FCvtWUS, getS, false, 32)
+  FTOI(FCvtLS, getS, true, 64)
+  FTOI(FCvtLUS, getS, false, 64)
+  FTOI(FCvtWD, getD, true, 32)
+  FTOI(FCvtWUD, getD, false, 32)
+  FTOI(FCvtLD, getD, true, 64)
+  FTOI(FCvtLUD, getD, false, 64)
+#undef FTOI
+  case FCvtSW: setS(reg(I, 0), float(int32_t(X[reg(I, 1)]))); break;
+  case FCvtSWU: setS(reg(I, 0), float(uint32_t(X[reg(I, 1)]))); break;
+  case FCvtSL: setS(reg(I, 0), float(int64_t(X[reg(I, 1)]))); break;
+  case FCvtSLU: setS(reg(I, 0), float(X[reg(I, 1)])); break;
+  case FCvtDW: setD(reg(I, 0), double(int32_t(X[reg(I, 1)]))); break;
+  case FCvtDWU: setD(reg(I, 0), double(uint32_t(X[reg(I, 1)]))); break;
+  case FCvtDL: setD(reg(I, 0), double(int64_t(X[reg(I, 1)]))); break;
+  case FCvtDLU: setD(reg(I, 0), double(X[reg(I, 1)])); break;
+  case FCvtSD: setS(reg(I, 0), float(getD(reg(I, 1)))); break;
+  case FCvtDS: setD(reg(I, 0), double(getS(reg(I, 1)))); break;
+  case FMvXS: setX(reg(I, 0), int64_t(int32_t(F[reg(I, 1)]))); break;
+  case FMvSX: F[reg(I, 0)] = 0xffffffff00000000ULL | uint32_t(X[reg(I, 1)]);
+    break;
+  case FMvXD: setX(reg(I, 0), F[reg(I, 1)]); break;
+  case FMvDX: F[reg(I, 0)] = X[reg(I, 1)]; break;
+  }
+
+  PC = canonical(NextPC);
+  return true;
+}
+
+void Simulator::account(const DecodedInst &DI, bool Taken) {
+  if (!SM.hasInstrSchedModel())
+    return;
+
+  // Wait for the register operands.
+  const MCInst &I = DI.Inst;
+  const MCInstrDesc &Desc = MII.get(I.getOpcode());
+  unsigned NumDefs = Desc.getNumDefs();
+  uint64_t Ready = Cycle;
+  for (unsigned Op = NumDefs, E = I.getNumOperands(); Op != E; ++Op) {
+    if (!I.getOperand(Op).isReg())
+      continue;
+    for (MCRegUnitIterator U(I.getOperand(Op).getReg(), &MRI); U.isValid(); ++U)
+      Ready = std::max(Ready, RegUnitReady[*U]);
+  }
+
+  // Wait for the processor resources.
+  for (const MCWriteProcResEntry *WPR = DI.ResBegin; WPR != DI.ResEnd; ++WPR)
+    Ready = std::max(Ready, ResourceFree[WPR->ProcResourceIdx]);
+
+  // Dispatch at most IssueWidth micro-ops per cycle.
+  unsigned NumMicroOps = DI.NumMicroOps;
+  if (Ready > Cycle) {
+    Cycle = Ready;
+    SlotsUsed = 0;
+  }
+  if (SlotsUsed && SlotsUsed + NumMicroOps > SM.IssueWidth) {
+    ++Cycle;
+    SlotsUsed = 0;
+  }
+  uint64_t Issue = Cycle;
+  SlotsUsed += NumMicroOps;
+
+  for (const MCWriteProcResEntry *WPR = DI.ResBegin; WPR != DI.ResEnd; ++WPR)
+    ResourceFree[WPR->ProcResourceIdx] = Issue + WPR->Cycles;
+
+  uint64_t Done = Issue + DI.Latency;
+  for (unsigned Op = 0; Op != NumDefs && Op != I.getNumOperands(); ++Op)
+    if (I.getOperand(Op).isReg())
+      for (MCRegUnitIterator U(I.getOperand(Op).getReg(), &MRI); U.isValid();
+           ++U)
+        RegUnitReady[*U] = Done;
+  LastCompletion = std::max(LastCompletion, Done);
+
+  // Conditional branches are predicted backward-taken, forward-not-taken;
+  // indirect jumps are always mispredicted.
+  OpKind Kind = DI.Info.Kind;
+  bool IsBranch = Kind >= Beq && Kind <= Bleu;
+  bool IsIndirect = Kind == Jalr || Kind == Ret;
+  bool Mispredicted = IsIndirect || (IsBranch && Taken != (imm(I, 0) < 0));
+  if (Mispredicted) {
+    Cycle = Issue + 1 + SM.MispredictPenalty;
+    SlotsUsed = 0;
+  }
+}
+
+bool Simulator::run() {
+  while (true) {
+    if (MaxInstructions && NumInstructions == MaxInstructions)
+      return error("instruction limit reached");
+
+    const DecodedInst *DI = decode(PC);
+    if (!DI)
+      return false;
+    if (Trace)
+      errs() << format("%8" PRIx64 ": ", PC)
+             << MII.getName(DI->Inst.getOpcode()) << '\n';
+
+    bool Taken = false, Exited = false;
+    if (!execute(*DI, Taken, Exited))
+      return false;
+    ++NumInstructions;
+    ++OpcodeCounts[DI->Inst.getOpcode()];
+    account(*DI, Taken);
+
+    if (Exited)
+      return true;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// ELF loading
+//===----------------------------------------------------------------------===//
+
+/// Copy the allocated parts of an ELF file into memory.  Executables are
+/// loaded by segment; files without program headers are loaded section by
+/// section at their addresses.  Returns the end of the highest mapped byte.
+template <class ELFT>
+static bool loadELF(const ELFFile<ELFT> &EF, Memory &Mem, uint64_t &End) {
+  typedef typename ELFFile<ELFT>::Elf_Phdr Elf_Phdr;
+  typedef typename ELFFile<ELFT>::Elf_Shdr Elf_Shdr;
+  End = 0;
+  bool HasSegments = false;
+  for (const Elf_Phdr &Phdr : EF.program_headers()) {
+    if (Phdr.p_type != ELF::PT_LOAD)
+      continue;
+    HasSegments = true;
+    Mem.map(Phdr.p_vaddr, Phdr.p_memsz);
+    Mem.write(Phdr.p_vaddr, EF.base() + Phdr.p_offset,
+              std::min<uint64_t>(Phdr.p_filesz, Phdr.p_memsz));
+    End = std::max<uint64_t>(End, Phdr.p_vaddr + Phdr.p_memsz);
+  }
+  if (HasSegments)
+    return true;
+
+  for (const Elf_Shdr &Shdr : EF.sections()) {
+    if (!(Shdr.sh_flags & ELF::SHF_ALLOC) || Shdr.sh_size == 0)
+      continue;
+    Mem.map(Shdr.sh_addr, Shdr.sh_size);
+    if (Shdr.sh_type != ELF::SHT_NOBITS) {
+      ErrorOr<ArrayRef<uint8_t>> Contents = EF.getSectionContents(&Shdr);
+      if (!Contents)
+        return false;
+      Mem.write(Shdr.sh_addr, Contents->data(), Contents->size());
+    }
+    End = std::max<uint64_t>(End, Shdr.sh_addr + Shdr.sh_size);
+  }
+  return true;
+}
+
+static void printReport(const Simulator &Sim, const MCInstrInfo &MII) {
+  raw_ostream &OS = errs();
+  OS << "Exit code:     " << Sim.ExitCode << '\n';
+  OS << "Instructions:  " << Sim.NumInstructions << '\n';
+  if (Sim.hasCycleModel()) {
+    uint64_t Cycles = Sim.getCycles();
+    OS << "Cycles:        " << Cycles << '\n';
+    OS << "IPC:           "
+       << format("%.2f", Cycles ? double(Sim.NumInstructions) / Cycles : 0.0)
+       << '\n';
+  }
+  if (NoHistogram)
+    return;
+
+  std::vector<std::pair<uint64_t, unsigned>> Counts;
+  for (unsigned Opc = 0, E = Sim.OpcodeCounts.size(); Opc != E; ++Opc)
+    if (Sim.OpcodeCounts[Opc])
+      Counts.push_back(std::make_pair(Sim.OpcodeCounts[Opc], Opc));
+  // Most frequent first, ties broken by name for stable output.
+  std::sort(Counts.begin(), Counts.end(),
+            [&](const std::pair<uint64_t, unsigned> &A,
+                const std::pair<uint64_t, unsigned> &B) {
+              if (A.first != B.first)
+                return A.first > B.first;
+              return StringRef(MII.getName(A.second)) <
+                     StringRef(MII.getName(B.second));
+            });
+
+  OS << "\nOpcode histogram:\n";
+  for (const auto &C : Counts)
+    OS << format("  %-16s %10" PRIu64 " %6.2f%%\n", MII.getName(C.second),
+                 C.first, 100.0 * C.first / Sim.NumInstructions);
+}
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y; // Call llvm_shutdown() on exit.
+
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllDisassemblers();
+
+  cl::ParseCommandLineOptions(argc, argv, "RISC-V instruction set simulator\n");
+  ProgName = argv[0];
+
+  Expected<OwningBinary<ObjectFile>> BinaryOrErr =
+      ObjectFile::createObjectFile(InputFilename);
+  if (!BinaryOrErr) {
+    std::string Buf;
+    raw_string_ostream OS(Buf);
+    logAllUnhandledErrors(BinaryOrErr.takeError(), OS, "");
+    errs() << ProgName << ": '" << InputFilename << "': " << OS.str();
+    return 1;
+  }
+  ObjectFile &Obj = *BinaryOrErr->getBinary();
+  Triple::ArchType Arch = Triple::ArchType(Obj.getArch());
+  if (!Obj.isELF() || (Arch != Triple::riscv && Arch != Triple::riscv64)) {
+    errs() << ProgName << ": '" << InputFilename
+           << "': not a RISC-V ELF file\n";
+    return 1;
+  }
+  bool Is64 = Arch == Triple::riscv64;
+
+  // Pick a subtarget that decodes everything the simulator implements, then
+  // add what the selected CPU provides.
+  std::string TripleName = Is64 ? "riscv64-unknown-linux"
+                                : "riscv-unknown-linux";
+  std::string Error;
+  const Target *TheTarget =
+      TargetRegistry::lookupTarget(TripleName, Error);
+  if (!TheTarget) {
+    errs() << ProgName << ": " << Error << '\n';
+    return 1;
+  }
+  std::string CPU = MCPU;
+  if (CPU.empty())
+    CPU = Is64 ? "RV64IMAFD" : "RV32IMAFD";
+  SubtargetFeatures Features;
+  Features.AddFeature("rv32", !Is64);
+  Features.AddFeature("rv64", Is64);
+  for (StringRef F : {"m", "a", "f", "d"})
+    Features.AddFeature(F);
+  for (const std::string &Attr : MAttrs)
+    Features.AddFeature(Attr);
+
+  std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
+  std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
+  std::unique_ptr<MCInstrInfo> MII(TheTarget->createMCInstrInfo());
+  std::unique_ptr<MCSubtargetInfo> STI(TheTarget->createMCSubtargetInfo(
+      TripleName, CPU, Features.getString()));
+  if (!MRI || !MAI || !MII || !STI) {
+    errs() << ProgName << ": error: unable to create the RISC-V MC layer\n";
+    return 1;
+  }
+  MCObjectFileInfo MOFI;
+  MCContext Ctx(MAI.get(), MRI.get(), &MOFI);
+  std::unique_ptr<MCDisassembler> Dis(
+      TheTarget->createMCDisassembler(*STI, Ctx));
+  if (!Dis) {
+    errs() << ProgName << ": error: no disassembler for RISC-V\n";
+    return 1;
+  }
+
+  Memory Mem;
+  uint64_t End, Entry;
+  bool Loaded;
+  if (auto *ELF = dyn_cast<ELF32LEObjectFile>(&Obj)) {
+    Loaded = loadELF(*ELF->getELFFile(), Mem, End);
+    Entry = ELF->getELFFile()->getHeader()->e_entry;
+  } else if (auto *ELF = dyn_cast<ELF64LEObjectFile>(&Obj)) {
+    Loaded = loadELF(*ELF->getELFFile(), Mem, End);
+    Entry = ELF->getELFFile()->getHeader()->e_entry;
+  } else {
+    errs() << ProgName << ": '" << InputFilename
+           << "': big-endian RISC-V files are not supported\n";
+    return 1;
+  }
+  if (!Loaded) {
+    errs() << ProgName << ": '" << InputFilename
+           << "': malformed section contents\n";
+    return 1;
+  }
+
+  // The stack sits below 2GiB so that it is addressable on RV32 as well.
+  // argc, argv and envp are all zero.
+  const uint64_t StackTop = 0x7fff0000;
+  uint64_t StackBytes = uint64_t(StackSize) * 1024;
+  Mem.map(StackTop - StackBytes, StackBytes);
+  uint64_t Brk = alignTo(End, 4096);
+
+  Simulator Sim(*STI, *MII, *MRI, *Dis, Mem, Is64, Entry, StackTop - 64, Brk);
+  bool Success = Sim.run();
+  outs().flush();
+  printReport(Sim, *MII);
+  if (!Success)
+    return 1;
+  return Sim.ExitCode;
+}
@@ -48,6 +48,7 @@
 #include "llvm/Support/SystemUtils.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
@@ -220,6 +221,39 @@ static cl::opt<bool> PassRemarksWithHotness(
     cl::desc("With PGO, include profile count in optimization remarks"),
     cl::Hidden);
 
+static cl::opt<bool> TimeTrace(
+    "time-trace",
+    cl::desc("Record the time of each pass on each function in Chrome trace "
+             "event format"));
+
+static cl::opt<unsigned> TimeTraceGranularity(
+    "time-trace-granularity",
+    cl::desc("Minimum duration, in microseconds, of the sections written "
+             "by -time-trace"),
+    cl::init(500), cl::Hidden);
+
+static cl::opt<std::string>
+    TimeTraceFile("time-trace-file",
+                  cl::desc("Write the -time-trace output to this file instead "
+                           "of <output>.time-trace"),
+                  cl::value_desc("filename"));
+
+/// Write the -time-trace output. Return true on success.
+static bool writeTimeTrace(const char *Argv0) {
+  // Name the trace after the input when there is no output file.
+  StringRef TraceBase = OutputFilename.empty() || OutputFilename == "-"
+                            ? StringRef(InputFilename)
+                            : StringRef(OutputFilename);
+  std::error_code EC = timeTraceProfilerWrite(TimeTraceFile, TraceBase);
+  timeTraceProfilerCleanup();
+  if (EC) {
+    errs() << Argv0 << ": could not write the time trace: " << EC.message()
+           << '\n';
+    return false;
+  }
+  return true;
+}
+
 static inline void addPass(legacy::PassManagerBase &PM, Pass *P) {
   // Add the pass to the pass manager...
   PM.add(P);
@@ -383,6 +417,9 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  if (TimeTrace)
+    timeTraceProfilerInitialize(TimeTraceGranularity, argv[0]);
+
   SMDiagnostic Err;
 
   Context.setDiscardValueNames(DiscardValueNames);
@@ -474,11 +511,13 @@ int main(int argc, char **argv) {
     // The user has asked to use the new pass manager and provided a pipeline
     // string. Hand off the rest of the functionality to the new code for that
     // layer.
-    return runPassPipeline(argv[0], Context, *M, TM.get(), Out.get(),
-                           PassPipeline, OK, VK, PreserveAssemblyUseListOrder,
-                           PreserveBitcodeUseListOrder)
-               ? 0
-               : 1;
+    bool Success =
+        runPassPipeline(argv[0], Context, *M, TM.get(), Out.get(),
+                        PassPipeline, OK, VK, PreserveAssemblyUseListOrder,
+                        PreserveBitcodeUseListOrder);
+    if (TimeTrace && !writeTimeTrace(argv[0]))
+      return 1;
+    return Success ? 0 : 1;
   }
 
   // Create a PassManager to hold and optimize the collection of passes we are
@@ -676,7 +715,10 @@ int main(int argc, char **argv) {
   }
 
   // Now that we have all of the passes ready, run them.
-  Passes.run(*M);
+  {
+    TimeTraceScope TimeScope("Optimizer", M->getModuleIdentifier());
+    Passes.run(*M);
+  }
 
   // Compare the two outputs and make sure they're the same
   if (RunTwice) {
@@ -695,6 +737,9 @@ int main(int argc, char **argv) {
     Out->os() << BOS->str();
   }
 
+  if (TimeTrace && !writeTimeTrace(argv[0]))
+    return 1;
+
   // Declare success.
   if (!NoOutput || PrintBreakpoints)
     Out->keep();
@@ -0,0 +1,87 @@
+//===- llvm/unittest/ADT/StatisticTest.cpp - Statistic unit tests ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "unittest"
+STATISTIC(Counter, "Counts things");
+STATISTIC(ModuleCounter, "Counts things per module");
+
+namespace {
+
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
+
+TEST(StatisticTest, Count) {
+  Counter = 0;
+  EXPECT_EQ(0u, Counter);
+  ++Counter;
+  EXPECT_EQ(1u, Counter++);
+  Counter += 5;
+  EXPECT_EQ(7u, Counter);
+  EXPECT_EQ(7u, Counter--);
+  Counter -= 2;
+  EXPECT_EQ(4u, Counter);
+}
+
+TEST(StatisticTest, CountFromThreads) {
+  Counter = 3;
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I != 4; ++I)
+    Threads.emplace_back([] {
+      for (unsigned J = 0; J != 1000; ++J)
+        ++Counter;
+    });
+  for (std::thread &T : Threads)
+    T.join();
+  // The counts of the threads that exited are kept.
+  EXPECT_EQ(4003u, Counter);
+
+  // Setting the value clears the counts of every thread.
+  Counter = 1;
+  EXPECT_EQ(1u, Counter);
+}
+
+TEST(StatisticTest, PrintPerModuleJSON) {
+  // Only the statistics first bumped after the call are printed.
+  EnableStatistics();
+  {
+    StatisticModuleScope Scope("a.ll");
+    ModuleCounter += 2;
+  }
+  std::thread([] {
+    StatisticModuleScope Scope("dir\\b.ll");
+    ++ModuleCounter;
+  }).join();
+  EXPECT_EQ(3u, ModuleCounter);
+
+  std::string JSON;
+  raw_string_ostream OS(JSON);
+  PrintStatisticsJSON(OS);
+  OS.str();
+  EXPECT_NE(std::string::npos,
+            JSON.find("\t\"unittest.ModuleCounter\": 3"));
+  EXPECT_NE(std::string::npos, JSON.find("\t\"modules\": {\n"));
+  EXPECT_NE(std::string::npos,
+            JSON.find("\t\t\"a.ll\": {\n\t\t\t\"unittest.ModuleCounter\": 2\n"
+                      "\t\t}"));
+  EXPECT_NE(
+      std::string::npos,
+      JSON.find("\t\t\"dir\\\\b.ll\": {\n\t\t\t\"unittest.ModuleCounter\": 1\n"
+                "\t\t}"));
+}
+
+#endif
+
+} // end anonymous namespace
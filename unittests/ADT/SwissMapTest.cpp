@@ -0,0 +1,234 @@
+//===- llvm/unittest/ADT/SwissMapTest.cpp - SwissMap unit tests -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SwissMap.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(SwissMapTest, EmptyMap) {
+  SwissMap<unsigned, unsigned> Map;
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.size());
+  EXPECT_TRUE(Map.begin() == Map.end());
+  EXPECT_TRUE(Map.find(1) == Map.end());
+  EXPECT_EQ(0u, Map.count(1));
+  EXPECT_EQ(0u, Map.lookup(1));
+  EXPECT_FALSE(Map.erase(1));
+  EXPECT_EQ(0u, Map.getMemorySize());
+}
+
+TEST(SwissMapTest, InsertFindErase) {
+  SwissMap<unsigned, unsigned> Map;
+  EXPECT_TRUE(Map.insert(std::make_pair(1u, 10u)).second);
+  EXPECT_FALSE(Map.insert(std::make_pair(1u, 20u)).second);
+  EXPECT_EQ(10u, Map.lookup(1));
+  EXPECT_EQ(1u, Map.size());
+
+  // Keys that DenseMap reserves for its empty and tombstone keys are fine.
+  Map[~0u] = 1;
+  Map[~0u - 1] = 2;
+  EXPECT_EQ(1u, Map.lookup(~0u));
+  EXPECT_EQ(2u, Map.lookup(~0u - 1));
+  EXPECT_EQ(3u, Map.size());
+
+  auto It = Map.find(1);
+  ASSERT_TRUE(It != Map.end());
+  EXPECT_EQ(1u, It->first);
+  EXPECT_EQ(10u, It->second);
+  Map.erase(It);
+  EXPECT_EQ(0u, Map.count(1));
+  EXPECT_TRUE(Map.erase(~0u));
+  EXPECT_FALSE(Map.erase(~0u));
+  EXPECT_EQ(1u, Map.size());
+
+  Map.clear();
+  EXPECT_TRUE(Map.empty());
+  EXPECT_TRUE(Map.begin() == Map.end());
+}
+
+TEST(SwissMapTest, Iteration) {
+  SwissMap<int, int> Map;
+  for (int I = 0; I != 1000; ++I)
+    Map[I] = I * 2;
+  std::map<int, int> Seen;
+  for (const auto &KV : Map)
+    EXPECT_TRUE(Seen.insert(KV).second);
+  ASSERT_EQ(1000u, Seen.size());
+  for (const auto &KV : Seen)
+    EXPECT_EQ(KV.first * 2, KV.second);
+
+  const SwissMap<int, int> &ConstMap = Map;
+  SwissMap<int, int>::const_iterator CI = Map.begin();
+  EXPECT_TRUE(CI == ConstMap.begin());
+  EXPECT_EQ(1000, std::distance(ConstMap.begin(), ConstMap.end()));
+}
+
+TEST(SwissMapTest, EraseWhileIterating) {
+  // The DenseMap idiom for erasing while iterating works: erasing an entry
+  // leaves the iterators to the others valid.
+  SwissMap<int, int> Map;
+  for (int I = 0; I != 1000; ++I)
+    Map[I] = I;
+  for (auto I = Map.begin(), E = Map.end(); I != E;) {
+    auto Cur = I++;
+    if (Cur->first % 3 == 0)
+      Map.erase(Cur);
+  }
+  EXPECT_EQ(666u, Map.size());
+  for (int I = 0; I != 1000; ++I)
+    EXPECT_EQ(I % 3 != 0, Map.count(I) == 1);
+}
+
+TEST(SwissMapTest, PointerIntoBucketsArray) {
+  SwissMap<unsigned, unsigned> Map;
+  Map[1] = 1;
+  const void *Buckets = Map.getPointerIntoBucketsArray();
+  EXPECT_TRUE(Map.isPointerIntoBucketsArray(Buckets));
+  EXPECT_TRUE(Map.isPointerIntoBucketsArray(&Map.find(1)->second));
+  unsigned Local = 0;
+  EXPECT_FALSE(Map.isPointerIntoBucketsArray(&Local));
+
+  for (unsigned I = 2; I != 1000; ++I)
+    Map[I] = I;
+  EXPECT_NE(Buckets, Map.getPointerIntoBucketsArray());
+  EXPECT_TRUE(Map.isPointerIntoBucketsArray(&Map.find(999)->first));
+}
+
+TEST(SwissMapTest, ShrinkAndClear) {
+  SwissMap<unsigned, std::string> Map;
+  for (unsigned I = 0; I != 10000; ++I)
+    Map[I] = std::to_string(I);
+  for (unsigned I = 100; I != 10000; ++I)
+    Map.erase(I);
+  size_t MemorySize = Map.getMemorySize();
+  Map.shrink_and_clear();
+  EXPECT_TRUE(Map.empty());
+  EXPECT_TRUE(Map.begin() == Map.end());
+  EXPECT_LT(Map.getMemorySize(), MemorySize);
+
+  Map[5] = "5";
+  EXPECT_EQ("5", Map.lookup(5));
+  Map.erase(5);
+  Map.shrink_and_clear();
+  EXPECT_EQ(0u, Map.getMemorySize());
+}
+
+TEST(SwissMapTest, CopyAndMove) {
+  SwissMap<int, std::string> Map;
+  for (int I = 0; I != 100; ++I)
+    Map[I] = std::to_string(I);
+
+  SwissMap<int, std::string> Copy(Map);
+  EXPECT_EQ(100u, Copy.size());
+  EXPECT_EQ("42", Copy.lookup(42));
+
+  SwissMap<int, std::string> Moved(std::move(Copy));
+  EXPECT_EQ(100u, Moved.size());
+  EXPECT_TRUE(Copy.empty());
+  EXPECT_EQ("99", Moved.lookup(99));
+
+  Copy = Moved;
+  Copy.erase(7);
+  EXPECT_EQ(99u, Copy.size());
+  EXPECT_EQ(100u, Moved.size());
+
+  Moved = std::move(Copy);
+  EXPECT_EQ(0u, Moved.count(7));
+  EXPECT_EQ("8", Moved.lookup(8));
+
+  Moved.swap(Map);
+  EXPECT_EQ(1u, Moved.count(7));
+  EXPECT_EQ(0u, Map.count(7));
+}
+
+TEST(SwissMapTest, MoveOnlyValues) {
+  SwissMap<unsigned, std::unique_ptr<int>> Map;
+  for (unsigned I = 0; I != 300; ++I)
+    Map.try_emplace(I, new int(I));
+  EXPECT_FALSE(Map.try_emplace(5u, nullptr).second);
+  for (unsigned I = 0; I != 300; ++I)
+    EXPECT_EQ(int(I), *Map.find(I)->second);
+}
+
+TEST(SwissMapTest, Reserve) {
+  SwissMap<unsigned, unsigned> Map;
+  Map.reserve(1000);
+  size_t MemorySize = Map.getMemorySize();
+  for (unsigned I = 0; I != 1000; ++I)
+    Map[I] = I;
+  EXPECT_EQ(MemorySize, Map.getMemorySize());
+
+  SwissMap<unsigned, unsigned> Reserved(14);
+  MemorySize = Reserved.getMemorySize();
+  for (unsigned I = 0; I != 14; ++I)
+    Reserved[I] = I;
+  EXPECT_EQ(MemorySize, Reserved.getMemorySize());
+}
+
+TEST(SwissMapTest, ChurnDoesNotGrow) {
+  // A map that keeps about the same number of entries while keys come and go
+  // reuses the erased slots instead of growing.
+  SwissMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != 500; ++I)
+    Map[I] = I;
+  size_t MemorySize = Map.getMemorySize();
+  for (unsigned I = 500; I != 100000; ++I) {
+    EXPECT_TRUE(Map.erase(I - 500));
+    Map[I] = I;
+  }
+  EXPECT_EQ(500u, Map.size());
+  EXPECT_EQ(MemorySize, Map.getMemorySize());
+  for (unsigned I = 100000 - 500; I != 100000; ++I)
+    EXPECT_EQ(I, Map.lookup(I));
+}
+
+TEST(SwissMapTest, PointerKeys) {
+  std::vector<int> Objects(5000);
+  SwissMap<int *, unsigned> Map;
+  for (unsigned I = 0; I != Objects.size(); ++I)
+    Map[&Objects[I]] = I;
+  for (unsigned I = 0; I != Objects.size(); ++I)
+    EXPECT_EQ(I, Map.lookup(&Objects[I]));
+  EXPECT_EQ(0u, Map.count(nullptr));
+}
+
+TEST(SwissMapTest, RandomOperations) {
+  // Compare with std::map through a random mix of insertions and erasures.
+  std::mt19937 Gen(1);
+  std::uniform_int_distribution<unsigned> KeyDist(0, 4000);
+  SwissMap<unsigned, unsigned> Map;
+  std::map<unsigned, unsigned> Ref;
+  for (unsigned I = 0; I != 100000; ++I) {
+    unsigned Key = KeyDist(Gen);
+    if (Gen() % 3 == 0) {
+      EXPECT_EQ(Ref.erase(Key) != 0, Map.erase(Key));
+    } else {
+      Ref[Key] = I;
+      Map[Key] = I;
+    }
+  }
+  ASSERT_EQ(Ref.size(), Map.size());
+  for (const auto &KV : Ref)
+    EXPECT_EQ(KV.second, Map.lookup(KV.first));
+  unsigned Count = 0;
+  for (const auto &KV : Map) {
+    EXPECT_EQ(Ref[KV.first], KV.second);
+    ++Count;
+  }
+  EXPECT_EQ(Ref.size(), Count);
+}
+
+} // end anonymous namespace
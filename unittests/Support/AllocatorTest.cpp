@@ -10,6 +10,7 @@
 #include "llvm/Support/Allocator.h"
 #include "gtest/gtest.h"
 #include <cstdlib>
+#include <cstring>
 
 using namespace llvm;
 
@@ -185,4 +186,72 @@ TEST(AllocatorTest, TestBigAlignment) {
   EXPECT_GT(MockSlabAllocator::GetLastSlabSize(), 4096u);
 }
 
+// The slabs of a destroyed allocator are reused by the next one.
+TEST(AllocatorTest, SlabCacheReuse) {
+  SlabCacheAllocator::releaseThreadCache();
+  SlabCacheStatistics Before = SlabCacheAllocator::getStatistics();
+  for (unsigned I = 0; I != 10; ++I) {
+    CachingBumpPtrAllocator Alloc;
+    for (unsigned J = 0; J != 4; ++J)
+      memset(Alloc.Allocate(3000, 1), 0, 3000);
+    EXPECT_EQ(4U, Alloc.GetNumSlabs());
+    // Custom sized slabs are not cached.
+    Alloc.Allocate(10000, 8);
+  }
+  SlabCacheStatistics After = SlabCacheAllocator::getStatistics();
+  EXPECT_GE(After.SlabsAllocated - Before.SlabsAllocated, 1U);
+  EXPECT_LE(After.SlabsAllocated - Before.SlabsAllocated, 4U);
+  EXPECT_GE(After.SlabsReused - Before.SlabsReused, 36U);
+}
+
+class DestructorCounter {
+  unsigned &Count;
+
+public:
+  DestructorCounter(unsigned &Count) : Count(Count) {}
+  ~DestructorCounter() { ++Count; }
+};
+
+TEST(AllocatorTest, SpecificSlabCacheAllocator) {
+  unsigned Count = 0;
+  {
+    SpecificBumpPtrAllocator<DestructorCounter, SlabCacheAllocator> Alloc;
+    for (unsigned I = 0; I != 2000; ++I)
+      new (Alloc.Allocate()) DestructorCounter(Count);
+    Alloc.DestroyAll();
+    EXPECT_EQ(2000U, Count);
+    new (Alloc.Allocate()) DestructorCounter(Count);
+  }
+  EXPECT_EQ(2001U, Count);
+}
+
+TEST(AllocatorTest, SlabCacheLimits) {
+  // Without a cache, every slab goes back to malloc.
+  SlabCacheAllocator::setLimits(0, 0);
+  SlabCacheStatistics Before = SlabCacheAllocator::getStatistics();
+  EXPECT_EQ(0U, Before.SharedPoolBytes);
+  {
+    CachingBumpPtrAllocator Alloc;
+    for (unsigned J = 0; J != 4; ++J)
+      Alloc.Allocate(3000, 1);
+  }
+  SlabCacheStatistics After = SlabCacheAllocator::getStatistics();
+  EXPECT_EQ(4U, After.SlabsAllocated - Before.SlabsAllocated);
+  EXPECT_EQ(4U, After.SlabsFreed - Before.SlabsFreed);
+  EXPECT_EQ(0U, After.SharedPoolBytes);
+
+  // The slabs of a thread go to the shared pool, for the other threads.
+  SlabCacheAllocator::setLimits(2, 1 << 20);
+  {
+    CachingBumpPtrAllocator Alloc;
+    for (unsigned J = 0; J != 4; ++J)
+      Alloc.Allocate(3000, 1);
+  }
+  EXPECT_EQ(2 * 4096U, SlabCacheAllocator::getStatistics().SharedPoolBytes);
+  SlabCacheAllocator::releaseThreadCache();
+  EXPECT_EQ(4 * 4096U, SlabCacheAllocator::getStatistics().SharedPoolBytes);
+
+  SlabCacheAllocator::setLimits(16, 32 << 20);
+}
+
 }  // anonymous namespace
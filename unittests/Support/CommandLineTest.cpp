@@ -393,6 +393,44 @@ TEST(CommandLineTest, ReparseCommandLineOptions) {
   EXPECT_TRUE(TopLevelOpt);
 }
 
+TEST(CommandLineTest, RegisterOptionAfterParsing) {
+  cl::ResetCommandLineParser();
+
+  StackOption<bool> FirstOpt("first-opt", cl::init(false));
+  const char *args0[] = {"prog", "-first-opt"};
+  EXPECT_TRUE(cl::ParseCommandLineOptions(2, args0, nullptr, true));
+  EXPECT_TRUE(FirstOpt);
+
+  // An option registered once the command line was parsed is found by the
+  // next parse and by getRegisteredOptions().
+  StackOption<bool> LateOpt("late-opt", cl::init(false));
+  EXPECT_EQ(1u, cl::getRegisteredOptions().count("late-opt"));
+
+  const char *args1[] = {"prog", "-late-opt"};
+  cl::ResetAllOptionOccurrences();
+  EXPECT_TRUE(cl::ParseCommandLineOptions(2, args1, nullptr, true));
+  EXPECT_TRUE(LateOpt);
+}
+
+TEST(CommandLineTest, ParseQueuedOptions) {
+  cl::ResetCommandLineParser();
+
+  // The parser finds the named options before they are added to the option
+  // maps. A prefixed option is only found once they are.
+  StackOption<std::string> ValueOpt("value-opt");
+  StackOption<std::string> PrefixOpt("P", cl::Prefix);
+  const char *args0[] = {"prog", "-value-opt=v", "-Pp"};
+  EXPECT_TRUE(cl::ParseCommandLineOptions(3, args0, nullptr, true));
+  EXPECT_EQ("v", ValueOpt.getValue());
+  EXPECT_EQ("p", PrefixOpt.getValue());
+
+  // A required option is checked even if the command line does not name it.
+  StackOption<bool> RequiredOpt("required-opt", cl::Required);
+  const char *args1[] = {"prog", "-value-opt=w"};
+  cl::ResetAllOptionOccurrences();
+  EXPECT_FALSE(cl::ParseCommandLineOptions(2, args1, nullptr, true));
+}
+
 TEST(CommandLineTest, RemoveFromRegularSubCommand) {
   cl::ResetCommandLineParser();
 
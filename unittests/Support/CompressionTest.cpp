@@ -13,8 +13,10 @@
 
 #include "llvm/Support/Compression.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Config/config.h"
+#include "llvm/Support/Parallel.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -59,6 +61,57 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+void TestZlibParallelCompression(StringRef Input, zlib::CompressionLevel Level,
+                                 size_t ChunkSize) {
+  SmallString<32> Compressed;
+  SmallString<32> Uncompressed;
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressParallel(Input, Compressed, Level, ChunkSize));
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::uncompress(Compressed, Uncompressed, Input.size()));
+  EXPECT_EQ(Input, Uncompressed);
+
+  // The output does not depend on the number of threads.
+  unsigned SavedThreads = parallel::ThreadsRequested;
+  parallel::ThreadsRequested = 1;
+  SmallString<32> SerialCompressed;
+  EXPECT_EQ(zlib::StatusOK, zlib::compressParallel(Input, SerialCompressed,
+                                                   Level, ChunkSize));
+  parallel::ThreadsRequested = SavedThreads;
+  EXPECT_EQ(Compressed, SerialCompressed);
+}
+
+TEST(CompressionTest, ZlibParallel) {
+  // Inputs that fit in a chunk are compressed as by compress().
+  SmallString<32> Compressed;
+  SmallString<32> ParallelCompressed;
+  EXPECT_EQ(zlib::StatusOK, zlib::compress("hello, world!", Compressed));
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressParallel("hello, world!", ParallelCompressed));
+  EXPECT_EQ(Compressed, ParallelCompressed);
+
+  TestZlibParallelCompression("hello, world!", zlib::DefaultCompression, 1);
+  TestZlibParallelCompression("hello, world!", zlib::NoCompression, 5);
+
+  // Text with matches across chunk boundaries, and a final partial chunk.
+  std::string Text;
+  for (unsigned I = 0; Text.size() < 300000; ++I)
+    Text += "line " + utostr(I % 1000) + ": hello, world!\n";
+  for (zlib::CompressionLevel Level :
+       {zlib::NoCompression, zlib::BestSpeedCompression,
+        zlib::DefaultCompression, zlib::BestSizeCompression}) {
+    TestZlibParallelCompression(Text, Level, 4096);
+    TestZlibParallelCompression(Text, Level, 65536);
+  }
+
+  // Chunking costs little compression.
+  EXPECT_EQ(zlib::StatusOK, zlib::compress(Text, Compressed));
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressParallel(Text, ParallelCompressed,
+                                   zlib::DefaultCompression, 65536));
+  EXPECT_LT(ParallelCompressed.size(), Compressed.size() * 11 / 10);
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
@@ -11,6 +11,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
@@ -118,4 +119,57 @@ TEST(FileOutputBuffer, Test) {
   // Clean up.
   ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
 }
+
+TEST(FileOutputBuffer, Stream) {
+  SmallString<128> TestDirectory;
+  ASSERT_NO_ERROR(
+      fs::createUniqueDirectory("FileOutputBuffer-test", TestDirectory));
+  SmallString<128> File(TestDirectory);
+  File.append("/file");
+
+  // Interleave plain and deferred writes, with a fixup of the header. Lay the
+  // output out both in a mapping, where the deferred writes are large enough
+  // to be filled in parallel, and in memory.
+  std::string Expected = "HEAD" + std::string(1200000, 'a') + "middle" +
+                         std::string(7, 'b') + std::string(3000, 'c') + "Tail";
+  for (uint64_t MinMapSize : {uint64_t(0), uint64_t(1) << 30}) {
+    {
+      raw_output_buffer_ostream OS(File, MinMapSize);
+      OS << "head";
+      OS.writeDeferred(1200000, [](raw_pwrite_stream &S) {
+        S << std::string(600000, 'a');
+        S << std::string(600000, 'a');
+      });
+      OS << "middle";
+      OS.writeDeferred(7, [](raw_pwrite_stream &S) { S << "bbbbbbb"; });
+      OS.writeDeferred(3000, [](raw_pwrite_stream &S) {
+        S << std::string(3000, 'x');
+        S.pwrite(std::string(3000, 'c').data(), 3000, 0);
+      });
+      OS << "tail";
+      EXPECT_EQ(Expected.size(), OS.tell());
+      OS.pwrite("HEAD", 4, 0);
+      OS.flushDeferred();
+      EXPECT_EQ(MinMapSize == 0, OS.isMapped());
+      OS.pwrite("T", 1, Expected.size() - 4);
+      ASSERT_NO_ERROR(OS.commit());
+    }
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+        MemoryBuffer::getFile(File);
+    ASSERT_TRUE(bool(BufferOrErr));
+    EXPECT_EQ(Expected, (*BufferOrErr)->getBuffer().str());
+    ASSERT_NO_ERROR(fs::remove(File.str()));
+  }
+
+  // Nothing is written without a commit.
+  {
+    raw_output_buffer_ostream OS(File);
+    OS << "contents";
+    OS.flushDeferred();
+  }
+  ASSERT_EQ(fs::access(Twine(File), fs::AccessMode::Exist),
+            errc::no_such_file_or_directory);
+
+  ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
+}
 } // anonymous namespace
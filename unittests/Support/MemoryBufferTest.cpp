@@ -12,9 +12,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#ifdef __linux__
+#include <unistd.h>
+#endif
 
 using namespace llvm;
 
@@ -222,4 +226,61 @@ TEST_F(MemoryBufferTest, slice) {
   EXPECT_TRUE(BufData2.substr(0x1800,8).equals("abcdefgh"));
   EXPECT_TRUE(BufData2.substr(0x2FF8,8).equals("abcdefgh"));
 }
+
+TEST_F(MemoryBufferTest, FileHints) {
+  // Create a file large enough to be aligned for huge pages, with a short
+  // last page so that it can be mapped with a null terminator.
+  int FD;
+  SmallString<64> TestPath;
+  sys::fs::createTemporaryFile("MemoryBufferTest_FileHints", "temp", FD,
+                               TestPath);
+  raw_fd_ostream OF(FD, true);
+  const unsigned NumLines = (9 << 20) / 8;
+  for (unsigned i = 0; i < NumLines; ++i)
+    OF << format("%07x\n", i);
+  OF << "end";
+  OF.close();
+
+  typedef sys::fs::mapped_file_region MFR;
+  const unsigned Flags[] = {MFR::none, MFR::sequential, MFR::random,
+                            MFR::populate, MFR::sequential | MFR::huge_pages,
+                            MFR::random | MFR::populate | MFR::huge_pages};
+  for (unsigned MapFlags : Flags) {
+    ErrorOr<OwningBuffer> MB = MemoryBuffer::getFile(
+        TestPath, MemoryBuffer::FileHints(MapFlags, 1 << 20));
+    ASSERT_FALSE(MB.getError());
+    EXPECT_EQ(MemoryBuffer::MemoryBuffer_MMap, MB.get()->getBufferKind());
+
+    StringRef BufData = MB.get()->getBuffer();
+    ASSERT_EQ(NumLines * 8 + 3, BufData.size());
+    EXPECT_EQ("0000000\n", BufData.substr(0, 8));
+    EXPECT_EQ("0100000\n", BufData.substr(0x100000 * 8, 8));
+    EXPECT_EQ("end", BufData.substr(NumLines * 8));
+    EXPECT_EQ('\0', *MB.get()->getBufferEnd());
+#ifdef __linux__
+    if (MapFlags & MFR::huge_pages) {
+      EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(BufData.data()) % (2 << 20));
+    }
+#endif
+  }
+
+#ifdef __linux__
+  // A region mapped from an offset starts at an address congruent to the
+  // offset modulo the huge page size.
+  int ReadFD;
+  EXPECT_FALSE(sys::fs::openFileForRead(TestPath.c_str(), ReadFD));
+  uint64_t Offset = 3 * MFR::alignment();
+  std::error_code EC;
+  MFR Region(ReadFD, MFR::readonly, 8 << 20, Offset, EC, MFR::huge_pages);
+  ::close(ReadFD);
+  ASSERT_FALSE(EC);
+  EXPECT_EQ(Offset % (2 << 20),
+            reinterpret_cast<uintptr_t>(Region.const_data()) % (2 << 20));
+  SmallString<8> Line;
+  raw_svector_ostream(Line) << format("%07x\n", unsigned(Offset / 8));
+  EXPECT_EQ(Line, StringRef(Region.const_data(), 8));
+#endif
+
+  sys::fs::remove(TestPath);
+}
 }
@@ -0,0 +1,135 @@
+//===- unittests/Support/ParallelTest.cpp - Parallel algorithm tests ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/Parallel.h"
+#include "gtest/gtest.h"
+#include <array>
+#include <atomic>
+#include <random>
+#include <thread>
+
+using namespace llvm;
+
+namespace {
+
+/// Run the tests on several threads, even on a single core host.
+class ParallelTest : public testing::Test {
+  unsigned Saved;
+
+protected:
+  ParallelTest() : Saved(parallel::ThreadsRequested) {
+    parallel::ThreadsRequested = 4;
+  }
+  ~ParallelTest() override { parallel::ThreadsRequested = Saved; }
+};
+
+TEST_F(ParallelTest, ParallelFor) {
+  std::vector<unsigned> Counts(10000);
+  parallel_for(0, Counts.size(), [&](size_t I) { ++Counts[I]; });
+  for (unsigned Count : Counts)
+    EXPECT_EQ(1u, Count);
+
+  // An explicit grain size, which does not divide the range.
+  std::vector<unsigned> Range(1000);
+  parallel_for(7, 1000, [&](size_t I) { Range[I] = I; }, 64);
+  for (size_t I = 0; I != Range.size(); ++I)
+    EXPECT_EQ(I < 7 ? 0u : I, Range[I]);
+
+  // An empty range.
+  parallel_for(5, 5, [](size_t) { FAIL(); });
+}
+
+TEST_F(ParallelTest, ParallelForEach) {
+  std::array<unsigned, 1000> Values;
+  for (unsigned I = 0; I != Values.size(); ++I)
+    Values[I] = I;
+  std::atomic<unsigned> Sum(0);
+  parallel_for_each(Values, [&](unsigned V) { Sum += V; });
+  EXPECT_EQ(999u * 1000 / 2, Sum);
+}
+
+TEST_F(ParallelTest, ParallelSort) {
+  std::mt19937 Gen(42);
+  std::vector<uint32_t> Values(100000);
+  for (uint32_t &V : Values)
+    V = Gen();
+  std::vector<uint32_t> Expected = Values;
+  std::sort(Expected.begin(), Expected.end());
+
+  parallel_sort(Values.begin(), Values.end());
+  EXPECT_EQ(Expected, Values);
+
+  // Already sorted, in reverse, and all equal.
+  parallel_sort(Values.begin(), Values.end(), std::greater<uint32_t>());
+  EXPECT_TRUE(std::is_sorted(Values.rbegin(), Values.rend()));
+  parallel_sort(Values.begin(), Values.end());
+  EXPECT_EQ(Expected, Values);
+  std::vector<uint32_t> Same(5000, 7);
+  parallel_sort(Same.begin(), Same.end());
+  EXPECT_EQ(std::vector<uint32_t>(5000, 7), Same);
+}
+
+TEST_F(ParallelTest, ParallelTransformReduce) {
+  std::vector<uint64_t> Values(12345);
+  for (size_t I = 0; I != Values.size(); ++I)
+    Values[I] = I;
+  uint64_t Sum = parallel_transform_reduce(
+      Values.begin(), Values.end(), uint64_t(3),
+      [](uint64_t A, uint64_t B) { return A + B; },
+      [](uint64_t V) { return V * 2; });
+  EXPECT_EQ(3 + 12344u * 12345, Sum);
+
+  // The chunks are reduced in order, so non-commutative reductions work.
+  std::vector<std::string> Strings;
+  for (unsigned I = 0; I != 3000; ++I)
+    Strings.push_back(std::string(1, 'a' + I % 26));
+  std::string Concat = parallel_transform_reduce(
+      Strings.begin(), Strings.end(), std::string(">"),
+      [](std::string A, const std::string &B) { return A + B; },
+      [](const std::string &S) { return S; });
+  std::string Expected = ">";
+  for (const std::string &S : Strings)
+    Expected += S;
+  EXPECT_EQ(Expected, Concat);
+
+  EXPECT_EQ(5, parallel_transform_reduce(
+                   Values.begin(), Values.begin(), 5,
+                   [](int A, int B) { return A + B; },
+                   [](uint64_t) { return 1; }));
+}
+
+TEST_F(ParallelTest, Sequential) {
+  // With one thread, everything runs in order on the calling thread.
+  parallel::ThreadsRequested = 1;
+  std::thread::id Caller = std::this_thread::get_id();
+  std::vector<size_t> Order;
+  parallel_for(0, 5000, [&](size_t I) {
+    EXPECT_EQ(Caller, std::this_thread::get_id());
+    Order.push_back(I);
+  });
+  ASSERT_EQ(5000u, Order.size());
+  for (size_t I = 0; I != Order.size(); ++I)
+    EXPECT_EQ(I, Order[I]);
+}
+
+TEST_F(ParallelTest, Nested) {
+  // Algorithms called from the tasks of another must not deadlock.
+  std::atomic<unsigned> Count(0);
+  parallel_for(0, 64, [&](size_t) {
+    std::vector<unsigned> Values(2000);
+    for (unsigned I = 0; I != Values.size(); ++I)
+      Values[I] = Values.size() - I;
+    parallel_sort(Values.begin(), Values.end());
+    EXPECT_TRUE(std::is_sorted(Values.begin(), Values.end()));
+    parallel_for(0, 100, [&](size_t) { ++Count; }, 1);
+  }, 1);
+  EXPECT_EQ(6400u, Count);
+}
+
+} // end anonymous namespace
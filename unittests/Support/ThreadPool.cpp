@@ -166,3 +166,55 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   }
   ASSERT_EQ(5, checked_in);
 }
+
+TEST_F(ThreadPoolTest, TaskGroup) {
+  CHECK_UNSUPPORTED();
+  ThreadPool Pool{2};
+  std::atomic_int checked_in{0};
+  std::atomic_int other{0};
+  Pool.async([this, &other] {
+    waitForMainThread();
+    ++other;
+  });
+  // Waiting for a group does not wait for the tasks of other groups.
+  ThreadPoolTaskGroup Group(Pool);
+  for (size_t i = 0; i < 10; ++i)
+    Group.async([&checked_in] { ++checked_in; });
+  Group.wait();
+  ASSERT_EQ(10, checked_in);
+  ASSERT_EQ(0, other);
+  setMainThreadReady();
+  Pool.wait();
+  ASSERT_EQ(1, other);
+}
+
+TEST_F(ThreadPoolTest, NestedTaskGroups) {
+  CHECK_UNSUPPORTED();
+  // Tasks waiting for their subtasks run them in the meantime, so this does
+  // not deadlock even with a single thread.
+  ThreadPool Pool{1};
+  std::atomic_int checked_in{0};
+  ThreadPoolTaskGroup Outer(Pool);
+  for (size_t i = 0; i < 4; ++i) {
+    Outer.async([&Pool, &checked_in] {
+      ThreadPoolTaskGroup Inner(Pool);
+      for (size_t j = 0; j < 8; ++j)
+        Inner.async([&checked_in] { ++checked_in; });
+      Inner.wait();
+    });
+  }
+  Outer.wait();
+  ASSERT_EQ(32, checked_in);
+}
+
+TEST_F(ThreadPoolTest, NoThreads) {
+  CHECK_UNSUPPORTED();
+  // Without threads, the tasks run on the thread that waits for them.
+  ThreadPool Pool{0};
+  std::atomic_int checked_in{0};
+  for (size_t i = 0; i < 5; ++i)
+    Pool.async([&checked_in] { ++checked_in; });
+  ASSERT_EQ(0, checked_in);
+  Pool.wait();
+  ASSERT_EQ(5, checked_in);
+}
@@ -143,6 +143,16 @@ TEST(raw_ostreamTest, WriteEscaped) {
   EXPECT_EQ("\\001\\010\\200", Str);
 }
 
+TEST(raw_ostreamTest, WriteJSONString) {
+  std::string Str;
+  raw_string_ostream(Str).write_json_string("hi");
+  EXPECT_EQ("\"hi\"", Str);
+
+  Str = "";
+  raw_string_ostream(Str).write_json_string("\\\t\n\"\1\37\200");
+  EXPECT_EQ("\"\\\\\\t\\n\\\"\\u0001\\u001f\200\"", Str);
+}
+
 TEST(raw_ostreamTest, Justify) {  
   EXPECT_EQ("xyz   ", printToString(left_justify("xyz", 6), 6));
   EXPECT_EQ("abc",    printToString(left_justify("abc", 3), 3));
@@ -0,0 +1,73 @@
+//===- llvm/unittest/Support/xxhashTest.cpp -------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/xxhash.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+TEST(xxhashTest, Basic) {
+  EXPECT_EQ(0xef46db3751d8e999U, xxHash64(StringRef()));
+  EXPECT_EQ(0x33bf00a859c4ba3fU, xxHash64("foo"));
+  EXPECT_EQ(0x48a37c90ad27a659U, xxHash64("bar"));
+  EXPECT_EQ(0x69196c1b3af0bff9U,
+            xxHash64("0123456789abcdefghijklmnopqrstuvwxyz"));
+}
+
+TEST(xxhashTest, Seed) {
+  EXPECT_NE(xxHash64("foo"), xxHash64("foo", 1));
+  EXPECT_EQ(xxHash64("foo", 1), xxHash64("foo", 1));
+}
+
+TEST(xxhashTest, Streaming) {
+  std::vector<uint8_t> Data(1000);
+  for (unsigned I = 0; I != Data.size(); ++I)
+    Data[I] = I * 7 + I / 3;
+
+  // Every length, split at every position of the first stripes.
+  for (size_t Length : {0, 1, 4, 7, 8, 31, 32, 33, 63, 64, 100, 1000}) {
+    ArrayRef<uint8_t> Input(Data.data(), Length);
+    uint64_t Expected = xxHash64(Input, 42);
+    for (size_t Split = 0; Split <= std::min<size_t>(Length, 70); ++Split) {
+      XXHash64 Hasher(42);
+      Hasher.update(Input.slice(0, Split));
+      Hasher.update(Input.slice(Split));
+      EXPECT_EQ(Expected, Hasher.digest()) << Length << " " << Split;
+    }
+
+    // Byte by byte, looking at the intermediate results along the way.
+    XXHash64 Hasher(42);
+    for (size_t I = 0; I != Length; ++I) {
+      Hasher.update(Input.slice(I, 1));
+      EXPECT_EQ(xxHash64(Input.slice(0, I + 1), 42), Hasher.digest());
+    }
+    EXPECT_EQ(Expected, Hasher.digest());
+  }
+}
+
+TEST(xxhashTest, Hash128) {
+  XXHash128Result Foo = xxHash128("foo");
+  EXPECT_EQ(xxHash64("foo"), Foo.High);
+  EXPECT_NE(Foo.High, Foo.Low);
+  EXPECT_NE(Foo, xxHash128("bar"));
+  EXPECT_EQ(32u, Foo.toHex().size());
+  EXPECT_EQ("33bf00a859c4ba3f", Foo.toHex().substr(0, 16));
+
+  XXHash128 Hasher;
+  Hasher.update("fo");
+  Hasher.update("o");
+  EXPECT_EQ(Foo, Hasher.digest());
+  Hasher.init();
+  EXPECT_EQ(xxHash128(""), Hasher.digest());
+}
+
+} // end anonymous namespace
@@ -773,6 +773,17 @@ std::string TreePredicateFn::getFnName() const {
   return "Predicate_" + PatFragRec->getRecord()->getName();
 }
 
+/// getCodeToRunOnConstantInt - Return the code for the function body that
+/// evaluates this predicate on the value of a constant.  ImmLeaf predicates
+/// get the value as "Imm", like on SelectionDAG, and PatLeaf predicates on imm
+/// only use the accessors that ConstantSDNode and ConstantInt share.
+std::string TreePredicateFn::getCodeToRunOnConstantInt() const {
+  std::string ImmCode = getImmCode();
+  if (!ImmCode.empty())
+    return "    int64_t Imm = N->getSExtValue();\n" + ImmCode;
+  return getPredCode();
+}
+
 /// getCodeToRunOnSDNode - Return the code for the function body that
 /// evaluates this predicate.  The argument is expected to be in "Node",
 /// not N.  This handles casting and conversion to a concrete node type as
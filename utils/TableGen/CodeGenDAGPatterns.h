@@ -309,6 +309,12 @@ public:
   /// not N.  This handles casting and conversion to a concrete node type as
   /// appropriate.
   std::string getCodeToRunOnSDNode() const;
+
+  /// getCodeToRunOnConstantInt - Return the code for the function body that
+  /// evaluates this predicate on the value of a constant, which is expected
+  /// to be in "N" as a const ConstantInt *. This is what the GlobalISel
+  /// selector uses for the predicates on imm nodes.
+  std::string getCodeToRunOnConstantInt() const;
   
 private:
   std::string getPredCode() const;
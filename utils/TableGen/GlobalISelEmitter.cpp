@@ -0,0 +1,389 @@
+//===- GlobalISelEmitter.cpp - Generate an instruction selector -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// This tablegen backend emits code for use by the GlobalISel instruction
+/// selector. See include/llvm/Target/TargetGlobalISel.td.
+///
+/// This file analyzes the patterns recognized by the SelectionDAGISel tablegen
+/// backend, filters out the ones that are unsupported, maps
+/// SelectionDAG-specific constructs to their GlobalISel counterpart
+/// (when applicable: MVT to size, SDNode to generic Instruction, ...) and
+/// emits a match table walked by InstructionSelector::selectFromTable.
+///
+/// For now, the supported patterns are single operations on scalar integers
+/// whose operands are registers or a single immediate, and whose result is a
+/// single target instruction.
+///
+/// Not all patterns are supported: pass the tablegen invocation
+/// "-warn-on-skipped-patterns" to emit a warning when a pattern is skipped,
+/// as well as why.
+///
+/// The emitted code defines members of the <Target>InstructionSelector
+/// class: selectImpl, checkPredicates and checkImmPredicate. That class is
+/// expected to provide the TII, TRI and RBI members as well as the Subtarget
+/// object that the pattern predicates refer to.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeGenDAGPatterns.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineValueType.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/TableGen/Error.h"
+#include "llvm/TableGen/Record.h"
+#include "llvm/TableGen/TableGenBackend.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+using namespace llvm;
+
+#define DEBUG_TYPE "gisel-emitter"
+
+STATISTIC(NumPatternTotal, "Total number of patterns");
+STATISTIC(NumPatternSkipped, "Number of patterns skipped");
+STATISTIC(NumPatternEmitted, "Number of patterns emitted");
+
+static cl::opt<bool> WarnOnSkippedPatterns(
+    "warn-on-skipped-patterns",
+    cl::desc("Explain why a pattern was skipped for inclusion "
+             "in the GlobalISel selector"),
+    cl::init(false));
+
+namespace {
+
+/// One row of the match table, see InstructionSelector::MatchTableEntry.
+struct MatchRow {
+  const CodeGenInstruction *GenericInst;
+  unsigned SizeInBits;
+  int ImmOperand;
+  unsigned ImmPredicateID;
+  unsigned PredicatesID;
+  const CodeGenInstruction *TargetInst;
+  std::vector<int> OperandMap;
+  /// Pattern the row was imported from, and its complexity.
+  const PatternToMatch *Pattern;
+  int Complexity;
+};
+
+class GlobalISelEmitter {
+public:
+  explicit GlobalISelEmitter(RecordKeeper &RK);
+  void run(raw_ostream &OS);
+
+private:
+  const RecordKeeper &RK;
+  const CodeGenDAGPatterns CGP;
+  const CodeGenTarget &Target;
+
+  /// Keep track of the equivalence between SDNodes and Instruction.
+  /// This is defined using 'GINodeEquiv' in the target description.
+  DenseMap<Record *, const CodeGenInstruction *> NodeEquivs;
+
+  /// The distinct subtarget predicate checks and immediate predicates used by
+  /// the imported patterns. The ID of an entry is its index plus one, 0 means
+  /// "no predicate".
+  std::vector<std::string> PredicateChecks;
+  std::vector<TreePredicateFn> ImmPredicates;
+
+  void gatherNodeEquivs();
+  unsigned getPredicateCheckID(const std::string &Check);
+  unsigned getImmPredicateID(const TreePredicateFn &Pred);
+
+  /// Check whether the immediate leaf \p N can be matched, and record its
+  /// predicate in \p PredicateID.
+  /// \returns an empty string on success, the reason of the failure otherwise.
+  std::string importImmediate(const TreePatternNode *N,
+                              unsigned &PredicateID);
+
+  /// Analyze pattern \p P, filling \p Row if it can be imported.
+  /// \returns an empty string on success, the reason of the failure otherwise.
+  std::string importPattern(const PatternToMatch &P, MatchRow &Row);
+};
+
+} // end anonymous namespace
+
+GlobalISelEmitter::GlobalISelEmitter(RecordKeeper &RK)
+    : RK(RK), CGP(RK), Target(CGP.getTargetInfo()) {}
+
+void GlobalISelEmitter::gatherNodeEquivs() {
+  assert(NodeEquivs.empty());
+  for (Record *Equiv : RK.getAllDerivedDefinitions("GINodeEquiv"))
+    NodeEquivs[Equiv->getValueAsDef("Node")] =
+        &Target.getInstruction(Equiv->getValueAsDef("I"));
+}
+
+unsigned GlobalISelEmitter::getPredicateCheckID(const std::string &Check) {
+  if (Check.empty())
+    return 0;
+  auto I = std::find(PredicateChecks.begin(), PredicateChecks.end(), Check);
+  if (I != PredicateChecks.end())
+    return I - PredicateChecks.begin() + 1;
+  PredicateChecks.push_back(Check);
+  return PredicateChecks.size();
+}
+
+unsigned GlobalISelEmitter::getImmPredicateID(const TreePredicateFn &Pred) {
+  if (Pred.isAlwaysTrue())
+    return 0;
+  auto I = std::find(ImmPredicates.begin(), ImmPredicates.end(), Pred);
+  if (I != ImmPredicates.end())
+    return I - ImmPredicates.begin() + 1;
+  ImmPredicates.push_back(Pred);
+  return ImmPredicates.size();
+}
+
+std::string GlobalISelEmitter::importImmediate(const TreePatternNode *N,
+                                               unsigned &PredicateID) {
+  if (N->getTransformFn())
+    return "Immediate has a transform";
+  const std::vector<TreePredicateFn> &Preds = N->getPredicateFns();
+  if (Preds.size() > 1)
+    return "Immediate has more than one predicate";
+  PredicateID = Preds.empty() ? 0 : getImmPredicateID(Preds.front());
+  return "";
+}
+
+std::string GlobalISelEmitter::importPattern(const PatternToMatch &P,
+                                             MatchRow &Row) {
+  // Look at the source pattern: it must be a single operation with an
+  // equivalent generic instruction.
+  const TreePatternNode *Src = P.getSrcPattern();
+  if (Src->isLeaf())
+    return "Src pattern root is a leaf";
+  Record *SrcOp = Src->getOperator();
+  auto Equiv = NodeEquivs.find(SrcOp);
+  if (Equiv == NodeEquivs.end())
+    return "Pattern operator lacks an equivalent Instruction (" +
+           SrcOp->getName() + ")";
+  Row.GenericInst = Equiv->second;
+
+  // The only thing the generic instructions record is the size of their
+  // type, so only accept plain scalar integers.
+  if (Src->getNumTypes() != 1)
+    return "Src pattern does not have a single result";
+  if (!Src->getExtType(0).isConcrete())
+    return "Src pattern type is not concrete";
+  MVT VT = Src->getType(0);
+  if (!VT.isScalarInteger())
+    return "Src pattern type is not a scalar integer";
+  Row.SizeInBits = VT.getSizeInBits();
+  Row.ImmOperand = -1;
+  Row.ImmPredicateID = 0;
+
+  // Map the names of the source operands to the operands of the generic
+  // instruction.
+  std::map<std::string, int> NameToOperand;
+  if (SrcOp->getName() == "imm") {
+    // The constant itself is the operand of G_CONSTANT.
+    if (Src->getName().empty())
+      return "Src immediate is not named";
+    std::string Reason = importImmediate(Src, Row.ImmPredicateID);
+    if (!Reason.empty())
+      return Reason;
+    Row.ImmOperand = 1;
+    NameToOperand[Src->getName()] = 1;
+  } else {
+    if (!Src->getPredicateFns().empty())
+      return "Src pattern root has predicates";
+    if (Src->getTransformFn())
+      return "Src pattern root has a transform";
+
+    for (unsigned i = 0, e = Src->getNumChildren(); i != e; ++i) {
+      const TreePatternNode *Child = Src->getChild(i);
+      int OpIdx = i + 1;
+      if (Child->getName().empty())
+        return "Src operand is not named";
+      if (Child->getNumTypes() != 1 || !Child->getExtType(0).isConcrete() ||
+          Child->getType(0) != VT.SimpleTy)
+        return "Src operand type differs from the pattern type";
+
+      if (!Child->isLeaf()) {
+        if (Child->getOperator()->getName() != "imm")
+          return "Src operand is neither a leaf nor an immediate";
+        if (Row.ImmOperand != -1)
+          return "Src pattern has more than one immediate";
+        std::string Reason = importImmediate(Child, Row.ImmPredicateID);
+        if (!Reason.empty())
+          return Reason;
+        Row.ImmOperand = OpIdx;
+      } else {
+        if (!Child->getPredicateFns().empty())
+          return "Src operand has predicates";
+        DefInit *DI = dyn_cast<DefInit>(Child->getLeafValue());
+        if (!DI)
+          return "Src operand is not a record";
+        Record *LeafRec = DI->getDef();
+        if (!LeafRec->isSubClassOf("RegisterClass") &&
+            !LeafRec->isSubClassOf("RegisterOperand") &&
+            !LeafRec->isSubClassOf("ValueType"))
+          return "Src operand kind not supported (" + LeafRec->getName() +
+                 ")";
+      }
+      NameToOperand[Child->getName()] = OpIdx;
+    }
+  }
+
+  // Now look at the destination pattern: it must be a single instruction
+  // whose operands all come from the source pattern.
+  const TreePatternNode *Dst = P.getDstPattern();
+  if (Dst->isLeaf())
+    return "Dst pattern root is a leaf";
+  Record *DstOp = Dst->getOperator();
+  if (!DstOp->isSubClassOf("Instruction"))
+    return "Dst pattern root isn't an instruction";
+  const CodeGenInstruction &DstI = Target.getInstruction(DstOp);
+  if (!P.getDstRegs().empty())
+    return "Dst pattern defines physical registers";
+  if (DstI.Operands.NumDefs != 1)
+    return "Dst MI does not have a single def";
+  Record *DefRec = DstI.Operands[0].Rec;
+  if (!DefRec->isSubClassOf("RegisterClass") &&
+      !DefRec->isSubClassOf("RegisterOperand"))
+    return "Dst MI def isn't a register class";
+  if (Dst->getNumChildren() + 1 != DstI.Operands.size())
+    return "Dst pattern does not cover all the operands";
+  if (DstI.Operands.size() > 4)
+    return "Dst MI has too many operands";
+  Row.TargetInst = &DstI;
+
+  Row.OperandMap.clear();
+  Row.OperandMap.push_back(0);
+  for (unsigned i = 0, e = Dst->getNumChildren(); i != e; ++i) {
+    const TreePatternNode *Child = Dst->getChild(i);
+    // Immediates are copied over from the source pattern with their
+    // predicates, so they show up as named 'imm' nodes.
+    if (!Child->isLeaf() && Child->getOperator()->getName() != "imm")
+      return "Dst operand is neither a leaf nor an immediate";
+    if (Child->getTransformFn())
+      return "Dst operand has a transform";
+    if (DstI.Operands[i + 1].MINumOperands != 1)
+      return "Dst operand is a complex operand";
+    auto Named = NameToOperand.find(Child->getName());
+    if (Child->getName().empty() || Named == NameToOperand.end())
+      return "Dst operand does not come from the Src pattern";
+    Row.OperandMap.push_back(Named->second);
+  }
+
+  Row.PredicatesID = getPredicateCheckID(P.getPredicateCheck());
+  Row.Pattern = &P;
+  Row.Complexity = P.getPatternComplexity(CGP);
+  return "";
+}
+
+void GlobalISelEmitter::run(raw_ostream &OS) {
+  // Track the GINodeEquiv definitions.
+  gatherNodeEquivs();
+
+  emitSourceFileHeader(
+      "Global Instruction Selector for the " + Target.getName() + " target",
+      OS);
+
+  // Look through the SelectionDAG patterns we found, possibly emitting some.
+  std::vector<MatchRow> Rows;
+  for (CodeGenDAGPatterns::ptm_iterator I = CGP.ptm_begin(),
+                                        E = CGP.ptm_end();
+       I != E; ++I) {
+    const PatternToMatch &Pat = *I;
+    ++NumPatternTotal;
+    MatchRow Row;
+    std::string Reason = importPattern(Pat, Row);
+    if (!Reason.empty()) {
+      if (WarnOnSkippedPatterns)
+        PrintWarning(Pat.getSrcRecord()->getLoc(),
+                     "Skipped pattern: " + Reason);
+      ++NumPatternSkipped;
+      continue;
+    }
+    Rows.push_back(std::move(Row));
+  }
+
+  // The selector looks rows up by generic opcode, and then takes the first
+  // one that matches, so sort by opcode and put the most specific patterns
+  // first.
+  DenseMap<const CodeGenInstruction *, unsigned> OpcodeValues;
+  unsigned OpcodeValue = 0;
+  for (const CodeGenInstruction *Inst : Target.getInstructionsByEnumValue())
+    OpcodeValues[Inst] = OpcodeValue++;
+  std::stable_sort(Rows.begin(), Rows.end(),
+                   [&](const MatchRow &LHS, const MatchRow &RHS) {
+                     unsigned LHSOpc = OpcodeValues[LHS.GenericInst];
+                     unsigned RHSOpc = OpcodeValues[RHS.GenericInst];
+                     if (LHSOpc != RHSOpc)
+                       return LHSOpc < RHSOpc;
+                     return LHS.Complexity > RHS.Complexity;
+                   });
+  NumPatternEmitted += Rows.size();
+
+  std::string ClassName = Target.getName() + "InstructionSelector";
+  std::string InstNS = Target.getInstNamespace();
+
+  OS << "#ifdef GET_GLOBALISEL_IMPL\n";
+
+  // Emit the immediate predicates.
+  for (const TreePredicateFn &Pred : ImmPredicates)
+    OS << "static bool " << Pred.getFnName() << "(const ConstantInt *N) {\n"
+       << Pred.getCodeToRunOnConstantInt() << "\n}\n\n";
+
+  OS << "bool " << ClassName
+     << "::checkPredicates(unsigned PredicatesID) const {\n"
+     << "  switch (PredicatesID) {\n"
+     << "  case 0: return true;\n";
+  for (unsigned i = 0, e = PredicateChecks.size(); i != e; ++i)
+    OS << "  case " << i + 1 << ": return " << PredicateChecks[i] << ";\n";
+  OS << "  }\n"
+     << "  llvm_unreachable(\"Invalid predicate ID\");\n"
+     << "}\n\n";
+
+  OS << "bool " << ClassName << "::checkImmPredicate(unsigned PredicateID,\n"
+     << "    const ConstantInt &Imm) const {\n"
+     << "  switch (PredicateID) {\n"
+     << "  case 0: return true;\n";
+  for (unsigned i = 0, e = ImmPredicates.size(); i != e; ++i)
+    OS << "  case " << i + 1 << ": return " << ImmPredicates[i].getFnName()
+       << "(&Imm);\n";
+  OS << "  }\n"
+     << "  llvm_unreachable(\"Invalid immediate predicate ID\");\n"
+     << "}\n\n";
+
+  OS << "bool " << ClassName << "::selectImpl(MachineInstr &I) const {\n";
+  if (Rows.empty())
+    OS << "  return false;\n";
+  else {
+    OS << "  static const MatchTableEntry MatchTable[] = {\n";
+    for (const MatchRow &Row : Rows) {
+      OS << "    // Src: ";
+      Row.Pattern->getSrcPattern()->print(OS);
+      OS << "\n    // Dst: ";
+      Row.Pattern->getDstPattern()->print(OS);
+      OS << "\n    { TargetOpcode::" << Row.GenericInst->TheDef->getName()
+         << ", " << Row.SizeInBits << ", " << Row.ImmOperand << ", "
+         << Row.ImmPredicateID << ", " << Row.PredicatesID << ", " << InstNS
+         << "::" << Row.TargetInst->TheDef->getName() << ", "
+         << Row.OperandMap.size() << ", {";
+      for (unsigned i = 0, e = Row.OperandMap.size(); i != e; ++i)
+        OS << (i ? ", " : "") << Row.OperandMap[i];
+      OS << "} },\n";
+    }
+    OS << "  };\n"
+       << "  return selectFromTable(I, MatchTable, TII, TRI, RBI);\n";
+  }
+  OS << "}\n"
+     << "#endif // ifdef GET_GLOBALISEL_IMPL\n";
+}
+
+//===----------------------------------------------------------------------===//
+
+namespace llvm {
+void EmitGlobalISel(RecordKeeper &RK, raw_ostream &OS) {
+  GlobalISelEmitter(RK).run(OS);
+}
+} // End llvm namespace
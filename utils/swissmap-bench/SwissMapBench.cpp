@@ -0,0 +1,143 @@
+//===- SwissMapBench - Compare SwissMap with DenseMap ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program times insertions, successful and unsuccessful lookups and
+// erasures in a SwissMap and in a DenseMap of the same pointer keys, for maps
+// of 1000 entries up to -max-entries, and a churn of erasures and insertions
+// in a map of constant size. The times are printed in ns per operation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SwissMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<unsigned>
+    MaxEntries("max-entries", cl::desc("Time maps of up to this many entries"),
+               cl::init(10000000));
+
+static cl::opt<unsigned>
+    ChurnEntries("churn-entries",
+                 cl::desc("Number of entries of the map for the churn"),
+                 cl::init(1000));
+
+typedef std::chrono::steady_clock Clock;
+
+/// Keeps the lookups from being optimized away.
+static volatile unsigned Sink;
+
+static double nsPerOp(Clock::time_point Start, size_t NumOps) {
+  std::chrono::duration<double, std::nano> Elapsed = Clock::now() - Start;
+  return Elapsed.count() / NumOps;
+}
+
+namespace {
+/// An object the size of a small IR object. DenseMapInfo<T *> drops the low
+/// bits of pointers, so the keys must not be closer than that.
+struct Object {
+  int Data[8];
+};
+
+/// The keys are the addresses of N objects, inserted in a random order, and
+/// the misses the addresses of N other objects.
+struct Keys {
+  std::vector<Object> Objects;
+  std::vector<int *> Hits;
+  std::vector<int *> Misses;
+
+  explicit Keys(size_t N) : Objects(2 * N) {
+    std::vector<int *> All;
+    for (Object &O : Objects)
+      All.push_back(O.Data);
+    std::mt19937 Gen(N);
+    std::shuffle(All.begin(), All.end(), Gen);
+    Hits.assign(All.begin(), All.begin() + N);
+    Misses.assign(All.begin() + N, All.end());
+  }
+};
+} // end anonymous namespace
+
+/// Time insertion, successful and unsuccessful lookups and erasure of all
+/// the keys, in ns per operation.
+template <typename MapT>
+static void timeOperations(const Keys &K, double Times[4]) {
+  size_t N = K.Hits.size();
+  MapT Map;
+  auto Start = Clock::now();
+  for (size_t I = 0; I != N; ++I)
+    Map[K.Hits[I]] = I;
+  Times[0] = nsPerOp(Start, N);
+
+  unsigned Sum = 0;
+  Start = Clock::now();
+  for (int *Key : K.Hits)
+    Sum += Map.find(Key)->second;
+  Times[1] = nsPerOp(Start, N);
+
+  Start = Clock::now();
+  for (int *Key : K.Misses)
+    Sum += Map.count(Key);
+  Times[2] = nsPerOp(Start, N);
+
+  Start = Clock::now();
+  for (int *Key : K.Hits)
+    Sum += Map.erase(Key);
+  Times[3] = nsPerOp(Start, N);
+  Sink = Sum;
+}
+
+/// Time erasing the oldest of \p Live keys and inserting a new one, over the
+/// keys of \p K.
+template <typename MapT> static double timeChurn(const Keys &K, size_t Live) {
+  size_t N = K.Hits.size();
+  MapT Map;
+  for (size_t I = 0; I != Live; ++I)
+    Map[K.Hits[I]] = I;
+  auto Start = Clock::now();
+  for (size_t I = Live; I != N; ++I) {
+    Map.erase(K.Hits[I - Live]);
+    Map[K.Hits[I]] = I;
+  }
+  double Time = nsPerOp(Start, N - Live);
+  Sink = Map.size();
+  return Time;
+}
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "SwissMap benchmark\n");
+
+  outs() << "ns/op, DenseMap -> SwissMap\n";
+  outs() << "       N        insert           hit          miss"
+            "         erase\n";
+  for (size_t N = 1000; N <= MaxEntries; N *= 10) {
+    Keys K(N);
+    double Dense[4], Swiss[4];
+    timeOperations<DenseMap<int *, unsigned>>(K, Dense);
+    timeOperations<SwissMap<int *, unsigned>>(K, Swiss);
+    outs() << format("%8zu", N);
+    for (unsigned I = 0; I != 4; ++I)
+      outs() << format("  %5.1f -> %5.1f", Dense[I], Swiss[I]);
+    outs() << "\n";
+  }
+
+  Keys K(std::max<size_t>(1000000, 2 * ChurnEntries));
+  double Dense = timeChurn<DenseMap<int *, unsigned>>(K, ChurnEntries);
+  double Swiss = timeChurn<SwissMap<int *, unsigned>>(K, ChurnEntries);
+  outs() << format("%u live keys, erase+insert: %.1f -> %.1f ns/op\n",
+                   unsigned(ChurnEntries), Dense, Swiss);
+  return 0;
+}
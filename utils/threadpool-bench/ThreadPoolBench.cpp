@@ -0,0 +1,93 @@
+//===- ThreadPoolBench - Measure the overhead of ThreadPool tasks ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program runs empty tasks on a ThreadPool, so that only the cost of
+// queuing, stealing and waiting is measured, in two patterns:
+//
+// - one producer: the main thread submits every task and waits for the pool.
+// - nested producers: the main thread submits a few tasks, each of which
+//   submits its share of the tasks from a thread of the pool and waits for
+//   them as a task group.
+//
+// Each pattern runs -repeat times, and the fastest and median wall times are
+// printed in milliseconds.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<unsigned> Threads("threads",
+                                 cl::desc("Number of threads of the pool"),
+                                 cl::init(4));
+
+static cl::opt<unsigned> Tasks("tasks", cl::desc("Number of tasks per run"),
+                               cl::init(200000));
+
+static cl::opt<unsigned>
+    Producers("producers",
+              cl::desc("Number of tasks submitting the others in the nested "
+                       "pattern"),
+              cl::init(8));
+
+static cl::opt<unsigned> Repeat("repeat", cl::desc("Number of runs"),
+                                cl::init(5));
+
+typedef std::chrono::steady_clock Clock;
+
+/// Run \p Body -repeat times and print its fastest and median times.
+static void measure(StringRef Name, std::function<void()> Body) {
+  std::vector<double> Times;
+  for (unsigned I = 0; I != Repeat; ++I) {
+    auto Start = Clock::now();
+    Body();
+    std::chrono::duration<double, std::milli> Elapsed = Clock::now() - Start;
+    Times.push_back(Elapsed.count());
+  }
+  std::sort(Times.begin(), Times.end());
+  outs() << format("%-18s min %8.1f ms  median %8.1f ms\n", Name.str().c_str(),
+                   Times.front(), Times[Times.size() / 2]);
+}
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "ThreadPool benchmark\n");
+  if (!Repeat || !Producers) {
+    errs() << argv[0] << ": -repeat and -producers must not be zero\n";
+    return 1;
+  }
+
+  outs() << Tasks << " empty tasks on " << Threads << " threads\n";
+  measure("one producer", [] {
+    ThreadPool Pool(Threads);
+    for (unsigned I = 0; I != Tasks; ++I)
+      Pool.async([] {});
+    Pool.wait();
+  });
+
+  measure("nested producers", [] {
+    ThreadPool Pool(Threads);
+    for (unsigned P = 0; P != Producers; ++P)
+      Pool.async([&Pool] {
+        ThreadPoolTaskGroup Group(Pool);
+        for (unsigned I = 0, E = Tasks / Producers; I != E; ++I)
+          Group.async([] {});
+        Group.wait();
+      });
+    Pool.wait();
+  });
+  return 0;
+}